@@ -0,0 +1,898 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cheferd/networking/interface_definitions.hpp>
+#include <cheferd/networking/enforcement_table.hpp>
+#include <cheferd/networking/stats_segment.hpp>
+#include <cheferd/utils/options.hpp>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <gflags/gflags.h>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+}
+
+using namespace cheferd;
+
+DEFINE_string (local_address,
+    "0.0.0.0:50053",
+    "Defines the address of the local controller (stages connect to /tmp/<address>.socket).");
+DEFINE_int32 (stages, 1000, "Defines the number of simulated data plane stages.");
+DEFINE_int32 (jobs, 10, "Defines the number of jobs the stages belong to (round-robin).");
+DEFINE_string (job_prefix, "fake_job", "Defines the prefix of the jobs' names.");
+DEFINE_int32 (workers, 4, "Defines the number of threads serving the stages' control operations.");
+DEFINE_int32 (connectors, 1, "Defines the number of threads performing handshakes concurrently.");
+DEFINE_string (curve,
+    "constant",
+    "Defines the rate curve of each channel (constant, sine, square, ramp, or noise).");
+DEFINE_double (base_rate, 1000, "Defines the base rate (ops/s) of each channel.");
+DEFINE_double (amplitude, 500, "Defines the amplitude (ops/s) of the rate curve.");
+DEFINE_double (curve_period, 60, "Defines the period (in seconds) of the rate curve.");
+DEFINE_int32 (request_size, 4096, "Defines the size (in bytes) of each simulated request.");
+DEFINE_int32 (duration, 0, "Defines the time (in seconds) to run (0 to run until interrupted).");
+DEFINE_int32 (report_period, 5, "Defines the period (in seconds) of the progress reports.");
+DEFINE_bool (seqpacket,
+    option_default_data_plane_seqpacket,
+    "Defines if the data plane sessions use SOCK_SEQPACKET sockets (one record per message).");
+DEFINE_bool (stats_segment,
+    true,
+    "Defines if stages accept to publish their statistics in the local controller's segment.");
+DEFINE_bool (channel_stats,
+    true,
+    "Defines if stages report per-channel statistics records (otherwise, they answer as stages of "
+    "the previous version, which only report their total rate).");
+DEFINE_bool (enforcement_table,
+    true,
+    "Defines if stages accept to apply their rules from the local controller's enforcement table.");
+
+// Time (in milliseconds) that workers wait for control operations before serving new stages.
+#define FAKE_STAGE_POLL_TIMEOUT 50
+
+// Time (in milliseconds) that a stage retries connecting to the socket of its data plane session.
+#define FAKE_STAGE_CONNECT_TIMEOUT 5000
+
+// Maximum size of the payload of a control operation.
+#define FAKE_STAGE_MAX_PAYLOAD 4096
+
+namespace {
+
+std::atomic<bool> running { true };
+
+/**
+ * SimulationStats struct.
+ * Statistics of the simulation, shared by every thread.
+ * - m_handshakes, m_failed_handshakes: number of handshakes completed and failed.
+ * - m_ready_stages: number of stages marked as ready by the local controller.
+ * - m_disconnected_stages: number of stages whose local controller closed the connection.
+ * - m_housekeeping_rules, m_enforcement_rules: number of rules acknowledged.
+ * - m_stats_requests: number of statistics requests served.
+ * - m_stats_publications: number of statistics published in the statistics segment.
+ * - m_table_rules: number of enforcement rules applied from the enforcement table.
+ * - m_latencies_lock: mutex for concurrency control over m_ready_latencies.
+ * - m_ready_latencies: time (in microseconds) from the first connection of each stage until it
+ * was marked as ready.
+ */
+struct SimulationStats {
+    std::atomic<uint64_t> m_handshakes { 0 };
+    std::atomic<uint64_t> m_failed_handshakes { 0 };
+    std::atomic<uint64_t> m_ready_stages { 0 };
+    std::atomic<uint64_t> m_disconnected_stages { 0 };
+    std::atomic<uint64_t> m_housekeeping_rules { 0 };
+    std::atomic<uint64_t> m_enforcement_rules { 0 };
+    std::atomic<uint64_t> m_stats_requests { 0 };
+    std::atomic<uint64_t> m_stats_publications { 0 };
+    std::atomic<uint64_t> m_table_rules { 0 };
+    std::mutex m_latencies_lock {};
+    std::vector<double> m_ready_latencies {};
+};
+
+SimulationStats simulation_stats {};
+
+// shared-memory segments of the local controller, attached once and shared by every stage
+std::mutex shared_segments_lock {};
+StatsSegment stats_segment {};
+EnforcementTable enforcement_table {};
+
+// attach_shared_segment call. Attaches to a shared-memory segment of the local controller.
+template <typename Segment>
+bool attach_shared_segment (Segment& segment,
+    uint32_t version,
+    const SharedSegmentRaw& segment_info)
+{
+    std::unique_lock<std::mutex> lock_t { shared_segments_lock };
+    std::string name (segment_info.m_name,
+        strnlen (segment_info.m_name, shared_segment_name_max_size));
+
+    if (!segment.is_mapped () && !segment.attach (name).isOk ()) {
+        return false;
+    }
+
+    return segment.name () == name && segment_info.m_version == version
+        && segment_info.m_slot >= 0 && segment_info.m_slot < segment.slots ();
+}
+
+// read_full call. Reads exactly size bytes from a socket.
+bool read_full (int socket, void* buffer, std::size_t size)
+{
+    std::size_t done = 0;
+    while (done < size) {
+        ssize_t value = ::read (socket, static_cast<char*> (buffer) + done, size - done);
+        if (value <= 0) {
+            return false;
+        }
+        done += value;
+    }
+    return true;
+}
+
+// write_full call. Writes exactly size bytes to a socket.
+bool write_full (int socket, const void* buffer, std::size_t size)
+{
+    std::size_t done = 0;
+    while (done < size) {
+        ssize_t value = ::send (socket,
+            static_cast<const char*> (buffer) + done,
+            size - done,
+            MSG_NOSIGNAL);
+        if (value <= 0) {
+            return false;
+        }
+        done += value;
+    }
+    return true;
+}
+
+// connect_unix call. Connects to a UNIX domain socket of the given type (-1 on failure).
+int connect_unix (const std::string& socket_name, int type)
+{
+    int socket_t = socket (AF_UNIX, type, 0);
+    if (socket_t < 0) {
+        return -1;
+    }
+
+    struct sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    strncpy (address.sun_path, socket_name.c_str (), sizeof (address.sun_path) - 1);
+
+    if (connect (socket_t, (struct sockaddr*)&address, sizeof (address)) < 0) {
+        close (socket_t);
+        return -1;
+    }
+
+    return socket_t;
+}
+
+// now_ns call. Gets the time of the monotonic clock, in nanoseconds.
+uint64_t now_ns ()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (
+        std::chrono::steady_clock::now ().time_since_epoch ())
+        .count ();
+}
+
+/**
+ * RateCurve class.
+ * Synthetic rate (ops/s) of a channel over time, shifted by a per-stage phase so that the stages
+ * do not change in lockstep.
+ * Currently, the RateCurve class contains the following variables:
+ * - shape_: shape of the curve (constant, sine, square, ramp, or noise).
+ * - base_, amplitude_: base rate and amplitude of the curve.
+ * - period_: period (in seconds) of the curve.
+ * - noise_: generator of the noise curve.
+ */
+class RateCurve {
+
+private:
+    std::string shape_;
+    double base_;
+    double amplitude_;
+    double period_;
+    std::mt19937 noise_;
+
+public:
+    RateCurve (std::string shape, double base, double amplitude, double period, unsigned seed) :
+        shape_ { std::move (shape) },
+        base_ { base },
+        amplitude_ { amplitude },
+        period_ { std::max (period, 1e-3) },
+        noise_ { seed }
+    { }
+
+    /**
+     * rate: Gets the rate of the curve at a point in time.
+     * @param time Time (in seconds, including the phase of the stage).
+     * @return Rate (ops/s), never negative.
+     */
+    double rate (double time)
+    {
+        double position = std::fmod (time, period_) / period_;
+        double value = base_;
+
+        if (shape_ == "sine") {
+            value += amplitude_ * std::sin (2 * M_PI * position);
+        } else if (shape_ == "square") {
+            value += position < 0.5 ? amplitude_ : -amplitude_;
+        } else if (shape_ == "ramp") {
+            value += amplitude_ * (2 * position - 1);
+        } else if (shape_ == "noise") {
+            value += std::uniform_real_distribution<double> { -amplitude_, amplitude_ } (noise_);
+        }
+
+        return std::max (value, 0.0);
+    }
+};
+
+/**
+ * FakeChannel struct.
+ * Channel of a simulated data plane stage.
+ * - m_channel_id: channel identifier (from the housekeeping rules).
+ * - m_limit: rate limit (ops/s) enforced by the control plane (negative if unlimited).
+ * - m_ops_rate, m_bytes_rate: rates served at the last update.
+ * - m_total_ops, m_total_bytes, m_delayed_ops: counters since the channel was created.
+ */
+struct FakeChannel {
+    long m_channel_id { -1 };
+    double m_limit { -1 };
+    double m_ops_rate { 0 };
+    double m_bytes_rate { 0 };
+    double m_total_ops { 0 };
+    double m_total_bytes { 0 };
+    double m_delayed_ops { 0 };
+};
+
+/**
+ * FakeStage class.
+ * Simulated data plane stage that speaks the UNIX-socket protocol of PAIO: it performs the
+ * handshake with the local controller, acknowledges housekeeping and enforcement rules, and answers
+ * statistics requests with the rates of its synthetic curve (capped by the enforced limits).
+ * Currently, the FakeStage class contains the following variables:
+ * - index_: index of the stage in the simulation.
+ * - handshake_: identification of the stage sent at the handshake.
+ * - socket_: socket of the data plane session (-1 if not connected).
+ * - curve_: synthetic rate curve of the channels.
+ * - phase_: time shift (in seconds) of the curve.
+ * - channels_: channels created by housekeeping rules.
+ * - stats_slot_: slot of the stage in the statistics segment (-1 if it does not publish).
+ * - enforcement_slot_: slot of the stage in the enforcement table (-1 if it does not use it).
+ * - enforcement_generations_: generation of each entry of the enforcement table at its last read.
+ * - last_update_: time (monotonic clock, in nanoseconds) at which the counters were updated.
+ * - connect_start_: time at which the handshake started.
+ */
+class FakeStage {
+
+private:
+    int index_;
+    StageSimplifiedHandshakeRaw handshake_;
+    int socket_;
+    RateCurve curve_;
+    double phase_;
+    std::vector<FakeChannel> channels_;
+    int stats_slot_;
+    int enforcement_slot_;
+    std::vector<uint64_t> enforcement_generations_;
+    uint64_t last_update_;
+    std::chrono::steady_clock::time_point connect_start_;
+
+    // channel call. Gets a channel, creating it if needed.
+    FakeChannel& channel (long channel_id)
+    {
+        for (auto& channel : channels_) {
+            if (channel.m_channel_id == channel_id) {
+                return channel;
+            }
+        }
+
+        FakeChannel channel {};
+        channel.m_channel_id = channel_id;
+        channels_.push_back (channel);
+        return channels_.back ();
+    }
+
+    // update_counters call. Advances the counters of every channel until now.
+    void update_counters ()
+    {
+        uint64_t now = now_ns ();
+        double elapsed = (now - last_update_) / 1e9;
+        double rate = curve_.rate (now / 1e9 + phase_);
+        last_update_ = now;
+
+        for (auto& channel : channels_) {
+            double served = channel.m_limit >= 0 ? std::min (rate, channel.m_limit) : rate;
+            channel.m_ops_rate = served;
+            channel.m_bytes_rate = served * FLAGS_request_size;
+            channel.m_total_ops += served * elapsed;
+            channel.m_total_bytes += served * elapsed * FLAGS_request_size;
+            channel.m_delayed_ops += (rate - served) * elapsed;
+        }
+    }
+
+    // acknowledge call. Writes an ACK to the data plane session.
+    bool acknowledge (AckCode code)
+    {
+        ACK ack { static_cast<int> (code) };
+        return write_full (socket_, &ack, sizeof (ACK));
+    }
+
+    // serve_housekeeping_rule call. Applies a housekeeping rule (channels and initial limits).
+    bool serve_housekeeping_rule (const ControlOperation& operation, const char* payload)
+    {
+        if (operation.m_operation_subtype == HSK_CREATE_CHANNEL
+            && operation.m_size == sizeof (HousekeepingCreateChannelRaw)) {
+            HousekeepingCreateChannelRaw rule {};
+            std::memcpy (&rule, payload, sizeof (rule));
+            update_counters ();
+            channel (rule.m_channel_id);
+        } else if (operation.m_operation_subtype == HSK_CREATE_OBJECT
+            && operation.m_size == sizeof (HousekeepingCreateObjectRaw)) {
+            HousekeepingCreateObjectRaw rule {};
+            std::memcpy (&rule, payload, sizeof (rule));
+            update_counters ();
+            channel (rule.m_channel_id).m_limit = static_cast<double> (rule.m_property_second);
+        }
+
+        simulation_stats.m_housekeeping_rules++;
+        return acknowledge (AckCode::ok);
+    }
+
+    // apply_enforcement_rule call. Applies an enforcement rule (init or rate of a DRL object).
+    void apply_enforcement_rule (const EnforcementRuleRaw& rule)
+    {
+        update_counters ();
+
+        // init (1) sets <refill period, rate>; rate (2) sets <rate>
+        if (rule.m_enforcement_operation == 1) {
+            channel (rule.m_channel_id).m_limit = static_cast<double> (rule.m_property_second);
+        } else if (rule.m_enforcement_operation == 2) {
+            channel (rule.m_channel_id).m_limit = static_cast<double> (rule.m_property_first);
+        }
+    }
+
+    // serve_enforcement_rule call. Applies an enforcement rule received through the socket.
+    bool serve_enforcement_rule (const char* payload)
+    {
+        EnforcementRuleRaw rule {};
+        std::memcpy (&rule, payload, sizeof (rule));
+        apply_enforcement_rule (rule);
+
+        simulation_stats.m_enforcement_rules++;
+        return acknowledge (AckCode::ok);
+    }
+
+    // fill_channel_records call. Converts the channels into the records sent to the control plane.
+    void fill_channel_records (std::vector<StatsChannelRaw>& records) const
+    {
+        records.resize (std::min (static_cast<int> (channels_.size ()), stats_max_channels));
+        uint64_t timestamp = now_ns ();
+
+        for (std::size_t i = 0; i < records.size (); i++) {
+            const FakeChannel& channel = channels_[i];
+            records[i] = StatsChannelRaw {};
+            records[i].m_channel_id = channel.m_channel_id;
+            records[i].m_ops_rate = channel.m_ops_rate;
+            records[i].m_bytes_rate = channel.m_bytes_rate;
+            records[i].m_total_ops = static_cast<uint64_t> (channel.m_total_ops);
+            records[i].m_delayed_ops = static_cast<uint64_t> (channel.m_delayed_ops);
+            records[i].m_total_bytes = static_cast<uint64_t> (channel.m_total_bytes);
+            records[i].m_timestamp = timestamp;
+        }
+    }
+
+    // serve_stats_segment call. Accepts (or refuses) to publish in the statistics segment.
+    bool serve_stats_segment (const ControlOperation& operation, const char* payload)
+    {
+        if (!FLAGS_stats_segment || operation.m_size != sizeof (SharedSegmentRaw)) {
+            return acknowledge (AckCode::error);
+        }
+
+        SharedSegmentRaw segment_info {};
+        std::memcpy (&segment_info, payload, sizeof (segment_info));
+        if (!attach_shared_segment (stats_segment, stats_segment_version, segment_info)) {
+            return acknowledge (AckCode::error);
+        }
+
+        stats_slot_ = segment_info.m_slot;
+        return acknowledge (AckCode::ok);
+    }
+
+    // serve_enforcement_table call. Accepts (or refuses) to apply rules from the enforcement table.
+    bool serve_enforcement_table (const ControlOperation& operation, const char* payload)
+    {
+        if (!FLAGS_enforcement_table || operation.m_size != sizeof (SharedSegmentRaw)) {
+            return acknowledge (AckCode::error);
+        }
+
+        SharedSegmentRaw segment_info {};
+        std::memcpy (&segment_info, payload, sizeof (segment_info));
+        if (!attach_shared_segment (enforcement_table, enforcement_table_version, segment_info)) {
+            return acknowledge (AckCode::error);
+        }
+
+        enforcement_slot_ = segment_info.m_slot;
+        std::fill (enforcement_generations_.begin (), enforcement_generations_.end (), 0);
+        return acknowledge (AckCode::ok);
+    }
+
+    // serve_stats_version call. Accepts (or refuses) to report per-channel statistics records.
+    bool serve_stats_version (const ControlOperation& operation, const char* payload)
+    {
+        if (!FLAGS_channel_stats || operation.m_size != sizeof (StatsVersionRaw)) {
+            return acknowledge (AckCode::error);
+        }
+
+        StatsVersionRaw version {};
+        std::memcpy (&version, payload, sizeof (version));
+        return acknowledge (
+            version.m_version == stats_channel_version ? AckCode::ok : AckCode::error);
+    }
+
+    // serve_statistics call. Answers a statistics request.
+    bool serve_statistics (const ControlOperation& operation)
+    {
+        update_counters ();
+        simulation_stats.m_stats_requests++;
+
+        if (operation.m_operation_subtype == COLLECT_GLOBAL_STATS) {
+            StatsGlobalRaw stats { 0 };
+            for (const auto& channel : channels_) {
+                stats.m_total_rate += channel.m_ops_rate;
+            }
+            return write_full (socket_, &stats, sizeof (StatsGlobalRaw));
+        }
+
+        if (operation.m_operation_subtype == COLLECT_CHANNEL_STATS && FLAGS_channel_stats) {
+            std::vector<StatsChannelRaw> records {};
+            fill_channel_records (records);
+
+            StatsChannelHeaderRaw header {};
+            header.m_record_size = sizeof (StatsChannelRaw);
+            header.m_channels = static_cast<int> (records.size ());
+
+            // the header and the records are written at once (a single SOCK_SEQPACKET record)
+            std::size_t records_size = records.size () * sizeof (StatsChannelRaw);
+            std::vector<char> message (sizeof (header) + records_size);
+            std::memcpy (message.data (), &header, sizeof (header));
+            std::memcpy (message.data () + sizeof (header), records.data (), records_size);
+
+            return write_full (socket_, message.data (), message.size ());
+        }
+
+        return false;
+    }
+
+public:
+    FakeStage (int index, const std::string& job_name, RateCurve curve, double phase) :
+        index_ { index },
+        handshake_ {},
+        socket_ { -1 },
+        curve_ { std::move (curve) },
+        phase_ { phase },
+        channels_ {},
+        stats_slot_ { -1 },
+        enforcement_slot_ { -1 },
+        enforcement_generations_ (enforcement_table_max_rules, 0),
+        last_update_ { now_ns () },
+        connect_start_ {}
+    {
+        std::string stage_env = "stage" + std::to_string (index);
+        strncpy (handshake_.m_stage_name, job_name.c_str (), stage_name_max_size - 1);
+        strncpy (handshake_.m_stage_env, stage_env.c_str (), stage_env_max_size - 1);
+        handshake_.m_pid = getpid ();
+        handshake_.m_ppid = getppid ();
+        gethostname (handshake_.m_stage_hostname, HOST_NAME_MAX - 1);
+        strncpy (handshake_.m_stage_user, "cheferd", LOGIN_NAME_MAX - 1);
+    }
+
+    ~FakeStage ()
+    {
+        disconnect ();
+    }
+
+    /**
+     * handshake: Performs the handshake with the local controller: sends the identification of
+     * the stage, reads the address of its data plane session, and connects to it.
+     * @param control_socket_name Socket of the local controller.
+     * @return Returns true if the stage is connected to its data plane session.
+     */
+    bool handshake (const std::string& control_socket_name)
+    {
+        connect_start_ = std::chrono::steady_clock::now ();
+        int control_socket = connect_unix (control_socket_name, SOCK_STREAM);
+        if (control_socket < 0) {
+            return false;
+        }
+
+        ControlOperation operation {};
+        StageHandshakeRaw address {};
+        bool received = read_full (control_socket, &operation, sizeof (operation))
+            && operation.m_operation_type == STAGE_HANDSHAKE
+            && write_full (control_socket, &handshake_, sizeof (handshake_))
+            && read_full (control_socket, &address, sizeof (address));
+        close (control_socket);
+
+        if (!received) {
+            return false;
+        }
+
+        // the data plane session listens before its address is sent, but it may not accept yet
+        address.m_address[stage_max_handshake_address_size - 1] = '\0';
+        auto deadline = std::chrono::steady_clock::now ()
+            + std::chrono::milliseconds (FAKE_STAGE_CONNECT_TIMEOUT);
+        int type = FLAGS_seqpacket ? SOCK_SEQPACKET : SOCK_STREAM;
+        while ((socket_ = connect_unix (address.m_address, type)) < 0
+            && std::chrono::steady_clock::now () < deadline) {
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        }
+
+        return socket_ >= 0;
+    }
+
+    /**
+     * serve_operation: Reads a control operation from the data plane session and answers it.
+     * @return Returns false if the session was closed.
+     */
+    bool serve_operation ()
+    {
+        ControlOperation operation {};
+        char payload[FAKE_STAGE_MAX_PAYLOAD];
+        std::size_t payload_size = 0;
+        ssize_t record_size = 0;
+
+        // with SOCK_SEQPACKET, the ControlOperation and its payload are a single record
+        if (FLAGS_seqpacket) {
+            struct iovec iov[2] { { &operation, sizeof (operation) },
+                { payload, sizeof (payload) } };
+            record_size = ::readv (socket_, iov, 2);
+            if (record_size < static_cast<ssize_t> (sizeof (operation))) {
+                return false;
+            }
+        } else if (!read_full (socket_, &operation, sizeof (operation))) {
+            return false;
+        }
+
+        // every operation with a payload sends it right after the ControlOperation
+
+        switch (operation.m_operation_type) {
+            case STAGE_READY:
+            case CREATE_HSK_RULE:
+            case CREATE_ENF_RULE:
+            case STAGE_STATS_SEGMENT:
+            case STAGE_ENF_TABLE:
+            case STAGE_STATS_VERSION:
+                payload_size = static_cast<std::size_t> (std::max (operation.m_size, 0));
+                break;
+            case REMOVE_RULE:
+                payload_size = sizeof (ControlOperation);
+                break;
+            default:
+                break;
+        }
+
+        if (payload_size > sizeof (payload)) {
+            return false;
+        } else if (FLAGS_seqpacket) {
+            if (static_cast<std::size_t> (record_size) != sizeof (operation) + payload_size) {
+                return false;
+            }
+        } else if (!read_full (socket_, payload, payload_size)) {
+            return false;
+        }
+
+        switch (operation.m_operation_type) {
+            case STAGE_READY: {
+                simulation_stats.m_ready_stages++;
+                auto latency = std::chrono::duration<double, std::micro> (
+                    std::chrono::steady_clock::now () - connect_start_);
+                {
+                    std::unique_lock<std::mutex> lock_t { simulation_stats.m_latencies_lock };
+                    simulation_stats.m_ready_latencies.push_back (latency.count ());
+                }
+                return acknowledge (AckCode::ok);
+            }
+
+            case CREATE_HSK_RULE:
+                return serve_housekeeping_rule (operation, payload);
+
+            case CREATE_ENF_RULE:
+                return operation.m_size == sizeof (EnforcementRuleRaw)
+                    ? serve_enforcement_rule (payload)
+                    : acknowledge (AckCode::error);
+
+            case REMOVE_RULE:
+                // the control plane reads two ACKs (submission and removal)
+                return acknowledge (AckCode::ok) && acknowledge (AckCode::ok);
+
+            case COLLECT_DETAILED_STATS:
+                return serve_statistics (operation);
+
+            case STAGE_STATS_SEGMENT:
+                return serve_stats_segment (operation, payload);
+
+            case STAGE_ENF_TABLE:
+                return serve_enforcement_table (operation, payload);
+
+            case STAGE_STATS_VERSION:
+                return serve_stats_version (operation, payload);
+
+            default:
+                std::cerr << "FakeStage-" << index_ << ": operation "
+                          << operation.m_operation_type << " not supported.\n";
+                return false;
+        }
+    }
+
+    /**
+     * publish_statistics: Publishes the statistics of the stage in the statistics segment (if the
+     * stage publishes in it).
+     */
+    void publish_statistics ()
+    {
+        if (stats_slot_ < 0) {
+            return;
+        }
+
+        update_counters ();
+        std::vector<StatsChannelRaw> records {};
+        fill_channel_records (records);
+        stats_segment.publish (stats_slot_, records);
+        simulation_stats.m_stats_publications++;
+    }
+
+    /**
+     * refresh_limits: Applies the rules of the enforcement table that changed since the last
+     * refresh (if the stage uses the table), as a PAIO stage does when refilling its token buckets.
+     */
+    void refresh_limits ()
+    {
+        if (enforcement_slot_ < 0) {
+            return;
+        }
+
+        EnforcementRuleRaw rule {};
+        for (int entry = 0; entry < enforcement_table_max_rules; entry++) {
+            if (enforcement_table
+                    .read (enforcement_slot_, entry, enforcement_generations_[entry], rule)
+                    .isOk ()) {
+                apply_enforcement_rule (rule);
+                simulation_stats.m_table_rules++;
+            }
+        }
+    }
+
+    /**
+     * disconnect: Closes the connection to the data plane session.
+     */
+    void disconnect ()
+    {
+        if (socket_ >= 0) {
+            close (socket_);
+            socket_ = -1;
+        }
+    }
+
+    /**
+     * socket: Gets the socket of the data plane session.
+     */
+    int socket () const
+    {
+        return socket_;
+    }
+};
+
+/**
+ * StageWorker class.
+ * Serves the control operations of a set of stages, polling their sockets from a single thread.
+ * Currently, the StageWorker class contains the following variables:
+ * - incoming_lock_: mutex for concurrency control over incoming_.
+ * - incoming_: stages connected and not yet served by the worker.
+ * - stages_: stages served by the worker.
+ */
+class StageWorker {
+
+private:
+    std::mutex incoming_lock_;
+    std::vector<FakeStage*> incoming_;
+    std::vector<FakeStage*> stages_;
+
+public:
+    /**
+     * add: Hands a connected stage to the worker.
+     * @param stage Stage connected to its data plane session.
+     */
+    void add (FakeStage* stage)
+    {
+        std::unique_lock<std::mutex> lock_t { incoming_lock_ };
+        incoming_.push_back (stage);
+    }
+
+    /**
+     * run: Serves the stages until the simulation stops.
+     */
+    void run ()
+    {
+        std::vector<struct pollfd> sockets;
+
+        while (running.load ()) {
+            {
+                std::unique_lock<std::mutex> lock_t { incoming_lock_ };
+                stages_.insert (stages_.end (), incoming_.begin (), incoming_.end ());
+                incoming_.clear ();
+            }
+
+            sockets.resize (stages_.size ());
+            for (std::size_t i = 0; i < stages_.size (); i++) {
+                sockets[i] = { stages_[i]->socket (), POLLIN, 0 };
+            }
+
+            int ready = poll (sockets.data (), sockets.size (), FAKE_STAGE_POLL_TIMEOUT);
+
+            // stages refill their limits and publish their statistics at every round of the worker
+            for (auto* stage : stages_) {
+                stage->refresh_limits ();
+                stage->publish_statistics ();
+            }
+
+            if (ready <= 0) {
+                continue;
+            }
+
+            for (std::size_t i = 0; i < stages_.size (); i++) {
+                if (sockets[i].revents != 0 && !stages_[i]->serve_operation ()) {
+                    stages_[i]->disconnect ();
+                    stages_[i] = nullptr;
+                    simulation_stats.m_disconnected_stages++;
+                }
+            }
+
+            stages_.erase (std::remove (stages_.begin (), stages_.end (), nullptr), stages_.end ());
+        }
+    }
+};
+
+// percentile call. Gets a percentile of sorted values.
+double percentile (const std::vector<double>& sorted_values, double rank)
+{
+    if (sorted_values.empty ()) {
+        return 0;
+    }
+    return sorted_values[static_cast<std::size_t> (rank / 100 * (sorted_values.size () - 1))];
+}
+
+// report call. Prints the progress of the simulation.
+void report (double elapsed, uint64_t& last_stats_requests)
+{
+    std::vector<double> latencies;
+    {
+        std::unique_lock<std::mutex> lock_t { simulation_stats.m_latencies_lock };
+        latencies = simulation_stats.m_ready_latencies;
+    }
+    std::sort (latencies.begin (), latencies.end ());
+
+    uint64_t stats_requests = simulation_stats.m_stats_requests.load ();
+
+    std::cout << "[" << elapsed << " s] ready: " << simulation_stats.m_ready_stages.load ()
+              << "/" << FLAGS_stages << " (failed " << simulation_stats.m_failed_handshakes.load ()
+              << ", disconnected " << simulation_stats.m_disconnected_stages.load ()
+              << ")\thandshake p50/p99: " << percentile (latencies, 50) / 1000 << "/"
+              << percentile (latencies, 99) / 1000
+              << " ms\thousekeeping: " << simulation_stats.m_housekeeping_rules.load ()
+              << "\tenforcement: " << simulation_stats.m_enforcement_rules.load ()
+              << "\tstats requests/s: "
+              << (stats_requests - last_stats_requests) / static_cast<double> (FLAGS_report_period)
+              << "\tstats publications: " << simulation_stats.m_stats_publications.load ()
+              << "\ttable rules: " << simulation_stats.m_table_rules.load () << "\n";
+
+    last_stats_requests = stats_requests;
+}
+
+} // namespace
+
+/**
+ * Simulates thousands of PAIO data plane stages in one process, against a running local
+ * controller. Every stage performs the full handshake (identification, address of its data plane
+ * session, housekeeping rules, and stage ready), acknowledges enforcement rules (or applies them
+ * from the enforcement table of the local controller, when offered), and answers statistics
+ * requests with a synthetic rate curve (or publishes its statistics in the statistics segment of
+ * the local controller, when offered). Reports the handshake throughput and latency, and the rate
+ * of statistics requests served.
+ */
+int main (int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags (&argc, &argv, true);
+    signal (SIGINT, [] (int) { running = false; });
+    signal (SIGTERM, [] (int) { running = false; });
+
+    std::string control_socket_name = "/tmp/" + FLAGS_local_address + ".socket";
+    int total_jobs = std::max (FLAGS_jobs, 1);
+
+    std::vector<std::unique_ptr<FakeStage>> stages;
+    stages.reserve (FLAGS_stages);
+    for (int i = 0; i < FLAGS_stages; i++) {
+        std::string job_name = FLAGS_job_prefix + std::to_string (i % total_jobs);
+        double phase = FLAGS_curve_period * i / std::max (FLAGS_stages, 1);
+        RateCurve curve {
+            FLAGS_curve, FLAGS_base_rate, FLAGS_amplitude, FLAGS_curve_period, 42u + i
+        };
+        stages.push_back (std::make_unique<FakeStage> (i, job_name, std::move (curve), phase));
+    }
+
+    std::vector<StageWorker> workers (std::max (FLAGS_workers, 1));
+    std::vector<std::thread> threads;
+    for (auto& worker : workers) {
+        threads.emplace_back (&StageWorker::run, &worker);
+    }
+
+    // connectors take the next stage to handshake, and hand it to its worker once connected
+    auto start = std::chrono::steady_clock::now ();
+    std::atomic<int> next_stage { 0 };
+    std::vector<std::thread> connectors;
+
+    for (int i = 0; i < std::max (FLAGS_connectors, 1); i++) {
+        connectors.emplace_back ([&] {
+            int stage;
+            while (running.load () && (stage = next_stage.fetch_add (1)) < FLAGS_stages) {
+                if (stages[stage]->handshake (control_socket_name)) {
+                    simulation_stats.m_handshakes++;
+                    workers[stage % workers.size ()].add (stages[stage].get ());
+                } else {
+                    simulation_stats.m_failed_handshakes++;
+                    std::cerr << "FakeStage-" << stage << ": handshake failed.\n";
+                }
+            }
+        });
+    }
+
+    uint64_t last_stats_requests = 0;
+    auto next_report = start + std::chrono::seconds (FLAGS_report_period);
+    bool all_ready_reported = false;
+
+    while (running.load ()) {
+        std::this_thread::sleep_for (std::chrono::milliseconds (100));
+        auto now = std::chrono::steady_clock::now ();
+        double elapsed = std::chrono::duration<double> (now - start).count ();
+
+        if (!all_ready_reported
+            && simulation_stats.m_ready_stages.load () == static_cast<uint64_t> (FLAGS_stages)) {
+            std::cout << "all " << FLAGS_stages << " stages ready in " << elapsed << " s ("
+                      << FLAGS_stages / elapsed << " handshakes/s)\n";
+            all_ready_reported = true;
+        }
+
+        if (now >= next_report) {
+            report (elapsed, last_stats_requests);
+            next_report += std::chrono::seconds (FLAGS_report_period);
+        }
+
+        if (FLAGS_duration > 0 && elapsed >= FLAGS_duration) {
+            running = false;
+        }
+    }
+
+    for (auto& connector : connectors) {
+        connector.join ();
+    }
+    for (auto& thread : threads) {
+        thread.join ();
+    }
+
+    report (std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count (),
+        last_stats_requests);
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <chrono>
+#include <cheferd/controller/job_table.hpp>
+#include <cheferd/controller/max_min_allocator.hpp>
+#include <iostream>
+#include <random>
+
+using namespace cheferd;
+
+// Number of control cycles measured per number of stages.
+#define BENCHMARK_CYCLES 20
+
+// Number of data plane stages of each job.
+#define BENCHMARK_STAGES_PER_JOB 10
+
+// Number of local controllers the stages are spread across.
+#define BENCHMARK_LOCALS 100
+
+// Capacity of each operation (e.g., IOPS).
+#define BENCHMARK_CAPACITY 220000000L
+
+/**
+ * Measures the cost per cycle of the compute and batching phases of the core controller
+ * (water-filling of each operation, followed by batching the enforcement rules of every job per
+ * local controller) over a JobTable with an increasing number of data plane stages, whose jobs'
+ * demands change at each cycle.
+ */
+int main (int argc, char** argv)
+{
+    std::mt19937_64 generator { 42 };
+    MaxMinAllocator allocator {};
+    const std::vector<std::string> operations { "read", "write", "open" };
+
+    for (int total_stages : { 1000, 10000, 100000 }) {
+        JobTable table {};
+        int total_jobs = total_stages / BENCHMARK_STAGES_PER_JOB;
+
+        for (const auto& operation : operations) {
+            table.register_operation (operation, BENCHMARK_CAPACITY);
+        }
+
+        for (int stage = 0; stage < total_stages; stage++) {
+            table.register_stage ("job" + std::to_string (stage % total_jobs),
+                std::to_string (stage),
+                "local" + std::to_string (stage % BENCHMARK_LOCALS));
+        }
+
+        std::uniform_int_distribution<long> demand_distribution { 1,
+            2 * BENCHMARK_CAPACITY / total_jobs };
+        std::vector<long> demands;
+        std::vector<long> rates;
+        std::size_t batched_rules = 0;
+        auto elapsed = std::chrono::nanoseconds::zero ();
+
+        for (int cycle = 0; cycle < BENCHMARK_CYCLES; cycle++) {
+            for (int op = 0; op < table.total_operations (); op++) {
+                for (int job : table.active_jobs ()) {
+                    table.demands (op)[job] = demand_distribution (generator);
+                }
+            }
+
+            auto start = std::chrono::steady_clock::now ();
+            const std::vector<int>& active_jobs = table.active_jobs ();
+
+            for (int op = 0; op < table.total_operations (); op++) {
+                demands.clear ();
+                for (int job : active_jobs) {
+                    demands.push_back (table.demands (op)[job]);
+                }
+
+                allocator.allocate (demands, table.capacity (op), rates);
+
+                for (std::size_t i = 0; i < active_jobs.size (); i++) {
+                    table.rates (op)[active_jobs[i]] = rates[i];
+                    table.previous_rates (op)[active_jobs[i]] = rates[i];
+                    table.batch_enforcement_rule (active_jobs[i], op, rates[i]);
+                }
+            }
+
+            for (int local : table.batched_locals ()) {
+                batched_rules += table.local_rules (local)->size ();
+            }
+            table.clear_batches ();
+
+            elapsed += std::chrono::steady_clock::now () - start;
+        }
+
+        auto cycle_ns
+            = std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ()
+            / BENCHMARK_CYCLES;
+
+        std::cout << "stages: " << total_stages << "\tjobs: " << total_jobs
+                  << "\tcycle: " << cycle_ns / 1000.0
+                  << " µs\trules: " << batched_rules / BENCHMARK_CYCLES << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,761 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cheferd/controller/core_control_application.hpp>
+#include <cheferd/networking/core_connection_manager.hpp>
+#include <cheferd/networking/interface_definitions.hpp>
+#include <cheferd/networking/metrics_server.hpp>
+#include <cheferd/session/policy_generator.hpp>
+#include <cheferd/utils/logging.hpp>
+#include <cheferd/utils/rules_file_parser.hpp>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <gflags/gflags.h>
+#include <grpcpp/grpcpp.h>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+}
+
+using namespace cheferd;
+
+DEFINE_string (core_address, "127.0.0.1:50051", "Defines the address of the core controller.");
+DEFINE_int32 (metrics_port, 50090, "Defines the port of the core controller's metrics endpoint.");
+DEFINE_string (locals,
+    "10,100,1000",
+    "Defines the number of simulated local controllers of each configuration (comma-separated).");
+DEFINE_string (stages_per_local,
+    "10",
+    "Defines the number of virtual stages per local controller of each configuration "
+    "(comma-separated; every combination with --locals is run).");
+DEFINE_int32 (jobs, 10, "Defines the number of jobs the stages belong to (round-robin).");
+DEFINE_string (job_prefix, "fleet_job", "Defines the prefix of the jobs' names.");
+DEFINE_int32 (control_type,
+    2,
+    "Defines the control algorithm (1 - static, 2 - dynamic vanilla, 3 - dynamic leftover, "
+    "5 - dynamic water filling).");
+DEFINE_string (housekeeping_rules_file,
+    option_housekeeping_rules_file_path_posix_dynamic,
+    "Defines the housekeeping rules sent to the local controllers.");
+DEFINE_int32 (system_limit, 1000000, "Defines the maximum rate (ops/s) of the system.");
+DEFINE_int32 (job_demand,
+    10000,
+    "Defines the demand (ops/s) of each job, per operation (0 to submit no demands).");
+DEFINE_int32 (cycle_period, 1000000, "Defines the (fixed) feedback loop period (in µs).");
+DEFINE_int32 (local_interface_pollers,
+    option_default_local_interface_pollers,
+    "Defines the threads polling asynchronous calls to local controllers (0 - thread per local).");
+DEFINE_int32 (statistics_stream_period,
+    0,
+    "Defines the period (in µs) of statistics streamed by local controllers (0 - no streams).");
+DEFINE_int32 (warmup_cycles, 3, "Defines the cycles discarded after every stage is ready.");
+DEFINE_int32 (cycles, 20, "Defines the cycles measured in each configuration.");
+DEFINE_int32 (server_threads,
+    2,
+    "Defines the maximum number of threads serving each simulated local controller.");
+DEFINE_double (base_rate, 1000, "Defines the base demand (ops/s) of each channel of a stage.");
+DEFINE_double (amplitude, 500, "Defines the amplitude (ops/s) of the sine demand curve.");
+DEFINE_double (curve_period, 60, "Defines the period (in seconds) of the demand curve.");
+DEFINE_int32 (registration_timeout,
+    600,
+    "Defines the time (in seconds) to wait for every stage to be marked as ready.");
+DEFINE_bool (core_log, false, "Keeps the output of the core controller (discarded by default).");
+
+// Time (in milliseconds) between verifications of the progress of the core controller.
+#define FLEET_POLL_INTERVAL 50
+
+// Maximum time (in seconds) that a local controller waits for the core controller to be up.
+#define FLEET_CONNECT_TIMEOUT 30
+
+namespace {
+
+/**
+ * FleetStats struct.
+ * Calls served by the simulated local controllers, shared by every server thread.
+ * - m_local_handshakes, m_stage_handshakes, m_ready_stages: number of handshake calls.
+ * - m_enforcement_calls: number of CreateEnforcementRule calls.
+ * - m_enforcement_rules: number of job rules received through them.
+ * - m_collect_calls: number of (aggregated or not) statistics calls.
+ * - m_stream_pushes: number of statistics pushed through streams.
+ */
+struct FleetStats {
+    std::atomic<uint64_t> m_local_handshakes { 0 };
+    std::atomic<uint64_t> m_stage_handshakes { 0 };
+    std::atomic<uint64_t> m_ready_stages { 0 };
+    std::atomic<uint64_t> m_enforcement_calls { 0 };
+    std::atomic<uint64_t> m_enforcement_rules { 0 };
+    std::atomic<uint64_t> m_collect_calls { 0 };
+    std::atomic<uint64_t> m_stream_pushes { 0 };
+
+    // calls: Gets the number of calls served (each stream push counts as one).
+    uint64_t calls () const
+    {
+        return m_local_handshakes.load () + m_stage_handshakes.load () + m_ready_stages.load ()
+            + m_enforcement_calls.load () + m_collect_calls.load () + m_stream_pushes.load ();
+    }
+};
+
+FleetStats fleet_stats {};
+
+const auto fleet_start = std::chrono::steady_clock::now ();
+
+// split_list call. Parses a comma-separated list of positive integers.
+std::vector<int> split_list (const std::string& list)
+{
+    std::vector<int> values {};
+    std::stringstream stream { list };
+    std::string token;
+
+    while (std::getline (stream, token, ',')) {
+        if (!token.empty () && std::stoi (token) > 0) {
+            values.push_back (std::stoi (token));
+        }
+    }
+
+    return values;
+}
+
+// split_rule call. Splits a rule by '|' (empty tokens are discarded).
+std::vector<std::string> split_rule (const std::string& rule)
+{
+    std::vector<std::string> tokens {};
+    std::stringstream stream { rule };
+    std::string token;
+
+    while (std::getline (stream, token, '|')) {
+        if (!token.empty ()) {
+            tokens.push_back (token);
+        }
+    }
+
+    return tokens;
+}
+
+// load_housekeeping_rules call. Converts the housekeeping rules of a file to their string format,
+// as the core controller does at startup.
+std::vector<std::string> load_housekeeping_rules (const std::string& path)
+{
+    PolicyGenerator generator {};
+    RulesFileParser file_parser { RuleType::housekeeping, path };
+    std::vector<std::string> rules {};
+
+    std::vector<HousekeepingCreateChannelRaw> hsk_create_channel {};
+    int rules_size = file_parser.get_create_channel_rules (hsk_create_channel, -1);
+    for (int i = 0; i < rules_size; i++) {
+        std::string rule;
+        generator.convert_housekeeping_create_channel_string (hsk_create_channel.at (i), rule);
+        rules.push_back (rule);
+    }
+
+    std::vector<HousekeepingCreateObjectRaw> hsk_create_object {};
+    rules_size = file_parser.get_create_object_rules (hsk_create_object, -1);
+    for (int i = 0; i < rules_size; i++) {
+        std::string rule;
+        generator.convert_housekeeping_create_object_string (hsk_create_object.at (i), rule);
+        rules.push_back (rule);
+    }
+
+    return rules;
+}
+
+// channel_operation call. Gets the channel and operation of a create_channel rule (false for other
+// rules).
+bool channel_operation (const std::string& rule, long& channel, std::string& operation)
+{
+    std::vector<std::string> tokens = split_rule (rule);
+    if (tokens.size () < 8 || tokens[2] != "create_channel") {
+        return false;
+    }
+
+    channel = std::stol (tokens[3]);
+    operation = tokens[6] == "no_op" ? tokens[7] : tokens[6];
+    return true;
+}
+
+/**
+ * VirtualStage struct.
+ * Stage simulated by a local controller.
+ * - m_job: name of the job (stage name).
+ * - m_env: identifier of the stage within the job (stage env).
+ * - m_phase: phase (in seconds) of the demand curve.
+ * - m_limits: rate (ops/s) enforced by the core controller, by operation.
+ */
+struct VirtualStage {
+    std::string m_job {};
+    long m_env { 0 };
+    double m_phase { 0 };
+    std::unordered_map<std::string, long> m_limits {};
+};
+
+/**
+ * SimulatedLocal class.
+ * Local controller that serves the calls of the core controller from the state of its virtual
+ * stages, instead of forwarding them to data plane stages. Each one runs its own server, so the
+ * core controller holds a channel (and session) per local controller, as in a real deployment.
+ * Currently, the SimulatedLocal class contains the following variables:
+ * - address_: address of the server.
+ * - server_: server of the local controller.
+ * - lock_: mutex for concurrency control over operation_channels_ and stages_.
+ * - operation_channels_: channels of each operation, from the housekeeping rules.
+ * - stages_: virtual stages, by stage env.
+ */
+class SimulatedLocal final : public GlobalToLocal::Service {
+
+private:
+    std::string address_;
+    std::unique_ptr<Server> server_;
+    std::mutex lock_;
+    std::map<std::string, std::vector<long>> operation_channels_;
+    std::unordered_map<long, VirtualStage> stages_;
+
+    // fill_statistics call. Fills the statistics of every virtual stage, with each channel serving
+    // the demand of its curve, capped by the rate enforced for its operation.
+    void fill_statistics (controllers_grpc_interface::StatsGlobalMap* reply)
+    {
+        double now = std::chrono::duration<double> (std::chrono::steady_clock::now () - fleet_start)
+                         .count ();
+        std::unique_lock<std::mutex> lock_t { lock_ };
+
+        for (auto const& [env, stage] : stages_) {
+            double demand = std::max (0.0,
+                FLAGS_base_rate
+                    + FLAGS_amplitude
+                        * std::sin (2 * M_PI * (now + stage.m_phase) / FLAGS_curve_period));
+
+            controllers_grpc_interface::StatsGlobal& stats
+                = (*reply->mutable_gl_stats ())[stage.m_job + "+" + std::to_string (env)];
+            auto& channels_map = *stats.mutable_m_channel_stats ();
+            double total_rate = 0;
+
+            for (auto const& [operation, channels] : operation_channels_) {
+                double rate = demand;
+                auto limit = stage.m_limits.find (operation);
+                if (limit != stage.m_limits.end ()) {
+                    rate = std::min (rate, static_cast<double> (limit->second) / channels.size ());
+                }
+
+                for (long channel : channels) {
+                    controllers_grpc_interface::ChannelStats& channel_stats = channels_map[channel];
+                    channel_stats.set_m_ops_rate (rate);
+                    channel_stats.set_m_bytes_rate (rate * 4096);
+                    total_rate += rate;
+                }
+            }
+
+            stats.set_m_metadata_total_rate (total_rate);
+            stats.set_m_ewma_rate (total_rate);
+            stats.set_m_min_rate (total_rate);
+            stats.set_m_max_rate (total_rate);
+            stats.set_m_last_rate (total_rate);
+            stats.set_m_samples (1);
+            stats.set_m_stats_version (stats_channel_version);
+        }
+    }
+
+    // apply_rule call. Stores the rates enforced on the job's virtual stages.
+    void apply_rule (const std::string& operation,
+        const controllers_grpc_interface::EnforcementOpRules& rule)
+    {
+        for (auto const& [env, rate] : rule.env_rates ()) {
+            auto stage = stages_.find (env);
+            if (stage != stages_.end ()) {
+                stage->second.m_limits[operation] = rate;
+            }
+        }
+    }
+
+public:
+    /**
+     * SimulatedLocal parameterized constructor. Starts the server on an ephemeral port.
+     */
+    SimulatedLocal () : address_ {}, server_ {}, lock_ {}, operation_channels_ {}, stages_ {}
+    {
+        int port = 0;
+        ServerBuilder builder;
+        builder.AddListeningPort ("127.0.0.1:0", grpc::InsecureServerCredentials (), &port);
+        builder.RegisterService (this);
+        builder.SetSyncServerOption (ServerBuilder::SyncServerOption::NUM_CQS, 1);
+        builder.SetSyncServerOption (ServerBuilder::SyncServerOption::MIN_POLLERS, 1);
+        builder.SetSyncServerOption (ServerBuilder::SyncServerOption::MAX_POLLERS,
+            std::max (FLAGS_server_threads, 1));
+        server_ = builder.BuildAndStart ();
+        address_ = "127.0.0.1:" + std::to_string (port);
+    }
+
+    /**
+     * address: Gets the address of the local controller (empty if the server did not start).
+     */
+    std::string address () const
+    {
+        return server_ != nullptr ? address_ : "";
+    }
+
+    /**
+     * add_stage: Adds a virtual stage, before it is registered in the core controller.
+     */
+    void add_stage (const std::string& job, long env, double phase)
+    {
+        std::unique_lock<std::mutex> lock_t { lock_ };
+        stages_[env] = VirtualStage { job, env, phase, {} };
+    }
+
+    Status LocalHandshake (ServerContext* context,
+        const controllers_grpc_interface::LocalSimplifiedHandshakeRaw* request,
+        controllers_grpc_interface::ACK* reply) override
+    {
+        fleet_stats.m_local_handshakes++;
+        std::unique_lock<std::mutex> lock_t { lock_ };
+
+        for (auto const& rule : request->rules ()) {
+            long channel;
+            std::string operation;
+            if (channel_operation (rule, channel, operation)) {
+                operation_channels_[operation].push_back (channel);
+            }
+        }
+
+        reply->set_m_message (1);
+        return Status::OK;
+    }
+
+    Status StageHandshake (ServerContext* context,
+        const controllers_grpc_interface::ControlOperation* request,
+        controllers_grpc_interface::StageSimplifiedHandshakeRaw* reply) override
+    {
+        fleet_stats.m_stage_handshakes++;
+        return Status::OK;
+    }
+
+    Status MarkStageReady (ServerContext* context,
+        const controllers_grpc_interface::StageReadyRaw* request,
+        controllers_grpc_interface::ACK* reply) override
+    {
+        fleet_stats.m_ready_stages++;
+        reply->set_m_message (1);
+        return Status::OK;
+    }
+
+    Status CreateEnforcementRule (ServerContext* context,
+        const controllers_grpc_interface::EnforcementRules* request,
+        controllers_grpc_interface::ACK* reply) override
+    {
+        fleet_stats.m_enforcement_calls++;
+        fleet_stats.m_enforcement_rules += request->operation_rules_size ()
+            + request->job_rules_size ();
+        std::unique_lock<std::mutex> lock_t { lock_ };
+
+        for (auto const& [operation, rule] : request->operation_rules ()) {
+            apply_rule (operation, rule);
+        }
+        for (auto const& rule : request->job_rules ()) {
+            apply_rule (rule.m_operation (), rule);
+        }
+
+        reply->set_m_message (1);
+        return Status::OK;
+    }
+
+    Status CollectGlobalStatistics (ServerContext* context,
+        const controllers_grpc_interface::ControlOperation* request,
+        controllers_grpc_interface::StatsGlobalMap* reply) override
+    {
+        fleet_stats.m_collect_calls++;
+        fill_statistics (reply);
+        return Status::OK;
+    }
+
+    Status CollectGlobalStatisticsAggregated (ServerContext* context,
+        const controllers_grpc_interface::ControlOperation* request,
+        controllers_grpc_interface::StatsGlobalMap* reply) override
+    {
+        fleet_stats.m_collect_calls++;
+        fill_statistics (reply);
+        return Status::OK;
+    }
+
+    Status StreamGlobalStatistics (ServerContext* context,
+        const controllers_grpc_interface::StatsStreamRequest* request,
+        grpc::ServerWriter<controllers_grpc_interface::StatsGlobalMap>* writer) override
+    {
+        uint64_t sequence = 1;
+        auto period = std::chrono::microseconds (std::max<uint64_t> (request->m_period (), 1));
+        auto next_push = std::chrono::steady_clock::now ();
+
+        while (!context->IsCancelled ()) {
+            controllers_grpc_interface::StatsGlobalMap stats;
+            fill_statistics (&stats);
+            stats.set_m_sequence (sequence++);
+            if (!writer->Write (stats)) {
+                break;
+            }
+
+            fleet_stats.m_stream_pushes++;
+            next_push += period;
+            std::this_thread::sleep_until (next_push);
+        }
+
+        return Status::OK;
+    }
+};
+
+/**
+ * CoreSample struct.
+ * Progress of the core controller at a point in time.
+ * - m_time: time of the sample.
+ * - m_metrics: samples of the metrics endpoint, by name (with labels).
+ * - m_cpu_time: CPU time (in seconds) of the core controller's process.
+ * - m_rss: resident set size (in bytes) of the core controller's process.
+ * - m_fleet_calls: calls served by the simulated local controllers.
+ */
+struct CoreSample {
+    std::chrono::steady_clock::time_point m_time {};
+    std::map<std::string, double> m_metrics {};
+    double m_cpu_time { 0 };
+    double m_rss { 0 };
+    uint64_t m_fleet_calls { 0 };
+
+    // metric: Gets a sample of the metrics endpoint (0 if not served).
+    double metric (const std::string& name) const
+    {
+        auto sample = m_metrics.find (name);
+        return sample != m_metrics.end () ? sample->second : 0;
+    }
+};
+
+// scrape_metrics call. Reads the metrics endpoint of the core controller.
+bool scrape_metrics (std::map<std::string, double>& metrics)
+{
+    int socket_fd = socket (AF_INET, SOCK_STREAM, 0);
+    if (socket_fd < 0) {
+        return false;
+    }
+
+    struct sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons (FLAGS_metrics_port);
+    inet_pton (AF_INET, "127.0.0.1", &address.sin_addr);
+
+    std::string request = "GET /metrics HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+    if (connect (socket_fd, (struct sockaddr*)&address, sizeof (address)) < 0
+        || write (socket_fd, request.data (), request.size ())
+            != static_cast<ssize_t> (request.size ())) {
+        close (socket_fd);
+        return false;
+    }
+
+    // the server closes the connection after the response
+    std::string response {};
+    char buffer[4096];
+    ssize_t bytes;
+    while ((bytes = read (socket_fd, buffer, sizeof (buffer))) > 0) {
+        response.append (buffer, bytes);
+    }
+    close (socket_fd);
+
+    std::size_t body = response.find ("\r\n\r\n");
+    if (body == std::string::npos) {
+        return false;
+    }
+
+    std::stringstream stream { response.substr (body + 4) };
+    std::string line;
+    while (std::getline (stream, line)) {
+        std::size_t separator = line.rfind (' ');
+        if (line.empty () || line[0] == '#' || separator == std::string::npos) {
+            continue;
+        }
+        metrics[line.substr (0, separator)] = std::stod (line.substr (separator + 1));
+    }
+
+    return true;
+}
+
+// sample_core call. Samples the progress and resource usage of the core controller.
+bool sample_core (pid_t core_pid, CoreSample& sample)
+{
+    sample.m_time = std::chrono::steady_clock::now ();
+    sample.m_fleet_calls = fleet_stats.calls ();
+    sample.m_metrics.clear ();
+    if (!scrape_metrics (sample.m_metrics)) {
+        return false;
+    }
+
+    // utime and stime are the 14th and 15th fields, after the (parenthesized) command name
+    std::ifstream stat_file { "/proc/" + std::to_string (core_pid) + "/stat" };
+    std::string stat_line;
+    std::getline (stat_file, stat_line);
+    std::stringstream stat_stream { stat_line.substr (stat_line.rfind (')') + 2) };
+    std::string field;
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    for (int i = 3; i <= 15 && stat_stream >> field; i++) {
+        if (i == 14) {
+            utime = std::stoull (field);
+        } else if (i == 15) {
+            stime = std::stoull (field);
+        }
+    }
+    sample.m_cpu_time = static_cast<double> (utime + stime) / sysconf (_SC_CLK_TCK);
+
+    // resident pages are the 2nd field
+    std::ifstream statm_file { "/proc/" + std::to_string (core_pid) + "/statm" };
+    unsigned long long pages = 0;
+    unsigned long long resident = 0;
+    statm_file >> pages >> resident;
+    sample.m_rss = static_cast<double> (resident) * sysconf (_SC_PAGESIZE);
+
+    return true;
+}
+
+// wait_for_cycles call. Waits until the core controller executes a number of cycles.
+bool wait_for_cycles (pid_t core_pid, double cycles, CoreSample& sample)
+{
+    auto deadline = std::chrono::steady_clock::now ()
+        + std::chrono::microseconds (static_cast<uint64_t> (FLAGS_cycle_period))
+            * (static_cast<uint64_t> (cycles) + 10)
+        + std::chrono::seconds (FLEET_CONNECT_TIMEOUT);
+
+    while (std::chrono::steady_clock::now () < deadline) {
+        if (sample_core (core_pid, sample) && sample.metric ("cheferd_cycles_total") >= cycles) {
+            return true;
+        }
+        std::this_thread::sleep_for (std::chrono::milliseconds (FLEET_POLL_INTERVAL));
+    }
+
+    return false;
+}
+
+// run_core call. Runs the core controller (in its own process) until it is killed.
+void run_core ()
+{
+    if (!FLAGS_core_log) {
+        int null_fd = open ("/dev/null", O_WRONLY);
+        dup2 (null_fd, STDOUT_FILENO);
+        dup2 (null_fd, STDERR_FILENO);
+    }
+
+    Logging logger { false };
+    std::vector<std::string> housekeeping_rules
+        = load_housekeeping_rules (FLAGS_housekeeping_rules_file);
+
+    MetricsServer metrics_server { "127.0.0.1", FLAGS_metrics_port };
+    metrics_server.start ();
+
+    CoreControlApplication application { static_cast<ControlType> (FLAGS_control_type),
+        &housekeeping_rules,
+        static_cast<uint64_t> (FLAGS_cycle_period),
+        static_cast<uint64_t> (FLAGS_cycle_period),
+        FLAGS_system_limit,
+        {},
+        FLAGS_local_interface_pollers,
+        static_cast<uint64_t> (FLAGS_statistics_stream_period) };
+
+    // demands of every job for each operation, applied (one per cycle) as stages register
+    if (FLAGS_job_demand > 0) {
+        std::set<std::string> operations {};
+        for (auto const& rule : housekeeping_rules) {
+            long channel;
+            std::string operation;
+            if (channel_operation (rule, channel, operation)) {
+                operations.insert (operation);
+            }
+        }
+
+        int rule_id = 1;
+        for (int job = 0; job < FLAGS_jobs; job++) {
+            for (auto const& operation : operations) {
+                application.enqueue_rule_in_queue ("|" + std::to_string (rule_id++) + "|job|"
+                    + FLAGS_job_prefix + std::to_string (job) + "|" + operation + "|"
+                    + std::to_string (FLAGS_job_demand) + "|");
+            }
+        }
+    }
+
+    std::thread feedback_loop_t = std::thread (std::ref (application));
+    feedback_loop_t.detach ();
+
+    CoreConnectionManager connection_manager { FLAGS_core_address };
+    connection_manager.Start (&application);
+}
+
+// run_fleet call. Registers the simulated local controllers and their stages in the core
+// controller, and measures it as it controls them.
+int run_fleet (pid_t core_pid, int total_locals, int stages_per_local)
+{
+    std::vector<std::unique_ptr<SimulatedLocal>> locals {};
+    for (int i = 0; i < total_locals; i++) {
+        locals.push_back (std::make_unique<SimulatedLocal> ());
+        if (locals.back ()->address ().empty ()) {
+            std::cerr << "Fleet: simulated local controller " << i << " did not start.\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto core_stub = LocalToGlobal::NewStub (
+        grpc::CreateChannel (FLAGS_core_address, grpc::InsecureChannelCredentials ()));
+    int total_jobs = std::max (FLAGS_jobs, 1);
+    int total_stages = total_locals * stages_per_local;
+    auto registration_start = std::chrono::steady_clock::now ();
+
+    for (int i = 0; i < total_locals; i++) {
+        ClientContext context;
+        context.set_wait_for_ready (true);
+        context.set_deadline (std::chrono::system_clock::now ()
+            + std::chrono::seconds (FLEET_CONNECT_TIMEOUT));
+        ConnectRequest request;
+        ConnectReply reply;
+        request.set_user_address (locals[i]->address ());
+
+        Status status = core_stub->ConnectLocalToGlobal (&context, request, &reply);
+        if (!status.ok ()) {
+            std::cerr << "Fleet: ConnectLocalToGlobal failed (" << status.error_message ()
+                      << ").\n";
+            return EXIT_FAILURE;
+        }
+
+        for (int j = 0; j < stages_per_local; j++) {
+            int stage = i * stages_per_local + j;
+            std::string job_name = FLAGS_job_prefix + std::to_string (stage % total_jobs);
+            locals[i]->add_stage (job_name, stage, FLAGS_curve_period * stage / total_stages);
+
+            ClientContext stage_context;
+            StageInfoConnect stage_request;
+            ConnectReply stage_reply;
+            stage_request.set_local_address (locals[i]->address ());
+            stage_request.set_stage_name (job_name);
+            stage_request.set_stage_env (std::to_string (stage));
+            stage_request.set_stage_user ("fleet");
+
+            status = core_stub->ConnectStageToGlobal (&stage_context, stage_request, &stage_reply);
+            if (!status.ok ()) {
+                std::cerr << "Fleet: ConnectStageToGlobal failed (" << status.error_message ()
+                          << ").\n";
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    auto registration_deadline = registration_start
+        + std::chrono::seconds (FLAGS_registration_timeout);
+    while (fleet_stats.m_ready_stages.load () < static_cast<uint64_t> (total_stages)) {
+        if (std::chrono::steady_clock::now () > registration_deadline) {
+            std::cerr << "Fleet: only " << fleet_stats.m_ready_stages.load () << " of "
+                      << total_stages << " stages were marked as ready.\n";
+            return EXIT_FAILURE;
+        }
+        std::this_thread::sleep_for (std::chrono::milliseconds (FLEET_POLL_INTERVAL));
+    }
+    double registration_time = std::chrono::duration<double> (
+        std::chrono::steady_clock::now () - registration_start)
+                                   .count ();
+
+    CoreSample first {};
+    CoreSample last {};
+    if (!sample_core (core_pid, first)
+        || !wait_for_cycles (core_pid,
+            first.metric ("cheferd_cycles_total") + FLAGS_warmup_cycles,
+            first)
+        || !wait_for_cycles (core_pid,
+            first.metric ("cheferd_cycles_total") + std::max (FLAGS_cycles, 1),
+            last)) {
+        std::cerr << "Fleet: the core controller did not complete the cycles.\n";
+        return EXIT_FAILURE;
+    }
+
+    // averages over the cycles measured, from the differences between both samples
+    double cycles = last.metric ("cheferd_cycles_total") - first.metric ("cheferd_cycles_total");
+    auto mean = [&first, &last, cycles] (const std::string& name) {
+        return (last.metric (name) - first.metric (name)) / cycles * 1e3;
+    };
+    double elapsed = std::chrono::duration<double> (last.m_time - first.m_time).count ();
+
+    std::cout << std::fixed << std::setprecision (2) << std::setw (7) << total_locals
+              << std::setw (7) << stages_per_local << std::setw (9) << total_stages
+              << std::setw (9) << registration_time << std::setw (10)
+              << mean ("cheferd_cycle_seconds_sum") << std::setw (10)
+              << mean ("cheferd_cycle_phase_seconds_sum{phase=\"collect\"}") << std::setw (10)
+              << mean ("cheferd_cycle_phase_seconds_sum{phase=\"compute\"}") << std::setw (10)
+              << mean ("cheferd_cycle_phase_seconds_sum{phase=\"enforce\"}") << std::setw (10)
+              << cycles / elapsed << std::setw (11)
+              << (last.m_fleet_calls - first.m_fleet_calls) / cycles << std::setw (10)
+              << mean ("cheferd_enforcement_rules_total") / 1e3 << std::setw (10)
+              << (last.m_cpu_time - first.m_cpu_time) / cycles * 1e3 << std::setw (10)
+              << last.m_rss / (1024 * 1024) << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+// run_configuration call. Runs the core controller and the fleet in separate processes, so the
+// resources of the core controller are measured alone (the feedback loop also exits the process
+// when it ends).
+void run_configuration (int total_locals, int stages_per_local)
+{
+    pid_t core_pid = fork ();
+    if (core_pid == 0) {
+        run_core ();
+        _exit (EXIT_FAILURE);
+    }
+
+    pid_t fleet_pid = fork ();
+    if (fleet_pid == 0) {
+        int status = run_fleet (core_pid, total_locals, stages_per_local);
+        std::cout.flush ();
+        _exit (status);
+    }
+
+    int fleet_status = 0;
+    waitpid (fleet_pid, &fleet_status, 0);
+    kill (core_pid, SIGKILL);
+    waitpid (core_pid, nullptr, 0);
+
+    if (!WIFEXITED (fleet_status) || WEXITSTATUS (fleet_status) != EXIT_SUCCESS) {
+        std::cerr << "Configuration with " << total_locals << " local controllers and "
+                  << stages_per_local << " stages each failed.\n";
+    }
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags (&argc, &argv, true);
+
+    std::cout << "control type " << FLAGS_control_type << ", cycle period "
+              << FLAGS_cycle_period / 1e3 << " ms, " << FLAGS_jobs << " jobs, "
+              << FLAGS_cycles << " cycles measured (times in ms, per cycle)\n";
+    std::cout << std::setw (7) << "locals" << std::setw (7) << "stages" << std::setw (9) << "total"
+              << std::setw (9) << "reg(s)" << std::setw (10) << "cycle" << std::setw (10)
+              << "collect" << std::setw (10) << "compute" << std::setw (10) << "enforce"
+              << std::setw (10) << "cycles/s" << std::setw (11) << "rpcs" << std::setw (10)
+              << "rules" << std::setw (10) << "cpu" << std::setw (10) << "rss(MiB)" << std::endl;
+
+    for (int total_locals : split_list (FLAGS_locals)) {
+        for (int stages_per_local : split_list (FLAGS_stages_per_local)) {
+            run_configuration (total_locals, stages_per_local);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <chrono>
+#include <cheferd/controller/max_min_allocator.hpp>
+#include <iostream>
+#include <random>
+
+using namespace cheferd;
+
+// Number of allocation cycles measured per number of jobs.
+#define BENCHMARK_CYCLES 100
+
+// Capacity shared among the jobs (e.g., IOPS).
+#define BENCHMARK_CAPACITY 220000000L
+
+/**
+ * Measures the cost per cycle of MaxMinAllocator::allocate with an increasing number of jobs, whose
+ * demands change at each cycle (a tenth of the jobs has no demand).
+ */
+int main (int argc, char** argv)
+{
+    std::mt19937_64 generator { 42 };
+    MaxMinAllocator allocator {};
+
+    for (std::size_t total_jobs : { 10, 100, 1000, 10000, 100000 }) {
+        std::uniform_int_distribution<long> demand_distribution { 1,
+            2 * BENCHMARK_CAPACITY / static_cast<long> (total_jobs) };
+        std::vector<std::vector<long>> demands (BENCHMARK_CYCLES);
+        std::vector<long> rates;
+
+        for (auto& cycle_demands : demands) {
+            for (std::size_t job = 0; job < total_jobs; job++) {
+                cycle_demands.push_back (
+                    job % 10 == 0 ? UNBOUNDED_DEMAND : demand_distribution (generator));
+            }
+        }
+
+        long unallocated = 0;
+        auto start = std::chrono::steady_clock::now ();
+
+        for (const auto& cycle_demands : demands) {
+            unallocated += allocator.allocate (cycle_demands, BENCHMARK_CAPACITY, rates);
+        }
+
+        auto end = std::chrono::steady_clock::now ();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count ();
+
+        std::cout << "jobs: " << total_jobs << "\tcycle: " << (elapsed / BENCHMARK_CYCLES) / 1000.0
+                  << " µs\tunallocated: " << unallocated / BENCHMARK_CYCLES << "\n";
+    }
+
+    return 0;
+}
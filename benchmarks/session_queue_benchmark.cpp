@@ -0,0 +1,138 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <chrono>
+#include <cheferd/utils/options.hpp>
+#include <cheferd/utils/spsc_ring.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cheferd;
+
+// Number of commands submitted to the session for each queue and pipeline depth.
+#define BENCHMARK_COMMANDS 1000000
+
+/**
+ * LockedQueue class.
+ * Unbounded queue guarded by a mutex and a condition variable, as the submission and completion
+ * queues of the sessions were before the SpscRing.
+ */
+template <typename T>
+class LockedQueue {
+
+private:
+    std::queue<T> queue_;
+    std::mutex queue_lock_;
+    std::condition_variable queue_condition_;
+
+public:
+    /**
+     * LockedQueue parameterized constructor (the queue is unbounded, so its capacity is unused).
+     */
+    explicit LockedQueue (std::size_t)
+    { }
+
+    void push (T value)
+    {
+        std::unique_lock<std::mutex> lock_t { queue_lock_ };
+        queue_.emplace (std::move (value));
+        queue_condition_.notify_one ();
+    }
+
+    T pop ()
+    {
+        std::unique_lock<std::mutex> lock_t { queue_lock_ };
+        while (queue_.empty ()) {
+            queue_condition_.wait (lock_t);
+        }
+
+        T value = std::move (queue_.front ());
+        queue_.pop ();
+        return value;
+    }
+};
+
+// Command exchanged with the session (its submission time is echoed back in the response).
+struct BenchmarkCommand {
+    uint64_t m_id;
+    std::chrono::steady_clock::time_point m_submitted;
+};
+
+/**
+ * run_benchmark: Submits BENCHMARK_COMMANDS commands to a session thread that echoes them back,
+ * keeping depth commands in flight, and prints the throughput and the round-trip latency.
+ * @param name Name of the queue.
+ * @param depth Number of commands in flight.
+ */
+template <template <typename> class Queue>
+void run_benchmark (const std::string& name, int depth)
+{
+    Queue<BenchmarkCommand> submission_queue { option_default_session_ring_capacity };
+    Queue<BenchmarkCommand> completion_queue { option_default_session_ring_capacity };
+
+    std::thread session_thread { [&submission_queue, &completion_queue] {
+        for (uint64_t i = 0; i < BENCHMARK_COMMANDS; i++) {
+            completion_queue.push (submission_queue.pop ());
+        }
+    } };
+
+    std::vector<uint64_t> latencies;
+    latencies.reserve (BENCHMARK_COMMANDS);
+
+    auto start = std::chrono::steady_clock::now ();
+    uint64_t submitted = 0;
+
+    for (; submitted < static_cast<uint64_t> (depth) && submitted < BENCHMARK_COMMANDS;
+         submitted++) {
+        submission_queue.push ({ submitted, std::chrono::steady_clock::now () });
+    }
+
+    for (uint64_t completed = 0; completed < BENCHMARK_COMMANDS; completed++) {
+        BenchmarkCommand response = completion_queue.pop ();
+        auto now = std::chrono::steady_clock::now ();
+        latencies.push_back (
+            std::chrono::duration_cast<std::chrono::nanoseconds> (now - response.m_submitted)
+                .count ());
+
+        if (submitted < BENCHMARK_COMMANDS) {
+            submission_queue.push ({ submitted++, std::chrono::steady_clock::now () });
+        }
+    }
+
+    auto elapsed = std::chrono::steady_clock::now () - start;
+    session_thread.join ();
+
+    std::sort (latencies.begin (), latencies.end ());
+    auto percentile = [&latencies] (double value) {
+        return latencies[static_cast<std::size_t> (value / 100 * (latencies.size () - 1))] / 1000.0;
+    };
+
+    double seconds = std::chrono::duration<double> (elapsed).count ();
+
+    std::cout << "queue: " << name << "\tdepth: " << depth
+              << "\tthroughput: " << BENCHMARK_COMMANDS / seconds / 1000000 << " Mops/s"
+              << "\tp50: " << percentile (50) << " µs\tp99: " << percentile (99) << " µs\n";
+}
+
+/**
+ * Measures the round-trip latency (p50 and p99) and the throughput of commands echoed by a session
+ * thread through a submission and a completion queue, with the mutex and condition variable
+ * queues the sessions used before, and with the SpscRing, at several pipeline depths.
+ */
+int main (int argc, char** argv)
+{
+    for (int depth : { 1, 8, 64, 512 }) {
+        run_benchmark<LockedQueue> ("mutex", depth);
+        run_benchmark<SpscRing> ("spsc", depth);
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <chrono>
+#include <cheferd/controller/time_series_store.hpp>
+#include <cheferd/utils/options.hpp>
+#include <iostream>
+#include <random>
+
+using namespace cheferd;
+
+// Period (in microseconds) between the samples of the store.
+#define BENCHMARK_PERIOD 1000000
+
+// Window (in microseconds) of the queries (last minute).
+#define BENCHMARK_WINDOW 60000000
+
+/**
+ * Measures the cost of recording one feedback-loop cycle (a sample of every data plane stage) into
+ * a full TimeSeriesStore, and of querying every stage over the last minute and over the whole
+ * history, with an increasing number of data plane stages.
+ */
+int main (int argc, char** argv)
+{
+    std::mt19937 generator { 42 };
+    std::uniform_real_distribution<float> rate_distribution { 0, 10000 };
+
+    for (std::size_t total_stages : { 1000, 10000, 100000 }) {
+        TimeSeriesStore store { option_default_history_length, total_stages };
+
+        auto time = std::chrono::steady_clock::time_point {};
+        auto elapsed = std::chrono::nanoseconds::zero ();
+
+        for (std::size_t cycle = 0; cycle < option_default_history_length; cycle++) {
+            time += std::chrono::microseconds (BENCHMARK_PERIOD);
+
+            auto start = std::chrono::steady_clock::now ();
+            store.advance (time);
+            for (std::size_t stage = 0; stage < total_stages; stage++) {
+                store.record (stage, rate_distribution (generator));
+            }
+            elapsed += std::chrono::steady_clock::now () - start;
+        }
+
+        auto record_ns = std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ()
+            / option_default_history_length;
+
+        std::cout << "stages: " << total_stages << "\tmemory: " << store.memory_usage () / 1048576
+                  << " MiB\trecord cycle: " << record_ns / 1000.0 << " µs\n";
+
+        std::vector<float> scratch;
+        double checksum = 0;
+
+        for (std::size_t length :
+            { store.window_length (std::chrono::microseconds (BENCHMARK_WINDOW)), store.size () }) {
+            auto start = std::chrono::steady_clock::now ();
+            for (std::size_t stage = 0; stage < total_stages; stage++) {
+                checksum += store.mean (stage, length);
+            }
+            auto mean_end = std::chrono::steady_clock::now ();
+            for (std::size_t stage = 0; stage < total_stages; stage++) {
+                checksum += store.trend (stage, length);
+            }
+            auto trend_end = std::chrono::steady_clock::now ();
+            for (std::size_t stage = 0; stage < total_stages; stage++) {
+                checksum += store.percentile (stage, length, 99, scratch);
+            }
+            auto percentile_end = std::chrono::steady_clock::now ();
+            for (std::size_t stage = 0; stage < total_stages; stage++) {
+                checksum += store.is_idle (stage, length, 1) ? 1 : 0;
+            }
+            auto idle_end = std::chrono::steady_clock::now ();
+
+            auto per_stage = [total_stages] (auto begin, auto end) {
+                return std::chrono::duration_cast<std::chrono::nanoseconds> (end - begin).count ()
+                    / static_cast<double> (total_stages);
+            };
+
+            std::cout << "\twindow: " << length << " samples\tmean: " << per_stage (start, mean_end)
+                      << " ns\ttrend: " << per_stage (mean_end, trend_end)
+                      << " ns\tp99: " << per_stage (trend_end, percentile_end)
+                      << " ns\tidle: " << per_stage (percentile_end, idle_end)
+                      << " ns (per stage)\n";
+        }
+
+        // prevents the queries from being optimized away
+        if (checksum < 0) {
+            std::cout << checksum << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_ADAPTIVE_PERIOD_HPP
+#define CHEFERD_ADAPTIVE_PERIOD_HPP
+
+#include <cstdint>
+
+namespace cheferd {
+
+// Relative change of the observed rate or demand between cycles that tightens the period.
+#define PERIOD_CHANGE_THRESHOLD 0.1
+// Factor by which the period is relaxed at each stable cycle.
+#define PERIOD_RELAX_FACTOR 1.25
+// Smallest period (in microseconds) of a feedback-loop cycle.
+#define PERIOD_MIN_BOUND 1000
+
+/**
+ * AdaptivePeriod class.
+ * Chooses the period of each feedback-loop cycle within [min_period, max_period]. When the
+ * workload changes (the observed rate or the total demand vary more than PERIOD_CHANGE_THRESHOLD
+ * between cycles, or the system changes), the period is halved so bursts are followed closely;
+ * while it is stable, the period grows by PERIOD_RELAX_FACTOR, saving statistics collections. If
+ * min_period equals max_period, the period is fixed. Both bounds are at least PERIOD_MIN_BOUND, so
+ * the feedback loop never spins.
+ * Currently, the AdaptivePeriod class contains the following variables:
+ * - min_period_, max_period_: bounds of the period (in microseconds).
+ * - period_: current period (in microseconds).
+ * - last_rate_, last_demand_: observed rate and total demand of the previous cycle.
+ */
+class AdaptivePeriod {
+
+private:
+    uint64_t min_period_;
+    uint64_t max_period_;
+    uint64_t period_;
+    double last_rate_;
+    double last_demand_;
+
+    /**
+     * relative_change: Computes the relative change between two values.
+     * @param previous Previous value.
+     * @param current Current value.
+     */
+    static double relative_change (double previous, double current);
+
+public:
+    /**
+     * AdaptivePeriod parameterized constructor. The period starts at max_period.
+     * @param min_period Minimum period (in microseconds, clamped to [PERIOD_MIN_BOUND,
+     * max_period]).
+     * @param max_period Maximum period (in microseconds, at least PERIOD_MIN_BOUND).
+     */
+    AdaptivePeriod (uint64_t min_period, uint64_t max_period);
+
+    /**
+     * AdaptivePeriod default destructor.
+     */
+    ~AdaptivePeriod ();
+
+    /**
+     * update: Chooses the period of the next cycle from the workload observed in this cycle.
+     * @param observed_rate Total rate observed at the data plane stages (negative if no
+     * statistics were collected in this cycle).
+     * @param demand Total demand of the active jobs.
+     * @param system_changed Marks if the system changed (e.g., registrations, new rules).
+     * @return Returns the period (in microseconds) of the next cycle.
+     */
+    uint64_t update (double observed_rate, double demand, bool system_changed);
+
+    /**
+     * period: Gets the current period (in microseconds).
+     */
+    uint64_t period () const;
+};
+} // namespace cheferd
+
+#endif // CHEFERD_ADAPTIVE_PERIOD_HPP
@@ -42,13 +42,28 @@ public:
      * Core Controller parameterized constructor.
      * @param control_type Type of control (STATIC, DYNAMIC_VANILLA, DYNAMIC_LEFTOVER).
      * @param core_address Core controller address.
-     * @param cycle_sleep_time Amount of time that a feedback-loop cycle should take.
+     * @param cycle_sleep_time Maximum amount of time that a feedback-loop cycle should take.
+     * @param min_cycle_period Minimum amount of time that a feedback-loop cycle should take (equal
+     * to cycle_sleep_time for a fixed period).
      * @param system_limit Maximum allowed operations in the system (e.g., IOPS or bandwidth)
+     * @param operation_limits Maximum allowed operations of specific operations (the remainder are
+     * limited by system_limit).
+     * @param local_interface_pollers Number of threads polling asynchronous calls to local
+     * controllers (0 for synchronous calls).
+     * @param statistics_stream_period Period (in microseconds) at which local controllers push
+     * statistics (0 to collect statistics on request).
+     * @param history_max_stages Maximum number of data plane stages whose statistics are kept in
+     * the history.
      */
     Controller (ControlType control_type,
         std::string& core_address,
         const uint64_t& cycle_sleep_time,
-        long system_limit);
+        uint64_t min_cycle_period,
+        long system_limit,
+        const std::map<std::string, long>& operation_limits,
+        int local_interface_pollers,
+        uint64_t statistics_stream_period,
+        std::size_t history_max_stages);
 
     /**
      * Local Controller parameterized constructor.
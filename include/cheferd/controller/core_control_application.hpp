@@ -5,9 +5,16 @@
 #ifndef CHEFERD_CORE_CONTROL_APPLICATION_HPP
 #define CHEFERD_CORE_CONTROL_APPLICATION_HPP
 
+#include "adaptive_period.hpp"
 #include "cheferd/session/local_controller_session.hpp"
+#include "cheferd/utils/metrics.hpp"
 #include "control_application.hpp"
+#include "job_table.hpp"
+#include "max_min_allocator.hpp"
+#include "time_series_store.hpp"
 
+#include <condition_variable>
+#include <queue>
 #include <regex>
 
 namespace cheferd {
@@ -16,6 +23,27 @@ namespace cheferd {
 #define IOPS_THRESHOLD 10
 // Number of rounds for aggregated statistics.
 #define COLLECT_ROUNDS 5
+// Weight of the standard deviation of a stage's rate in its usage (aggregated statistics).
+#define USAGE_NOISE_WEIGHT 1.0
+
+/**
+ * LocalStatsSample struct.
+ * Holds the last statistics sample received from a local controller, which is used when the local
+ * controller misses the statistics collection deadline.
+ * - m_stage_rates: last known total rate of each data plane stage of the local controller.
+ * - m_stage_channels: last known statistics of the channels of each data plane stage.
+ * - m_age: number of cycles since the sample was collected.
+ * - m_consecutive_misses: number of consecutive collection deadlines missed.
+ * - m_quarantined: marks if the local controller is quarantined (i.e., it is neither queried for
+ * statistics nor sent enforcement rules until it catches up with pending requests).
+ */
+struct LocalStatsSample {
+    std::unordered_map<std::string, double> m_stage_rates {};
+    std::unordered_map<std::string, std::vector<StatsChannelRaw>> m_stage_channels {};
+    int m_age { 0 };
+    int m_consecutive_misses { 0 };
+    bool m_quarantined { false };
+};
 
 /**
  * CoreControlApplication class.
@@ -25,6 +53,11 @@ namespace cheferd {
  * local controller/data plane stage; new rule).
  * - pending_rules_queue_: queue that holds new rules submitted by the system administrator.
  * - pending_rules_queue_lock_: mutex for concurrency control over pending_rules_queue_.
+ * - feedback_loop_event_: condition variable signaled when a local controller or data plane stage
+ * registers, a new rule is submitted, or the feedback loop is stopped, which wakes the feedback
+ * loop instead of waiting for the next cycle.
+ * - feedback_loop_event_lock_: mutex for concurrency control over m_feedback_loop_event_pending.
+ * - m_feedback_loop_event_pending: marks if an event arrived since the current cycle started.
  * - local_queue: queue that holds pending local controller trying to connect.
  * - pending_register_session_lock_: mutex for concurrency control over local_queue.
  * - local_to_data_queue_: queue that holds pending data plane sessions trying to connect.
@@ -37,13 +70,40 @@ namespace cheferd {
  * its current stages overviewed by it.
  * - stage_info_detailed: container used for mapping a stage to a Stageinfo struct that holds
  * its detailed information.
- * - job_location_tracker: container used for mapping a job to its local controllers.
- * - job_demands: container used for mapping a job's current demand.
- * - job_rates:  container used for mapping a job's current imposed rate.
- * - job_previous_rates: container used for mapping a job's previous imposed rate.
+ * - job_table: integer-indexed tables with the location of each job, and its demand, current
+ * imposed rate, and previous imposed rate for each operation, as well as the capacity of each
+ * controlled operation (in MDS, each metadata server).
  * - maximum_limit: defines the maximum limit of the system (e.g., IOPS, bandwidth).
+ * - operation_limits: container used for mapping an operation to its configured limit (operations
+ * without one are limited by maximum_limit).
  * - active_ops: current operations supported by the controller.
- * - active_op: current main operation.
+ * - channel_operations: container used for mapping a channel identifier (from the housekeeping
+ * rules) to the operation it serves, whose usage its statistics measure.
+ * - water_filling_allocator: max-min fair allocator used by DYNAMIC_WATER_FILLING and MDS.
+ * - allocation_demands, allocation_rates: demands and rates of the active jobs given to and taken
+ * from water_filling_allocator (reused across cycles to avoid allocations).
+ * - job_usage, job_maintain_rate: usage of each job and if its rate is maintained, used by
+ * DYNAMIC_LEFTOVER (reused across cycles to avoid allocations).
+ * - local_stats_samples: container used for mapping a local controller identifier to its last
+ * statistics sample.
+ * - stage_history_, job_history_: rate observed at each data plane stage and job in the last
+ * option_default_history_length cycles with statistics (bounded by the configured maximum
+ * stages and option_default_history_max_jobs; the history of removed stages and jobs is reused).
+ * - history_job_rates: rate of each job in the current cycle (reused across cycles to avoid
+ * allocations).
+ * - m_collect_deadline: maximum time (in microseconds) to wait for statistics at each cycle
+ * (independent of the cycle's period).
+ * - m_collect_max_misses: consecutive deadline misses before a local controller is quarantined.
+ * - local_interface_poller_: poller shared by asynchronous LocalControllerSessions (nullptr if
+ * sessions use synchronous calls).
+ * - m_statistics_stream_period: period (in microseconds) at which local controllers push
+ * statistics through a stream (0 if statistics are collected on request at each cycle).
+ * - cycle_period_: chooses the period of each cycle, between the minimum period and
+ * m_feedback_loop_sleep_time, from the changes in the observed rate and demands.
+ * - m_cycle_period: atomic value that holds the period (in microseconds) chosen for the current
+ * cycle.
+ * - last_aggregated_collection_: time of the last request of aggregated statistics, which bounds
+ * the window of the next one.
  * - m_active_local_controller_sessions: atomic value that marks the number of active local
  * controller sessions.
  * - m_pending_local_controller_sessions: atomic value that marks the number of pending local
@@ -52,6 +112,13 @@ namespace cheferd {
  * plane sessions.
  * - m_pending_data_plane_sessions: atomic value that marks the number of pending data
  * plane sessions.
+ * - phase_start_: time at which the current phase of the cycle started.
+ * - collect_phase_metric_, compute_phase_metric_, enforce_phase_metric_, cycle_metric_: duration
+ * of the collect, compute, and enforce phases, and of the whole cycle.
+ * - cycles_metric_: number of cycles executed.
+ * - cycle_period_metric_: period (in seconds) chosen for the current cycle.
+ * - enforced_rules_metric_, skipped_rules_metric_: number of enforcement rules sent, and skipped
+ * because the rate did not change enough (or is maintained).
  */
 class CoreControlApplication : public ControlApplication {
 
@@ -59,6 +126,9 @@ private:
     std::atomic<bool> change_in_system;
     std::queue<std::string> pending_rules_queue_;
     std::mutex pending_rules_queue_lock_;
+    std::condition_variable feedback_loop_event_;
+    std::mutex feedback_loop_event_lock_;
+    bool m_feedback_loop_event_pending;
     std::queue<std::string> local_queue;
     std::mutex pending_register_session_lock_;
     std::queue<std::unique_ptr<StageInfo>> local_to_data_queue_;
@@ -67,17 +137,40 @@ private:
     std::unordered_map<std::string, std::unique_ptr<LocalControllerSession>> local_sessions_;
     std::unordered_map<std::string, std::vector<std::string>> local_to_stages;
     std::unordered_map<std::string, std::unique_ptr<StageInfo>> stage_info_detailed;
-    std::map<std::string, std::unordered_map<std::string, std::vector<int>>> job_location_tracker;
-    std::unordered_map<std::string, long> job_demands;
-    std::unordered_map<std::string, long> job_rates;
-    std::unordered_map<std::string, long> job_previous_rates;
+    JobTable job_table;
     long maximum_limit;
+    std::map<std::string, long> operation_limits;
     std::unordered_set<std::string> active_ops;
-    std::string active_op;
+    std::unordered_map<long, int> channel_operations;
+    MaxMinAllocator water_filling_allocator;
+    std::vector<long> allocation_demands;
+    std::vector<long> allocation_rates;
+    std::vector<unsigned long> job_usage;
+    std::vector<char> job_maintain_rate;
+    std::unordered_map<std::string, LocalStatsSample> local_stats_samples;
+    TimeSeriesStore stage_history_;
+    TimeSeriesStore job_history_;
+    std::vector<double> history_job_rates;
+    uint64_t m_collect_deadline;
+    int m_collect_max_misses;
+    std::unique_ptr<LocalInterfacePoller> local_interface_poller_;
+    uint64_t m_statistics_stream_period;
+    AdaptivePeriod cycle_period_;
+    std::atomic<uint64_t> m_cycle_period;
+    std::chrono::steady_clock::time_point last_aggregated_collection_;
     std::atomic<int> m_active_local_controller_sessions;
     std::atomic<int> m_pending_local_controller_sessions;
     std::atomic<int> m_active_data_plane_sessions;
     std::atomic<int> m_pending_data_plane_sessions;
+    std::chrono::steady_clock::time_point phase_start_;
+    Histogram& collect_phase_metric_;
+    Histogram& compute_phase_metric_;
+    Histogram& enforce_phase_metric_;
+    Histogram& cycle_metric_;
+    Counter& cycles_metric_;
+    Gauge& cycle_period_metric_;
+    Counter& enforced_rules_metric_;
+    Counter& skipped_rules_metric_;
 
     /**
      * initialize: Fills housekeeping rules and operations supported by the control application.
@@ -103,6 +196,53 @@ private:
      */
     void handle_data_plane_sessions ();
 
+    /**
+     * notify_feedback_loop: Signals an event (e.g., registration, new rule) to the feedback loop.
+     */
+    void notify_feedback_loop ();
+
+    /**
+     * wait_for_feedback_loop_event: Blocks until an event is signaled, the feedback loop is
+     * stopped, or the deadline expires. The event remains pending until the next cycle starts.
+     * @param deadline Time point until which to wait.
+     * @return Returns true if an event is pending, false otherwise.
+     */
+    bool wait_for_feedback_loop_event (const steady_clock::time_point& deadline);
+
+    /**
+     * clear_feedback_loop_event: Clears pending events, at the start of each cycle.
+     */
+    void clear_feedback_loop_event ();
+
+    /**
+     * total_observed_rate: Sums the rate observed at every data plane stage.
+     * @param d_stats Statistics collected from local controllers.
+     * @return Returns the total rate.
+     */
+    double total_observed_rate (
+        const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats) const;
+
+    /**
+     * end_phase: Records the duration of the current phase of the cycle, and starts the next one.
+     * @param phase_metric Histogram of the phase.
+     */
+    void end_phase (Histogram& phase_metric);
+
+    /**
+     * record_history: Records the rate observed at each data plane stage and job in this cycle
+     * into stage_history_ and job_history_.
+     * @param d_stats Statistics collected from local controllers.
+     */
+    void record_history (
+        const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats);
+
+    /**
+     * total_demand: Sums the demands of the active jobs for every operation (jobs without a
+     * demand are not considered).
+     * @return Returns the total demand.
+     */
+    double total_demand ();
+
     /**
      * local_handshake: Performs a handshake with the local controller.
      * When a local controller connects to the core controller, it is informed of the housekeeping
@@ -133,13 +273,18 @@ private:
         const std::string& stage_env);
 
     /**
-     * collect_statistics_global_send: Sends to local controllers the request to collect statistics.
+     * collect_statistics_global_send: Sends to local controllers the request to collect statistics
+     * aggregated over the last rounds (served from their background samples).
      * @return Returns a list with the local controllers that the request was sent.
      */
     std::list<std::string> collect_statistics_global_send ();
 
     /**
      * collect_statistics_global_collect: Collects statistics from data plane stages.
+     * Responses (or, in streaming mode, the latest pushed statistics) are awaited until the
+     * collection deadline; local controllers that miss it are served from their last known
+     * sample. On return, sessions_sent holds the local controllers
+     * with statistics in the result.
      * @param sessions_sent List with the local controllers that the request was sent.
      * @return Returns the statistics collected.
      */
@@ -166,6 +311,15 @@ private:
     void compute_and_enforce_dynamic_vanilla_rules (
         const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats);
 
+    /**
+     * compute_and_enforce_water_filling_rules: Computes and enforces DYNAMIC_WATER_FILLING and MDS
+     * policies, i.e., an exact max-min fair share of each operation's capacity given the jobs'
+     * demands for that operation. In MDS, each operation is the channel of a metadata server.
+     * @param d_stats Statistics collected from data plane stages.
+     */
+    void compute_and_enforce_water_filling_rules (
+        const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats);
+
     /**
      * compute_and_enforce_dynamic_leftover_rules: Computes and enforces DYNAMIC_LEFTOVER policies.
      * @param d_stats Statistics collected from data plane stages.
@@ -174,6 +328,18 @@ private:
         const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats,
         std::list<std::string>& sessions_sent);
 
+    /**
+     * load_stage_usage: Loads the usage of each operation at each data plane stage from the
+     * statistics collected (the rate of the operation's channels, or the total rate if the stage
+     * does not report per-channel statistics). Stages of local controllers without statistics are
+     * assumed to use the whole system.
+     * @param d_stats Statistics collected from data plane stages.
+     * @param sessions_sent Local controllers with statistics.
+     */
+    void load_stage_usage (
+        const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats,
+        const std::list<std::string>& sessions_sent);
+
     /**
      * sleep: Used to make control application main thread wait for the next loop.
      */
@@ -192,39 +358,60 @@ private:
     std::string update_job_demands ();
 
     /**
-     * send_enforcement_rule. Sends new enforcement rules to local controllers.
-     * @param app_name Job's name.
-     * @param local_to_envs Container that stores job's location.
-     * @param operation Operation that enforcement rule refers to.
-     * @param job_address_updated Container that stores local controllers where
-     * the new enforcement rules were submitted.
+     * send_enforcement_rule. Adds the job's new enforcement rules (i.e., its current imposed rate
+     * for the operation) to the batch of each of its local controllers.
+     * @param job Job identifier.
+     * @param operation Operation identifier.
+     */
+    void send_enforcement_rule (int job, int operation);
+
+    /**
+     * submit_enforcement_rules. Submits the batched enforcement rules of the current cycle, so
+     * that each local controller receives a single CreateEnforcementRule request.
      */
-    void send_enforcement_rule (std::string app_name,
-        std::unordered_map<std::string, std::vector<int>> local_to_envs,
-        std::string operation,
-        std::unordered_map<std::string, bool>& job_address_updated);
+    void submit_enforcement_rules ();
 
     /**
-     * collect_enforcement_rule_results. Collects enforcement rules results.
-     * @param job_address_updated Container that stores local controllers where
-     * the new enforcement rules were submitted.
+     * collect_enforcement_rule_results. Collects enforcement rules results (one per local
+     * controller), and clears the batches of the current cycle.
      */
-    void collect_enforcement_rule_results (
-        std::unordered_map<std::string, bool>& job_address_updated);
+    void collect_enforcement_rule_results ();
 
     /**
-     * collect_statistics_result. Collects a local controller statistics.
-     * @param session LocalControllerSession to where collect results.
+     * collect_statistics_result. Processes a local controller statistics.
+     * @param stats_ptr Statistics received from the local controller.
      * @param local_address  Local controller identifier.
      * @param sessions_to_delete Data plane sessions that are no longer operational
      * and should be deleted.
      * @param collected_stats Collected statistics.
      */
-    void collect_statistics_result (const std::unique_ptr<LocalControllerSession>& session,
-        std::string local_address,
+    void collect_statistics_result (std::unique_ptr<StageResponse> stats_ptr,
+        const std::string& local_address,
         std::list<std::string>& sessions_to_delete,
         std::unordered_map<std::string, std::unique_ptr<StageResponse>>& collected_stats);
 
+    /**
+     * is_local_available: Verifies if a local controller is able to serve new requests, i.e., it
+     * is not quarantined and has no responses in flight from previous expired requests. Releases
+     * the local controller from quarantine once it catches up.
+     * @param local_address Local controller identifier.
+     * @return Returns true if the local controller is available, false otherwise.
+     */
+    bool is_local_available (const std::string& local_address);
+
+    /**
+     * use_last_statistics_sample: Serves the local controller's last known statistics sample,
+     * registering a missed collection deadline if missed is set. Quarantines the local controller
+     * after m_collect_max_misses consecutive misses.
+     * @param local_address Local controller identifier.
+     * @param collected_stats Collected statistics.
+     * @param missed Defines if the local controller missed the collection deadline.
+     * @return Returns true if a sample was served, false otherwise.
+     */
+    bool use_last_statistics_sample (const std::string& local_address,
+        std::unordered_map<std::string, std::unique_ptr<StageResponse>>& collected_stats,
+        bool missed);
+
     /**
      * stage_name_env: Removes a data plane stage that is no longer operational.
      * @param stage_name_env Data plane stage identifier.
@@ -241,15 +428,32 @@ private:
 public:
     /**
      * CoreControlApplication parameterized constructor.
-     * @param control_type Type of control (STATIC, DYNAMIC_VANILLA, DYNAMIC_LEFTOVER).
+     * @param control_type Type of control (STATIC, DYNAMIC_VANILLA, DYNAMIC_LEFTOVER, MDS,
+     * DYNAMIC_WATER_FILLING).
      * @param rules_ptr Container that holds the housekeeping rules.
-     * @param cycle_sleep_time Amount of time that a feedback-loop cycle should take.
-     * @param maximum_limit Maximum allowed operations in the system (e.g., IOPS or bandwidth)
+     * @param cycle_sleep_time Maximum amount of time that a feedback-loop cycle should take.
+     * @param min_cycle_period Minimum amount of time that a feedback-loop cycle should take (equal
+     * to cycle_sleep_time for a fixed period).
+     * @param maximum_limit Maximum allowed operations in the system (e.g., IOPS or bandwidth); in
+     * MDS, the initial capacity of each metadata server.
+     * @param operation_limits Maximum allowed operations of specific operations (the remainder are
+     * limited by maximum_limit).
+     * @param local_interface_pollers Number of threads polling asynchronous calls to local
+     * controllers (0 for synchronous calls).
+     * @param statistics_stream_period Period (in microseconds) at which local controllers push
+     * statistics (0 to collect statistics on request).
+     * @param history_max_stages Maximum number of data plane stages whose statistics are kept in
+     * the history.
      */
     CoreControlApplication (ControlType control_type,
         std::vector<std::string>* rules_ptr,
         const uint64_t& cycle_sleep_time,
-        long maximum_limit);
+        uint64_t min_cycle_period,
+        long maximum_limit,
+        const std::map<std::string, long>& operation_limits,
+        int local_interface_pollers,
+        uint64_t statistics_stream_period,
+        std::size_t history_max_stages);
 
     /**
      * CoreControlApplication default destructor.
@@ -285,6 +489,24 @@ public:
      */
     void enqueue_rule_in_queue (const std::string& rule);
 
+    /**
+     * get_cycle_period: Gets the period (in microseconds) chosen for the current cycle.
+     */
+    uint64_t get_cycle_period () const;
+
+    /**
+     * stage_history: Gets the rate observed at each data plane stage (by stage identifier) in the
+     * last option_default_history_length cycles with statistics, e.g., for trends, percentiles,
+     * and idle detection.
+     */
+    const TimeSeriesStore& stage_history () const;
+
+    /**
+     * job_history: Gets the rate observed at each job (by job identifier) in the last
+     * option_default_history_length cycles with statistics.
+     */
+    const TimeSeriesStore& job_history () const;
+
     /**
      * stop_feedback_loop: Stops the feedback loop from executing.
      */
@@ -0,0 +1,75 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_ID_REGISTRY_HPP
+#define CHEFERD_ID_REGISTRY_HPP
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+namespace cheferd {
+
+// Identifier of a name that is not registered.
+#define INVALID_ID -1
+
+/**
+ * IdRegistry class.
+ * Interns names (e.g., jobs, data plane stages, local controllers) into dense integer identifiers,
+ * assigned by order of registration, so that state can be kept in tables indexed by identifier.
+ * Identifiers are never released, which keeps them stable for the lifetime of the controller.
+ * Names keep their address once registered, so they can be referenced (e.g., by enforcement rules
+ * serialized by other threads) while new names are registered.
+ * Currently, the IdRegistry class contains the following variables:
+ * - ids_: container used for mapping a name to its identifier.
+ * - names_: container used for mapping an identifier to its name (a deque, which does not move
+ * its elements when it grows).
+ */
+class IdRegistry {
+
+private:
+    std::unordered_map<std::string, int> ids_;
+    std::deque<std::string> names_;
+
+public:
+    /**
+     * IdRegistry default constructor.
+     */
+    IdRegistry ();
+
+    /**
+     * IdRegistry default destructor.
+     */
+    ~IdRegistry ();
+
+    /**
+     * intern: Gets the identifier of a name, registering it if needed.
+     * @param name Name to be interned.
+     * @return Returns the identifier of the name.
+     */
+    int intern (const std::string& name);
+
+    /**
+     * find: Gets the identifier of a name.
+     * @param name Name to be searched.
+     * @return Returns the identifier of the name, or INVALID_ID if it is not registered.
+     */
+    int find (const std::string& name) const;
+
+    /**
+     * name: Gets the name of an identifier.
+     * @param id Identifier.
+     * @return Returns the name of the identifier.
+     */
+    const std::string& name (int id) const;
+
+    /**
+     * size: Gets the number of registered names.
+     * @return Returns the number of registered names.
+     */
+    int size () const;
+};
+} // namespace cheferd
+
+#endif // CHEFERD_ID_REGISTRY_HPP
@@ -0,0 +1,263 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_JOB_TABLE_HPP
+#define CHEFERD_JOB_TABLE_HPP
+
+#include "id_registry.hpp"
+#include "max_min_allocator.hpp"
+
+#include <cheferd/networking/interface_definitions.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cheferd {
+
+/**
+ * JobTable class.
+ * Holds the state of the core controller in flat tables indexed by integer identifiers, which are
+ * interned when jobs, data plane stages, local controllers, and operations are registered. Per
+ * operation tables are indexed by job (structure of arrays), so the compute phase of each cycle
+ * runs without string hashing, and enforcement rules are batched per local controller as
+ * JobEnforcementRule objects, sent as they are (without serializing them into rule strings). Rules
+ * reference the interned names and the env list of each job's stages at each local controller,
+ * which is rebuilt only when these stages change, and batches are reused across cycles once the
+ * sessions that sent them release them, so batching does not allocate in steady state.
+ * Currently, the JobTable class contains the following variables:
+ * - jobs_, stages_, locals_, operations_: identifiers of jobs, data plane stages ("name+env"),
+ * local controllers, and operations.
+ * - job_locations_: stages of each job, grouped by local controller.
+ * - job_location_envs_: envs of the stages of each entry of job_locations_ (shared with the rules
+ * that reference them).
+ * - job_total_stages_: number of active stages of each job.
+ * - active_jobs_: jobs with at least one active stage, by order of registration.
+ * - stage_job_, stage_local_: job and local controller of each stage.
+ * - stage_active_: marks if each stage is active.
+ * - stage_env_: env of each stage, as identified in enforcement rules.
+ * - stage_usage_: last usage (e.g., IOPS) observed at each stage, per operation.
+ * - local_stages_: active stages of each local controller.
+ * - local_enabled_: marks if each local controller is sent enforcement rules.
+ * - local_rules_: batch of enforcement rules of each local controller for the current cycle
+ * (shared with the command that submits it).
+ * - batched_locals_: local controllers with a non-empty batch.
+ * - operation_capacities_: capacity of each operation.
+ * - demands_, rates_, previous_rates_: demand, imposed rate, and previous imposed rate of each
+ * job, per operation.
+ */
+class JobTable {
+
+private:
+    IdRegistry jobs_;
+    IdRegistry stages_;
+    IdRegistry locals_;
+    IdRegistry operations_;
+    std::vector<std::vector<std::pair<int, std::vector<int>>>> job_locations_;
+    std::vector<std::vector<std::shared_ptr<const std::vector<long>>>> job_location_envs_;
+    std::vector<int> job_total_stages_;
+    std::vector<int> active_jobs_;
+    std::vector<int> stage_job_;
+    std::vector<int> stage_local_;
+    std::vector<char> stage_active_;
+    std::vector<long> stage_env_;
+    std::vector<std::vector<double>> stage_usage_;
+    std::vector<std::vector<int>> local_stages_;
+    std::vector<char> local_enabled_;
+    std::vector<std::shared_ptr<std::vector<JobEnforcementRule>>> local_rules_;
+    std::vector<int> batched_locals_;
+    std::vector<long> operation_capacities_;
+    std::vector<std::vector<long>> demands_;
+    std::vector<std::vector<long>> rates_;
+    std::vector<std::vector<long>> previous_rates_;
+
+    /**
+     * reset_job: Resets the demand and rates of a job for every operation.
+     * @param job Job identifier.
+     */
+    void reset_job (int job);
+
+    /**
+     * update_location_envs: Rebuilds the env list of an entry of a job's locations (after its
+     * stages changed). Rules already batched keep the previous list.
+     * @param job Job identifier.
+     * @param location Index of the entry in job_locations_[job].
+     */
+    void update_location_envs (int job, std::size_t location);
+
+public:
+    /**
+     * JobTable default constructor.
+     */
+    JobTable ();
+
+    /**
+     * JobTable default destructor.
+     */
+    ~JobTable ();
+
+    /**
+     * register_local: Registers a local controller.
+     * @param local_address Local controller identifier.
+     * @return Returns the local controller's identifier.
+     */
+    int register_local (const std::string& local_address);
+
+    /**
+     * register_operation: Registers an operation. The capacity of an operation that is already
+     * registered is not changed.
+     * @param operation Operation name.
+     * @param capacity Capacity of the operation.
+     * @return Returns the operation's identifier.
+     */
+    int register_operation (const std::string& operation, long capacity);
+
+    /**
+     * register_job: Registers a job (e.g., when its demand is known before its stages connect).
+     * @param job_name Job's name.
+     * @return Returns the job's identifier.
+     */
+    int register_job (const std::string& job_name);
+
+    /**
+     * register_stage: Registers an active data plane stage, and its job and local controller.
+     * @param job_name Data plane stage job's name.
+     * @param stage_env Data plane stage job's env.
+     * @param local_address Local controller identifier.
+     * @return Returns the stage's identifier.
+     */
+    int register_stage (const std::string& job_name,
+        const std::string& stage_env,
+        const std::string& local_address);
+
+    /**
+     * remove_stage: Removes an active data plane stage. A job without active stages is removed
+     * from active_jobs_, and its demand and rates are reset.
+     * @param stage Stage identifier.
+     * @return Returns true if the stage's job was removed, false otherwise.
+     */
+    bool remove_stage (int stage);
+
+    /**
+     * jobs: Gets the job identifiers.
+     */
+    const IdRegistry& jobs () const;
+
+    /**
+     * stages: Gets the data plane stage identifiers.
+     */
+    const IdRegistry& stages () const;
+
+    /**
+     * locals: Gets the local controller identifiers.
+     */
+    const IdRegistry& locals () const;
+
+    /**
+     * operations: Gets the operation identifiers.
+     */
+    const IdRegistry& operations () const;
+
+    /**
+     * active_jobs: Gets the jobs with at least one active stage.
+     */
+    const std::vector<int>& active_jobs () const;
+
+    /**
+     * job_locations: Gets the active stages of a job, grouped by local controller.
+     * @param job Job identifier.
+     */
+    const std::vector<std::pair<int, std::vector<int>>>& job_locations (int job) const;
+
+    /**
+     * local_stages: Gets the active stages of a local controller.
+     * @param local Local controller identifier.
+     */
+    const std::vector<int>& local_stages (int local) const;
+
+    /**
+     * is_stage_active: Verifies if a stage is active.
+     * @param stage Stage identifier.
+     */
+    bool is_stage_active (int stage) const;
+
+    /**
+     * stage_job: Gets the job of a stage.
+     * @param stage Stage identifier.
+     */
+    int stage_job (int stage) const;
+
+    /**
+     * total_operations: Gets the number of registered operations.
+     */
+    int total_operations () const;
+
+    /**
+     * capacity: Gets the capacity of an operation.
+     * @param operation Operation identifier.
+     */
+    long& capacity (int operation);
+
+    /**
+     * demands: Gets the demands of every job for an operation (UNBOUNDED_DEMAND if unknown).
+     * @param operation Operation identifier.
+     */
+    std::vector<long>& demands (int operation);
+
+    /**
+     * rates: Gets the imposed rates of every job for an operation.
+     * @param operation Operation identifier.
+     */
+    std::vector<long>& rates (int operation);
+
+    /**
+     * previous_rates: Gets the previous imposed rates of every job for an operation.
+     * @param operation Operation identifier.
+     */
+    std::vector<long>& previous_rates (int operation);
+
+    /**
+     * stage_usage: Gets the last usage of an operation observed at each stage.
+     * @param operation Operation identifier.
+     */
+    std::vector<double>& stage_usage (int operation);
+
+    /**
+     * set_local_enabled: Defines if a local controller is sent enforcement rules (e.g., it is not
+     * while quarantined).
+     * @param local Local controller identifier.
+     * @param enabled Defines if the local controller is enabled.
+     */
+    void set_local_enabled (int local, bool enabled);
+
+    /**
+     * batch_enforcement_rule: Splits a job's rate among its data plane stages and adds the
+     * resulting enforcement rules to the batch of each of its local controllers.
+     * @param job Job identifier.
+     * @param operation Operation identifier.
+     * @param rate Rate to be imposed to the job.
+     */
+    void batch_enforcement_rule (int job, int operation, long rate);
+
+    /**
+     * batched_locals: Gets the local controllers with a non-empty batch.
+     */
+    const std::vector<int>& batched_locals () const;
+
+    /**
+     * local_rules: Gets the batch of enforcement rules of a local controller (which may be shared
+     * with a command to be submitted, and must not be changed afterwards).
+     * @param local Local controller identifier.
+     */
+    const std::shared_ptr<std::vector<JobEnforcementRule>>& local_rules (int local);
+
+    /**
+     * clear_batches: Clears the batches of enforcement rules. A batch still held by a session
+     * (e.g., whose submission timed out) is replaced, so it is not changed while it is sent.
+     */
+    void clear_batches ();
+};
+} // namespace cheferd
+
+#endif // CHEFERD_JOB_TABLE_HPP
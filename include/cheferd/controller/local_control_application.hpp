@@ -5,11 +5,18 @@
 #ifndef CHEFERD_LOCAL_CONTROL_APPLICATION_HPP
 #define CHEFERD_LOCAL_CONTROL_APPLICATION_HPP
 
+#include <asio/post.hpp>
+#include <asio/thread_pool.hpp>
 #include <cheferd/controller/control_application.hpp>
+#include <cheferd/controller/stage_sampler.hpp>
+#include <cheferd/networking/enforcement_table.hpp>
+#include <cheferd/networking/stage_reactor.hpp>
+#include <cheferd/networking/stats_segment.hpp>
 #include <cheferd/session/data_plane_session.hpp>
 #include <cheferd/session/handshake_session.hpp>
 #include <grpc/support/log.h>
 #include <grpcpp/grpcpp.h>
+#include <queue>
 #include <regex>
 #include <thread>
 
@@ -40,7 +47,7 @@ using grpc::ClientContext;
 
 namespace cheferd {
 
-// Number of rounds for aggregated statistics.
+// Number of rounds (feedback-loop cycles) covered by the default window of aggregated statistics.
 #define COLLECT_ROUNDS 5
 
 /**
@@ -48,13 +55,33 @@ namespace cheferd {
  * The LocalControlApplication represents the local controller that coordinates data plane stages.
  * Currently, the LocalControlApplication class contains the following variables:
  * - local_address: local controller address.
+ * - stage_reactor_: StageReactor that drives the sockets of every DataPlaneSession (declared
+ * before the sessions, so that it outlives them).
+ * - handshake_pool_: pool of threads that handshake data plane stages (see handshake_stage), so
+ * that stages are handshaked concurrently, and never by the feedback loop.
+ * - stats_segment_: shared-memory segment where data plane stages publish their statistics
+ * (declared before the sessions, which release their slots).
+ * - enforcement_table_: shared-memory table where the enforcement rules of data plane stages are
+ * written (declared before the sessions, which release their slots).
  * - data_sessions_: container used for mapping active data plane stages to its DataPlaneSession.
  * - preparing_data_sessions_: container used for mapping preparing data plane stages to its
- * DataPlaneSession.
- * - pending_data_sessions_: queue that holds pending data plane sessions.
+ * DataPlaneSession, until the core controller marks them ready (guarded by data_sessions_lock_).
+ * - pending_data_sessions_: queue that holds pending data plane sessions (shared with the tasks
+ * of handshake_pool_ that handshake them).
  * - pending_data_plane_sessions_lock_: mutex for concurrency control over pending_data_sessions_.
+ * - stage_requests_lock_: mutex that serializes the requests submitted to the sessions of
+ * data_sessions_ and the waits for their responses (e.g., statistics collections and enforcement
+ * rules), so that each session has a single submitter. Waits are bounded by
+ * option_default_data_plane_response_timeout. Acquired before data_sessions_lock_.
+ * - data_sessions_lock_: mutex for concurrency control over data_sessions_ and
+ * preparing_data_sessions_, held only to look sessions up, insert, and remove them (never while
+ * waiting for a data plane stage).
+ * - stage_sampler_: samples of each data plane stage, collected in the background, from which
+ * aggregated statistics are served.
  * - operation_to_channel_object: container used for mapping an operation to its respective channel
  * in the data plane stage context.
+ * - housekeeping_commands_: housekeeping rules received from the core controller, parsed once
+ * and submitted as-is to each data plane stage.
  * - core_stub_: unique_ptr of stub used to communicate with the core controller.
  * - server: unique_ptr of Server  used to communicate by the core controller.
  * - m_active_data_plane_sessions: atomic value that marks the number of active data
@@ -66,11 +93,19 @@ class LocalControlApplication : public GlobalToLocal::Service, public ControlApp
 
 private:
     std::string local_address;
-    std::unordered_map<std::string, std::unique_ptr<DataPlaneSession>> data_sessions_;
-    std::unordered_map<std::string, std::unique_ptr<DataPlaneSession>> preparing_data_sessions_;
-    std::queue<std::unique_ptr<HandshakeSession>> pending_data_sessions_;
+    StageReactor stage_reactor_;
+    asio::thread_pool handshake_pool_;
+    StatsSegment stats_segment_;
+    EnforcementTable enforcement_table_;
+    std::unordered_map<std::string, std::shared_ptr<DataPlaneSession>> data_sessions_;
+    std::unordered_map<std::string, std::shared_ptr<DataPlaneSession>> preparing_data_sessions_;
+    std::queue<std::shared_ptr<HandshakeSession>> pending_data_sessions_;
     std::mutex pending_data_plane_sessions_lock_;
+    std::mutex stage_requests_lock_;
+    std::mutex data_sessions_lock_;
+    StageSampler stage_sampler_;
     std::unordered_map<std::string, std::vector<std::pair<int, int>>> operation_to_channel_object;
+    std::vector<ControlCommand> housekeeping_commands_;
     std::unique_ptr<LocalToGlobal::Stub> core_stub_;
     std::unique_ptr<Server> server;
     std::atomic<int> m_active_data_plane_sessions;
@@ -88,7 +123,8 @@ private:
     void execute_feedback_loop ();
 
     /**
-     * handle_data_plane_sessions. Processes pending data plane sessions.
+     * handle_data_plane_sessions. Processes pending data plane sessions, by handing each one to
+     * the handshake_pool_ (without waiting for the handshakes).
      */
     void handle_data_plane_sessions ();
 
@@ -97,27 +133,81 @@ private:
      */
     void sleep () override;
 
+    /**
+     * handshake_stage: Handshakes a data plane stage (identification, connection to its
+     * DataPlaneSession, housekeeping rules, and negotiations), and connects it to the core
+     * controller. Runs in the handshake_pool_; every wait for the stage is bounded by
+     * option_default_data_plane_response_timeout (and the connection by
+     * option_default_data_plane_accept_timeout).
+     * @param handshake_session Session of the data plane stage.
+     */
+    void handshake_stage (HandshakeSession* handshake_session);
+
     /**
      * call_stage_handshake: Submits STAGE_HANDSHAKE rule and housekeeping rules to data plane
      * stage.
      * @param handshake_session  Session to submit handshake rule to.
+     * @param data_session DataPlaneSession created for the data plane stage (nullptr if the stage
+     * did not answer).
      * @return  Returns unique_ptr holding data plane stage detailed information.
      */
-    std::unique_ptr<StageInfo> call_stage_handshake (HandshakeSession* handshake_session);
+    std::unique_ptr<StageInfo> call_stage_handshake (HandshakeSession* handshake_session,
+        std::shared_ptr<DataPlaneSession>& data_session);
 
     /**
      * mark_stage_ready: Submits STAGE_READY to data plane stage.
-     * @param stage_name_env Data plane stage identifier.
+     * @param data_session DataPlaneSession of the data plane stage.
      * @return Returns PStatus::OK if successful, PStatus::Error otherwise.
      */
-    PStatus mark_stage_ready (const std::string& stage_name_env) const;
+    PStatus mark_stage_ready (DataPlaneSession* data_session) const;
 
     /**
-     * submit_housekeeping_rules: Submits housekeeping rules to data plane stage.
+     * negotiate_shared_segment: Offers a slot of a shared-memory segment to a data plane stage
+     * (e.g., STAGE_STATS_SEGMENT or STAGE_ENF_TABLE). If the stage rejects it, the slot is
+     * released and the stage keeps using its socket.
      * @param stage_name_env Data plane stage identifier.
+     * @param data_session DataPlaneSession of the data plane stage.
+     * @param operation_type Operation that offers the segment.
+     * @param segment Shared-memory segment.
+     * @param version Version of the layout of the segment.
+     * @param slot Slot assigned to the stage (if accepted).
+     * @return Returns PStatus::OK if the stage uses the segment, PStatus::Error otherwise.
+     */
+    PStatus negotiate_shared_segment (const std::string& stage_name_env,
+        DataPlaneSession* data_session,
+        int operation_type,
+        SharedSegment& segment,
+        uint32_t version,
+        int& slot);
+
+    /**
+     * negotiate_stats_version: Exchanges the version of the per-channel statistics records with a
+     * data plane stage (STAGE_STATS_VERSION). Stages that do not report them (e.g., of the previous
+     * version) are asked for COLLECT_GLOBAL_STATS.
+     * @param stage_name_env Data plane stage identifier.
+     * @param data_session DataPlaneSession of the data plane stage.
+     * @return Returns PStatus::OK if the stage reports per-channel records, PStatus::Error
+     * otherwise.
+     */
+    PStatus negotiate_stats_version (const std::string& stage_name_env,
+        DataPlaneSession* data_session);
+
+    /**
+     * submit_housekeeping_rules: Submits housekeeping rules to data plane stage.
+     * @param data_session DataPlaneSession of the data plane stage.
      * @return Number of housekeeping rules successfully submitted.
      */
-    int submit_housekeeping_rules (const std::string& stage_name_env) const;
+    int submit_housekeeping_rules (DataPlaneSession* data_session) const;
+
+    /**
+     * fill_housekeeping_command: Converts a tokenized housekeeping rule (create_channel or
+     * create_object) into the ControlCommand submitted to the data plane stages.
+     * @param rule_tokens Tokens of the housekeeping rule.
+     * @param command ControlCommand to be filled.
+     * @return Returns PStatus::OK if successful, PStatus::Error otherwise.
+     */
+    static PStatus fill_housekeeping_command (const std::vector<std::string>& rule_tokens,
+        ControlCommand& command);
 
     /**
      * fill_socket_info: Defines a new individual socket for data plane stage.
@@ -184,7 +274,9 @@ private:
         controllers_grpc_interface::ACK* reply) override;
 
     /**
-     * CreateEnforcementRule: Create enforcement from core controller.
+     * CreateEnforcementRule: Create enforcement from core controller. A single request carries
+     * the rules of every job of the local controller for the current cycle. The rules of every job
+     * are written to the enforcement table before any rule is submitted through the sockets.
      * @param context Server context.
      * @param request Rules to be enforced.
      * @param reply Response.
@@ -194,6 +286,21 @@ private:
         const controllers_grpc_interface::EnforcementRules* request,
         controllers_grpc_interface::ACK* reply) override;
 
+    /**
+     * enforce_job_rule: Submits the enforcement rule of a job to its data plane stages. Must be
+     * called while holding stage_requests_lock_ and data_sessions_lock_. The rules of stages that
+     * use the enforcement table are written to it right away; the rules to be submitted through
+     * the sockets (of the remaining stages, or to confirm the table writes) are added to
+     * confirmations.
+     * @param operation Operation that the rule refers to.
+     * @param job_rates Rates of each of the job's data plane stages.
+     * @param confirmations Rules to be submitted through the socket of each stage.
+     * @return Returns Status::OK if the operation is supported, Status::CANCELLED otherwise.
+     */
+    Status enforce_job_rule (const std::string& operation,
+        const controllers_grpc_interface::EnforcementOpRules& job_rates,
+        std::vector<std::pair<std::string, std::vector<ControlCommand>>>& confirmations);
+
     /**
      * CollectGlobalStatistics: Collect Statistics request from core controller.
      * @param context Server context.
@@ -205,9 +312,56 @@ private:
         const controllers_grpc_interface::ControlOperation* request,
         controllers_grpc_interface::StatsGlobalMap* reply) override;
 
+    /**
+     * StreamGlobalStatistics: Statistics stream request from core controller. Pushes the
+     * statistics of the data plane stages at the requested period until the stream is cancelled.
+     * @param context Server context.
+     * @param request Defines the period between pushes.
+     * @param writer Stream writer.
+     * @return Returns Status::OK if successful, Status::Error otherwise.
+     */
+    Status StreamGlobalStatistics (ServerContext* context,
+        const controllers_grpc_interface::StatsStreamRequest* request,
+        grpc::ServerWriter<controllers_grpc_interface::StatsGlobalMap>* writer) override;
+
+    /**
+     * collect_stage_statistics: Collects the statistics of the active data plane stages. Must be
+     * called while holding stage_requests_lock_ (data_sessions_lock_ is only held to take a
+     * snapshot of the sessions, and to remove sessions). Stages that publish in the statistics
+     * segment are read from it, and the remaining through their sockets, within
+     * option_default_data_plane_response_timeout. Stages that disconnected or did not answer in
+     * time are removed, and reported by report_disconnected_stages.
+     * @param reply Container to store the statistics.
+     */
+    void collect_stage_statistics (controllers_grpc_interface::StatsGlobalMap* reply);
+
+    /**
+     * report_disconnected_stages: Adds the stages that disconnected since the last report to a
+     * reply (with a rate of -1), so that the core controller removes them.
+     * @param reply Container to store the statistics.
+     */
+    void report_disconnected_stages (controllers_grpc_interface::StatsGlobalMap* reply);
+
+    /**
+     * fill_channel_statistics: Adds the statistics of each channel of a data plane stage to its
+     * statistics message (and the version of the per-channel statistics).
+     * @param channel_stats Statistics of each channel.
+     * @param stats_global Statistics message of the data plane stage.
+     */
+    static void fill_channel_statistics (const std::vector<StatsChannelRaw>& channel_stats,
+        controllers_grpc_interface::StatsGlobal* stats_global);
+
+    /**
+     * sample_stage_statistics: Samples the statistics of the active data plane stages into
+     * stage_sampler_ every option_default_local_sampling_period, while the control application
+     * is working (executed by a background thread).
+     */
+    void sample_stage_statistics ();
+
     /**
      * CollectGlobalStatisticsAggregated: Collect Statistics request from core controller.
-     * It aggregates the statistics from several rounds.
+     * It summarizes the samples collected in the background over the requested window (by
+     * default, COLLECT_ROUNDS feedback-loop cycles), and returns without sampling the stages.
      * @param context Server context.
      * @param request Defines control operation.
      * @param reply Response.
@@ -218,12 +372,15 @@ private:
         StatsGlobalMap* reply) override;
 
     /**
-     * LocalPassthru: General function to submit rules to data plane stages.
+     * LocalPassthru: General function to submit rules to data plane stages. Every command is
+     * submitted before reading the responses, so that they are in flight at once. Must be called
+     * while holding stage_requests_lock_ (and not data_sessions_lock_). Responses are awaited
+     * within option_default_data_plane_response_timeout.
      * @param stage_name_env Data plane stage identifier.
-     * @param rule Rule to be submitted.
-     * @return Returns Status::OK if successful, Status::Error otherwise.
+     * @param commands Commands to be submitted.
+     * @return Returns Status::OK if every command was acknowledged, Status::CANCELLED otherwise.
      */
-    Status LocalPassthru (std::string stage_name_env, std::string rule);
+    Status LocalPassthru (std::string stage_name_env, std::vector<ControlCommand> commands);
 
 public:
     /**
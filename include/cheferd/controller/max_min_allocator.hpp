@@ -0,0 +1,58 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_MAX_MIN_ALLOCATOR_HPP
+#define CHEFERD_MAX_MIN_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace cheferd {
+
+// Demand of a job that did not state one; it is served as much as the fair share allows.
+#define UNBOUNDED_DEMAND -1
+
+/**
+ * MaxMinAllocator class.
+ * Water-filling allocator that shares a capacity (e.g., IOPS, bandwidth) among jobs in a max-min
+ * fair manner: the "water level" rises evenly for all jobs, and each job stops at its demand. Jobs
+ * are visited by increasing demand, with ties broken by their position in the input, so the
+ * allocation is exact, deterministic, and costs O(n log n).
+ * Currently, the MaxMinAllocator class contains the following variables:
+ * - order_: demand and position of each job, sorted by demand (reused across cycles to avoid
+ * allocations).
+ */
+class MaxMinAllocator {
+
+private:
+    std::vector<std::pair<long, std::size_t>> order_;
+
+public:
+    /**
+     * MaxMinAllocator default constructor.
+     */
+    MaxMinAllocator ();
+
+    /**
+     * MaxMinAllocator default destructor.
+     */
+    ~MaxMinAllocator ();
+
+    /**
+     * allocate: Computes the max-min fair allocation of capacity among jobs. Jobs with a demand
+     * below the water level are assigned their demand; the remaining capacity is split evenly
+     * among the others (the remainder of the division is assigned one unit at a time to the jobs
+     * with the largest demands, which never exceeds their demand).
+     * @param demands Demand of each job (UNBOUNDED_DEMAND if unknown).
+     * @param capacity Capacity to be shared.
+     * @param rates Container to store the rate assigned to each job (same positions as demands).
+     * @return Returns the capacity left unallocated, which is only positive when all demands are
+     * satisfied.
+     */
+    long allocate (const std::vector<long>& demands, long capacity, std::vector<long>& rates);
+};
+} // namespace cheferd
+
+#endif // CHEFERD_MAX_MIN_ALLOCATOR_HPP
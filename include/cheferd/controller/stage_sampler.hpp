@@ -0,0 +1,145 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_STAGE_SAMPLER_HPP
+#define CHEFERD_STAGE_SAMPLER_HPP
+
+#include <cheferd/networking/channel_counters.hpp>
+#include <cheferd/networking/interface_definitions.hpp>
+#include <cheferd/utils/ring_buffer.hpp>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cheferd {
+
+// Weight of the newest sample in the exponentially weighted moving average of a window.
+#define SAMPLE_EWMA_WEIGHT 0.3
+
+/**
+ * RateSample struct.
+ * Holds a rate sampled from a data plane stage.
+ * - m_time: time at which the sample was collected.
+ * - m_rate: total rate (e.g., IOPS) of the stage.
+ */
+struct RateSample {
+    std::chrono::steady_clock::time_point m_time {};
+    double m_rate { 0 };
+};
+
+/**
+ * RateSummary struct.
+ * Summary of the samples of a data plane stage over a window.
+ * - m_mean: arithmetic mean of the rate.
+ * - m_variance: variance of the rate.
+ * - m_ewma: exponentially weighted moving average of the rate (SAMPLE_EWMA_WEIGHT).
+ * - m_min, m_max: minimum and maximum rate.
+ * - m_last: newest rate.
+ * - m_samples: number of samples in the window.
+ * - m_channels: statistics of each channel, where rates are derived from the counters over the
+ * window (or the mean of the rates sampled, if the stage does not report counters) and counters
+ * are the newest.
+ */
+struct RateSummary {
+    double m_mean { 0 };
+    double m_variance { 0 };
+    double m_ewma { 0 };
+    double m_min { 0 };
+    double m_max { 0 };
+    double m_last { 0 };
+    int m_samples { 0 };
+    std::vector<StatsChannelRaw> m_channels {};
+};
+
+/**
+ * StageSamples struct.
+ * Holds the samples of a data plane stage. Channel samples are taken with the rate samples, so the
+ * newest samples of each buffer are aligned (a channel created later holds fewer samples, and
+ * channels missing from the newest sample are discarded).
+ * - m_rates: total rate samples.
+ * - m_channels: statistics samples of each channel, by channel identifier.
+ */
+struct StageSamples {
+    RingBuffer<RateSample> m_rates;
+    std::unordered_map<long, RingBuffer<StatsChannelRaw>> m_channels {};
+
+    explicit StageSamples (std::size_t capacity) : m_rates { capacity }
+    { }
+};
+
+/**
+ * StageSampler class.
+ * Holds the samples of each data plane stage of a local controller in a fixed-size ring buffer,
+ * filled by a background sampling thread and summarized over a window on request, so that
+ * aggregated statistics are served without sampling the stages again.
+ * Currently, the StageSampler class contains the following variables:
+ * - samples_lock_: mutex for concurrency control over samples_ and disconnected_stages_.
+ * - samples_: container used for mapping a data plane stage to its samples.
+ * - disconnected_stages_: stages that disconnected and were not yet reported.
+ * - capacity_: number of samples held per stage.
+ */
+class StageSampler {
+
+private:
+    std::mutex samples_lock_;
+    std::unordered_map<std::string, StageSamples> samples_;
+    std::vector<std::string> disconnected_stages_;
+    std::size_t capacity_;
+
+public:
+    /**
+     * StageSampler parameterized constructor.
+     * @param capacity Number of samples held per stage.
+     */
+    explicit StageSampler (std::size_t capacity);
+
+    /**
+     * StageSampler default destructor.
+     */
+    ~StageSampler ();
+
+    /**
+     * record: Adds a sample of a data plane stage.
+     * @param stage_name_env Data plane stage identifier.
+     * @param sample Rate sampled.
+     * @param channels Statistics of each channel sampled (empty if not reported); the samples of
+     * channels not included are discarded.
+     */
+    void record (const std::string& stage_name_env,
+        const RateSample& sample,
+        const std::vector<StatsChannelRaw>& channels);
+
+    /**
+     * remove: Discards the samples of a data plane stage that disconnected, and marks it to be
+     * reported.
+     * @param stage_name_env Data plane stage identifier.
+     */
+    void remove (const std::string& stage_name_env);
+
+    /**
+     * summarize: Summarizes the samples of each data plane stage collected within a window. Stages
+     * without samples in the window are summarized by their newest sample.
+     * @param window Length of the window (in microseconds), ending at now.
+     * @param max_samples Maximum number of (most recent) samples per stage (0 for no limit).
+     * @param now Time at which the window ends.
+     * @param summaries Container to store the summary of each stage.
+     */
+    void summarize (uint64_t window,
+        std::size_t max_samples,
+        std::chrono::steady_clock::time_point now,
+        std::unordered_map<std::string, RateSummary>& summaries);
+
+    /**
+     * take_disconnected: Gets the stages that disconnected since the last call, so each one is
+     * reported once.
+     * @param disconnected_stages Container to store the stages.
+     */
+    void take_disconnected (std::vector<std::string>& disconnected_stages);
+};
+} // namespace cheferd
+
+#endif // CHEFERD_STAGE_SAMPLER_HPP
@@ -0,0 +1,213 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_TIME_SERIES_STORE_HPP
+#define CHEFERD_TIME_SERIES_STORE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace cheferd {
+
+/**
+ * TimeSeriesStore class.
+ * Holds the most recent samples of a set of series (e.g., the rate of each data plane stage at each
+ * feedback-loop cycle) in a columnar ring: all series share a column of sample times, and each
+ * series has a contiguous, fixed-size column of values, so queries over a window read one series
+ * sequentially, in O(window). Series without a value at a sample (e.g., a stage that did not
+ * report) hold a missing value, which queries skip. Series are keyed by an identifier (e.g., a
+ * stage identifier) and are assigned on their first record; the columns of all series are
+ * allocated at construction, so memory is bounded by capacity * max_series values and recording
+ * never allocates them. The series of a released identifier (e.g., a removed stage) is reused by
+ * the next one; identifiers recorded when all series are assigned are not kept. It is not
+ * thread-safe.
+ * Currently, the TimeSeriesStore class contains the following variables:
+ * - capacity_: number of samples held per series.
+ * - max_series_: maximum number of series.
+ * - head_: slot of the newest sample.
+ * - size_: number of samples held.
+ * - total_series_: number of series that were assigned (in use or free).
+ * - times_: time of each sample.
+ * - values_: values of each series, by series (series * capacity_ + slot).
+ * - id_series_: series assigned to each identifier (or no_series).
+ * - free_series_: released series, reused before the unassigned ones.
+ */
+class TimeSeriesStore {
+
+private:
+    std::size_t capacity_;
+    std::size_t max_series_;
+    std::size_t head_;
+    std::size_t size_;
+    std::size_t total_series_;
+    std::vector<std::chrono::steady_clock::time_point> times_;
+    std::vector<float> values_;
+    std::vector<std::size_t> id_series_;
+    std::vector<std::size_t> free_series_;
+
+    /**
+     * series_of: Gets the series assigned to an identifier (or no_series).
+     * @param id Series identifier.
+     */
+    std::size_t series_of (std::size_t id) const;
+
+    /**
+     * slot: Gets the slot of a sample by its age.
+     * @param age Age of the sample, from the newest (0) to the oldest (size () - 1).
+     */
+    std::size_t slot (std::size_t age) const;
+
+    /**
+     * for_each_value: Visits the values of a series within the newest samples, from the newest to
+     * the oldest, in (at most) two sequential runs of its column (none if the identifier has no
+     * series).
+     * @param id Series identifier.
+     * @param length Number of samples.
+     * @param visit Function invoked with the slot and value of each sample (including missing
+     * values); it returns false to stop the visit.
+     */
+    template <typename Visit>
+    void for_each_value (std::size_t id, std::size_t length, Visit visit) const
+    {
+        std::size_t series = series_of (id);
+        if (series == no_series) {
+            return;
+        }
+
+        const float* column = values_.data () + series * capacity_;
+        length = length < size_ ? length : size_;
+
+        // from the newest slot down to the start of the column, then from its end
+        std::size_t first_run = length < head_ + 1 ? length : head_ + 1;
+        for (std::size_t i = 0; i < first_run; i++) {
+            if (!visit (head_ - i, column[head_ - i])) {
+                return;
+            }
+        }
+
+        for (std::size_t i = 0; i < length - first_run; i++) {
+            if (!visit (capacity_ - 1 - i, column[capacity_ - 1 - i])) {
+                return;
+            }
+        }
+    }
+
+public:
+    // Series of an identifier without one.
+    static constexpr std::size_t no_series = static_cast<std::size_t> (-1);
+
+    /**
+     * TimeSeriesStore parameterized constructor. Allocates the columns of every series.
+     * @param capacity Number of samples held per series (at least one).
+     * @param max_series Maximum number of series.
+     */
+    TimeSeriesStore (std::size_t capacity, std::size_t max_series);
+
+    /**
+     * TimeSeriesStore default destructor.
+     */
+    ~TimeSeriesStore ();
+
+    /**
+     * release: Releases the series of an identifier (e.g., of a removed stage), to be reused by
+     * the next identifier recorded. Its values are discarded.
+     * @param id Series identifier.
+     */
+    void release (std::size_t id);
+
+    /**
+     * advance: Starts a new sample (overwriting the oldest one if the store is full), where every
+     * series holds a missing value until it is recorded.
+     * @param time Time of the sample.
+     */
+    void advance (std::chrono::steady_clock::time_point time);
+
+    /**
+     * record: Sets the value of a series at the newest sample. An identifier without a series is
+     * assigned one (holding missing values for past samples), if any is left.
+     * @param id Series identifier.
+     * @param value Value of the series.
+     * @return Returns false if the identifier has no series and none is left, and true otherwise.
+     */
+    bool record (std::size_t id, float value);
+
+    /**
+     * window_length: Gets the number of (newest) samples taken within a window.
+     * @param window Length of the window, ending at the newest sample.
+     */
+    std::size_t window_length (std::chrono::microseconds window) const;
+
+    /**
+     * count: Gets the number of values of a series within the newest samples.
+     * @param id Series identifier.
+     * @param length Number of samples (see window_length).
+     */
+    std::size_t count (std::size_t id, std::size_t length) const;
+
+    /**
+     * mean: Computes the mean of a series within the newest samples (0 without values).
+     * @param id Series identifier.
+     * @param length Number of samples (see window_length).
+     */
+    double mean (std::size_t id, std::size_t length) const;
+
+    /**
+     * trend: Computes the trend (least-squares slope, in units per second) of a series within the
+     * newest samples (0 with fewer than two values).
+     * @param id Series identifier.
+     * @param length Number of samples (see window_length).
+     */
+    double trend (std::size_t id, std::size_t length) const;
+
+    /**
+     * percentile: Computes a percentile of a series within the newest samples (0 without values).
+     * @param id Series identifier.
+     * @param length Number of samples (see window_length).
+     * @param percentile Percentile, between 0 and 100.
+     * @param scratch Buffer used to select the percentile (reused across queries to avoid
+     * allocations).
+     */
+    double percentile (std::size_t id,
+        std::size_t length,
+        double percentile,
+        std::vector<float>& scratch) const;
+
+    /**
+     * is_idle: Verifies if a series did not exceed a threshold within the newest samples (missing
+     * values count as idle).
+     * @param id Series identifier.
+     * @param length Number of samples (see window_length).
+     * @param threshold Maximum value of an idle series.
+     */
+    bool is_idle (std::size_t id, std::size_t length, double threshold) const;
+
+    /**
+     * size: Gets the number of samples held.
+     */
+    std::size_t size () const;
+
+    /**
+     * capacity: Gets the number of samples held per series.
+     */
+    std::size_t capacity () const;
+
+    /**
+     * max_series: Gets the maximum number of series.
+     */
+    std::size_t max_series () const;
+
+    /**
+     * total_series: Gets the number of series assigned to identifiers.
+     */
+    std::size_t total_series () const;
+
+    /**
+     * memory_usage: Gets the memory (in bytes) allocated for samples.
+     */
+    std::size_t memory_usage () const;
+};
+} // namespace cheferd
+
+#endif // CHEFERD_TIME_SERIES_STORE_HPP
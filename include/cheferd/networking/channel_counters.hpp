@@ -0,0 +1,67 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_CHANNEL_COUNTERS_HPP
+#define CHEFERD_CHANNEL_COUNTERS_HPP
+
+#include <cheferd/networking/interface_definitions.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace cheferd {
+
+/**
+ * ChannelCounters class.
+ * Derives the rates of the channels of a data plane stage from the monotonic counters (requests
+ * and bytes) and timestamps it reports. Since each rate is computed over the exact interval between
+ * two reports, late or missed reports do not distort it. Channels of stages that do not report
+ * counters (m_timestamp is 0) keep the rates computed by the stage.
+ * Currently, the ChannelCounters class contains the following variables:
+ * - last_counters_: last report of each channel, by channel identifier.
+ */
+class ChannelCounters {
+
+private:
+    std::unordered_map<long, StatsChannelRaw> last_counters_;
+
+public:
+    /**
+     * ChannelCounters default constructor.
+     */
+    ChannelCounters ();
+
+    /**
+     * ChannelCounters default destructor.
+     */
+    ~ChannelCounters ();
+
+    /**
+     * derive_rates: Replaces the rates of each channel with the rates derived from its counters
+     * since its last report. The first report of a channel, and reports after its counters were
+     * reset (e.g., the stage restarted), keep the rates computed by the stage.
+     * @param channel_stats Statistics of each channel of the data plane stage.
+     */
+    void derive_rates (std::vector<StatsChannelRaw>& channel_stats);
+
+    /**
+     * clear: Discards the last report of every channel.
+     */
+    void clear ();
+
+    /**
+     * rates_between: Computes the rates of a channel between two of its reports.
+     * @param previous Older report.
+     * @param current Newer report.
+     * @param ops_rate Rate of requests (ops/s) between the reports.
+     * @param bytes_rate Rate of bytes (bytes/s) between the reports.
+     * @return Returns true if both reports hold counters and they did not go back (e.g., reset).
+     */
+    static bool rates_between (const StatsChannelRaw& previous,
+        const StatsChannelRaw& current,
+        double& ops_rate,
+        double& bytes_rate);
+};
+} // namespace cheferd
+
+#endif // CHEFERD_CHANNEL_COUNTERS_HPP
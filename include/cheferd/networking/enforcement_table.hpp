@@ -0,0 +1,83 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_ENFORCEMENT_TABLE_HPP
+#define CHEFERD_ENFORCEMENT_TABLE_HPP
+
+#include <cheferd/networking/shared_segment.hpp>
+
+namespace cheferd {
+
+// Number of times a read of an enforcement table entry is retried while overlapping a write.
+#define ENFORCEMENT_TABLE_READ_RETRIES 64
+
+/**
+ * EnforcementTable class.
+ * Shared-memory table where the local controller writes the enforcement rules of the data plane
+ * stages of a node, so that rate changes reach a stage without a request and a response through
+ * its socket. Each slot holds the entries of a data plane stage, one per enforcement object; each
+ * entry has a single writer (the local controller) and is read by its stage under a seqlock
+ * (EnforcementEntryRaw), which applies the entries whose generation changed since its last read.
+ */
+class EnforcementTable : public SharedSegment {
+
+protected:
+    /**
+     * initialize_slot: Initializes a slot (no rules written).
+     * @param slot Address of the slot.
+     */
+    void initialize_slot (void* slot) override;
+
+public:
+    /**
+     * EnforcementTable default constructor.
+     */
+    EnforcementTable ();
+
+    /**
+     * EnforcementTable default destructor.
+     */
+    ~EnforcementTable () override;
+
+    /**
+     * create: Creates the table (local controller side).
+     * @param name Name of the table (e.g., "/cheferd_enforcement_<pid>").
+     * @param slots Number of slots.
+     * @return Returns PStatus::OK if successful, PStatus::Error otherwise.
+     */
+    PStatus create (const std::string& name, int slots);
+
+    /**
+     * attach: Attaches to a table created by the local controller (data plane stage side).
+     * @param name Name of the table.
+     * @return Returns PStatus::OK if successful and its layout is supported, PStatus::Error
+     * otherwise.
+     */
+    PStatus attach (const std::string& name);
+
+    /**
+     * write: Writes the enforcement rule of an enforcement object of a data plane stage (executed
+     * by the single writer of the entry).
+     * @param slot Slot of the data plane stage.
+     * @param entry Entry of the enforcement object.
+     * @param rule Enforcement rule.
+     * @return Generation of the entry after the write, or 0 if the entry does not exist.
+     */
+    uint64_t write (int slot, int entry, const EnforcementRuleRaw& rule);
+
+    /**
+     * read: Reads the enforcement rule of an enforcement object, if it changed since the last read,
+     * without system calls.
+     * @param slot Slot of the data plane stage.
+     * @param entry Entry of the enforcement object.
+     * @param generation Generation of the last read, updated if a new rule is read.
+     * @param rule Container to store the enforcement rule.
+     * @return Returns PStatus::OK if a new rule was read, PStatus::Error if the entry did not
+     * change, or every retry overlapped a write.
+     */
+    PStatus read (int slot, int entry, uint64_t& generation, EnforcementRuleRaw& rule) const;
+};
+} // namespace cheferd
+
+#endif // CHEFERD_ENFORCEMENT_TABLE_HPP
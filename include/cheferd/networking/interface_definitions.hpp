@@ -5,11 +5,15 @@
 #ifndef CHEFERD_INTERFACE_DEFINITIONS_HPP
 #define CHEFERD_INTERFACE_DEFINITIONS_HPP
 
+#include <atomic>
 #include <cheferd/utils/context_propagation_definitions.hpp>
 #include <climits>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace cheferd {
 
@@ -26,11 +30,15 @@ namespace cheferd {
 #define LOCAL_HANDSHAKE      11
 #define STAGE_HANDSHAKE_INFO 12
 #define COLLECT_ENTITY_STATS 14
+#define STAGE_STATS_SEGMENT  15
+#define STAGE_ENF_TABLE      16
+#define STAGE_STATS_VERSION  17
 
 #define HSK_CREATE_CHANNEL              1
 #define HSK_CREATE_OBJECT               2
 #define COLLECT_GLOBAL_STATS            5
 #define COLLECT_GLOBAL_STATS_AGGREGATED 6
+#define COLLECT_CHANNEL_STATS           7
 
 /**
  * ControlOperation structure.
@@ -228,6 +236,27 @@ struct EnforcementRuleRaw {
     long m_property_third { -1 };
 };
 
+/**
+ * JobEnforcementRule: Structure that holds the enforcement rule of a job, submitted by the core
+ * controller to a local controller (batched with the rules of the local controller's other jobs).
+ * It references the interned names and env lists of the core controller (see JobTable), so
+ * batching a rule does not allocate; they are resolved when the rule is serialized.
+ * - m_rule_id: defines the rule identifier;
+ * - m_job_name: defines the job's name (i.e., the name of its data plane stages), interned by
+ * the core controller (never released);
+ * - m_operation: defines the operation to be enforced, interned by the core controller;
+ * - m_envs: defines the envs of the job's data plane stages at the local controller (shared and
+ * immutable, so it outlives changes to the job's stages while the rule is serialized);
+ * - m_rate: defines the rate to be imposed to each of these data plane stages.
+ */
+struct JobEnforcementRule {
+    long m_rule_id { 0 };
+    const std::string* m_job_name { nullptr };
+    const std::string* m_operation { nullptr };
+    std::shared_ptr<const std::vector<long>> m_envs {};
+    long m_rate { -1 };
+};
+
 /**
  * StageReadyRaw: Raw structure that defines if the data plane is ready to receive I/O requests
  * from the targeted I/O layer.
@@ -243,6 +272,167 @@ struct StatsGlobalRaw {
     double m_total_rate;
 };
 
+/**
+ * stats_channel_version: defines the version of the per-channel statistics records
+ * (StatsChannelRaw) understood by the control plane.
+ */
+const uint32_t stats_channel_version = 2;
+
+/**
+ * stats_max_channels: defines the maximum number of channels reported by a data plane stage.
+ */
+const int stats_max_channels = 64;
+
+/**
+ * StatsChannelHeaderRaw: Raw structure that precedes the per-channel statistics records sent by a
+ * data plane stage (COLLECT_CHANNEL_STATS).
+ * - m_version: defines the version of the records (stats_channel_version);
+ * - m_record_size: defines the size of each record. Newer versions only append fields, so records
+ * larger than StatsChannelRaw are truncated and smaller ones are zero-filled (at most
+ * stats_max_record_size);
+ * - m_channels: defines the number of records that follow.
+ */
+struct StatsChannelHeaderRaw {
+    uint32_t m_version { stats_channel_version };
+    uint32_t m_record_size { 0 };
+    int m_channels { 0 };
+};
+
+/**
+ * StatsChannelRaw: Raw structure that holds the statistics of a channel of a data plane stage.
+ * - m_channel_id: defines the Channel identifier;
+ * - m_ops_rate: defines the rate of requests (ops/s);
+ * - m_bytes_rate: defines the rate of bytes (bytes/s);
+ * - m_total_ops: defines the total number of requests served since the channel was created;
+ * - m_delayed_ops: defines the total number of requests delayed by the rate limiter;
+ * - m_avg_wait: defines the average time (in microseconds) a delayed request waited;
+ * - m_total_bytes: defines the total number of bytes served since the channel was created
+ * (version 2);
+ * - m_timestamp: defines the time (monotonic clock, in nanoseconds) at which the counters were read
+ * (version 2; 0 if the stage does not report counters, and only its rates are valid).
+ */
+struct StatsChannelRaw {
+    long m_channel_id { -1 };
+    double m_ops_rate { 0 };
+    double m_bytes_rate { 0 };
+    uint64_t m_total_ops { 0 };
+    uint64_t m_delayed_ops { 0 };
+    double m_avg_wait { 0 };
+    uint64_t m_total_bytes { 0 };
+    uint64_t m_timestamp { 0 };
+};
+
+/**
+ * StatsVersionRaw: Raw structure sent by the local controller to a data plane stage, at handshake
+ * time, with the version of the per-channel statistics records it understands
+ * (STAGE_STATS_VERSION). Stages that report these records answer with AckCode::ok, and are asked
+ * for COLLECT_CHANNEL_STATS; stages of the previous version answer with AckCode::error, and are
+ * asked for COLLECT_GLOBAL_STATS.
+ * - m_version: defines the version of the records (stats_channel_version);
+ * - m_record_size: defines the size of each record (StatsChannelRaw).
+ */
+struct StatsVersionRaw {
+    uint32_t m_version { stats_channel_version };
+    uint32_t m_record_size { sizeof (StatsChannelRaw) };
+};
+
+/**
+ * stats_max_record_size: defines the maximum size of each record of StatsChannelHeaderRaw (newer
+ * versions may append fields to StatsChannelRaw, up to this size).
+ */
+const uint32_t stats_max_record_size = 4 * sizeof (StatsChannelRaw);
+
+/**
+ * shared_segment_name_max_size: defines the maximum size of the name of the shared-memory segments
+ * of the local controller (statistics segment and enforcement table).
+ */
+const int shared_segment_name_max_size = 64;
+
+/**
+ * SharedSegmentHeaderRaw: Raw structure at the beginning of the shared-memory segments of the local
+ * controller, followed by one slot per data plane stage.
+ * - m_version: defines the version of the segment layout (e.g., stats_segment_version);
+ * - m_slot_size: defines the size of each slot;
+ * - m_slots: defines the number of slots that follow the header.
+ */
+struct alignas (64) SharedSegmentHeaderRaw {
+    uint32_t m_version { 0 };
+    uint32_t m_slot_size { 0 };
+    int m_slots { 0 };
+};
+
+/**
+ * SharedSegmentRaw: Raw structure sent by the local controller to a data plane stage so that it
+ * uses a slot of one of the shared-memory segments of the node (STAGE_STATS_SEGMENT or
+ * STAGE_ENF_TABLE). Stages that do not support the segment answer with AckCode::error, and keep
+ * using their socket.
+ * - m_name: defines the name of the segment (shm_open);
+ * - m_version: defines the version of the segment layout (e.g., stats_segment_version);
+ * - m_slot: defines the slot of the segment assigned to the stage.
+ */
+struct SharedSegmentRaw {
+    char m_name[shared_segment_name_max_size] {};
+    uint32_t m_version { 0 };
+    int m_slot { -1 };
+};
+
+/**
+ * stats_segment_version: defines the version of the layout of the shared-memory statistics segment
+ * (StatsSegmentSlotRaw) understood by the control plane.
+ */
+const uint32_t stats_segment_version = 1;
+
+/**
+ * StatsSegmentSlotRaw: Raw structure where a data plane stage publishes the statistics of its
+ * channels, under a seqlock: the stage makes m_sequence odd before writing the records and even
+ * again after, so readers retry the reads that overlap a write.
+ * - m_sequence: defines the sequence of the seqlock (0 if the stage never published);
+ * - m_channels: defines the number of valid records;
+ * - m_channel_stats: defines the statistics of each channel (same records as
+ * COLLECT_CHANNEL_STATS).
+ */
+struct alignas (64) StatsSegmentSlotRaw {
+    std::atomic<uint64_t> m_sequence { 0 };
+    int m_channels { 0 };
+    StatsChannelRaw m_channel_stats[stats_max_channels] {};
+};
+
+/**
+ * enforcement_table_version: defines the version of the layout of the shared-memory enforcement
+ * table (EnforcementTableSlotRaw) understood by the control plane.
+ */
+const uint32_t enforcement_table_version = 1;
+
+/**
+ * enforcement_table_max_rules: defines the maximum number of enforcement objects of a data plane
+ * stage whose rates are set through the enforcement table.
+ */
+const int enforcement_table_max_rules = 64;
+
+/**
+ * EnforcementEntryRaw: Raw structure that holds the latest enforcement rule of an enforcement
+ * object, written by the local controller under a seqlock: m_generation is odd while the rule is
+ * written, and grows by two with each rule. The data plane stage applies the entries whose
+ * generation changed since it last read them (e.g., at the next refill of its token buckets).
+ * - m_generation: defines the generation of the rule (0 if the entry is unused);
+ * - m_rule: defines the enforcement rule.
+ */
+struct alignas (64) EnforcementEntryRaw {
+    std::atomic<uint64_t> m_generation { 0 };
+    EnforcementRuleRaw m_rule {};
+};
+
+/**
+ * EnforcementTableSlotRaw: Raw structure that holds the enforcement rules of a data plane stage.
+ * - m_entries: defines the entry of each enforcement object (assigned by the local controller).
+ */
+struct EnforcementTableSlotRaw {
+    EnforcementEntryRaw m_entries[enforcement_table_max_rules] {};
+};
+
+static_assert (std::atomic<uint64_t>::is_always_lock_free,
+    "the sequences of the shared-memory segments are shared across processes");
+
 } // namespace cheferd
 
 #endif // CHEFERD_INTERFACE_DEFINITIONS_HPP
@@ -5,8 +5,6 @@
 #ifndef CHEFERD_LOCAL_CONNECTION_MANAGER_HPP
 #define CHEFERD_LOCAL_CONNECTION_MANAGER_HPP
 
-#include <asio/post.hpp>
-#include <asio/thread_pool.hpp>
 #include <cheferd/controller/core_control_application.hpp>
 #include <cheferd/controller/local_control_application.hpp>
 #include <cheferd/networking/connection_manager.hpp>
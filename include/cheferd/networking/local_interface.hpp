@@ -8,11 +8,15 @@
 #include "cheferd/networking/stage_response/stage_response_stat.hpp"
 #include "cheferd/networking/stage_response/stage_response_stats.hpp"
 
+#include <cheferd/networking/local_interface_poller.hpp>
 #include <cheferd/networking/southbound_interface.hpp>
 #include <cheferd/utils/logging.hpp>
+#include <cheferd/utils/metrics.hpp>
 #include <cstdio>
+#include <functional>
 #include <grpc/support/log.h>
 #include <grpcpp/grpcpp.h>
+#include <mutex>
 #include <netinet/in.h>
 #include <random>
 #include <sstream>
@@ -33,6 +37,7 @@ using controllers_grpc_interface::EnforcementRules;
 using controllers_grpc_interface::StageInfoConnect;
 using controllers_grpc_interface::StageReadyRaw;
 using controllers_grpc_interface::StatsGlobalMap;
+using controllers_grpc_interface::StatsStreamRequest;
 using grpc::Server;
 using grpc::ServerBuilder;
 using grpc::ServerContext;
@@ -48,31 +53,88 @@ using grpc::ClientContext;
 
 namespace cheferd {
 
+// Callbacks of asynchronous calls.
+using StatsCallback = std::function<void (PStatus,
+    std::unique_ptr<std::unordered_map<std::string, std::unique_ptr<StageResponse>>>&)>;
+using ACKCallback = std::function<void (PStatus, const ACK&)>;
+using StatsStreamCallback = std::function<void (const StatsGlobalMap&)>;
+
 /**
- * PAIOInterface class.
- * Interface to communication with a local controller
+ * LocalInterface class.
+ * Interface to communication with a local controller. Calls are either synchronous, or
+ * asynchronous (async_* calls) when a LocalInterfacePoller is provided; the latter are completed
+ * by the poller threads, which invoke the given callback.
+ * Currently, the LocalInterface class contains the following variables:
+ * - stub_: stub used to communicate with the local controller.
+ * - poller_: poller of the completion queue used by asynchronous calls (nullptr if synchronous).
+ * - in_flight_call_: asynchronous call currently in flight, if any.
+ * - in_flight_call_lock_: mutex for concurrency control over in_flight_call_.
+ * - stream_context_: context of the statistics stream currently open, if any.
+ * - stream_cancelled_: marks if the statistics stream was cancelled (no new streams are opened).
+ * - stream_lock_: mutex for concurrency control over stream_context_ and stream_cancelled_.
+ * - rpc_latency_metric_: latency of the unary calls to the local controller.
  */
 class LocalInterface {
 
 private:
     /**
-     * parse_rule: Parse a rule into tokens using char c as delimiter.
-     * @param rule Rule to be parsed.
-     * @param tokens Container to store parsed tokens.
-     * @param c Delimiter.
+     * fill_housekeeping_rules_grpc: Fill LocalSimplifiedHandshakeRaw with housekeeping rules.
+     * @param housekeeping_rules LocalSimplifiedHandshakeRaw object to be filled.
+     * @param rules Housekeeping rules.
      */
-    void parse_rule (const std::string& rule, std::vector<std::string>* tokens, char c);
+    static void fill_housekeeping_rules_grpc (
+        controllers_grpc_interface::LocalSimplifiedHandshakeRaw* housekeeping_rules,
+        const std::vector<std::string>& rules);
 
     /**
-     * fill_create_channel_rule: Fill LocalSimplifiedHandshakeRaw with rule data.
-     * @param housekeeping_rules LocalSimplifiedHandshakeRaw object to be filled.
-     * @param rule Data to fill object.
+     * fill_enforcement_rules_grpc: Fill EnforcementRules with the rules of each job.
+     * @param enforcement_rules EnforcementRules object to be filled.
+     * @param rules Enforcement rules of each job.
      */
-    void fill_housekeeping_rules_grpc (
-        controllers_grpc_interface::LocalSimplifiedHandshakeRaw* housekeeping_rules,
-        const std::string& rule);
+    static void fill_enforcement_rules_grpc (
+        controllers_grpc_interface::EnforcementRules* enforcement_rules,
+        const std::vector<JobEnforcementRule>& rules);
+
+    /**
+     * fill_stage_ready_grpc: Fill StageReadyRaw with the stage identifier.
+     * @param stage_ready_raw StageReadyRaw object to be filled.
+     * @param stage_name_env Data plane stage identifier ("name+env").
+     */
+    static void fill_stage_ready_grpc (controllers_grpc_interface::StageReadyRaw* stage_ready_raw,
+        const std::string& stage_name_env);
+
+    /**
+     * handle_ack_reply: Validate the ACK reply of the local controller.
+     * @param call_name Name of the call (for logging).
+     * @param status Status of the call.
+     * @param reply Reply of the local controller.
+     * @param response Response obtained.
+     * @return PStatus value that defines if the operation was successful.
+     */
+    static PStatus handle_ack_reply (const std::string& call_name,
+        const Status& status,
+        const controllers_grpc_interface::ACK& reply,
+        ACK& response);
+
+    /**
+     * start_async_call: Submits an asynchronous unary call to the shared completion queue.
+     * @param prepare Prepares the call over the stub.
+     * @param request Request to be sent.
+     * @param on_complete Callback invoked once the call finishes.
+     */
+    template <typename Reply, typename Request, typename Prepare>
+    void start_async_call (Prepare prepare,
+        const Request& request,
+        std::function<void (const Status&, const Reply&)> on_complete);
 
     std::unique_ptr<GlobalToLocal::Stub> stub_;
+    LocalInterfacePoller* poller_;
+    LocalAsyncCall* in_flight_call_;
+    std::mutex in_flight_call_lock_;
+    ClientContext* stream_context_;
+    bool stream_cancelled_;
+    std::mutex stream_lock_;
+    Histogram& rpc_latency_metric_;
 
 public:
     /**
@@ -80,6 +142,13 @@ public:
      */
     explicit LocalInterface (const std::string& user_address);
 
+    /**
+     * LocalInterface parameterized constructor.
+     * @param user_address Corresponds to the local controller address.
+     * @param poller Poller of the completion queue used by asynchronous calls.
+     */
+    LocalInterface (const std::string& user_address, LocalInterfacePoller* poller);
+
     /**
      * LocalInterface default destructor.
      */
@@ -90,13 +159,13 @@ public:
      * of the housekeeping rules that should be imposed at the data plane stages.
      * @param user_address Corresponds to the local controller address.
      * @param operation ControlOperation.
-     * @param rule Housekeeping rules.
+     * @param rules Housekeeping rules.
      * @param response Response obtained.
      * @return PStatus value that defines if the operation was successful.
      */
     PStatus local_handshake (const std::string& user_address,
         ControlOperation* operation,
-        const std::string& rule,
+        const std::vector<std::string>& rules,
         ACK& response);
 
     /**
@@ -116,13 +185,13 @@ public:
      * mark_stage_ready: Mark data plane stage as ready.
      * @param user_address Corresponds to the local controller address.
      * @param operation ControlOperation.
-     * @param rule Rule to mark stage as ready.
+     * @param stage_name_env Identifier ("name+env") of the stage to mark as ready.
      * @param response Response obtained.
      * @return PStatus value that defines if the operation was successful.
      */
     PStatus mark_stage_ready (const std::string& user_address,
         ControlOperation* operation,
-        const std::string& rule,
+        const std::string& stage_name_env,
         ACK& response);
 
     /**
@@ -130,13 +199,13 @@ public:
      * data plane stages.
      * @param user_address  Corresponds to the local controller address.
      * @param operation  ControlOperation.
-     * @param rule Enforcement rules.
+     * @param rules Enforcement rules of each job.
      * @param response Response obtained.
      * @return PStatus value that defines if the operation was successful.
      */
     PStatus create_enforcement_rule (const std::string& user_address,
         ControlOperation* operation,
-        const std::string& rule,
+        const std::vector<JobEnforcementRule>& rules,
         ACK& response);
 
     /**
@@ -155,11 +224,92 @@ public:
      * collect_global_statistics_aggregated: Collect aggregated statistics from data plane stages.
      * @param user_address Corresponds to the local controller address.
      * @param operation ControlOperation.
+     * @param window Window (in microseconds) over which statistics are aggregated (0 for the
+     * local controller's default).
+     * @param max_samples Maximum number of (most recent) samples per stage (0 for no limit).
      * @param stats_tf_objects Container to store responses.
      * @return  PStatus value that defines if the operation was successful.
      */
     PStatus collect_global_statistics_aggregated (const std::string& user_address,
         ControlOperation* operation,
+        uint64_t window,
+        int max_samples,
+        std::unique_ptr<std::unordered_map<std::string, std::unique_ptr<StageResponse>>>&
+            stats_tf_objects);
+
+    /**
+     * is_async: Verifies if the interface submits asynchronous calls.
+     * @return Returns true if a LocalInterfacePoller was provided, false otherwise.
+     */
+    bool is_async () const;
+
+    /**
+     * async_local_handshake: Asynchronous version of local_handshake.
+     * @param rules Housekeeping rules.
+     * @param on_complete Callback invoked with the response obtained.
+     */
+    void async_local_handshake (const std::vector<std::string>& rules, ACKCallback on_complete);
+
+    /**
+     * async_mark_stage_ready: Asynchronous version of mark_stage_ready.
+     * @param stage_name_env Identifier ("name+env") of the stage to mark as ready.
+     * @param on_complete Callback invoked with the response obtained.
+     */
+    void async_mark_stage_ready (const std::string& stage_name_env, ACKCallback on_complete);
+
+    /**
+     * async_create_enforcement_rule: Asynchronous version of create_enforcement_rule.
+     * @param rules Enforcement rules of each job.
+     * @param on_complete Callback invoked with the response obtained.
+     */
+    void async_create_enforcement_rule (const std::vector<JobEnforcementRule>& rules,
+        ACKCallback on_complete);
+
+    /**
+     * async_collect_global_statistics: Asynchronous version of collect_global_statistics and
+     * collect_global_statistics_aggregated (selected by the operation's subtype).
+     * @param operation ControlOperation.
+     * @param window Window (in microseconds) of aggregated statistics.
+     * @param max_samples Maximum number of samples per stage of aggregated statistics.
+     * @param on_complete Callback invoked with the statistics collected.
+     */
+    void async_collect_global_statistics (ControlOperation* operation,
+        uint64_t window,
+        int max_samples,
+        StatsCallback on_complete);
+
+    /**
+     * stream_global_statistics: Opens a long-lived stream through which the local controller
+     * pushes the statistics of its data plane stages at the given period. Blocks until the stream
+     * is closed or cancelled.
+     * @param period Period (in microseconds) between statistics pushes.
+     * @param on_stats Callback invoked for each set of statistics received.
+     * @return PStatus value that defines if the stream was closed gracefully.
+     */
+    PStatus stream_global_statistics (uint64_t period, const StatsStreamCallback& on_stats);
+
+    /**
+     * cancel_statistics_stream: Cancels the statistics stream, and prevents new streams from
+     * being opened.
+     */
+    void cancel_statistics_stream ();
+
+    /**
+     * cancel_async_call: Cancels the asynchronous call in flight, if any. The call is still
+     * completed (with an error status) by the poller.
+     */
+    void cancel_async_call ();
+
+    /**
+     * fill_global_statistics: Convert the statistics reply of the local controller (also used for
+     * the statistics pushed through the stream, so both are converted alike).
+     * @param reply Reply of the local controller.
+     * @param response_type Type of the responses (COLLECT_GLOBAL_STATS or
+     * COLLECT_GLOBAL_STATS_AGGREGATED).
+     * @param stats_tf_objects Container to store responses.
+     */
+    static void fill_global_statistics (const controllers_grpc_interface::StatsGlobalMap& reply,
+        int response_type,
         std::unique_ptr<std::unordered_map<std::string, std::unique_ptr<StageResponse>>>&
             stats_tf_objects);
 };
@@ -0,0 +1,102 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_LOCAL_INTERFACE_POLLER_HPP
+#define CHEFERD_LOCAL_INTERFACE_POLLER_HPP
+
+#include <cheferd/utils/logging.hpp>
+#include <functional>
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/impl/codegen/async_unary_call.h>
+#include <thread>
+#include <vector>
+
+namespace cheferd {
+
+/**
+ * LocalAsyncCall struct.
+ * Base of the asynchronous calls submitted to local controllers. Each call is used as the tag of
+ * the completion queue, and is deleted by the poller thread after being completed.
+ * - m_context: context of the call.
+ * - m_status: status of the call, filled once the call finishes.
+ */
+struct LocalAsyncCall {
+    grpc::ClientContext m_context;
+    grpc::Status m_status;
+
+    virtual ~LocalAsyncCall () = default;
+
+    /**
+     * complete: Handles the completion of the call.
+     * @param ok Defines if the completion queue successfully finished the call.
+     */
+    virtual void complete (bool ok) = 0;
+};
+
+/**
+ * LocalAsyncUnaryCall struct.
+ * Asynchronous unary call submitted to a local controller.
+ * - m_reply: reply of the local controller.
+ * - m_reader: response reader of the call.
+ * - m_on_complete: callback invoked (at a poller thread) once the call finishes.
+ */
+template <typename Reply>
+struct LocalAsyncUnaryCall : public LocalAsyncCall {
+    Reply m_reply;
+    std::unique_ptr<grpc::ClientAsyncResponseReader<Reply>> m_reader;
+    std::function<void (const grpc::Status&, const Reply&)> m_on_complete;
+
+    void complete (bool ok) override
+    {
+        if (!ok) {
+            m_status = grpc::Status (grpc::StatusCode::CANCELLED, "completion queue shutdown");
+        }
+
+        m_on_complete (m_status, m_reply);
+    }
+};
+
+/**
+ * LocalInterfacePoller class.
+ * The LocalInterfacePoller holds the completion queue shared by the asynchronous LocalInterfaces
+ * of the core controller, and a fixed pool of threads that poll it and complete the calls. This
+ * way, all core to local controller calls are multiplexed over a small number of threads instead
+ * of one blocking thread per LocalControllerSession.
+ * Currently, the LocalInterfacePoller class contains the following variables:
+ * - completion_queue_: completion queue shared by all asynchronous calls.
+ * - pollers_: threads that poll the completion queue.
+ */
+class LocalInterfacePoller {
+
+private:
+    grpc::CompletionQueue completion_queue_;
+    std::vector<std::thread> pollers_;
+
+    /**
+     * poll: Polls the completion queue and completes finished calls until shutdown.
+     */
+    void poll ();
+
+public:
+    /**
+     * LocalInterfacePoller parameterized constructor.
+     * @param pollers Number of threads polling the completion queue.
+     */
+    explicit LocalInterfacePoller (int pollers);
+
+    /**
+     * LocalInterfacePoller default destructor. Shuts down the completion queue and waits for the
+     * poller threads to exit.
+     */
+    ~LocalInterfacePoller ();
+
+    /**
+     * completion_queue: Get the shared completion queue.
+     * @return Pointer to the completion queue.
+     */
+    grpc::CompletionQueue* completion_queue ();
+};
+} // namespace cheferd
+
+#endif // CHEFERD_LOCAL_INTERFACE_POLLER_HPP
@@ -0,0 +1,75 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_METRICS_SERVER_HPP
+#define CHEFERD_METRICS_SERVER_HPP
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace cheferd {
+
+/**
+ * MetricsServer class.
+ * Minimal HTTP listener that serves the Metrics registry in Prometheus text format (GET /metrics),
+ * from a background thread. Each connection is served and closed, so scrapes do not contend with
+ * the control loop beyond reading the metrics; a connection that does not send its request (or
+ * read its response) within METRICS_CONNECTION_TIMEOUT is closed, so it cannot stall the server or
+ * stop ().
+ * Currently, the MetricsServer class contains the following variables:
+ * - address_: IPv4 address to listen on.
+ * - port_: TCP port to listen on.
+ * - server_fd_: listening socket file descriptor (-1 if not listening).
+ * - working_server_: atomic bool that stores if the server is active.
+ * - server_thread_: thread that accepts and serves connections.
+ */
+class MetricsServer {
+
+private:
+    std::string address_;
+    int port_;
+    int server_fd_;
+    std::atomic<bool> working_server_;
+    std::thread server_thread_;
+
+    /**
+     * serve: Accepts and serves connections until the server is stopped.
+     */
+    void serve ();
+
+    /**
+     * handle_connection: Reads an HTTP request and writes its response (400 if its request line
+     * is not complete within the size limit of requests, or before the connection ends).
+     * @param socket Connection socket.
+     */
+    static void handle_connection (int socket);
+
+public:
+    /**
+     * MetricsServer parameterized constructor.
+     * @param address IPv4 address to listen on.
+     * @param port TCP port to listen on.
+     */
+    MetricsServer (const std::string& address, int port);
+
+    /**
+     * MetricsServer default destructor. Stops the server.
+     */
+    ~MetricsServer ();
+
+    /**
+     * start: Starts listening and serving connections in the background.
+     * @return Returns true if the server is listening.
+     */
+    bool start ();
+
+    /**
+     * stop: Stops serving connections.
+     */
+    void stop ();
+};
+} // namespace cheferd
+
+#endif // CHEFERD_METRICS_SERVER_HPP
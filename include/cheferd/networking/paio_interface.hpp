@@ -12,49 +12,90 @@
 #include <random>
 #include <signal.h>
 #include <sstream>
+#include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
+#include <vector>
 
 namespace cheferd {
 
 /**
  * PAIOInterface class.
- * Interface to communication with a PAIO data plane stage.
+ * Interface to communication with a PAIO data plane stage. Each control message (ControlOperation
+ * followed by its payload) is sent with a single writev, and responses are read in full, retrying
+ * on short reads and EINTR. Over SOCK_SEQPACKET sockets, each message is a single record.
+ * Currently, the PAIOInterface class contains the following variables:
+ * - seqpacket_: defines if the sockets are SOCK_SEQPACKET (true) or SOCK_STREAM (false).
  */
 class PAIOInterface : public SouthboundInterface {
 
 private:
+    bool seqpacket_;
+
+    /**
+     * write_vectored: Writes every buffer to the socket, retrying on short writes and EINTR.
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param iov Buffers to be written (updated as they are written).
+     * @param iovcnt Number of buffers.
+     * @return Number of bytes written, or -1 on error.
+     */
+    static ssize_t write_vectored (int socket, struct iovec* iov, int iovcnt);
+
     /**
-     * parse_rule: Parses a rule into tokens.
-     * @param rule Rule to be parsed.
-     * @param tokens Container to store parsed tokens.
+     * write_message: Writes a control message to the data plane stage with a single writev.
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param operation ControlOperation object (nullptr for messages without header).
+     * @param payload Payload of the message.
+     * @param payload_size Size of the payload (0 for messages without payload).
+     * @return Number of bytes written, or -1 on error.
      */
-    void parse_rule (const std::string& rule, std::vector<std::string>* tokens);
+    ssize_t write_message (int socket,
+        const ControlOperation* operation,
+        const void* payload,
+        std::size_t payload_size) const;
 
     /**
-     * fill_create_channel_rule: Fill HousekeepingCreateChannelRaw with tokens data.
-     * @param hsk_channel_obj HousekeepingCreateChannelRaw object to be filled.
-     * @param tokens Data to fill object.
+     * read_vectored: Fills every buffer from the socket, retrying on short reads and EINTR. With
+     * SOCK_SEQPACKET, reads a single record instead (larger records are an error).
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param iov Buffers to be filled (updated as they are filled).
+     * @param iovcnt Number of buffers.
+     * @return Number of bytes read (less than requested if the connection was closed), or -1 on
+     * error.
      */
-    void fill_create_channel_rule (HousekeepingCreateChannelRaw* hsk_channel_obj,
-        const std::vector<std::string>& tokens);
+    ssize_t read_vectored (int socket, struct iovec* iov, int iovcnt) const;
 
     /**
-     * fill_create_object_rule: Fill HousekeepingCreateObjectRaw with tokens data.
-     * @param hsk_object_obj HousekeepingCreateObjectRaw object to be filled.
-     * @param tokens Data to fill object.
+     * read_exact: Reads exactly size bytes from the socket (see read_vectored).
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param buffer Buffer to be filled.
+     * @param size Number of bytes to read.
+     * @return Number of bytes read, or -1 on error.
      */
-    void fill_create_object_rule (HousekeepingCreateObjectRaw* hsk_object_obj,
-        const std::vector<std::string>& tokens);
+    ssize_t read_exact (int socket, void* buffer, std::size_t size) const;
 
     /**
-     * fill_enforcement_rule: Fill EnforcementRuleRaw with tokens data.
-     * @param enf_object EnforcementRuleRaw object to be filled.
-     * @param tokens Data to fill object.
+     * send_housekeeping_rule: Writes a housekeeping rule to the data plane stage and reads its
+     * ACK.
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param operation ControlOperation object that contains the type of rule that will
+     * be sent, its size, and the id.
+     * @param rule Housekeeping rule (HousekeepingCreateChannelRaw or HousekeepingCreateObjectRaw)
+     * of operation->m_size bytes.
+     * @param response Response obtained.
+     * @return PStatus::OK() if the rule was successfully created, PStatus::Error() otherwise.
      */
-    void fill_enforcement_rule (EnforcementRuleRaw* enf_object,
-        const std::vector<std::string>& tokens);
+    PStatus send_housekeeping_rule (int socket,
+        ControlOperation* operation,
+        const void* rule,
+        ACK& response);
 
 public:
     /**
@@ -62,11 +103,92 @@ public:
      */
     PAIOInterface ();
 
+    /**
+     * PAIOInterface parameterized constructor.
+     * @param seqpacket Defines if the sockets are SOCK_SEQPACKET (true) or SOCK_STREAM (false).
+     */
+    explicit PAIOInterface (bool seqpacket);
+
     /**
      * PAIOInterface default destructor.
      */
     ~PAIOInterface ();
 
+    /**
+     * send_operation: Sends a control operation and its payload to the data plane stage, as a
+     * single message. The response is read separately (receive_* calls), so that several
+     * operations may be in flight through the same socket.
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param operation ControlOperation object that contains the type of rule that will
+     * be sent, its size, and the id.
+     * @param payload Payload of the operation (nullptr if none).
+     * @param payload_size Size of the payload.
+     * @return PStatus::OK() if the operation was successfully sent, PStatus::Error() otherwise.
+     */
+    PStatus send_operation (int socket,
+        const ControlOperation& operation,
+        const void* payload,
+        std::size_t payload_size);
+
+    /**
+     * receive_stage_handshake: Reads the response to a STAGE_HANDSHAKE operation.
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param stage_handshake_obj StageSimplifiedHandshakeRaw object to store the data plane
+     * stage detailed information.
+     * @return PStatus::OK() if the response was successfully read, PStatus::Error() otherwise.
+     */
+    PStatus receive_stage_handshake (int socket, StageSimplifiedHandshakeRaw& stage_handshake_obj);
+
+    /**
+     * receive_ack: Reads the ACK of an operation (e.g., STAGE_READY, CREATE_HSK_RULE,
+     * CREATE_ENF_RULE).
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param response Response obtained.
+     * @return PStatus::OK() if the operation was acknowledged, PStatus::Error() otherwise.
+     */
+    PStatus receive_ack (int socket, ACK& response);
+
+    /**
+     * receive_global_statistics: Reads the response to a COLLECT_GLOBAL_STATS operation.
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param stats_tf_object StatsGlobalRaw object to store the statistics.
+     * @return PStatus::OK() if the response was successfully read, PStatus::Error() otherwise.
+     */
+    PStatus receive_global_statistics (int socket, StatsGlobalRaw& stats_tf_object);
+
+    /**
+     * receive_channel_statistics: Reads the response to a COLLECT_CHANNEL_STATS operation (a
+     * StatsChannelHeaderRaw followed by one record per channel).
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param channel_stats Container to store the statistics of each channel.
+     * @return PStatus::OK() if the response was successfully read, PStatus::Error() otherwise.
+     */
+    PStatus receive_channel_statistics (int socket, std::vector<StatsChannelRaw>& channel_stats);
+
+    /**
+     * valid_channel_header: Validates the StatsChannelHeaderRaw sent by a data plane stage (its
+     * version, its record size, up to stats_max_record_size, and its number of channels).
+     * @param header StatsChannelHeaderRaw object.
+     * @return Returns true if the header is valid, false otherwise.
+     */
+    static bool valid_channel_header (const StatsChannelHeaderRaw& header);
+
+    /**
+     * parse_channel_statistics: Converts the records sent by a data plane stage (of
+     * header.m_record_size bytes each) into StatsChannelRaw structures.
+     * @param header StatsChannelHeaderRaw object that precedes the records.
+     * @param records Records sent by the data plane stage.
+     * @param channel_stats Container to store the statistics of each channel.
+     */
+    static void parse_channel_statistics (const StatsChannelHeaderRaw& header,
+        const char* records,
+        std::vector<StatsChannelRaw>& channel_stats);
+
     /**
      * stage_handshake: Handshake a data plane stage.
      * Submit a handshake request to collect data about the data plane stage.
@@ -87,15 +209,18 @@ public:
      * stage_handshake_address: Informs a data plane stage about the new socket to connect to.
      * @param socket Corresponds to the open file descriptor/socket of a
      * specific controller-data plane communication.
-     * @param rule New socket to connect to.
+     * @param handshake_object StageHandshakeRaw object with the new socket to connect to.
      * @param response Response obtained.
      * @return PStatus::OK() if the rule was successfully dequeued,
      * * PStatus::Error() otherwise.
      */
-    PStatus stage_handshake_address (int socket, const std::string& rule, ACK& response);
+    PStatus stage_handshake_address (int socket,
+        const StageHandshakeRaw& handshake_object,
+        ACK& response);
 
     /**
-     * create_housekeeping_rule: Creates a housekeeping rule at the data plane stage.
+     * create_housekeeping_rule: Creates a housekeeping rule (create_channel) at the data plane
+     * stage.
      * @param socket Corresponds to the open file descriptor/socket of a
      * specific controller-data plane communication.
      * @param operation ControlOperation object that contains the type of rule that will
@@ -107,7 +232,24 @@ public:
      */
     PStatus create_housekeeping_rule (int socket,
         ControlOperation* operation,
-        const std::string& rule,
+        const HousekeepingCreateChannelRaw& rule,
+        ACK& response) override;
+
+    /**
+     * create_housekeeping_rule: Creates a housekeeping rule (create_object) at the data plane
+     * stage.
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param operation ControlOperation object that contains the type of rule that will
+     * be sent, its size, and the id..
+     * @param rule Housekeeping rule to be created.
+     * @param response Response obtained.
+     * @return PStatus::OK() if the rule was successfully dequeued,
+     * * PStatus::Error() otherwise.
+     */
+    PStatus create_housekeeping_rule (int socket,
+        ControlOperation* operation,
+        const HousekeepingCreateObjectRaw& rule,
         ACK& response) override;
 
     /**
@@ -140,7 +282,7 @@ public:
      */
     PStatus create_enforcement_rule (int socket,
         ControlOperation* operation,
-        const std::string& rule,
+        const EnforcementRuleRaw& rule,
         ACK& response) override;
 
     /**
@@ -176,6 +318,20 @@ public:
     PStatus collect_global_statistics (int socket,
         ControlOperation* operation,
         StatsGlobalRaw& stats_tf_object);
+
+    /**
+     * collect_channel_statistics: Get the statistics of each channel of a current data plane
+     * stage. The stage replies with a StatsChannelHeaderRaw followed by one record per channel.
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param operation ControlOperation object that contains the type of rule that will
+     * be sent, its size, and the id.
+     * @param channel_stats Container to store the statistics of each channel.
+     * @return PStatus value that defines if the operation was successful.
+     */
+    PStatus collect_channel_statistics (int socket,
+        ControlOperation* operation,
+        std::vector<StatsChannelRaw>& channel_stats);
 };
 } // namespace cheferd
 
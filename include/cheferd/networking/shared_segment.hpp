@@ -0,0 +1,137 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_SHARED_SEGMENT_HPP
+#define CHEFERD_SHARED_SEGMENT_HPP
+
+#include <cheferd/networking/interface_definitions.hpp>
+#include <cheferd/utils/logging.hpp>
+#include <cheferd/utils/status.hpp>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cheferd {
+
+/**
+ * SharedSegment class.
+ * Shared-memory segment (shm_open) shared by the local controller and the data plane stages of a
+ * node, made of a header (SharedSegmentHeaderRaw) and one slot per data plane stage. The segment
+ * is created by the local controller, which assigns the slots, and attached by the data plane
+ * stages. Derived classes define the layout of the slots and how they are written and read
+ * (e.g., StatsSegment and EnforcementTable).
+ * Currently, the SharedSegment class contains the following variables:
+ * - name_: name of the segment.
+ * - owner_: bool that stores if the segment was created (and is unlinked) by this object.
+ * - size_: size of the mapping.
+ * - header_: header of the segment (nullptr if not mapped).
+ * - slots_: first slot of the segment.
+ * - slots_lock_: mutex for concurrency control over used_slots_.
+ * - used_slots_: slots assigned to data plane stages.
+ */
+class SharedSegment {
+
+private:
+    std::string name_;
+    bool owner_;
+    std::size_t size_;
+    SharedSegmentHeaderRaw* header_;
+    char* slots_;
+    std::mutex slots_lock_;
+    std::vector<bool> used_slots_;
+
+    /**
+     * map: Maps the segment into memory.
+     * @param fd File descriptor of the segment (closed after the mapping).
+     * @param size Size of the segment.
+     * @return Returns PStatus::OK if successful, PStatus::Error otherwise.
+     */
+    PStatus map (int fd, std::size_t size);
+
+    /**
+     * unmap: Unmaps the segment (if mapped).
+     */
+    void unmap ();
+
+protected:
+    /**
+     * SharedSegment default constructor.
+     */
+    SharedSegment ();
+
+    /**
+     * SharedSegment default destructor. Unmaps the segment, and unlinks it if created by this
+     * object.
+     */
+    virtual ~SharedSegment ();
+
+    /**
+     * create: Creates the segment (local controller side).
+     * @param name Name of the segment.
+     * @param slots Number of slots.
+     * @param version Version of the layout of the slots.
+     * @param slot_size Size of each slot.
+     * @return Returns PStatus::OK if successful, PStatus::Error otherwise.
+     */
+    PStatus create (const std::string& name, int slots, uint32_t version, std::size_t slot_size);
+
+    /**
+     * attach: Attaches to a segment created by the local controller (data plane stage side).
+     * @param name Name of the segment.
+     * @param version Version of the layout of the slots understood by the caller.
+     * @param slot_size Size of each slot understood by the caller.
+     * @return Returns PStatus::OK if successful and its layout is supported, PStatus::Error
+     * otherwise.
+     */
+    PStatus attach (const std::string& name, uint32_t version, std::size_t slot_size);
+
+    /**
+     * slot_address: Gets the address of a slot.
+     * @param slot Slot.
+     * @return Address of the slot, or nullptr if the slot does not exist.
+     */
+    void* slot_address (int slot) const;
+
+    /**
+     * initialize_slot: Initializes a slot, when the segment is created and when the slot is
+     * released.
+     * @param slot Address of the slot.
+     */
+    virtual void initialize_slot (void* slot) = 0;
+
+public:
+    /**
+     * is_mapped: Checks if the segment is mapped.
+     * @return Returns true if the segment is mapped, false otherwise.
+     */
+    bool is_mapped () const;
+
+    /**
+     * name: Gets the name of the segment.
+     * @return Name of the segment.
+     */
+    const std::string& name () const;
+
+    /**
+     * slots: Gets the number of slots of the segment.
+     * @return Number of slots (0 if not mapped).
+     */
+    int slots () const;
+
+    /**
+     * acquire_slot: Assigns a free slot to a data plane stage.
+     * @return Slot, or -1 if the segment is not mapped or has no free slots.
+     */
+    int acquire_slot ();
+
+    /**
+     * release_slot: Frees (and initializes) the slot of a data plane stage, which no longer uses
+     * it.
+     * @param slot Slot.
+     */
+    void release_slot (int slot);
+};
+} // namespace cheferd
+
+#endif // CHEFERD_SHARED_SEGMENT_HPP
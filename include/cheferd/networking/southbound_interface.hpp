@@ -51,7 +51,8 @@ public:
         = 0;
 
     /**
-     * create_housekeeping_rule: Creates a housekeeping rule at the data plane stage.
+     * create_housekeeping_rule: Creates a housekeeping rule (create_channel) at the data plane
+     * stage.
      * @param socket Corresponds to the open file descriptor/socket of a
      * specific controller-data plane communication.
      * @param operation ControlOperation object that contains the type of rule that will
@@ -63,7 +64,25 @@ public:
      */
     virtual PStatus create_housekeeping_rule (int socket,
         ControlOperation* operation,
-        const std::string& rule,
+        const HousekeepingCreateChannelRaw& rule,
+        ACK& response)
+        = 0;
+
+    /**
+     * create_housekeeping_rule: Creates a housekeeping rule (create_object) at the data plane
+     * stage.
+     * @param socket Corresponds to the open file descriptor/socket of a
+     * specific controller-data plane communication.
+     * @param operation ControlOperation object that contains the type of rule that will
+     * be sent, its size, and the id..
+     * @param rule Housekeeping rule to be created.
+     * @param response Response obtained.
+     * @return PStatus::OK() if the rule was successfully dequeued,
+     * * PStatus::Error() otherwise.
+     */
+    virtual PStatus create_housekeeping_rule (int socket,
+        ControlOperation* operation,
+        const HousekeepingCreateObjectRaw& rule,
         ACK& response)
         = 0;
 
@@ -80,7 +99,7 @@ public:
      */
     virtual PStatus create_enforcement_rule (int socket,
         ControlOperation* operation,
-        const std::string& rule,
+        const EnforcementRuleRaw& rule,
         ACK& response)
         = 0;
 
@@ -0,0 +1,139 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_STAGE_REACTOR_HPP
+#define CHEFERD_STAGE_REACTOR_HPP
+
+#include <atomic>
+#include <cheferd/utils/logging.hpp>
+#include <cheferd/utils/status.hpp>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace cheferd {
+
+// Maximum number of events handled by each epoll_wait call of the StageReactor.
+#define STAGE_REACTOR_MAX_EVENTS 64
+
+/**
+ * StageReactorHandler class.
+ * Handler of the events of a socket registered at the StageReactor (e.g., a DataPlaneSession).
+ */
+class StageReactorHandler {
+
+public:
+    virtual ~StageReactorHandler () = default;
+
+    /**
+     * handle_readable: Handles a readable (or closed) socket, without blocking. It is executed by
+     * a thread of the reactor.
+     * @return Returns false if the socket must be deregistered (e.g., it was closed by the
+     * data plane stage), true otherwise.
+     */
+    virtual bool handle_readable () = 0;
+
+    /**
+     * handle_writable: Handles a writable socket (only while it was marked with set_writable),
+     * without blocking. It is executed by a thread of the reactor.
+     * @return Returns false if the socket must be deregistered, true otherwise.
+     */
+    virtual bool handle_writable () = 0;
+};
+
+/**
+ * StageReactor class.
+ * The StageReactor drives the sockets of the data plane stages of the local controller from a
+ * small pool of threads, instead of one blocking thread per stage. Sockets are sharded by file
+ * descriptor, and each shard has its own epoll instance and thread.
+ * Handlers are executed without holding the lock of their shard (so they may take their own locks,
+ * and mark their socket with set_writable, without ordering them after it), and remove waits for a
+ * handler being executed, so once it returns, the handler of the socket is no longer executed (and
+ * can be safely destroyed).
+ * Currently, the StageReactor class contains the following variables:
+ * - shards_: shards of the reactor.
+ * - working_reactor_: atomic bool that stores if the reactor is running.
+ */
+class StageReactor {
+
+private:
+    /**
+     * Shard struct.
+     * - m_epoll_fd: epoll instance of the shard.
+     * - m_wakeup_fd: eventfd used to wake up the thread of the shard (e.g., on shutdown).
+     * - m_lock: mutex for concurrency control over m_handlers and m_running.
+     * - m_handler_done: condition variable signaled when a handler finishes.
+     * - m_handlers: container used for mapping each socket to its handler.
+     * - m_running: socket whose handler is being executed (-1 if none).
+     * - m_thread: thread that waits for, and handles, the events of the shard.
+     */
+    struct Shard {
+        int m_epoll_fd { -1 };
+        int m_wakeup_fd { -1 };
+        std::mutex m_lock {};
+        std::condition_variable m_handler_done {};
+        std::unordered_map<int, StageReactorHandler*> m_handlers {};
+        int m_running { -1 };
+        std::thread m_thread {};
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> working_reactor_;
+
+    /**
+     * shard: Gets the shard of a socket.
+     * @param fd Socket (file descriptor).
+     * @return Shard of the socket.
+     */
+    Shard& shard (int fd);
+
+    /**
+     * run: Waits for, and handles, the events of a shard until the reactor is stopped.
+     * @param shard Shard to be handled.
+     */
+    void run (Shard* shard);
+
+public:
+    /**
+     * StageReactor parameterized constructor.
+     * @param threads Number of shards (and threads).
+     */
+    explicit StageReactor (int threads);
+
+    /**
+     * StageReactor default destructor. Stops the threads of the reactor and waits for them.
+     */
+    ~StageReactor ();
+
+    /**
+     * add: Registers a socket, whose handler is executed whenever it is readable.
+     * @param fd Socket (file descriptor).
+     * @param handler Handler of the socket.
+     * @return Returns PStatus::OK if successful, PStatus::Error otherwise.
+     */
+    PStatus add (int fd, StageReactorHandler* handler);
+
+    /**
+     * set_writable: Defines if the handler of a socket is also executed whenever it is writable
+     * (e.g., while it has bytes queued to be written).
+     * @param fd Socket (file descriptor).
+     * @param writable Defines if the socket's writability is handled.
+     * @return Returns PStatus::OK if successful, PStatus::Error otherwise (e.g., the socket is not
+     * registered).
+     */
+    PStatus set_writable (int fd, bool writable);
+
+    /**
+     * remove: Deregisters a socket (if registered), waiting for its handler to finish. Must not
+     * be called from a handler.
+     * @param fd Socket (file descriptor).
+     */
+    void remove (int fd);
+};
+} // namespace cheferd
+
+#endif // CHEFERD_STAGE_REACTOR_HPP
@@ -7,6 +7,9 @@
 
 #include "stage_response.hpp"
 
+#include <cheferd/networking/interface_definitions.hpp>
+#include <vector>
+
 namespace cheferd {
 
 
@@ -14,11 +17,18 @@ namespace cheferd {
  * StageResponseStat class.
  * StageResponseStat is used for responses that hold a single data plane stage statistic.
  * Currently, the StageResponseStat class contains the following variables:
- * - m_value: data plane stage total rate.
+ * - m_value: data plane stage total rate (mean rate over the window, if aggregated).
+ * - m_rate_variance: variance of the rate over the window (0 if not aggregated).
+ * - m_samples: number of samples that the rate summarizes.
+ * - m_channel_stats: statistics of each channel of the data plane stage (empty if the stage only
+ * reported its total rate).
  */
 class StageResponseStat : public StageResponse {
 private:
     double m_total_rate;
+    double m_rate_variance;
+    int m_samples;
+    std::vector<StatsChannelRaw> m_channel_stats;
 
 public:
     /**
@@ -33,6 +43,32 @@ public:
      */
     StageResponseStat (const int& response_type, const double& total_rate);
 
+    /**
+     * StageResponseStat parameterized constructor, for statistics aggregated over a window.
+     * @param response_type Type of response.
+     * @param total_rate Data plane stage mean rate over the window.
+     * @param rate_variance Variance of the rate over the window.
+     * @param samples Number of samples in the window.
+     */
+    StageResponseStat (const int& response_type,
+        const double& total_rate,
+        const double& rate_variance,
+        const int& samples);
+
+    /**
+     * StageResponseStat parameterized constructor, with the statistics of each channel.
+     * @param response_type Type of response.
+     * @param total_rate Data plane stage total rate (mean rate over the window, if aggregated).
+     * @param rate_variance Variance of the rate over the window.
+     * @param samples Number of samples in the window.
+     * @param channel_stats Statistics of each channel of the data plane stage.
+     */
+    StageResponseStat (const int& response_type,
+        const double& total_rate,
+        const double& rate_variance,
+        const int& samples,
+        std::vector<StatsChannelRaw> channel_stats);
+
     /**
      * StageResponseStat default destructor.
      */
@@ -50,6 +86,24 @@ public:
      */
     double get_total_rate () const;
 
+    /**
+     * get_rate_variance: Get the variance of the data plane stage rate.
+     * @return Variance of the rate over the window.
+     */
+    double get_rate_variance () const;
+
+    /**
+     * get_samples: Get the number of samples that the rate summarizes.
+     * @return Number of samples.
+     */
+    int get_samples () const;
+
+    /**
+     * get_channel_stats: Get the statistics of each channel of the data plane stage.
+     * @return Statistics of each channel (empty if not reported).
+     */
+    const std::vector<StatsChannelRaw>& get_channel_stats () const;
+
     /**
      * toString: Converts response to string.
      * @return Response in string format.
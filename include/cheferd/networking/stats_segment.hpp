@@ -0,0 +1,78 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_STATS_SEGMENT_HPP
+#define CHEFERD_STATS_SEGMENT_HPP
+
+#include <cheferd/networking/shared_segment.hpp>
+#include <vector>
+
+namespace cheferd {
+
+// Number of times a read of the statistics segment is retried while overlapping a write.
+#define STATS_SEGMENT_READ_RETRIES 64
+
+/**
+ * StatsSegment class.
+ * Shared-memory segment where the data plane stages of a node publish the statistics of their
+ * channels, so that the local controller reads them with plain memory loads instead of a request
+ * and a response through each stage's socket. Each slot has a single writer (its stage), and is
+ * read under a seqlock (StatsSegmentSlotRaw).
+ */
+class StatsSegment : public SharedSegment {
+
+protected:
+    /**
+     * initialize_slot: Initializes a slot (no statistics published).
+     * @param slot Address of the slot.
+     */
+    void initialize_slot (void* slot) override;
+
+public:
+    /**
+     * StatsSegment default constructor.
+     */
+    StatsSegment ();
+
+    /**
+     * StatsSegment default destructor.
+     */
+    ~StatsSegment () override;
+
+    /**
+     * create: Creates the segment (local controller side).
+     * @param name Name of the segment (e.g., "/cheferd_stats_<pid>").
+     * @param slots Number of slots.
+     * @return Returns PStatus::OK if successful, PStatus::Error otherwise.
+     */
+    PStatus create (const std::string& name, int slots);
+
+    /**
+     * attach: Attaches to a segment created by the local controller (data plane stage side).
+     * @param name Name of the segment.
+     * @return Returns PStatus::OK if successful and its layout is supported, PStatus::Error
+     * otherwise.
+     */
+    PStatus attach (const std::string& name);
+
+    /**
+     * publish: Publishes the statistics of the channels of a data plane stage (executed by the
+     * single writer of the slot).
+     * @param slot Slot of the data plane stage.
+     * @param channel_stats Statistics of each channel (at most stats_max_channels are published).
+     */
+    void publish (int slot, const std::vector<StatsChannelRaw>& channel_stats);
+
+    /**
+     * read: Reads the statistics published by a data plane stage, without system calls.
+     * @param slot Slot of the data plane stage.
+     * @param channel_stats Container to store the statistics of each channel.
+     * @return Returns PStatus::OK if successful, PStatus::Error if the stage never published, or
+     * every retry overlapped a write.
+     */
+    PStatus read (int slot, std::vector<StatsChannelRaw>& channel_stats) const;
+};
+} // namespace cheferd
+
+#endif // CHEFERD_STATS_SEGMENT_HPP
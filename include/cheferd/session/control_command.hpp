@@ -0,0 +1,68 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_CONTROL_COMMAND_HPP
+#define CHEFERD_CONTROL_COMMAND_HPP
+
+#include <cheferd/networking/interface_definitions.hpp>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace cheferd {
+
+/**
+ * StatisticsWindow: Structure that defines how a local controller aggregates the statistics of
+ * its data plane stages (COLLECT_GLOBAL_STATS_AGGREGATED).
+ * - m_window: defines the window (in microseconds) over which statistics are aggregated (0 for
+ * the local controller's default);
+ * - m_max_samples: defines the maximum number of (most recent) samples per stage (0 for no limit).
+ */
+struct StatisticsWindow {
+    uint64_t m_window { 0 };
+    int m_max_samples { 0 };
+};
+
+/**
+ * ControlCommand: Structure submitted to the sessions (LocalControllerSession, DataPlaneSession,
+ * and HandshakeSession). It carries the operation and its payload already in the format sent
+ * through the session's interface, so sessions dispatch on m_operation_type without parsing.
+ * - m_operation_type: defines the type of operation (e.g., STAGE_READY, CREATE_ENF_RULE); -1 for
+ * none (e.g., the command that wakes a session being removed);
+ * - m_operation_subtype: defines the subtype of the operation (e.g., COLLECT_GLOBAL_STATS,
+ * HSK_CREATE_CHANNEL);
+ * - m_payload: defines the payload of the operation, which depends on its type:
+ *  - LOCAL_HANDSHAKE: housekeeping rules (owned by the control application);
+ *  - STAGE_READY (core controller): stage identifier ("name+env");
+ *  - CREATE_ENF_RULE (core controller): enforcement rules of the local controller's jobs (the
+ *  batch is shared with the JobTable, which reuses it once the session releases it);
+ *  - COLLECT_DETAILED_STATS (COLLECT_GLOBAL_STATS_AGGREGATED): StatisticsWindow;
+ *  - CREATE_HSK_RULE: HousekeepingCreateChannelRaw or HousekeepingCreateObjectRaw;
+ *  - CREATE_ENF_RULE (local controller): EnforcementRuleRaw;
+ *  - STAGE_HANDSHAKE_INFO: StageHandshakeRaw;
+ *  - STAGE_STATS_SEGMENT and STAGE_ENF_TABLE: SharedSegmentRaw;
+ *  - STAGE_STATS_VERSION: StatsVersionRaw;
+ *  - remainder: none (std::monostate).
+ */
+struct ControlCommand {
+    int m_operation_type { -1 };
+    int m_operation_subtype { -1 };
+    std::variant<std::monostate,
+        const std::vector<std::string>*,
+        std::string,
+        std::shared_ptr<const std::vector<JobEnforcementRule>>,
+        StatisticsWindow,
+        HousekeepingCreateChannelRaw,
+        HousekeepingCreateObjectRaw,
+        EnforcementRuleRaw,
+        StageHandshakeRaw,
+        SharedSegmentRaw,
+        StatsVersionRaw>
+        m_payload {};
+};
+
+} // namespace cheferd
+
+#endif // CHEFERD_CONTROL_COMMAND_HPP
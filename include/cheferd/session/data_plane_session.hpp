@@ -11,50 +11,123 @@
 #include "cheferd/networking/stage_response/stage_response_stat.hpp"
 #include "cheferd/networking/stage_response/stage_response_stats.hpp"
 
+#include <cheferd/networking/channel_counters.hpp>
+#include <cheferd/networking/enforcement_table.hpp>
 #include <cheferd/networking/paio_interface.hpp>
+#include <cheferd/networking/stage_reactor.hpp>
+#include <cheferd/networking/stats_segment.hpp>
+#include <cheferd/session/control_command.hpp>
 #include <cheferd/utils/logging.hpp>
 #include <cheferd/utils/options.hpp>
-#include <condition_variable>
+#include <cheferd/utils/spsc_ring.hpp>
+#include <chrono>
 #include <cstdio>
+#include <deque>
 #include <iostream>
+#include <map>
 #include <mutex>
-#include <queue>
 #include <unistd.h>
+#include <vector>
 
 namespace cheferd {
 
+// Number of bytes read from a data plane stage when its socket reports none pending.
+#define DATA_PLANE_SESSION_READ_SIZE 4096
+
+/**
+ * InFlightOperation: Operation submitted to a data plane stage whose response was not read yet.
+ * - m_operation: ControlOperation of the operation (with its identifier);
+ * - m_sent: defines if the operation was sent (otherwise, it is answered with an error response).
+ */
+struct InFlightOperation {
+    ControlOperation m_operation {};
+    bool m_sent { false };
+};
+
 /**
  * DataPlaneSession class.
  * DataPlaneSession component serves as a liaison between the LocalControlApplication
  * and the data plane stage interface. It is used for the handshake step.
+ * The session has no threads of its own: operations are sent by the thread that submits them
+ * (once a slot in flight is free), and responses are read without blocking by the StageReactor,
+ * which completes the oldest operations in flight and sends the operations still queued. The
+ * socket is non-blocking: the bytes of the operations that it does not take are queued in
+ * tx_buffer_, and written by the StageReactor once it is writable, so a data plane stage that
+ * does not read its socket never blocks the submitting thread or the reactor.
+ * Commands are submitted by one LocalControlApplication thread at a time, while the consumer of
+ * the submission_queue_ and the producer of the completion_queue_ (either the submitting thread
+ * or the reactor) are serialized by submission_queue_lock_, so each ring has a single producer
+ * and a single consumer.
  * Currently, the DataPlaneSession class contains the following variables:
  * - session_id_: session Identifier.
- * - submission_queue_: queue that holds requests to submit to the data plane stage.
- * - submission_queue_lock_:  mutex for concurrency control over submission_queue_.
- * - submission_queue_condition_: condition for submission_queue_.
- * - completion_queue_: queue that holds responses from the data plane stage.
- * - completion_queue_lock_: mutex for concurrency control over completion_queue_.
- * - completion_queue_condition_: condition for completion_queue_.
+ * - reactor_: StageReactor that drives the socket of the session.
+ * - submission_queue_: ring that holds commands waiting for a slot in flight.
+ * - submission_queue_lock_: mutex for concurrency control over the consumer of submission_queue_,
+ * the producer of completion_queue_, in_flight_,
+ * next_operation_id_, closed_session_, channel_counters_, stats_segment_, enforcement_table_,
+ * enforcement_entries_, tx_buffer_, and the writes to socket_.
+ * - completion_queue_: ring that holds responses from the data plane stage.
  * - working_session_: atomic bool that stores if session is active.
+ * - closed_session_: bool that stores if session was closed (i.e., commands are answered with an
+ * error response).
  * - interface_: interface to submit requests.
+ * - next_operation_id_: identifier of the next operation sent to the data plane stage.
+ * - in_flight_: operations sent to the data plane stage whose response was not read yet, in the
+ * order they were sent. The stage serves the operations of its socket in order, so each response
+ * belongs to the oldest operation in flight.
+ * - max_in_flight_: maximum number of operations in flight.
+ * - rx_buffer_: bytes read from the data plane stage that do not form a complete response yet
+ * (only accessed by the reactor).
+ * - tx_buffer_: bytes of the operations sent to the data plane stage that were not written yet
+ * (reused across operations to avoid allocations).
+ * - tx_offset_: number of bytes of tx_buffer_ already written.
+ * - tx_records_: size of each message left in tx_buffer_ (with SOCK_SEQPACKET, each message is
+ * written as a single record).
+ * - channel_counters_: derives the rates of the stage's channels from the counters it reports.
+ * - stats_segment_: statistics segment where the data plane stage publishes its statistics
+ * (nullptr if it does not).
+ * - stats_slot_: slot of the data plane stage in stats_segment_.
+ * - stats_subtype_: subtype of the statistics requests sent to the data plane stage, negotiated at
+ * handshake time (COLLECT_CHANNEL_STATS if the stage reports per-channel records, and
+ * COLLECT_GLOBAL_STATS otherwise).
+ * - enforcement_table_: enforcement table from which the data plane stage applies its enforcement
+ * rules (nullptr if it does not).
+ * - enforcement_slot_: slot of the data plane stage in enforcement_table_.
+ * - enforcement_entries_: entry of the slot assigned to each enforcement object, by
+ * <channel, enforcement object>.
  * - unix_socket_: UNIX socket.
  * - server_fd_: socket file descriptor.
+ * - socket_: socket connected to the data plane stage.
  * - addrlen_: address length.
  */
-class DataPlaneSession {
+class DataPlaneSession : public StageReactorHandler {
 
 private:
     long session_id_;
-    std::queue<std::string> submission_queue_;
+    StageReactor* reactor_;
+    SpscRing<ControlCommand> submission_queue_;
     std::mutex submission_queue_lock_;
-    std::condition_variable submission_queue_condition_;
-    std::queue<std::unique_ptr<StageResponse>> completion_queue_;
-    std::mutex completion_queue_lock_;
-    std::condition_variable completion_queue_condition_;
+    SpscRing<std::unique_ptr<StageResponse>> completion_queue_;
     std::atomic<bool> working_session_;
+    bool closed_session_;
     PAIOInterface interface_;
+    int next_operation_id_;
+    std::deque<InFlightOperation> in_flight_;
+    std::size_t max_in_flight_;
+    std::vector<char> rx_buffer_;
+    std::vector<char> tx_buffer_;
+    std::size_t tx_offset_;
+    std::deque<std::size_t> tx_records_;
+    ChannelCounters channel_counters_;
+    StatsSegment* stats_segment_;
+    int stats_slot_;
+    std::atomic<int> stats_subtype_;
+    EnforcementTable* enforcement_table_;
+    int enforcement_slot_;
+    std::map<std::pair<long, long>, int> enforcement_entries_;
     struct sockaddr_un unix_socket_;
     int server_fd_;
+    int socket_;
     int addrlen_;
 
     /**
@@ -65,30 +138,83 @@ private:
     void PrepareUnixConnection (const char* socket_name);
 
     /**
-     * SendRule: Handle the rule to be submitted to the data plane stage.
-     * @param socket Socket identifier.
-     * @param rule Rule to be submitted.
+     * SendRule: Handle the command to be submitted to the data plane stage. The command is sent
+     * and registered in in_flight_; its response is read by handle_readable. Must be called
+     * while holding submission_queue_lock_.
+     * @param command Command to be submitted.
      * @param operation ControlOperation.
-     * @return PStatus::OK() if the rule was successfully dequeued,
+     * @return PStatus::OK() if the command was successfully sent,
      * PStatus::Error() otherwise
      */
-    PStatus SendRule (int socket, const std::string& rule, ControlOperation* operation);
+    PStatus SendRule (const ControlCommand& command, ControlOperation* operation);
+
+    /**
+     * TransmitOperation: Writes an operation and its payload to the data plane stage without
+     * blocking. The bytes that the socket does not take (all of them, if bytes are already queued)
+     * are queued in tx_buffer_, and the socket is marked to be flushed by the reactor once it is
+     * writable. Must be called while holding submission_queue_lock_.
+     * @param operation ControlOperation.
+     * @param payload Payload of the operation (nullptr if none).
+     * @param payload_size Size of the payload.
+     * @return PStatus::OK() if the operation was written or queued, PStatus::Error() otherwise.
+     */
+    PStatus TransmitOperation (const ControlOperation& operation,
+        const void* payload,
+        std::size_t payload_size);
+
+    /**
+     * FlushTransmitBuffer: Writes the bytes queued in tx_buffer_ without blocking, until the
+     * socket takes no more. Must be called while holding submission_queue_lock_.
+     * @return PStatus::OK() if successful (even if bytes are left), PStatus::Error() otherwise.
+     */
+    PStatus FlushTransmitBuffer ();
+
+    /**
+     * DispatchRules: Sends the commands of the submission_queue_ while less than max_in_flight_
+     * operations are in flight. Must be called while holding submission_queue_lock_.
+     */
+    void DispatchRules ();
 
     /**
-     * EnqueueRuleInSubmissionQueue: Enqueue rule in the submission_queue_ in
-     * string-based format.
-     * @param rule Rule to be enqueued.
+     * CompleteOperation: Completes an operation in flight with the response at the front of
+     * rx_buffer_ (consuming it), by enqueueing it in the completion_queue_. Operations that were
+     * not sent are completed with an error response, without consuming rx_buffer_.
+     * @param in_flight Operation in flight.
+     * @param complete Stores if the operation was completed (false if its response was not fully
+     * read yet).
+     * @return PStatus::OK() if successful, PStatus::Error() if the response is not valid.
      */
-    void EnqueueRuleInSubmissionQueue (const std::string& rule);
+    PStatus CompleteOperation (const InFlightOperation& in_flight, bool& complete);
 
     /**
-     * DequeueRuleFromSubmissionQueue: Dequeue rule from the submission_queue_
-     * in string-based format.
-     * @param rule  Rule dequeued.
-     * @return PStatus::OK() if the rule was successfully dequeued,
+     * EnqueueErrorResponse: Enqueue the error response of an operation in the completion_queue_.
+     * @param operation ControlOperation.
+     */
+    void EnqueueErrorResponse (const ControlOperation& operation);
+
+    /**
+     * FailSession: Closes the session, answering the operations in flight and the commands of
+     * the submission_queue_ with an error response, in submission order. Must be called while
+     * holding submission_queue_lock_.
+     */
+    void FailSession ();
+
+    /**
+     * EnqueueRuleInSubmissionQueue: Enqueue command in the submission_queue_, waiting while it is
+     * full. Must not be called while holding submission_queue_lock_, which the consumer of the
+     * submission_queue_ holds.
+     * @param command Command to be enqueued.
+     */
+    void EnqueueRuleInSubmissionQueue (ControlCommand command);
+
+    /**
+     * DequeueRuleFromSubmissionQueue: Dequeue command from the submission_queue_, without
+     * waiting. Must be called while holding submission_queue_lock_.
+     * @param command Command dequeued.
+     * @return PStatus::OK() if the command was successfully dequeued,
      * PStatus::Error() otherwise.
      */
-    PStatus DequeueRuleFromSubmissionQueue (std::string& rule);
+    PStatus DequeueRuleFromSubmissionQueue (ControlCommand& command);
 
     /**
      * EnqueueResponseInCompletionQueue: Enqueue response in the completion_queue_
@@ -101,7 +227,7 @@ private:
 
     /**
      * DequeueResponseFromCompletionQueue: Dequeue response from the
-     * completion_queue_ in StageResponse format.
+     * completion_queue_ in StageResponse format, waiting while it is empty.
      * @return Smart pointer of a StageResponse object.
      */
     std::unique_ptr<StageResponse> DequeueResponseFromCompletionQueue ();
@@ -115,26 +241,32 @@ private:
 public:
     /**
      * DataPlaneSession parameterized constructor.
+     * @param reactor StageReactor that drives the socket of the session.
      * @param socket_name Socket name.
      */
-    DataPlaneSession (const char* socket_name);
+    DataPlaneSession (StageReactor* reactor, const char* socket_name);
 
     /**
      * DataPlaneSession parameterized constructor.
      * @param id Session identifier.
+     * @param reactor StageReactor that drives the socket of the session.
      * @param socket_name Socket name.
      */
-    explicit DataPlaneSession (long id, const char* socket_name);
+    explicit DataPlaneSession (long id, StageReactor* reactor, const char* socket_name);
 
     /**
      * DataPlaneSession default destructor.
      */
-    ~DataPlaneSession ();
+    ~DataPlaneSession () override;
 
     /**
-     * StartSession: Start session execution.
+     * StartSession: Start session execution. Waits (up to
+     * option_default_data_plane_accept_timeout) for the data plane stage to connect, registers
+     * its socket at the reactor, and sends the commands submitted meanwhile.
+     * @return PStatus::OK() if the session started, PStatus::Error() otherwise (commands are
+     * answered with an error response).
      */
-    void StartSession ();
+    PStatus StartSession ();
 
     /**
      * RemoveSession: Stop session execution.
@@ -142,17 +274,34 @@ public:
     void RemoveSession ();
 
     /**
-     * SubmitRule: Emplace rules in the Session. This is the public
+     * handle_readable: Reads the responses of the data plane stage without blocking, completes
+     * the operations in flight they belong to, and sends the commands still queued (executed by a
+     * thread of the reactor).
+     * @return Returns false if the session failed (e.g., the data plane stage closed its socket),
+     * true otherwise.
+     */
+    bool handle_readable () override;
+
+    /**
+     * handle_writable: Writes the bytes queued in tx_buffer_ without blocking (executed by a
+     * thread of the reactor, while the socket is marked as writable), and unmarks the socket once
+     * they are all written.
+     * @return Returns false if the session failed, true otherwise.
+     */
+    bool handle_writable () override;
+
+    /**
+     * SubmitRule: Emplace commands in the Session. This is the public
      * method that will be used by ControlApplication objects to submit
-     * rules. Rules are enqueued in the submission_queue_ through the
-     * EnqueueRuleInSubmissionQueue call. Concurrency control is already handled
-     * in the EnqueueRuleInSubmissionQueue call (controlling concurrency here as
-     * well could lead to a deadlock).
-     * @param submission_rule Const value of the submission rule.
-     * @return Returns PStatus::OK() if the rule was successfully enqueued,
+     * commands. Commands are enqueued in the submission_queue_ through the
+     * EnqueueRuleInSubmissionQueue call, and then sent while holding
+     * submission_queue_lock_ (if the session was closed, queued commands are
+     * answered with an error response instead).
+     * @param command Command to be submitted (moved into the submission_queue_).
+     * @return Returns PStatus::OK() if the command was successfully enqueued,
      * PStatus::Error() otherwise. (possibly revisit this return statement).
      */
-    PStatus SubmitRule (const std::string& submission_rule);
+    PStatus SubmitRule (ControlCommand command);
 
     /**
      * GetRule: Pop result objects (StageResponse) from the Session.
@@ -167,6 +316,70 @@ public:
      */
     std::unique_ptr<StageResponse> GetResult ();
 
+    /**
+     * GetResult: Pop result objects (StageResponse) from the Session, waiting at most until
+     * deadline. A data plane stage that misses the deadline is considered unresponsive: the
+     * session is removed (its remaining requests are answered with an error response), and the
+     * response of the expired request is discarded, so that the session's responses still match
+     * their requests.
+     * @param deadline Time point until which the call waits for the response.
+     * @return Returns smart pointer (std::unique_ptr) of a StageResponse object, or nullptr if
+     * the deadline expired.
+     */
+    std::unique_ptr<StageResponse> GetResult (
+        const std::chrono::steady_clock::time_point& deadline);
+
+    /**
+     * AttachStatsSegment: Reads the statistics of the data plane stage from a slot of the
+     * statistics segment, which the stage agreed to publish in (STAGE_STATS_SEGMENT). The slot is
+     * released when the session is destroyed.
+     * @param segment Statistics segment.
+     * @param slot Slot of the data plane stage.
+     */
+    void AttachStatsSegment (StatsSegment* segment, int slot);
+
+    /**
+     * SetStatisticsSubtype: Sets the subtype of the statistics requests sent to the data plane
+     * stage, as negotiated at handshake time (STAGE_STATS_VERSION).
+     * @param subtype COLLECT_CHANNEL_STATS or COLLECT_GLOBAL_STATS.
+     */
+    void SetStatisticsSubtype (int subtype);
+
+    /**
+     * StatisticsSubtype: Get the subtype of the statistics requests sent to the data plane stage.
+     * @return COLLECT_CHANNEL_STATS if the stage reports per-channel records, and
+     * COLLECT_GLOBAL_STATS otherwise (the default, understood by every version).
+     */
+    int StatisticsSubtype () const;
+
+    /**
+     * ReadStatistics: Reads the statistics published by the data plane stage in the statistics
+     * segment (without a request through the socket), and derives the rates of its channels.
+     * @param channel_stats Container to store the statistics of each channel.
+     * @return Returns PStatus::OK() if successful, PStatus::Error() if the stage does not publish
+     * its statistics (or did not yet), or the session was closed.
+     */
+    PStatus ReadStatistics (std::vector<StatsChannelRaw>& channel_stats);
+
+    /**
+     * AttachEnforcementTable: Writes the enforcement rules of the data plane stage in a slot of
+     * the enforcement table, which the stage agreed to apply (STAGE_ENF_TABLE). The slot is
+     * released when the session is destroyed.
+     * @param table Enforcement table.
+     * @param slot Slot of the data plane stage.
+     */
+    void AttachEnforcementTable (EnforcementTable* table, int slot);
+
+    /**
+     * WriteEnforcementRule: Writes an enforcement rule in the slot of the data plane stage in the
+     * enforcement table (without a request through the socket). The stage applies it the next
+     * time it reads the table (e.g., at the next refill of its token buckets).
+     * @param rule Enforcement rule.
+     * @return Returns PStatus::OK() if successful, PStatus::Error() if the stage does not use the
+     * enforcement table, its slot has no free entries, or the session was closed.
+     */
+    PStatus WriteEnforcementRule (const EnforcementRuleRaw& rule);
+
     /**
      * SessionIdentifier: Get session identifier.
      * @return Session identifier.
@@ -10,13 +10,13 @@
 #include "cheferd/networking/stage_response/stage_response_handshake.hpp"
 
 #include <cheferd/networking/paio_interface.hpp>
+#include <cheferd/session/control_command.hpp>
 #include <cheferd/utils/logging.hpp>
 #include <cheferd/utils/options.hpp>
-#include <condition_variable>
+#include <cheferd/utils/spsc_ring.hpp>
+#include <chrono>
 #include <cstdio>
 #include <iostream>
-#include <mutex>
-#include <queue>
 #include <unistd.h>
 
 namespace cheferd {
@@ -25,14 +25,14 @@ namespace cheferd {
  * HandshakeSession class.
  * HandshakeSession component serves as a liaison between the LocalControlApplication
  * and the data plane stage interface. It is used for the handshake step.
- * Currently, the LocalControllerSession class contains the following variables:
- * - session_id_: session Identifier.
- * - submission_queue_: queue that holds requests to submit to the data plane stage.
- * - submission_queue_lock_:  mutex for concurrency control over submission_queue_.
- * - submission_queue_condition_: condition for submission_queue_.
- * - completion_queue_: queue that holds responses from the data plane stage.
- * - completion_queue_lock_: mutex for concurrency control over completion_queue_.
- * - completion_queue_condition_: condition for completion_queue_.
+ * The session has no threads of its own: commands are sent, and their responses read, by the
+ * thread that submits them (a thread of the LocalControlApplication's handshake pool), so
+ * handshakes do not wait for another thread of the pool. Reads and writes of the socket are
+ * bounded by option_default_data_plane_response_timeout (see StartSession), so an unresponsive
+ * data plane stage does not hold a thread of the pool.
+ * Currently, the HandshakeSession class contains the following variables:
+ * - socket_id_: socket connected to the data plane stage (session identifier).
+ * - completion_queue_: ring that holds responses from the data plane stage.
  * - working_session_: atomic bool that stores if session is active.
  * - interface_: interface to submit requests.
  */
@@ -40,39 +40,19 @@ class HandshakeSession {
 
 private:
     long socket_id_;
-    std::queue<std::string> submission_queue_;
-    std::mutex submission_queue_lock_;
-    std::queue<std::unique_ptr<StageResponse>> completion_queue_;
-    std::mutex completion_queue_lock_;
-    std::condition_variable completion_queue_condition_;
+    SpscRing<std::unique_ptr<StageResponse>> completion_queue_;
     std::atomic<bool> working_session_;
     PAIOInterface interface_;
 
     /**
-     * SendRule: Handle the rule to be submitted to the data plane stage.
+     * SendRule: Handle the command to be submitted to the data plane stage.
      * @param socket Socket identifier.
-     * @param rule Rule to be submitted.
+     * @param command Command to be submitted.
      * @param operation ControlOperation.
      * @return PStatus::OK() if the rule was successfully dequeued,
      * PStatus::Error() otherwise
      */
-    PStatus SendRule (int socket, const std::string& rule, ControlOperation* operation);
-
-    /**
-     * EnqueueRuleInSubmissionQueue: Enqueue rule in the submission_queue_ in
-     * string-based format.
-     * @param rule Rule to be enqueued.
-     */
-    void EnqueueRuleInSubmissionQueue (const std::string& rule);
-
-    /**
-     * DequeueRuleFromSubmissionQueue: Dequeue rule from the submission_queue_
-     * in string-based format.
-     * @param rule  Rule dequeued.
-     * @return PStatus::OK() if the rule was successfully dequeued,
-     * PStatus::Error() otherwise.
-     */
-    PStatus DequeueRuleFromSubmissionQueue (std::string& rule);
+    PStatus SendRule (int socket, const ControlCommand& command, ControlOperation* operation);
 
     /**
      * EnqueueResponseInCompletionQueue: Enqueue response in the completion_queue_
@@ -90,15 +70,7 @@ private:
      */
     std::unique_ptr<StageResponse> DequeueResponseFromCompletionQueue ();
 
-    /**
-     * getSubmissionQueueSize: Get the total size of the submission_queue.
-     * @return Return the size of the submission_queue
-     */
-    int getSubmissionQueueSize ();
-
 public:
-    std::condition_variable submission_queue_condition_;
-
     /**
      * HandshakeSession default constructor.
      */
@@ -116,9 +88,11 @@ public:
     ~HandshakeSession ();
 
     /**
-     * StartSession: Start session execution.
+     * StartSession: Start session execution. Bounds the reads and writes of the socket by
+     * option_default_data_plane_response_timeout.
+     * @return Returns PStatus::OK() if successful, PStatus::Error() otherwise.
      */
-    void StartSession ();
+    PStatus StartSession ();
 
     /**
      * RemoveSession: Stop session execution.
@@ -126,31 +100,36 @@ public:
     void RemoveSession ();
 
     /**
-     * SubmitRule: Emplace rules in the Session. This is the public
-     * method that will be used by ControlApplication objects to submit
-     * rules. Rules are enqueued in the submission_queue_ through the
-     * EnqueueRuleInSubmissionQueue call. Concurrency control is already handled
-     * in the EnqueueRuleInSubmissionQueue call (controlling concurrency here as
-     * well could lead to a deadlock).
-     * @param submission_rule Const value of the submission rule.
-     * @return Returns PStatus::OK() if the rule was successfully enqueued,
-     * PStatus::Error() otherwise. (possibly revisit this return statement).
+     * SubmitRule: Sends a command to the data plane stage, and enqueues its response (an error
+     * response if the session was removed, or the stage did not answer in time). This is the
+     * public method that will be used by ControlApplication objects to submit commands.
+     * @param command Command to be submitted.
+     * @return Returns PStatus::OK() if the command was successfully sent, PStatus::Error()
+     * otherwise.
      */
-    PStatus SubmitRule (const std::string& submission_rule);
+    PStatus SubmitRule (ControlCommand command);
 
     /**
      * GetRule: Pop result objects (StageResponse) from the Session.
      * This is the public method that will be used by ControlApplication
      * objects to read received StageResponse of previously submitted requests.
      * StageResponses are dequeued from the completion_queue_ through the
-     * DequeueResponseFromCompletionQueue call. Concurrency control is already
-     * handled in the DequeueResponseFromCompletionQueue call (controlling
-     * concurrency here as well could lead to a deadlock).
+     * DequeueResponseFromCompletionQueue call.
      * @return Returns smart pointer (std::unique_ptr) of a StageResponse
      * object, so the caller can unmarshall based on the Base or Derived class.
      */
     std::unique_ptr<StageResponse> GetResult ();
 
+    /**
+     * GetResult: Pop result objects (StageResponse) from the Session, waiting at most until
+     * deadline.
+     * @param deadline Time point until which the call waits for the response.
+     * @return Returns smart pointer (std::unique_ptr) of a StageResponse object, or nullptr if
+     * the deadline expired.
+     */
+    std::unique_ptr<StageResponse> GetResult (
+        const std::chrono::steady_clock::time_point& deadline);
+
     /**
      * SessionIdentifier: Get session identifier.
      * @return Session identifier.
@@ -10,72 +10,140 @@
 #include "cheferd/networking/stage_response/stage_response_handshake.hpp"
 
 #include <cheferd/networking/local_interface.hpp>
+#include <cheferd/session/control_command.hpp>
 #include <cheferd/utils/logging.hpp>
 #include <cheferd/utils/options.hpp>
+#include <cheferd/utils/spsc_ring.hpp>
+#include <cheferd/utils/triple_buffer.hpp>
+#include <chrono>
 #include <condition_variable>
 #include <cstdio>
 #include <iostream>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <unistd.h>
 
 namespace cheferd {
 
+/**
+ * StatisticsSnapshot struct.
+ * Statistics pushed by a local controller through its statistics stream.
+ * - m_timestamp: time at which the statistics were received.
+ * - m_stats: statistics of each data plane stage of the local controller, as pushed (its
+ * m_sequence is 0 if none was received). They are converted as the replies of the unary
+ * statistics requests (see LocalInterface::fill_global_statistics).
+ */
+struct StatisticsSnapshot {
+    std::chrono::steady_clock::time_point m_timestamp {};
+    StatsGlobalMap m_stats {};
+};
+
 /**
  * LocalControllerSession class.
  * LocalControllerSession component serves as a liaison between the CoreControlApplication
  * and the LocalInterface.
+ * Commands are submitted, and responses read, by the CoreControlApplication's feedback loop, so
+ * each ring has a single producer and a single consumer.
  * Currently, the LocalControllerSession class contains the following variables:
  * - session_id_: session Identifier.
- * - submission_queue_: queue that holds requests to submit to the local controller.
- * - submission_queue_lock_:  mutex for concurrency control over submission_queue_.
- * - completion_queue_: queue that holds responses from the local controller.
- * - completion_queue_lock_: mutex for concurrency control over completion_queue_.
- * - completion_queue_condition_: condition for completion_queue_.
+ * - submission_queue_: ring that holds commands to submit to the local controller.
+ * - submission_queue_lock_: mutex that serializes the consumers of submission_queue_ in
+ * asynchronous mode (the submitter and the poller threads).
+ * - submission_queue_condition_: condition for rule_in_flight_.
+ * - completion_queue_: ring that holds responses from the local controller.
+ * - expired_responses_: number of responses whose deadline expired before being received; these
+ * are discarded from the completion_queue_ once they arrive (only accessed by the consumer of
+ * completion_queue_).
  * - working_session_: atomic bool that stores if session is active.
+ * - rule_in_flight_: marks if a rule was submitted asynchronously and awaits its response
+ * (guarded by submission_queue_lock_).
  * - interface_: interface to submit requests.
+ * - latest_statistics_: lock-free latest-value container of the statistics pushed by the local
+ * controller (written by the stream thread, read by the control application).
+ * - streaming_statistics_: atomic bool that stores if the statistics stream is active.
+ * - statistics_stream_thread_: thread that consumes the statistics stream.
+ * In asynchronous mode (i.e., when built with a LocalInterfacePoller), the session does not own a
+ * thread: rules are submitted from SubmitRule, and the next one is submitted by the poller thread
+ * that completes the previous, so at most one rule per local controller is in flight and
+ * responses keep the submission order.
  */
 class LocalControllerSession {
 
 private:
     long session_id_;
-    std::queue<std::string> submission_queue_;
+    SpscRing<ControlCommand> submission_queue_;
     std::mutex submission_queue_lock_;
     std::condition_variable submission_queue_condition_;
-    std::queue<std::unique_ptr<StageResponse>> completion_queue_;
-    std::mutex completion_queue_lock_;
-    std::condition_variable completion_queue_condition_;
+    SpscRing<std::unique_ptr<StageResponse>> completion_queue_;
+    int expired_responses_;
     std::atomic<bool> working_session_;
+    bool rule_in_flight_;
     LocalInterface interface_;
+    TripleBuffer<StatisticsSnapshot> latest_statistics_;
+    std::atomic<bool> streaming_statistics_;
+    std::thread statistics_stream_thread_;
+
+    /**
+     * ConsumeStatisticsStream: Consumes the statistics stream of the local controller, reopening
+     * it if it is closed while the session is still streaming.
+     * @param period Period (in microseconds) between statistics pushes.
+     */
+    void ConsumeStatisticsStream (uint64_t period);
 
     /**
-     * SendRule: Handle the rule to be submitted to the local controller.
+     * SendRule: Handle the command to be submitted to the local controller.
      * @param user_address Local controller address.
-     * @param rule Rule to be submitted.
+     * @param command Command to be submitted.
      * @param operation ControlOperation.
      * @return PStatus::OK() if the rule was successfully dequeued,
      * PStatus::Error() otherwise
      */
     PStatus SendRule (const std::string& user_address,
-        const std::string& rule,
+        const ControlCommand& command,
         ControlOperation* operation);
 
     /**
-     * EnqueueRuleInSubmissionQueue: Enqueue rule in the submission_queue_ in
-     * string-based format.
-     * @param rule Rule to be enqueued.
+     * SendRuleAsync: Asynchronously submit the command to the local controller. The response is
+     * handled by CompleteAsyncRule.
+     * @param command Command to be submitted.
      */
-    void EnqueueRuleInSubmissionQueue (const std::string& rule);
+    void SendRuleAsync (const ControlCommand& command);
 
     /**
-     * DequeueRuleFromSubmissionQueue: Dequeue rule from the submission_queue_
-     * in string-based format.
-     * @param rule  Rule dequeued.
-     * @return PStatus::OK() if the rule was successfully dequeued,
+     * DispatchNextRule: Submits the next rule of the submission_queue_ in asynchronous mode, if
+     * no other rule is in flight.
+     */
+    void DispatchNextRule ();
+
+    /**
+     * PopNextRule: Pops the next command to submit in asynchronous mode and marks it as in
+     * flight. Must be called while holding submission_queue_lock_.
+     * @param command Command dequeued.
+     * @return Returns true if there is a command to submit, false otherwise.
+     */
+    bool PopNextRule (ControlCommand& command);
+
+    /**
+     * CompleteAsyncRule: Handles the response of an asynchronously submitted rule and submits the
+     * next one.
+     * @param response_object Smart pointer of a StageResponse object (nullptr if the rule has no
+     * response).
+     */
+    void CompleteAsyncRule (std::unique_ptr<StageResponse> response_object);
+
+    /**
+     * EnqueueRuleInSubmissionQueue: Enqueue command in the submission_queue_.
+     * @param command Command to be enqueued.
+     */
+    void EnqueueRuleInSubmissionQueue (ControlCommand command);
+
+    /**
+     * DequeueRuleFromSubmissionQueue: Dequeue command from the submission_queue_.
+     * @param command Command dequeued.
+     * @return PStatus::OK() if the command was successfully dequeued,
      * PStatus::Error() otherwise.
      */
-    PStatus DequeueRuleFromSubmissionQueue (std::string& rule);
+    PStatus DequeueRuleFromSubmissionQueue (ControlCommand& command);
 
     /**
      * EnqueueResponseInCompletionQueue: Enqueue response in the completion_queue_
@@ -93,6 +161,22 @@ private:
      */
     std::unique_ptr<StageResponse> DequeueResponseFromCompletionQueue ();
 
+    /**
+     * DequeueResponseFromCompletionQueue: Dequeue response from the completion_queue_ in
+     * StageResponse format, waiting at most until deadline. If the deadline expires, the
+     * response is marked as expired and discarded once it arrives.
+     * @param deadline Time point until which the call waits for the response.
+     * @return Smart pointer of a StageResponse object, or nullptr if the deadline expired.
+     */
+    std::unique_ptr<StageResponse> DequeueResponseFromCompletionQueue (
+        const std::chrono::steady_clock::time_point& deadline);
+
+    /**
+     * DiscardExpiredResponses: Discard expired responses that already arrived at the
+     * completion_queue_.
+     */
+    void DiscardExpiredResponses ();
+
     /**
      * getSubmissionQueueSize: Get the total size of the submission_queue.
      * @return Return the size of the submission_queue
@@ -113,13 +197,20 @@ public:
      */
     LocalControllerSession (long id, const std::string& user_address);
 
+    /**
+     * LocalControllerSession parameterized constructor (asynchronous mode).
+     * @param user_address User address identifier of the local controller.
+     * @param poller Poller of the completion queue shared by asynchronous sessions.
+     */
+    LocalControllerSession (const std::string& user_address, LocalInterfacePoller* poller);
+
     /**
      * LocalControllerSession default destructor.
      */
     ~LocalControllerSession ();
 
     /**
-     * StartSession: Start session execution.
+     * StartSession: Start session execution. In asynchronous mode, it returns immediately.
      * @param user_address User address identifier of the local controller.
      */
     void StartSession (const std::string& user_address);
@@ -130,17 +221,17 @@ public:
     void RemoveSession ();
 
     /**
-     * SubmitRule: Emplace rules in the Session. This is the public
+     * SubmitRule: Emplace commands in the Session. This is the public
      * method that will be used by ControlApplication objects to submit
-     * rules. Rules are enqueued in the submission_queue_ through the
+     * commands. Commands are enqueued in the submission_queue_ through the
      * EnqueueRuleInSubmissionQueue call. Concurrency control is already handled
      * in the EnqueueRuleInSubmissionQueue call (controlling concurrency here as
      * well could lead to a deadlock).
-     * @param submission_rule Const value of the submission rule.
-     * @return Returns PStatus::OK() if the rule was successfully enqueued,
+     * @param command Command to be submitted (moved into the submission_queue_).
+     * @return Returns PStatus::OK() if the command was successfully enqueued,
      * PStatus::Error() otherwise. (possibly revisit this return statement).
      */
-    PStatus SubmitRule (const std::string& submission_rule);
+    PStatus SubmitRule (ControlCommand command);
 
     /**
      * GetRule: Pop result objects (StageResponse) from the Session.
@@ -155,6 +246,51 @@ public:
      */
     std::unique_ptr<StageResponse> GetResult ();
 
+    /**
+     * GetResult: Pop result objects (StageResponse) from the Session, waiting at most until
+     * deadline. Responses that miss the deadline are discarded when they arrive, so later calls
+     * to GetResult are still matched with their own requests.
+     * @param deadline Time point until which the call waits for the response.
+     * @return Returns smart pointer (std::unique_ptr) of a StageResponse object, or nullptr if
+     * the deadline expired.
+     */
+    std::unique_ptr<StageResponse> GetResult (
+        const std::chrono::steady_clock::time_point& deadline);
+
+    /**
+     * HasExpiredResponses: Verify if the session still waits for responses whose deadline
+     * expired (i.e., the local controller is lagging behind).
+     * @return Returns true if there are expired responses still in flight, false otherwise.
+     */
+    bool HasExpiredResponses ();
+
+    /**
+     * StartStatisticsStream: Start consuming the statistics pushed by the local controller.
+     * @param period Period (in microseconds) between statistics pushes.
+     */
+    void StartStatisticsStream (uint64_t period);
+
+    /**
+     * PublishStatistics: Publishes the statistics pushed by the local controller, so that they are
+     * read by the next GetLatestStatistics call.
+     * @param stats Statistics pushed by the local controller.
+     */
+    void PublishStatistics (const StatsGlobalMap& stats);
+
+    /**
+     * GetLatestStatistics: Get the statistics pushed by the local controller since the last call,
+     * without blocking.
+     * @return Returns smart pointer of a StageResponseStats object, or nullptr if no statistics
+     * were pushed since the last call.
+     */
+    std::unique_ptr<StageResponse> GetLatestStatistics ();
+
+    /**
+     * LatestStatisticsTime: Get the time at which the latest statistics were received.
+     * @return Time point of the latest statistics (or of the stream start if none was received).
+     */
+    std::chrono::steady_clock::time_point LatestStatisticsTime () const;
+
     /**
      * SessionIdentifier: Get session identifier.
      * @return Session identifier.
@@ -22,6 +22,18 @@ namespace cheferd {
  * - housekeeping_rules_file: path to file that contains housekeeping rules.
  * - policies_rules_file:  path to file that contains policy rules.
  * - system_limit: defines the maximum limit of the system (e.g., IOPS, bandwidth).
+ * - operation_limits: defines the maximum limit of specific operations (e.g., read, write, mds1);
+ * the remainder are limited by system_limit.
+ * - local_interface_pollers: number of threads polling asynchronous calls to local controllers
+ * (0 for synchronous calls).
+ * - statistics_stream_period: period (in microseconds) at which local controllers push statistics
+ * (0 to collect statistics on request).
+ * - history_max_stages: maximum number of data plane stages whose statistics the core controller
+ * keeps in its history.
+ * - min_cycle_period, max_cycle_period: bounds (in microseconds) of the adaptive period of the
+ * core controller's feedback loop (equal bounds fix the period).
+ * - metrics_port: TCP port at which the controller serves its metrics (0 to not serve them).
+ * - metrics_address: IPv4 address at which the controller serves its metrics.
  */
 class ConfigFileParser {
 
@@ -33,6 +45,14 @@ public:
     std::string housekeeping_rules_file;
     std::string policies_rules_file;
     long system_limit;
+    std::map<std::string, long> operation_limits;
+    int local_interface_pollers { option_default_local_interface_pollers };
+    uint64_t statistics_stream_period { option_default_statistics_stream_period };
+    std::size_t history_max_stages { option_default_history_max_stages };
+    uint64_t min_cycle_period { option_default_control_application_sleep };
+    uint64_t max_cycle_period { option_default_control_application_sleep };
+    int metrics_port { option_default_metrics_port };
+    std::string metrics_address { option_default_metrics_address };
 
     /**
      * process_config_file. Process configuration file.
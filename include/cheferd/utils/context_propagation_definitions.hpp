@@ -197,11 +197,20 @@ enum class POSIX {
     data = 95,
     metadata = 96,
     total = 97,
+    mds1 = 98,
+    mds2 = 99,
     no_op = 0
 };
 
 const int posix_size = 100;
 
+// Definition of the first metadata server ("mds1"); metadata server N ("mdsN") is defined as
+// posix_mds_base + N - 1, up to posix_max_metadata_servers.
+const int posix_mds_base = static_cast<int> (POSIX::mds1);
+
+// Maximum number of metadata servers that can be identified through the POSIX definitions.
+const int posix_max_metadata_servers = 1024;
+
 /**
  * POSIX_META definitions.
  * Defines the "meta" operations of POSIX applications.
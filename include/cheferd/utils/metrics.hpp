@@ -0,0 +1,209 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_METRICS_HPP
+#define CHEFERD_METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cheferd {
+
+/**
+ * Metric class.
+ * Base class of the metrics held by the Metrics registry.
+ */
+class Metric {
+
+public:
+    /**
+     * Metric default destructor.
+     */
+    virtual ~Metric ();
+
+    /**
+     * render: Appends the samples of the metric in Prometheus text format.
+     * @param name Name of the metric.
+     * @param labels Labels of the metric (e.g., local="host:port"; empty for none).
+     * @param output String to append the samples to.
+     */
+    virtual void render (const std::string& name,
+        const std::string& labels,
+        std::string& output) const
+        = 0;
+};
+
+/**
+ * Counter class.
+ * Monotonic counter (e.g., number of enforcement rules sent), updated lock-free.
+ * Currently, the Counter class contains the following variables:
+ * - value_: value of the counter.
+ */
+class Counter : public Metric {
+
+private:
+    std::atomic<uint64_t> value_ { 0 };
+
+public:
+    /**
+     * increment: Adds to the counter.
+     * @param amount Amount to add.
+     */
+    void increment (uint64_t amount = 1);
+
+    /**
+     * value: Gets the value of the counter.
+     */
+    uint64_t value () const;
+
+    void render (const std::string& name,
+        const std::string& labels,
+        std::string& output) const override;
+};
+
+/**
+ * Gauge class.
+ * Value that goes up and down (e.g., depth of a queue), updated lock-free.
+ * Currently, the Gauge class contains the following variables:
+ * - value_: value of the gauge.
+ */
+class Gauge : public Metric {
+
+private:
+    std::atomic<double> value_ { 0 };
+
+public:
+    /**
+     * set: Sets the value of the gauge.
+     * @param value New value.
+     */
+    void set (double value);
+
+    /**
+     * add: Adds to the value of the gauge.
+     * @param amount Amount to add (negative to subtract).
+     */
+    void add (double amount);
+
+    /**
+     * value: Gets the value of the gauge.
+     */
+    double value () const;
+
+    void render (const std::string& name,
+        const std::string& labels,
+        std::string& output) const override;
+};
+
+/**
+ * Histogram class.
+ * Distribution of observed values (e.g., latencies, in seconds) over fixed buckets, updated
+ * lock-free.
+ * Currently, the Histogram class contains the following variables:
+ * - bounds_: upper bound of each bucket (in increasing order).
+ * - buckets_: number of observations of each bucket (the last one counts values above every bound).
+ * - count_: number of observations.
+ * - sum_: sum of the observations.
+ */
+class Histogram : public Metric {
+
+private:
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+    std::atomic<uint64_t> count_ { 0 };
+    std::atomic<double> sum_ { 0 };
+
+public:
+    /**
+     * Histogram parameterized constructor.
+     * @param bounds Upper bound of each bucket (in increasing order).
+     */
+    explicit Histogram (std::vector<double> bounds);
+
+    /**
+     * observe: Adds an observation.
+     * @param value Value observed.
+     */
+    void observe (double value);
+
+    /**
+     * observe_since: Adds the time elapsed since a point in time, in seconds.
+     * @param start Point in time.
+     */
+    void observe_since (std::chrono::steady_clock::time_point start);
+
+    /**
+     * count: Gets the number of observations.
+     */
+    uint64_t count () const;
+
+    void render (const std::string& name,
+        const std::string& labels,
+        std::string& output) const override;
+};
+
+/**
+ * Metrics class.
+ * Registry of the metrics of the controller, served in Prometheus text format (see MetricsServer).
+ * Metrics are registered (under a lock) on their first use, and the returned references stay
+ * valid, so hot paths keep them and update them without locking.
+ */
+class Metrics {
+
+public:
+    /**
+     * latency_buckets: Default buckets (in seconds) of latency histograms.
+     */
+    static const std::vector<double>& latency_buckets ();
+
+    /**
+     * counter: Gets (registering it, if needed) a counter.
+     * @param name Name of the metric.
+     * @param help Description of the metric.
+     * @param labels Labels of the metric (e.g., phase="collect"; empty for none).
+     * @return Reference to the counter.
+     */
+    static Counter& counter (const std::string& name,
+        const std::string& help,
+        const std::string& labels = "");
+
+    /**
+     * gauge: Gets (registering it, if needed) a gauge.
+     * @param name Name of the metric.
+     * @param help Description of the metric.
+     * @param labels Labels of the metric (empty for none).
+     * @return Reference to the gauge.
+     */
+    static Gauge& gauge (const std::string& name,
+        const std::string& help,
+        const std::string& labels = "");
+
+    /**
+     * histogram: Gets (registering it, if needed) a histogram.
+     * @param name Name of the metric.
+     * @param help Description of the metric.
+     * @param labels Labels of the metric (empty for none).
+     * @param bounds Upper bound of each bucket (latency_buckets by default).
+     * @return Reference to the histogram.
+     */
+    static Histogram& histogram (const std::string& name,
+        const std::string& help,
+        const std::string& labels = "",
+        const std::vector<double>& bounds = latency_buckets ());
+
+    /**
+     * render: Renders every metric in Prometheus text format.
+     * @return Metrics in Prometheus text format.
+     */
+    static std::string render ();
+};
+} // namespace cheferd
+
+#endif // CHEFERD_METRICS_HPP
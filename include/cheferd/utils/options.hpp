@@ -13,7 +13,14 @@ enum class CommunicationType { UNIX = 0, INET = 1, gRPC = 2 };
 
 enum class ControllerType { CORE = 0, LOCAL = 1 };
 
-enum class ControlType { STATIC = 1, DYNAMIC_VANILLA = 2, DYNAMIC_LEFTOVER = 3, MDS = 4, NOOP = 0 };
+enum class ControlType {
+    STATIC = 1,
+    DYNAMIC_VANILLA = 2,
+    DYNAMIC_LEFTOVER = 3,
+    MDS = 4,
+    DYNAMIC_WATER_FILLING = 5,
+    NOOP = 0
+};
 
 enum class EnforcementChannelMode { SYNC = 0, ASYNC = 1 };
 
@@ -54,6 +61,9 @@ const std::string option_housekeeping_rules_file_path_posix_metadata_data
 const std::string option_housekeeping_rules_file_path_posix_total
     = "../files/posix_layer_housekeeping_rules_static_total";
 
+const std::string option_housekeeping_rules_file_path_posix_mds
+    = "../files/posix_layer_housekeeping_rules_mds";
+
 /**
  * HousekeepingRules files.
  * This parameter points to the path of the rules to insert and
@@ -77,6 +87,8 @@ const std::string option_static_rules_with_time_file_path_user
 const std::string option_dynamic_rules_with_time_file_path_
     = "../files/static_rules_with_time_file_job";
 
+const std::string option_mds_rules_with_time_file_path_ = "../files/mds_rules_with_time_file";
+
 /**
  * Default communication option.
  * This parameter is defined "a priori", as Sysadmins are not able to change it
@@ -132,6 +144,176 @@ const long option_postpone_time_ = 2000;
  */
 const uint64_t option_default_control_application_sleep = 1000000;
 
+/**
+ * Default statistics collection deadline.
+ * This parameter defines the maximum amount of time (in microseconds) that the core controller
+ * waits for the statistics of local controllers at each feedback-loop cycle. Local controllers
+ * that miss it are served from their last known sample.
+ */
+const uint64_t option_default_collect_deadline = 500000;
+
+/**
+ * Default maximum consecutive collection misses.
+ * This parameter defines the number of consecutive statistics collection deadlines that a local
+ * controller may miss before being quarantined.
+ */
+const int option_default_collect_max_misses = 3;
+
+/**
+ * Default number of LocalInterface pollers.
+ * This parameter defines the number of threads polling the completion queue shared by the
+ * asynchronous LocalInterfaces of the core controller. If 0, each LocalControllerSession uses
+ * a dedicated thread and synchronous calls.
+ */
+const int option_default_local_interface_pollers = 0;
+
+/**
+ * Default statistics stream period.
+ * This parameter defines the period (in microseconds) at which local controllers push the
+ * statistics of their data plane stages to the core controller. If 0, the core controller
+ * requests statistics from each local controller at every feedback-loop cycle.
+ */
+const uint64_t option_default_statistics_stream_period = 0;
+
+/**
+ * Default local sampling period.
+ * This parameter defines the period (in microseconds) at which the local controller samples the
+ * statistics of its data plane stages in the background, to serve aggregated statistics.
+ */
+const uint64_t option_default_local_sampling_period = 200000;
+
+/**
+ * Default local sampling capacity.
+ * This parameter defines the number of samples that the local controller holds per data plane
+ * stage, which bounds the window of aggregated statistics (capacity * sampling period).
+ */
+const std::size_t option_default_local_sampling_capacity = 64;
+
+/**
+ * Default history length.
+ * This parameter defines the number of feedback-loop cycles whose statistics the core controller
+ * keeps per data plane stage and per job (e.g., 10 minutes at a 1 second cycle period).
+ */
+const std::size_t option_default_history_length = 600;
+
+/**
+ * Default history maximum stages and jobs.
+ * These parameters define the maximum number of data plane stages and jobs whose statistics the
+ * core controller keeps (option_default_history_length samples of 4 bytes each, allocated at
+ * startup, i.e., about 228 MiB for 100,000 stages); the history of removed stages and jobs is
+ * reused, and stages and jobs beyond the maximum are not kept.
+ */
+const std::size_t option_default_history_max_stages = 100000;
+const std::size_t option_default_history_max_jobs = 1000;
+
+/**
+ * Default metrics port.
+ * This parameter defines the TCP port at which controllers serve their metrics in Prometheus text
+ * format (GET /metrics), or 0 to not serve them.
+ */
+const int option_default_metrics_port = 0;
+
+/**
+ * Default metrics address.
+ * This parameter defines the IPv4 address at which controllers serve their metrics (e.g.,
+ * 127.0.0.1 to serve them only to local scrapers).
+ */
+const std::string option_default_metrics_address = "0.0.0.0";
+
+/**
+ * Default data plane socket type.
+ * This parameter defines if the UNIX domain sockets of data plane sessions are SOCK_SEQPACKET
+ * (true) or SOCK_STREAM (false). With SOCK_SEQPACKET, each control message (ControlOperation and
+ * payload) and each response is a single record, so data plane stages must read and write them
+ * with a single call.
+ */
+const bool option_default_data_plane_seqpacket = false;
+
+/**
+ * Default maximum operations in flight.
+ * This parameter defines the number of operations that a data plane session may have sent to its
+ * data plane stage without having read their responses (1 to wait for each response before
+ * sending the next operation).
+ */
+const std::size_t option_default_data_plane_max_in_flight = 8;
+
+/**
+ * Default session ring capacity.
+ * This parameter defines the number of entries of the submission and completion rings of each
+ * session (LocalControllerSession, DataPlaneSession, and HandshakeSession), allocated when the
+ * session is created. Submitting to a full ring waits for a free slot, so a caller must not submit
+ * more commands than this before reading their responses.
+ */
+const std::size_t option_default_session_ring_capacity = 1024;
+
+/**
+ * Default stage reactor threads.
+ * This parameter defines the number of threads (each with its own epoll instance) that drive the
+ * sockets of every data plane session of the local controller.
+ */
+const int option_default_stage_reactor_threads = 2;
+
+/**
+ * Default handshake threads.
+ * This parameter defines the number of threads of the pool that runs the handshake sessions of
+ * the local controller (i.e., the number of data plane stages handshaked concurrently).
+ */
+const int option_default_handshake_threads = 2;
+
+/**
+ * Default data plane accept timeout.
+ * This parameter defines the time (in milliseconds) that a data plane session waits for its data
+ * plane stage to connect, after sending it the name of the session's socket.
+ */
+const int option_default_data_plane_accept_timeout = 5000;
+
+/**
+ * Default data plane response timeout.
+ * This parameter defines the time (in milliseconds) that the local controller waits for the
+ * response of a data plane stage (e.g., to a statistics request) before considering the stage
+ * unresponsive and removing its session.
+ */
+const int option_default_data_plane_response_timeout = 1000;
+
+/**
+ * Default statistics segment.
+ * This parameter defines if the local controller creates a shared-memory statistics segment, where
+ * the data plane stages that support it (negotiated at the handshake) publish their statistics.
+ * The statistics of the remaining stages are collected through their sockets.
+ */
+const bool option_default_stats_segment = false;
+
+/**
+ * Default statistics segment slots.
+ * This parameter defines the number of data plane stages that may publish their statistics in the
+ * statistics segment of the local controller.
+ */
+const int option_default_stats_segment_slots = 256;
+
+/**
+ * Default enforcement table.
+ * This parameter defines if the local controller creates a shared-memory enforcement table, where
+ * it writes the enforcement rules of the data plane stages that support it (negotiated at the
+ * handshake), which apply them without a round trip through their sockets. The rules of the
+ * remaining stages are submitted through their sockets.
+ */
+const bool option_default_enforcement_table = false;
+
+/**
+ * Default enforcement table slots.
+ * This parameter defines the number of data plane stages that may apply their enforcement rules
+ * from the enforcement table of the local controller.
+ */
+const int option_default_enforcement_table_slots = 256;
+
+/**
+ * Default enforcement table confirmation.
+ * This parameter defines if the enforcement rules written in the enforcement table are also
+ * submitted through the sockets of the data plane stages, after every table write of the batch,
+ * to confirm that the stages applied them.
+ */
+const bool option_default_enforcement_table_confirm = true;
+
 } // namespace cheferd
 
 #endif // CHEFERD_OPTIONS_HPP
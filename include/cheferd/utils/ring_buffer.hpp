@@ -0,0 +1,100 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_RING_BUFFER_HPP
+#define CHEFERD_RING_BUFFER_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace cheferd {
+
+/**
+ * RingBuffer class.
+ * Fixed-capacity container that keeps the most recent values pushed to it: once full, each push
+ * overwrites the oldest value. Storage is allocated once, at construction. It is not thread-safe.
+ * Currently, the RingBuffer class contains the following variables:
+ * - values_: storage of the values.
+ * - head_: position where the next value is written.
+ * - size_: number of values held.
+ */
+template <typename T>
+class RingBuffer {
+
+private:
+    std::vector<T> values_;
+    std::size_t head_;
+    std::size_t size_;
+
+public:
+    /**
+     * RingBuffer parameterized constructor.
+     * @param capacity Maximum number of values held (at least one).
+     */
+    explicit RingBuffer (std::size_t capacity) :
+        values_ (capacity > 0 ? capacity : 1),
+        head_ { 0 },
+        size_ { 0 }
+    { }
+
+    /**
+     * push: Adds a value, overwriting the oldest one if the buffer is full.
+     * @param value Value to be added.
+     */
+    void push (const T& value)
+    {
+        values_[head_] = value;
+        head_ = (head_ + 1) % values_.size ();
+
+        if (size_ < values_.size ()) {
+            size_++;
+        }
+    }
+
+    /**
+     * size: Gets the number of values held.
+     */
+    std::size_t size () const
+    {
+        return size_;
+    }
+
+    /**
+     * capacity: Gets the maximum number of values held.
+     */
+    std::size_t capacity () const
+    {
+        return values_.size ();
+    }
+
+    /**
+     * empty: Verifies if the buffer holds no values.
+     */
+    bool empty () const
+    {
+        return size_ == 0;
+    }
+
+    /**
+     * from_newest: Gets a value by its age.
+     * @param age Position of the value, from the newest (0) to the oldest (size () - 1).
+     * @return Reference to the value.
+     */
+    const T& from_newest (std::size_t age) const
+    {
+        return values_[(head_ + values_.size () - 1 - age) % values_.size ()];
+    }
+
+    /**
+     * clear: Removes all values (keeping the storage).
+     */
+    void clear ()
+    {
+        head_ = 0;
+        size_ = 0;
+    }
+};
+} // namespace cheferd
+
+#endif // CHEFERD_RING_BUFFER_HPP
@@ -156,6 +156,15 @@ public:
 
     static std::string convert_posix_definitions (const POSIX& posix_definitions);
 
+    /**
+     * convert_posix_mds_definition: Convert a metadata server definition (mdsN, with N between 1
+     * and posix_max_metadata_servers) from a string-based format to the corresponding long value.
+     * @param posix_definitions String-based definition of a metadata server.
+     * @return Returns posix_mds_base + N - 1, POSIX::no_op if the definition does not identify a
+     * metadata server, or -1 (and logs an error) if N is out of range.
+     */
+    static long convert_posix_mds_definition (const std::string& posix_definitions);
+
     /**
      * convert_posix_meta_definitions: Convert POSIX_META differentiation definitions from a
      * string-based format to the corresponding long value and vice-versa.
@@ -0,0 +1,339 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_SPSC_RING_HPP
+#define CHEFERD_SPSC_RING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cheferd {
+
+// Number of times a waiting side of an SpscRing polls the ring before yielding its processor.
+#define SPSC_RING_SPIN_ITERATIONS 256
+
+// Number of times a waiting side of an SpscRing yields its processor before parking.
+#define SPSC_RING_YIELD_ITERATIONS 16
+
+/**
+ * SpscRing class.
+ * Bounded lock-free single-producer/single-consumer queue. Entries live in a ring allocated once,
+ * at construction, and the producer and consumer indexes sit in their own cache lines, each next
+ * to the copy of the other side's index that its owner reads while the ring is neither full nor
+ * empty. A side that waits (for an entry, or for a free slot) spins, then yields, and only then
+ * parks on a condition variable; the other side takes the mutex to wake it only if it is parked.
+ * Several threads may act as the producer (or consumer) as long as they are serialized by the
+ * caller (e.g., by a mutex).
+ * Currently, the SpscRing class contains the following variables:
+ * - slots_: storage of the entries (its size is a power of two).
+ * - mask_: mask that maps an index to its slot.
+ * - tail_: index of the next entry to be pushed (written by the producer).
+ * - cached_head_: copy of head_ read by the producer.
+ * - head_: index of the next entry to be popped (written by the consumer).
+ * - cached_tail_: copy of tail_ read by the consumer.
+ * - producer_parked_, consumer_parked_: atomic bools that store if a side is parked.
+ * - park_lock_: mutex for concurrency control over the parking of both sides.
+ * - park_condition_: condition where parked sides wait.
+ */
+template <typename T>
+class SpscRing {
+
+private:
+    std::vector<T> slots_;
+    std::size_t mask_;
+    alignas (64) std::atomic<std::size_t> tail_;
+    std::size_t cached_head_;
+    alignas (64) std::atomic<std::size_t> head_;
+    std::size_t cached_tail_;
+    alignas (64) std::atomic<bool> producer_parked_;
+    std::atomic<bool> consumer_parked_;
+    std::mutex park_lock_;
+    std::condition_variable park_condition_;
+
+    /**
+     * ring_size: Gets the size of the ring for a capacity.
+     * @param capacity Requested capacity.
+     * @return Smallest power of two not below capacity (at least one).
+     */
+    static std::size_t ring_size (std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    /**
+     * relax: Hints the processor that the caller is spinning.
+     */
+    static void relax ()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause ();
+#elif defined(__aarch64__)
+        asm volatile ("yield");
+#endif
+    }
+
+    /**
+     * push_entry: Pushes an entry if the ring is not full, without waking the consumer.
+     * @param value Entry to be pushed (only moved from if pushed).
+     * @return Returns true if the entry was pushed, false if the ring is full.
+     */
+    bool push_entry (T&& value)
+    {
+        std::size_t tail = tail_.load (std::memory_order_relaxed);
+
+        if (tail - cached_head_ == slots_.size ()) {
+            cached_head_ = head_.load (std::memory_order_acquire);
+            if (tail - cached_head_ == slots_.size ()) {
+                return false;
+            }
+        }
+
+        slots_[tail & mask_] = std::move (value);
+        tail_.store (tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * pop_entry: Pops the oldest entry if the ring is not empty, without waking the producer.
+     * @param value Container to store the entry.
+     * @return Returns true if an entry was popped, false if the ring is empty.
+     */
+    bool pop_entry (T& value)
+    {
+        std::size_t head = head_.load (std::memory_order_relaxed);
+
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load (std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+
+        value = std::move (slots_[head & mask_]);
+        head_.store (head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * wake: Wakes the other side if it is parked. Must not be called while holding park_lock_.
+     * @param parked Parked flag of the other side.
+     */
+    void wake (const std::atomic<bool>& parked)
+    {
+        // pairs with the fence of wait: either the parked side sees the update, or it is seen
+        // as parked
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        if (parked.load (std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock_t { park_lock_ };
+            park_condition_.notify_all ();
+        }
+    }
+
+    /**
+     * wait: Waits until ready returns true, spinning (if there are several processors), then
+     * yielding, and then parking. As ready may be executed while holding park_lock_, it must not
+     * wake the other side.
+     * @param parked Parked flag of the waiting side.
+     * @param ready Condition to wait for (executed by the waiting side).
+     * @param deadline Time point until which the call waits (nullptr to wait indefinitely).
+     * @return Returns true if ready returned true, false if the deadline expired.
+     */
+    template <typename Ready>
+    bool wait (std::atomic<bool>& parked,
+        Ready ready,
+        const std::chrono::steady_clock::time_point* deadline)
+    {
+        // on a single processor, the other side cannot make progress while the caller spins
+        static const int spin_iterations
+            = std::thread::hardware_concurrency () > 1 ? SPSC_RING_SPIN_ITERATIONS : 0;
+
+        for (int i = 0; i < spin_iterations; i++) {
+            if (ready ()) {
+                return true;
+            }
+            relax ();
+        }
+
+        for (int i = 0; i < SPSC_RING_YIELD_ITERATIONS; i++) {
+            if (ready ()) {
+                return true;
+            }
+            std::this_thread::yield ();
+        }
+
+        std::unique_lock<std::mutex> lock_t { park_lock_ };
+        parked.store (true, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+
+        bool result = true;
+        if (deadline != nullptr) {
+            result = park_condition_.wait_until (lock_t, *deadline, ready);
+        } else {
+            park_condition_.wait (lock_t, ready);
+        }
+
+        parked.store (false, std::memory_order_relaxed);
+        return result;
+    }
+
+public:
+    /**
+     * SpscRing parameterized constructor.
+     * @param capacity Maximum number of entries held (rounded up to a power of two).
+     */
+    explicit SpscRing (std::size_t capacity) :
+        slots_ (ring_size (capacity)),
+        mask_ { slots_.size () - 1 },
+        tail_ { 0 },
+        cached_head_ { 0 },
+        head_ { 0 },
+        cached_tail_ { 0 },
+        producer_parked_ { false },
+        consumer_parked_ { false }
+    { }
+
+    /**
+     * try_push: Pushes an entry if the ring is not full (producer side).
+     * @param value Entry to be pushed (only moved from if pushed).
+     * @return Returns true if the entry was pushed, false if the ring is full.
+     */
+    bool try_push (T&& value)
+    {
+        if (!push_entry (std::move (value))) {
+            return false;
+        }
+
+        wake (consumer_parked_);
+        return true;
+    }
+
+    /**
+     * push: Pushes an entry, waiting while the ring is full (producer side).
+     * @param value Entry to be pushed.
+     */
+    void push (T value)
+    {
+        wait (
+            producer_parked_, [this, &value] { return push_entry (std::move (value)); }, nullptr);
+        wake (consumer_parked_);
+    }
+
+    /**
+     * try_pop: Pops the oldest entry if the ring is not empty (consumer side).
+     * @param value Container to store the entry.
+     * @return Returns true if an entry was popped, false if the ring is empty.
+     */
+    bool try_pop (T& value)
+    {
+        if (!pop_entry (value)) {
+            return false;
+        }
+
+        wake (producer_parked_);
+        return true;
+    }
+
+    /**
+     * pop: Pops the oldest entry, waiting while the ring is empty (consumer side).
+     * @return Entry popped.
+     */
+    T pop ()
+    {
+        T value {};
+        wait (
+            consumer_parked_, [this, &value] { return pop_entry (value); }, nullptr);
+        wake (producer_parked_);
+        return value;
+    }
+
+    /**
+     * pop: Pops the oldest entry, waiting while the ring is empty and active is set (consumer
+     * side). Parked consumers are woken to observe active through wake_consumer.
+     * @param value Container to store the entry.
+     * @param active Flag that stops the wait once cleared.
+     * @return Returns true if an entry was popped, false if active was cleared.
+     */
+    bool pop (T& value, const std::atomic<bool>& active)
+    {
+        bool popped = false;
+        wait (
+            consumer_parked_,
+            [this, &value, &active, &popped] {
+                popped = active.load () && pop_entry (value);
+                return popped || !active.load ();
+            },
+            nullptr);
+
+        if (popped) {
+            wake (producer_parked_);
+        }
+        return popped;
+    }
+
+    /**
+     * pop_until: Pops the oldest entry, waiting at most until deadline (consumer side).
+     * @param value Container to store the entry.
+     * @param deadline Time point until which the call waits for an entry.
+     * @return Returns true if an entry was popped, false if the deadline expired.
+     */
+    bool pop_until (T& value, const std::chrono::steady_clock::time_point& deadline)
+    {
+        if (!wait (
+                consumer_parked_, [this, &value] { return pop_entry (value); }, &deadline)) {
+            return false;
+        }
+
+        wake (producer_parked_);
+        return true;
+    }
+
+    /**
+     * wake_consumer: Wakes a parked consumer so that it re-evaluates its wait (e.g., the active
+     * flag of pop).
+     */
+    void wake_consumer ()
+    {
+        std::lock_guard<std::mutex> lock_t { park_lock_ };
+        park_condition_.notify_all ();
+    }
+
+    /**
+     * size: Gets the number of entries held (a snapshot, if the ring is in use).
+     */
+    std::size_t size () const
+    {
+        std::size_t head = head_.load (std::memory_order_acquire);
+        return tail_.load (std::memory_order_acquire) - head;
+    }
+
+    /**
+     * empty: Verifies if the ring holds no entries (a snapshot, if the ring is in use).
+     */
+    bool empty () const
+    {
+        return size () == 0;
+    }
+
+    /**
+     * capacity: Gets the maximum number of entries held.
+     */
+    std::size_t capacity () const
+    {
+        return slots_.size ();
+    }
+};
+} // namespace cheferd
+
+#endif // CHEFERD_SPSC_RING_HPP
@@ -0,0 +1,99 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#ifndef CHEFERD_TRIPLE_BUFFER_HPP
+#define CHEFERD_TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace cheferd {
+
+/**
+ * TripleBuffer class.
+ * Lock-free single-producer/single-consumer latest-value container. The producer fills the back
+ * buffer and publishes it; the consumer picks the most recent published buffer without ever
+ * blocking the producer (intermediate values may be skipped).
+ * Currently, the TripleBuffer class contains the following variables:
+ * - buffers_: the three buffers (back, middle, and front).
+ * - middle_: index of the middle buffer, with FRESH_BIT set when it holds an unread value.
+ * - back_: index of the buffer owned by the producer.
+ * - front_: index of the buffer owned by the consumer.
+ */
+template <typename T>
+class TripleBuffer {
+
+private:
+    static constexpr uint8_t FRESH_BIT = 0x4;
+    static constexpr uint8_t INDEX_MASK = 0x3;
+
+    T buffers_[3];
+    std::atomic<uint8_t> middle_;
+    uint8_t back_;
+    uint8_t front_;
+
+public:
+    /**
+     * TripleBuffer default constructor.
+     */
+    TripleBuffer () : buffers_ {}, middle_ { 1 }, back_ { 0 }, front_ { 2 }
+    { }
+
+    /**
+     * TripleBuffer parameterized constructor.
+     * @param value Initial value of the three buffers.
+     */
+    explicit TripleBuffer (const T& value) :
+        buffers_ { value, value, value },
+        middle_ { 1 },
+        back_ { 0 },
+        front_ { 2 }
+    { }
+
+    /**
+     * back: Get the buffer to be filled by the producer.
+     * @return Reference to the back buffer.
+     */
+    T& back ()
+    {
+        return buffers_[back_];
+    }
+
+    /**
+     * publish: Publishes the back buffer (producer side).
+     */
+    void publish ()
+    {
+        uint8_t previous = middle_.exchange (back_ | FRESH_BIT, std::memory_order_acq_rel);
+        back_ = previous & INDEX_MASK;
+    }
+
+    /**
+     * update: Moves the latest published value to the front buffer (consumer side).
+     * @return Returns true if a new value was published since the last update, false otherwise.
+     */
+    bool update ()
+    {
+        if ((middle_.load (std::memory_order_relaxed) & FRESH_BIT) == 0) {
+            return false;
+        }
+
+        uint8_t previous = middle_.exchange (front_, std::memory_order_acq_rel);
+        front_ = previous & INDEX_MASK;
+
+        return true;
+    }
+
+    /**
+     * front: Get the value read by the consumer.
+     * @return Reference to the front buffer.
+     */
+    const T& front () const
+    {
+        return buffers_[front_];
+    }
+};
+} // namespace cheferd
+
+#endif // CHEFERD_TRIPLE_BUFFER_HPP
@@ -0,0 +1,60 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <cheferd/controller/adaptive_period.hpp>
+#include <cmath>
+
+namespace cheferd {
+
+// AdaptivePeriod parameterized constructor.
+AdaptivePeriod::AdaptivePeriod (uint64_t min_period, uint64_t max_period) :
+    min_period_ { std::clamp<uint64_t> (min_period,
+        PERIOD_MIN_BOUND,
+        std::max<uint64_t> (max_period, PERIOD_MIN_BOUND)) },
+    max_period_ { std::max<uint64_t> (max_period, PERIOD_MIN_BOUND) },
+    period_ { max_period_ },
+    last_rate_ { 0 },
+    last_demand_ { 0 }
+{ }
+
+// AdaptivePeriod default destructor.
+AdaptivePeriod::~AdaptivePeriod () = default;
+
+// relative_change call. Computes the relative change between two values.
+double AdaptivePeriod::relative_change (double previous, double current)
+{
+    return std::abs (current - previous) / std::max (std::abs (previous), 1.0);
+}
+
+// update call. Chooses the period of the next cycle from the workload observed in this cycle.
+uint64_t AdaptivePeriod::update (double observed_rate, double demand, bool system_changed)
+{
+    bool changed
+        = system_changed || relative_change (last_demand_, demand) > PERIOD_CHANGE_THRESHOLD;
+    last_demand_ = demand;
+
+    // cycles without statistics (e.g., DYNAMIC_LEFTOVER aggregation rounds) keep the last rate
+    if (observed_rate >= 0) {
+        changed = changed || relative_change (last_rate_, observed_rate) > PERIOD_CHANGE_THRESHOLD;
+        last_rate_ = observed_rate;
+    }
+
+    if (changed) {
+        period_ = std::max (min_period_, period_ / 2);
+    } else {
+        period_ = std::min (max_period_,
+            std::max (period_ + 1, static_cast<uint64_t> (period_ * PERIOD_RELAX_FACTOR)));
+    }
+
+    return period_;
+}
+
+// period call. Gets the current period.
+uint64_t AdaptivePeriod::period () const
+{
+    return period_;
+}
+
+} // namespace cheferd
@@ -10,7 +10,12 @@ namespace cheferd {
 Controller::Controller (ControlType control_type,
     std::string& core_address,
     const uint64_t& cycle_sleep_time,
-    long system_limit) :
+    uint64_t min_cycle_period,
+    long system_limit,
+    const std::map<std::string, long>& operation_limits,
+    int local_interface_pollers,
+    uint64_t statistics_stream_period,
+    std::size_t history_max_stages) :
     m_system_admin { control_type },
     m_housekeeping_rules {}
 {
@@ -19,7 +24,12 @@ Controller::Controller (ControlType control_type,
     m_control_application = new CoreControlApplication (control_type,
         &m_housekeeping_rules,
         cycle_sleep_time,
-        system_limit);
+        min_cycle_period,
+        system_limit,
+        operation_limits,
+        local_interface_pollers,
+        statistics_stream_period,
+        history_max_stages);
 }
 
 // Local Controller parameterized constructor.
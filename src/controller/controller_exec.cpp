@@ -3,6 +3,7 @@
  **/
 
 #include <cheferd/controller/controller.hpp>
+#include <cheferd/networking/metrics_server.hpp>
 #include <cheferd/session/policy_generator.hpp>
 #include <cheferd/utils/command_line_parser.hpp>
 #include <cheferd/utils/config_file_parser.hpp>
@@ -32,6 +33,20 @@ int main (int argc, char** argv)
     std::string housekeeping_rules_file = configFileParser.housekeeping_rules_file;
     std::string policies_rules_file = configFileParser.policies_rules_file;
     long system_limit = configFileParser.system_limit;
+    std::map<std::string, long> operation_limits = configFileParser.operation_limits;
+    int local_interface_pollers = configFileParser.local_interface_pollers;
+    uint64_t statistics_stream_period = configFileParser.statistics_stream_period;
+    std::size_t history_max_stages = configFileParser.history_max_stages;
+    uint64_t min_cycle_period = configFileParser.min_cycle_period;
+    uint64_t max_cycle_period = configFileParser.max_cycle_period;
+    int metrics_port = configFileParser.metrics_port;
+    std::string metrics_address = configFileParser.metrics_address;
+
+    // serve metrics (in the background) for as long as the controller runs
+    MetricsServer metrics_server { metrics_address, metrics_port };
+    if (metrics_port > 0) {
+        metrics_server.start ();
+    }
 
     switch (controller_type) {
         case ControllerType::CORE: {
@@ -39,8 +54,13 @@ int main (int argc, char** argv)
             // create Controller
             Controller controller { control_type,
                 core_address,
-                option_default_control_application_sleep,
-                system_limit };
+                max_cycle_period,
+                min_cycle_period,
+                system_limit,
+                operation_limits,
+                local_interface_pollers,
+                statistics_stream_period,
+                history_max_stages };
 
             // create housekeeping rules files path list
             std::string housekeeping_rules_files_t {};
@@ -4,6 +4,7 @@
 
 #include <cheferd/controller/core_control_application.hpp>
 #include <cheferd/utils/rules_file_parser.hpp>
+#include <cmath>
 
 extern "C" {
 #include <fcntl.h>
@@ -16,25 +17,68 @@ namespace cheferd {
 CoreControlApplication::CoreControlApplication (ControlType control_type,
     std::vector<std::string>* rules_ptr,
     const uint64_t& cycle_sleep_time,
-    long system_limit) :
+    uint64_t min_cycle_period,
+    long system_limit,
+    const std::map<std::string, long>& operation_limits,
+    int local_interface_pollers,
+    uint64_t statistics_stream_period,
+    std::size_t history_max_stages) :
     ControlApplication { rules_ptr, cycle_sleep_time },
     change_in_system { false },
+    m_feedback_loop_event_pending { false },
     local_queue {},
     local_to_data_queue_ {},
     m_control_type { control_type },
     local_sessions_ {},
     local_to_stages {},
     stage_info_detailed {},
-    job_location_tracker {},
-    job_demands {},
-    job_rates {},
-    job_previous_rates {},
+    job_table {},
     maximum_limit { system_limit },
+    operation_limits { operation_limits },
     active_ops {},
+    channel_operations {},
+    water_filling_allocator {},
+    allocation_demands {},
+    allocation_rates {},
+    job_usage {},
+    job_maintain_rate {},
+    local_stats_samples {},
+    stage_history_ { option_default_history_length, history_max_stages },
+    job_history_ { option_default_history_length, option_default_history_max_jobs },
+    history_job_rates {},
+    m_collect_deadline { std::min (option_default_collect_deadline, cycle_sleep_time) },
+    m_collect_max_misses { option_default_collect_max_misses },
+    local_interface_poller_ { local_interface_pollers > 0
+            ? std::make_unique<LocalInterfacePoller> (local_interface_pollers)
+            : nullptr },
+    m_statistics_stream_period { statistics_stream_period },
+    cycle_period_ { min_cycle_period, cycle_sleep_time },
+    m_cycle_period { cycle_sleep_time },
+    last_aggregated_collection_ {},
     m_active_local_controller_sessions { 0 },
     m_pending_local_controller_sessions { 0 },
     m_active_data_plane_sessions { 0 },
-    m_pending_data_plane_sessions { 0 }
+    m_pending_data_plane_sessions { 0 },
+    phase_start_ {},
+    collect_phase_metric_ { Metrics::histogram ("cheferd_cycle_phase_seconds",
+        "Duration of the phases of the feedback loop cycle.",
+        "phase=\"collect\"") },
+    compute_phase_metric_ { Metrics::histogram ("cheferd_cycle_phase_seconds",
+        "Duration of the phases of the feedback loop cycle.",
+        "phase=\"compute\"") },
+    enforce_phase_metric_ { Metrics::histogram ("cheferd_cycle_phase_seconds",
+        "Duration of the phases of the feedback loop cycle.",
+        "phase=\"enforce\"") },
+    cycle_metric_ { Metrics::histogram ("cheferd_cycle_seconds",
+        "Duration of the feedback loop cycle (without sleeping).") },
+    cycles_metric_ { Metrics::counter ("cheferd_cycles_total",
+        "Number of feedback loop cycles executed.") },
+    cycle_period_metric_ { Metrics::gauge ("cheferd_cycle_period_seconds",
+        "Period chosen for the current feedback loop cycle.") },
+    enforced_rules_metric_ { Metrics::counter ("cheferd_enforcement_rules_total",
+        "Number of enforcement rules sent to data plane stages.") },
+    skipped_rules_metric_ { Metrics::counter ("cheferd_enforcement_rules_skipped_total",
+        "Number of enforcement rules skipped because the rate did not change enough.") }
 {
     Logging::log_info ("CoreControlApplication parameterized constructor.");
 }
@@ -60,6 +104,7 @@ void CoreControlApplication::register_local_controller_session (
     pending_register_session_lock_.unlock ();
 
     this->m_pending_local_controller_sessions.fetch_add (1);
+    notify_feedback_loop ();
 }
 
 // register_stage_session call. Register a new data plane.
@@ -83,6 +128,7 @@ void CoreControlApplication::register_stage_session (const std::string& local_co
     pending_register_stage_lock_.unlock ();
 
     this->m_pending_data_plane_sessions.fetch_add (1);
+    notify_feedback_loop ();
 }
 
 ////////////////////////////////////////////
@@ -99,11 +145,41 @@ void CoreControlApplication::operator() ()
 void CoreControlApplication::stop_feedback_loop ()
 {
     working_application_ = false;
+    notify_feedback_loop ();
+
     for (auto const& local_session : local_sessions_) {
         local_session.second->RemoveSession ();
     }
 }
 
+// notify_feedback_loop call. Signals an event (e.g., registration, new rule) to the feedback loop.
+void CoreControlApplication::notify_feedback_loop ()
+{
+    {
+        std::lock_guard<std::mutex> guard (feedback_loop_event_lock_);
+        m_feedback_loop_event_pending = true;
+    }
+    feedback_loop_event_.notify_one ();
+}
+
+// wait_for_feedback_loop_event call. Blocks until an event is signaled, the feedback loop is
+// stopped, or the deadline expires.
+bool CoreControlApplication::wait_for_feedback_loop_event (
+    const steady_clock::time_point& deadline)
+{
+    std::unique_lock<std::mutex> lock (feedback_loop_event_lock_);
+    return feedback_loop_event_.wait_until (lock, deadline, [this] {
+        return m_feedback_loop_event_pending || !working_application_.load ();
+    }) && m_feedback_loop_event_pending;
+}
+
+// clear_feedback_loop_event call. Clears pending events, at the start of each cycle.
+void CoreControlApplication::clear_feedback_loop_event ()
+{
+    std::lock_guard<std::mutex> guard (feedback_loop_event_lock_);
+    m_feedback_loop_event_pending = false;
+}
+
 // execute_feedback_loop call. Executes feedback loop.
 void CoreControlApplication::execute_feedback_loop ()
 {
@@ -113,13 +189,16 @@ void CoreControlApplication::execute_feedback_loop ()
     PStatus status = PStatus::Error ();
     working_application_ = true;
 
-    while (working_application_.load () && this->m_pending_local_controller_sessions.load () == 0) {
-        std::this_thread::sleep_for (milliseconds (100));
+    // block until the first local controller registers (or the feedback loop is stopped)
+    {
+        std::unique_lock<std::mutex> lock (feedback_loop_event_lock_);
+        feedback_loop_event_.wait (lock, [this] {
+            return !working_application_.load ()
+                || this->m_pending_local_controller_sessions.load () > 0;
+        });
     }
 
     int rounds_counter = 0;
-    std::list<std::string> session_temp = {};
-    std::list<std::string>& sessions_sent = session_temp;
 
     while (working_application_.load ()
         && (this->m_pending_local_controller_sessions.load ()
@@ -128,6 +207,11 @@ void CoreControlApplication::execute_feedback_loop ()
             > 0) {
 
         auto start = std::chrono::steady_clock::now ();
+        // total rate observed in this cycle (negative if no statistics were collected)
+        double observed_rate = -1;
+
+        // events signaled from now on are handled by the next cycle
+        clear_feedback_loop_event ();
 
         while (this->m_pending_local_controller_sessions.load () > 0) {
             handle_local_controller_sessions ();
@@ -137,41 +221,57 @@ void CoreControlApplication::execute_feedback_loop ()
             handle_data_plane_sessions ();
         }
 
+        phase_start_ = std::chrono::steady_clock::now ();
+
         switch (m_control_type) {
             case ControlType::STATIC: {
                 const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats
                     = this->collect_statistics_global ();
 
-                auto end = std::chrono::steady_clock::now ();
-                Logging::log_debug ("Latency Collect= "
-                    + std::to_string (
-                        std::chrono::duration_cast<std::chrono::microseconds> (end - start)
-                            .count ())
-                    + "[µs]");
+                end_phase (collect_phase_metric_);
 
                 if (this->m_active_local_controller_sessions.load () > 0)
                     this->compute_and_enforce_static_rules (d_stats);
 
+                observed_rate = total_observed_rate (d_stats);
+                record_history (d_stats);
+
                 break;
             }
             case ControlType::DYNAMIC_VANILLA: {
                 const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats
                     = this->collect_statistics_global ();
+                end_phase (collect_phase_metric_);
 
                 this->compute_and_enforce_dynamic_vanilla_rules (d_stats);
+                observed_rate = total_observed_rate (d_stats);
+                record_history (d_stats);
                 break;
             }
-            case ControlType::DYNAMIC_LEFTOVER: {
-                if (rounds_counter == 0) {
-                    sessions_sent = this->collect_statistics_global_send ();
-                }
+            case ControlType::DYNAMIC_WATER_FILLING:
+            case ControlType::MDS: {
+                const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats
+                    = this->collect_statistics_global ();
+                end_phase (collect_phase_metric_);
 
+                this->compute_and_enforce_water_filling_rules (d_stats);
+                observed_rate = total_observed_rate (d_stats);
+                record_history (d_stats);
+                break;
+            }
+            case ControlType::DYNAMIC_LEFTOVER: {
+                // local controllers sample their stages in the background, so the statistics
+                // aggregated over the last rounds are requested and collected in the same cycle
                 rounds_counter++;
                 if (rounds_counter == COLLECT_ROUNDS) {
+                    std::list<std::string> sessions_sent = this->collect_statistics_global_send ();
                     const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats
                         = this->collect_statistics_global_collect (sessions_sent);
+                    end_phase (collect_phase_metric_);
 
                     this->compute_and_enforce_dynamic_leftover_rules (d_stats, sessions_sent);
+                    observed_rate = total_observed_rate (d_stats);
+                    record_history (d_stats);
                     rounds_counter = 0;
                 }
                 break;
@@ -181,17 +281,29 @@ void CoreControlApplication::execute_feedback_loop ()
                 break;
         }
 
+        // 3rd phase: choose the period of the next cycle from the changes in the workload
+        uint64_t period = cycle_period_.update (observed_rate,
+            total_demand (),
+            change_in_system.load ());
+
+        if (m_cycle_period.exchange (period) != period) {
+            Logging::log_info ("Cycle Period= " + std::to_string (period) + "[µs]");
+        }
+
         change_in_system = false;
 
-        auto end = std::chrono::steady_clock::now ();
-        // 3rd phase: sleep for the next feedback loop cycle
-        Logging::log_debug ("Latency Round= "
-            + std::to_string (
-                std::chrono::duration_cast<std::chrono::microseconds> (end - start).count ())
-            + "[µs]");
+        cycle_metric_.observe_since (start);
+        cycles_metric_.increment ();
+        cycle_period_metric_.set (period / 1e6);
+
+        // 4th phase: sleep for the next feedback loop cycle
 
-        std::this_thread::sleep_for (microseconds (this->m_feedback_loop_sleep_time
-            - std::chrono::duration_cast<std::chrono::microseconds> (end - start).count ()));
+        // registrations and new rules start the next cycle right away (out-of-cycle
+        // recompute), instead of waiting for the remainder of the period
+        auto next_cycle = start + microseconds (period);
+        if (wait_for_feedback_loop_event (next_cycle)) {
+            Logging::log_debug ("CoreControlApplication: event received, starting cycle early.");
+        }
     }
 
     // log message and end control loop
@@ -204,23 +316,37 @@ void CoreControlApplication::execute_feedback_loop ()
 ////////////////////////////////////////////
 
 // collect_statistics_global_send call. Sends to local controllers the request to collect
-// statistics.
+// aggregated statistics.
 std::list<std::string> CoreControlApplication::collect_statistics_global_send ()
 {
     Logging::log_debug ("ControlApplication:collect_statistics_global_send");
 
     std::list<std::string> sessions_sent {};
 
-    // create COLLECT_GLOBAL_STATS request
-    std::string rule = std::to_string (COLLECT_DETAILED_STATS) + "|"
-        + std::to_string (COLLECT_GLOBAL_STATS_AGGREGATED) + "|";
+    // aggregate the samples taken since the previous request (COLLECT_ROUNDS periods at first)
+    auto now = std::chrono::steady_clock::now ();
+    uint64_t window = last_aggregated_collection_.time_since_epoch ().count () == 0
+        ? COLLECT_ROUNDS * m_cycle_period.load ()
+        : static_cast<uint64_t> (std::chrono::duration_cast<std::chrono::microseconds> (
+            now - last_aggregated_collection_)
+                                     .count ());
+    last_aggregated_collection_ = now;
+
+    // create COLLECT_GLOBAL_STATS_AGGREGATED request (window, all samples within it)
+    ControlCommand command { COLLECT_DETAILED_STATS,
+        COLLECT_GLOBAL_STATS_AGGREGATED,
+        StatisticsWindow { window, 0 } };
 
     // submit requests to each LocalControllerSession's submission_queue
     for (auto const& local_session : local_sessions_) {
         // put request on LocalControllerSession::submission_queue
         if (local_to_stages.find (local_session.first) != local_to_stages.end ()
-            && !local_to_stages.at (local_session.first).empty ()) {
-            local_session.second->SubmitRule (rule);
+            && !local_to_stages.at (local_session.first).empty ()
+            && is_local_available (local_session.first)) {
+            // streamed statistics are pushed by the local controller
+            if (m_statistics_stream_period == 0) {
+                local_session.second->SubmitRule (command);
+            }
             sessions_sent.push_back (local_session.first);
         }
     }
@@ -237,19 +363,43 @@ CoreControlApplication::collect_statistics_global_collect (std::list<std::string
     std::unordered_map<std::string, std::unique_ptr<StageResponse>> collected_stats {};
     std::list<std::string> sessions_to_delete;
 
+    // responses that arrive after the deadline are served from the last known sample; the
+    // deadline does not depend on the cycle period, so shorter cycles do not cause misses
+    auto deadline = std::chrono::steady_clock::now () + microseconds (m_collect_deadline);
+
     // collect requests from each DataPlaneSession's completion_queue
     for (auto const& local_session : local_sessions_) {
         std::string local_address = local_session.first;
 
-        // wait for request to be on DataPlaneSession::completion_queue
-        if (std::find (sessions_sent.begin (), sessions_sent.end (), local_address)
-                != sessions_sent.end ()
-            && local_to_stages.find (local_address) != local_to_stages.end ()
-            && !local_to_stages.at (local_address).empty ()) {
-            collect_statistics_result (local_session.second,
+        if (local_to_stages.find (local_address) == local_to_stages.end ()
+            || local_to_stages.at (local_address).empty ()) {
+            continue;
+        }
+
+        std::unique_ptr<StageResponse> stats_ptr {};
+        bool missed = true;
+
+        if (m_statistics_stream_period > 0) {
+            // read the latest statistics pushed through the local controller's stream; it only
+            // misses the deadline if nothing was pushed for a whole stream period
+            stats_ptr = local_session.second->GetLatestStatistics ();
+            missed = stats_ptr == nullptr
+                && std::chrono::steady_clock::now ()
+                        - local_session.second->LatestStatisticsTime ()
+                    > microseconds (m_statistics_stream_period + m_collect_deadline);
+        } else if (std::find (sessions_sent.begin (), sessions_sent.end (), local_address)
+            != sessions_sent.end ()) {
+            // wait for request to be on DataPlaneSession::completion_queue
+            stats_ptr = local_session.second->GetResult (deadline);
+        }
+
+        if (stats_ptr != nullptr) {
+            collect_statistics_result (std::move (stats_ptr),
                 local_address,
                 sessions_to_delete,
                 collected_stats);
+        } else {
+            use_last_statistics_sample (local_address, collected_stats, missed);
         }
     }
 
@@ -259,6 +409,14 @@ CoreControlApplication::collect_statistics_global_collect (std::list<std::string
             + local_session);
         this->m_active_local_controller_sessions.fetch_sub (1);
         local_sessions_.erase (local_session);
+        local_stats_samples.erase (local_session);
+        collected_stats.erase (local_session);
+    }
+
+    // only report local controllers whose statistics are available
+    sessions_sent.clear ();
+    for (auto const& local_stats : collected_stats) {
+        sessions_sent.push_back (local_stats.first);
     }
 
     return collected_stats;
@@ -270,46 +428,26 @@ CoreControlApplication::collect_statistics_global ()
 {
     Logging::log_debug ("ControlApplication:collect_statistics_global");
 
-    std::unordered_map<std::string, std::unique_ptr<StageResponse>> collected_stats {};
+    std::list<std::string> sessions_sent {};
 
     // create COLLECT_GLOBAL_STATS request
-    std::string rule = std::to_string (COLLECT_DETAILED_STATS) + "|"
-        + std::to_string (COLLECT_GLOBAL_STATS) + "|";
+    ControlCommand command { COLLECT_DETAILED_STATS, COLLECT_GLOBAL_STATS };
 
     // submit requests to each LocalControllerSession's submission_queue
     for (auto const& local_session : local_sessions_) {
         // put request on LocalControllerSession::submission_queue
         if (local_to_stages.find (local_session.first) != local_to_stages.end ()
-            && !local_to_stages.at (local_session.first).empty ()) {
-            local_session.second->SubmitRule (rule);
-        }
-    }
-
-    std::list<std::string> sessions_to_delete;
-
-    // collect requests from each DataPlaneSession's completion_queue
-    for (auto const& local_session : local_sessions_) {
-        std::string local_address = local_session.first;
-
-        // wait for request to be on DataPlaneSession::completion_queue
-        if (local_to_stages.find (local_address) != local_to_stages.end ()
-            && !local_to_stages.at (local_address).empty ()) {
-            collect_statistics_result (local_session.second,
-                local_address,
-                sessions_to_delete,
-                collected_stats);
+            && !local_to_stages.at (local_session.first).empty ()
+            && is_local_available (local_session.first)) {
+            // streamed statistics are pushed by the local controller
+            if (m_statistics_stream_period == 0) {
+                local_session.second->SubmitRule (command);
+            }
+            sessions_sent.push_back (local_session.first);
         }
     }
 
-    for (auto const& local_session : sessions_to_delete) {
-        Logging::log_error (
-            "collect_statistics_global2: Connection error; disconnecting from instance-"
-            + local_session);
-        this->m_active_local_controller_sessions.fetch_sub (1);
-        local_sessions_.erase (local_session);
-    }
-
-    return collected_stats;
+    return collect_statistics_global_collect (sessions_sent);
 }
 
 ////////////////////////////////////////////
@@ -337,35 +475,42 @@ void CoreControlApplication::compute_and_enforce_static_rules (
         change_in_system = true;
     }
 
-    std::string operation = active_op;
-
     Logging::log_debug ("ControlApplication: Computing Static Rules ");
 
     if (change_in_system.load ()) {
-        int current_jobs = job_location_tracker.size ();
+        const std::vector<int>& active_jobs = job_table.active_jobs ();
 
         Logging::log_debug (
-            "ControlApplication: Change in system: " + std::to_string (current_jobs));
+            "ControlApplication: Change in system: " + std::to_string (active_jobs.size ()));
+
+        if (!active_jobs.empty ()) {
+            // every operation is enforced in the same cycle
+            for (int op = 0; op < job_table.total_operations (); op++) {
+                const std::vector<long>& demands = job_table.demands (op);
+                std::vector<long>& rates = job_table.rates (op);
+                std::vector<long>& previous_rates = job_table.previous_rates (op);
+
+                for (int job : active_jobs) {
+                    // jobs without a demand for the operation are not limited
+                    if (demands[job] == UNBOUNDED_DEMAND) {
+                        continue;
+                    }
 
-        if (current_jobs > 0) {
-            for (auto const& job_demand : job_demands) {
-                if (job_demand.second != -1) {
-                    job_rates[job_demand.first] = job_demand.second;
-                }
-            }
+                    rates[job] = demands[job];
 
-            std::unordered_map<std::string, bool> job_address_updated;
-            for (auto const& app : job_location_tracker) {
-                // validate if assigned rate surpasses the changing bandwidth threshold
-                if (abs (job_rates[app.first] - job_previous_rates[app.first]) < IOPS_THRESHOLD) {
-                    job_rates[app.first] = -1;
-                } else {
-                    send_enforcement_rule (app.first, app.second, operation, job_address_updated);
+                    // validate if assigned rate surpasses the changing bandwidth threshold
+                    if (abs (rates[job] - previous_rates[job]) < IOPS_THRESHOLD) {
+                        rates[job] = -1;
+                        skipped_rules_metric_.increment ();
+                    } else {
+                        send_enforcement_rule (job, op);
+                    }
                 }
             }
 
-            /*Collect result from rules */
-            collect_enforcement_rule_results (job_address_updated);
+            /*Submit one batch per local controller and collect result from rules */
+            submit_enforcement_rules ();
+            collect_enforcement_rule_results ();
         }
     }
 }
@@ -375,56 +520,125 @@ void CoreControlApplication::compute_and_enforce_dynamic_vanilla_rules (
     const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats)
 {
     // Check if there is any change in the job's demands.
-    std::string operation = update_job_demands ();
+    update_job_demands ();
 
     // Check if there are active jobs to control.
-    long current_jobs = job_location_tracker.size ();
-    if (current_jobs > 0) {
+    const std::vector<int>& active_jobs = job_table.active_jobs ();
+    if (active_jobs.empty ()) {
+        return;
+    }
+
+    // Each operation shares its own capacity.
+    for (int op = 0; op < job_table.total_operations (); op++) {
+        const std::vector<long>& demands = job_table.demands (op);
+        std::vector<long>& rates = job_table.rates (op);
+        std::vector<long>& previous_rates = job_table.previous_rates (op);
+        long current_jobs = active_jobs.size ();
 
         // Assign all bandwidth to leftover_iops
-        long left_iops = maximum_limit;
+        long left_iops = job_table.capacity (op);
 
         // First phase: For each job assign either fair share or demand.
-        for (auto const& app : job_location_tracker) {
+        for (int job : active_jobs) {
+            long demand = demands[job];
 
             // If job's demand is less than fair share, assign demand
-            if (job_demands[app.first] <= (left_iops / current_jobs)) {
-                if (job_demands[app.first] == -1) {
-                    job_demands[app.first] = 1;
+            if (demand <= (left_iops / current_jobs)) {
+                if (demand == UNBOUNDED_DEMAND) {
+                    demand = 1;
                 }
-                job_rates[app.first] = job_demands[app.first];
+                rates[job] = demand;
             } else {
                 // If job's demand is greater than fair share, assign fair share
-                job_rates[app.first] = (left_iops / current_jobs);
+                rates[job] = (left_iops / current_jobs);
             }
 
             current_jobs--;
 
             // Consume assigned IOPS
-            left_iops -= job_rates[app.first];
+            left_iops -= rates[job];
         }
 
-        operation = active_op;
-        current_jobs = job_location_tracker.size ();
-        std::unordered_map<std::string, bool> job_address_updated;
+        current_jobs = active_jobs.size ();
 
         // Second phase: Distribute leftover bandwidth.
-        for (auto const& app : job_location_tracker) {
+        for (int job : active_jobs) {
             // Distribute equally any leftover bandwidth
-            job_rates[app.first] += (left_iops / current_jobs);
+            rates[job] += (left_iops / current_jobs);
 
             // Validate if assigned rate surpasses the changing bandwidth threshold
             if (!change_in_system.load ()
-                && abs (job_rates[app.first] - job_previous_rates[app.first]) < IOPS_THRESHOLD) {
-                job_rates[app.first] = -1;
+                && abs (rates[job] - previous_rates[job]) < IOPS_THRESHOLD) {
+                rates[job] = -1;
+                skipped_rules_metric_.increment ();
             } else {
-                send_enforcement_rule (app.first, app.second, operation, job_address_updated);
+                send_enforcement_rule (job, op);
             }
         }
+    }
+
+    /*Submit one batch per local controller and collect result from rules */
+    submit_enforcement_rules ();
+    collect_enforcement_rule_results ();
+}
+
+// compute_and_enforce_water_filling_rules call. Computes and enforces DYNAMIC_WATER_FILLING
+// and MDS policies.
+void CoreControlApplication::compute_and_enforce_water_filling_rules (
+    const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats)
+{
+    // Check if there is any change in the job's demands or in the operations' capacities.
+    update_job_demands ();
+
+    // Check if there are active jobs to control.
+    const std::vector<int>& active_jobs = job_table.active_jobs ();
+    if (active_jobs.empty ()) {
+        return;
+    }
+
+    // Each operation (e.g., each metadata server in MDS) is shared independently, and its rules
+    // are enforced at its channel.
+    for (int op = 0; op < job_table.total_operations (); op++) {
+        const std::vector<long>& demands = job_table.demands (op);
+        std::vector<long>& rates = job_table.rates (op);
+        std::vector<long>& previous_rates = job_table.previous_rates (op);
+
+        // active jobs are ordered by registration, which breaks ties between equal demands
+        allocation_demands.clear ();
+        for (int job : active_jobs) {
+            allocation_demands.push_back (demands[job]);
+        }
 
-        /*Collect result from rules */
-        collect_enforcement_rule_results (job_address_updated);
+        long left_iops = water_filling_allocator.allocate (allocation_demands,
+            job_table.capacity (op),
+            allocation_rates);
+
+        if (Logging::is_debug_enabled ()) {
+            Logging::log_debug ("ControlApplication: Water-filling allocation of "
+                + job_table.operations ().name (op) + " ("
+                + std::to_string (job_table.capacity (op)) + ") among "
+                + std::to_string (active_jobs.size ()) + " jobs (" + std::to_string (left_iops)
+                + " unallocated)");
+        }
+
+        for (std::size_t i = 0; i < active_jobs.size (); i++) {
+            int job = active_jobs[i];
+            rates[job] = allocation_rates[i];
+
+            // Validate if assigned rate surpasses the changing bandwidth threshold
+            if (!change_in_system.load ()
+                && abs (rates[job] - previous_rates[job]) < IOPS_THRESHOLD) {
+                rates[job] = -1;
+                skipped_rules_metric_.increment ();
+            } else {
+                send_enforcement_rule (job, op);
+            }
+        }
     }
+
+    /*Submit one batch per local controller and collect result from rules */
+    submit_enforcement_rules ();
+    collect_enforcement_rule_results ();
 }
 
 // compute_and_enforce_dynamic_leftover_rules call. Computes and enforces DYNAMIC_LEFTOVER policies.
@@ -434,146 +648,320 @@ void CoreControlApplication::compute_and_enforce_dynamic_leftover_rules (
 {
 
     // Check if there is any change in the job's demands.
-    std::string operation = update_job_demands ();
+    update_job_demands ();
 
     // Check if there are active jobs to control.
-    long current_jobs = job_location_tracker.size ();
-    if (current_jobs > 0) {
+    const std::vector<int>& active_jobs = job_table.active_jobs ();
+    if (!active_jobs.empty ()) {
 
-        // Assign all bandwidth to leftover_iops
-        unsigned long left_iops = maximum_limit;
+        // Data plane stages report the usage of each operation (through their channels).
+        load_stage_usage (d_stats, sessions_sent);
+
+        job_usage.resize (job_table.jobs ().size ());
+        job_maintain_rate.resize (job_table.jobs ().size ());
+
+        // Each operation shares its own capacity, according to its own usage.
+        for (int op = 0; op < job_table.total_operations (); op++) {
+            const std::vector<double>& stage_usage = job_table.stage_usage (op);
+            unsigned long system_total_rate = 0;
+
+            for (int job : active_jobs) {
+                long total_app_rate = 0;
+                for (auto const& [local, stages] : job_table.job_locations (job)) {
+                    for (int stage : stages) {
+                        total_app_rate += stage_usage[stage];
+                    }
+                }
 
-        std::unordered_map<std::string, unsigned long> per_app_usage;
-        unsigned long system_total_rate = 0;
+                job_usage[job] = total_app_rate;
+                system_total_rate += total_app_rate;
+            }
 
-        for (auto const& app : job_location_tracker) {
-            long total_app_rate = 0;
-            for (auto const& [local_address, envs] : app.second) {
+            const std::vector<long>& demands = job_table.demands (op);
+            std::vector<long>& rates = job_table.rates (op);
+            std::vector<long>& previous_rates = job_table.previous_rates (op);
+            long capacity = job_table.capacity (op);
+            long current_jobs = active_jobs.size ();
 
-                if (std::find (sessions_sent.begin (), sessions_sent.end (), local_address)
-                    != sessions_sent.end ()) {
-                    auto* response_ptr
-                        = dynamic_cast<StageResponseStats*> (d_stats.at (local_address).get());
+            // Assign all bandwidth to leftover_iops
+            unsigned long left_iops = capacity;
 
-                    for (int env : envs) {
-                        std::string stage_env = app.first + "+" + std::to_string (env);
+            for (int job : active_jobs) {
+                long total_app_rate = job_usage[job];
+                long demand = demands[job];
 
-                        auto stage_exists = (*response_ptr->m_stats_ptr.get ()).find (stage_env);
+                // jobs without a demand are not bounded by it; they share what the others leave
+                if (demand == UNBOUNDED_DEMAND) {
+                    continue;
+                }
 
-                        if (stage_exists == (*response_ptr->m_stats_ptr.get ()).end ()) {
-                            long current_rate = 1;
-                            total_app_rate += current_rate;
-                        } else {
-                            auto* entities_stat_ptr
-                                = dynamic_cast<StageResponseStat*> (stage_exists->second.get ());
+                float fair_share = left_iops / current_jobs;
 
-                            double current_rate = entities_stat_ptr->get_total_rate ();
-                            if (current_rate == 0) {
-                                current_rate = 1;
-                            }
+                // First phase
+                if (total_app_rate <= demand * 0.95) {
+                    float threshold_value = (float)(demand - total_app_rate) * 0.25;
 
-                            total_app_rate += current_rate;
-                        }
+                    if (total_app_rate + threshold_value < fair_share) {
+                        rates[job] = total_app_rate + threshold_value;
+                    } else {
+                        rates[job] = fair_share;
                     }
                 } else {
-                    for (int env : envs) {
-                        std::string stage_env = app.first + "+" + std::to_string (env);
-
-                        double current_rate = maximum_limit * job_location_tracker.size ();
-                        total_app_rate += current_rate;
+                    if (demand < fair_share) {
+                        rates[job] = demand;
+                    } else {
+                        rates[job] = fair_share;
                     }
                 }
+
+                current_jobs--;
+                left_iops -= rates[job];
             }
 
-            float fair_share = left_iops / current_jobs;
+            for (int job : active_jobs) {
+                if (demands[job] == UNBOUNDED_DEMAND) {
+                    rates[job] = left_iops / current_jobs;
 
-            // First phase
-            if (total_app_rate <= job_demands[app.first] * 0.95) {
-                float threshold_value = (float)(job_demands[app.first] - total_app_rate) * 0.25;
+                    current_jobs--;
+                    left_iops -= rates[job];
+                }
+            }
 
-                if (total_app_rate + threshold_value < fair_share) {
-                    job_rates[app.first] = total_app_rate + threshold_value;
-                } else {
-                    job_rates[app.first] = fair_share;
+            unsigned long left_iops_copy = left_iops;
+
+            // Second phase. Distribute leftover bandwidth according to current usage.
+            if (left_iops_copy > 0) {
+                for (int job : active_jobs) {
+                    float add_iops_perc = (float)job_usage[job] / system_total_rate;
+                    rates[job] += std::floor (add_iops_perc * left_iops_copy);
+                    left_iops -= std::floor (add_iops_perc * left_iops_copy);
                 }
-            } else {
-                if (job_demands[app.first] < fair_share) {
-                    job_rates[app.first] = job_demands[app.first];
+            }
+
+            unsigned long maintained_rate = 0;
+            unsigned long updated_rate = 0;
+
+            // Distribute per each job's stage.
+            for (int job : active_jobs) {
+
+                // validate if assigned rate surpasses the changing bandwidth threshold
+                auto rates_difference = abs (rates[job] - previous_rates[job]);
+
+                // validate if assigned rate surpasses the changing bandwidth threshold
+                if (!change_in_system.load ()
+                    && (rates_difference < (rates[job] * 0.01)
+                        || (system_total_rate < 0.95 * capacity
+                            && rates_difference < (rates[job] * 0.05)))) {
+                    maintained_rate += previous_rates[job];
+                    job_maintain_rate[job] = true;
+
                 } else {
-                    job_rates[app.first] = fair_share;
+                    updated_rate += rates[job];
+                    job_maintain_rate[job] = false;
                 }
             }
 
-            per_app_usage[app.first] = total_app_rate;
-            system_total_rate += total_app_rate;
-            current_jobs--;
-            left_iops -= job_rates[app.first];
+            float varied_perc = 1.0;
+
+            if (system_total_rate < 0.95 * capacity && maintained_rate + updated_rate > capacity) {
+                long allowed_rate = capacity - maintained_rate;
+                varied_perc = (float)allowed_rate / updated_rate;
+            }
+
+            for (int job : active_jobs) {
+                if (job_maintain_rate[job]) {
+                    skipped_rules_metric_.increment ();
+
+                } else {
+                    unsigned long cur_job_rate = rates[job];
+                    rates[job] = std::floor (cur_job_rate * varied_perc);
+
+                    send_enforcement_rule (job, op);
+                }
+            }
         }
 
-        unsigned long left_iops_copy = left_iops;
+        /*Submit one batch per local controller and collect result rules */
+        submit_enforcement_rules ();
+        collect_enforcement_rule_results ();
+    }
+}
+
+// load_stage_usage call. Loads the usage of each data plane stage from the statistics collected.
+void CoreControlApplication::load_stage_usage (
+    const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats,
+    const std::list<std::string>& sessions_sent)
+{
+    int total_operations = job_table.total_operations ();
+
+    // stages of local controllers without statistics are assumed to use the whole system
+    for (int op = 0; op < total_operations; op++) {
+        std::vector<double>& stage_usage = job_table.stage_usage (op);
+        std::fill (stage_usage.begin (),
+            stage_usage.end (),
+            static_cast<double> (maximum_limit * job_table.active_jobs ().size ()));
+    }
 
-        left_iops_copy = left_iops;
+    for (auto const& local_address : sessions_sent) {
+        int local = job_table.locals ().find (local_address);
+        auto local_stats = d_stats.find (local_address);
 
-        // Second phase. Distribute leftover bandwidth according to current usage.
-        if (left_iops_copy > 0) {
-            for (auto const& app : per_app_usage) {
-                float add_iops_perc = (float)app.second / system_total_rate;
-                job_rates[app.first] += std::floor (add_iops_perc * left_iops_copy);
-                left_iops -= std::floor (add_iops_perc * left_iops_copy);
+        if (local == INVALID_ID || local_stats == d_stats.end ()) {
+            continue;
+        }
+
+        for (int stage : job_table.local_stages (local)) {
+            for (int op = 0; op < total_operations; op++) {
+                job_table.stage_usage (op)[stage] = 1;
             }
         }
 
-        left_iops = 0;
-        std::string operation = active_op;
-        current_jobs = job_location_tracker.size ();
-        std::unordered_map<std::string, bool> job_address_updated;
-        std::unordered_map<std::string, bool> maintain_previous_job_rate;
-        unsigned long maintained_rate = 0;
-        unsigned long updated_rate = 0;
+        auto* response_ptr = dynamic_cast<StageResponseStats*> (local_stats->second.get ());
 
-        // Distribute per each job's stage.
-        for (auto const& app : job_location_tracker) {
+        for (auto const& [stage_name_env, stats] : (*response_ptr->m_stats_ptr.get ())) {
+            int stage = job_table.stages ().find (stage_name_env);
 
-            // validate if assigned rate surpasses the changing bandwidth threshold
-            auto rates_difference = abs (job_rates[app.first] - job_previous_rates[app.first]);
+            if (stage == INVALID_ID || !job_table.is_stage_active (stage)) {
+                continue;
+            }
 
-            // validate if assigned rate surpasses the changing bandwidth threshold
-            if (!change_in_system.load ()
-                && (rates_difference < (job_rates[app.first] * 0.01)
-                    || (system_total_rate < 0.95 * maximum_limit
-                        && rates_difference < (job_rates[app.first] * 0.05)))) {
-                maintained_rate += job_previous_rates[app.first];
-                maintain_previous_job_rate[app.first] = true;
+            auto* stat_ptr = dynamic_cast<StageResponseStat*> (stats.get ());
+            double total_rate = stat_ptr->get_total_rate ();
 
-            } else {
-                updated_rate += job_rates[app.first];
-                maintain_previous_job_rate[app.first] = false;
+            // noisy stages keep headroom over their mean rate, so bursts are not throttled
+            double headroom = 1;
+            if (stat_ptr->ResponseType () == COLLECT_GLOBAL_STATS_AGGREGATED && total_rate > 0) {
+                headroom += USAGE_NOISE_WEIGHT * std::sqrt (stat_ptr->get_rate_variance ())
+                    / total_rate;
+            }
+
+            const std::vector<StatsChannelRaw>& channels = stat_ptr->get_channel_stats ();
+
+            for (int op = 0; op < total_operations; op++) {
+                // stages that only report a total rate use it for every operation
+                job_table.stage_usage (op)[stage] = channels.empty () ? total_rate * headroom : 0;
             }
+
+            for (const auto& channel : channels) {
+                auto operation = channel_operations.find (channel.m_channel_id);
+                if (operation != channel_operations.end ()) {
+                    job_table.stage_usage (operation->second)[stage]
+                        += channel.m_ops_rate * headroom;
+                }
+            }
+
+            for (int op = 0; op < total_operations; op++) {
+                double& usage = job_table.stage_usage (op)[stage];
+                usage = usage == 0 ? 1 : usage;
+            }
+        }
+    }
+}
+
+// total_observed_rate call. Sums the rate observed at every data plane stage.
+double CoreControlApplication::total_observed_rate (
+    const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats) const
+{
+    double total_rate = 0;
+
+    for (auto const& [local_address, response] : d_stats) {
+        auto* response_ptr = dynamic_cast<StageResponseStats*> (response.get ());
+        if (response_ptr == nullptr) {
+            continue;
+        }
+
+        for (auto const& [stage_name_env, stats] : (*response_ptr->m_stats_ptr.get ())) {
+            total_rate += dynamic_cast<StageResponseStat*> (stats.get ())->get_total_rate ();
         }
+    }
+
+    return total_rate;
+}
 
-        float varied_perc = 1.0;
+// end_phase call. Records the duration of the current phase of the cycle, and starts the next one.
+void CoreControlApplication::end_phase (Histogram& phase_metric)
+{
+    auto now = std::chrono::steady_clock::now ();
+    phase_metric.observe (std::chrono::duration<double> (now - phase_start_).count ());
+    phase_start_ = now;
+}
 
-        if (system_total_rate < 0.95 * maximum_limit
-            && maintained_rate + updated_rate > maximum_limit) {
-            long allowed_rate = maximum_limit - maintained_rate;
-            varied_perc = (float)allowed_rate / updated_rate;
+// record_history call. Records the rate observed at each data plane stage and job in this cycle.
+void CoreControlApplication::record_history (
+    const std::unordered_map<std::string, std::unique_ptr<StageResponse>>& d_stats)
+{
+    auto now = std::chrono::steady_clock::now ();
+    stage_history_.advance (now);
+    job_history_.advance (now);
+
+    // jobs without statistics in this cycle hold a missing value
+    history_job_rates.assign (job_table.jobs ().size (), -1);
+    std::size_t unrecorded = 0;
+
+    for (auto const& [local_address, response] : d_stats) {
+        auto* response_ptr = dynamic_cast<StageResponseStats*> (response.get ());
+        if (response_ptr == nullptr) {
+            continue;
         }
 
-        for (auto const& app : job_location_tracker) {
-            if (maintain_previous_job_rate[app.first]) {
-                /*DO Nothing*/
+        for (auto const& [stage_name_env, stats] : (*response_ptr->m_stats_ptr.get ())) {
+            int stage = job_table.stages ().find (stage_name_env);
+            double rate = dynamic_cast<StageResponseStat*> (stats.get ())->get_total_rate ();
 
-            } else {
-                unsigned long cur_job_rate = job_rates[app.first];
-                job_rates[app.first] = std::floor (cur_job_rate * varied_perc);
+            if (stage == INVALID_ID || rate < 0) {
+                continue;
+            }
 
-                send_enforcement_rule (app.first, app.second, operation, job_address_updated);
+            if (!stage_history_.record (stage, static_cast<float> (rate))) {
+                unrecorded++;
             }
+
+            double& job_rate = history_job_rates[job_table.stage_job (stage)];
+            job_rate = std::max (job_rate, 0.0) + rate;
+        }
+    }
+
+    for (std::size_t job = 0; job < history_job_rates.size (); job++) {
+        if (history_job_rates[job] >= 0
+            && !job_history_.record (job, static_cast<float> (history_job_rates[job]))) {
+            unrecorded++;
         }
+    }
+
+    if (unrecorded > 0) {
+        Logging::log_debug ("ControlApplication: History is full, " + std::to_string (unrecorded)
+            + " stages and jobs not recorded.");
+    }
+}
+
+// stage_history call. Gets the rate observed at each data plane stage in the last cycles.
+const TimeSeriesStore& CoreControlApplication::stage_history () const
+{
+    return stage_history_;
+}
+
+// job_history call. Gets the rate observed at each job in the last cycles.
+const TimeSeriesStore& CoreControlApplication::job_history () const
+{
+    return job_history_;
+}
 
-        /*Collect result rules */
-        collect_enforcement_rule_results (job_address_updated);
+// total_demand call. Sums the demands of the active jobs for every operation.
+double CoreControlApplication::total_demand ()
+{
+    double demand = 0;
+
+    for (int op = 0; op < job_table.total_operations (); op++) {
+        const std::vector<long>& demands = job_table.demands (op);
+
+        for (int job : job_table.active_jobs ()) {
+            if (demands[job] != UNBOUNDED_DEMAND) {
+                demand += demands[job];
+            }
+        }
     }
+
+    return demand;
 }
 
 ////////////////////////////////////////////
@@ -586,6 +974,14 @@ void CoreControlApplication::enqueue_rule_in_queue (const std::string& rule)
     pending_rules_queue_lock_.lock ();
     pending_rules_queue_.emplace (rule);
     pending_rules_queue_lock_.unlock ();
+
+    notify_feedback_loop ();
+}
+
+// get_cycle_period call. Gets the period chosen for the current cycle.
+uint64_t CoreControlApplication::get_cycle_period () const
+{
+    return m_cycle_period.load ();
 }
 
 // dequeue_rule_from_queue call. Dequeues a new rule submitted by the system administrator.
@@ -610,22 +1006,31 @@ std::string CoreControlApplication::dequeue_rule_from_queue ()
 // Initialize call. Fills housekeeping rules and operations supported by the control application.
 void CoreControlApplication::initialize ()
 {
+    std::vector<std::pair<long, std::string>> channels {};
+
     for (const auto& specific_rule : *housekeeping_rules_ptr_) {
         std::vector<std::string> tokens {};
 
         parse_rule_with_break (specific_rule, &tokens);
 
         if (tokens[2] == "create_channel") {
-            if (tokens[6] == "no_op"){
-                active_ops.insert (tokens[7]);
-            }
-            else {
-                active_ops.insert (tokens[6]);
-            }
+            const std::string& op = tokens[6] == "no_op" ? tokens[7] : tokens[6];
+            active_ops.insert (op);
+            channels.emplace_back (std::stol (tokens[3]), op);
         }
     }
 
-    active_op = *(active_ops.begin ());
+    // each operation has its own capacity (in MDS, each operation identifies a metadata server)
+    for (const auto& op : active_ops) {
+        auto limit = operation_limits.find (op);
+        job_table.register_operation (op,
+            limit != operation_limits.end () ? limit->second : maximum_limit);
+    }
+
+    // the statistics of each channel are the usage of its operation
+    for (const auto& [channel_id, op] : channels) {
+        channel_operations[channel_id] = job_table.operations ().find (op);
+    }
 
     Logging::log_debug ("Current supported operations: ");
     for (const auto& op : active_ops) {
@@ -644,18 +1049,33 @@ void CoreControlApplication::handle_local_controller_sessions ()
 
         m_pending_local_controller_sessions.fetch_sub (1);
 
-        this->local_sessions_.emplace (local_controller_address,
-            std::make_unique<LocalControllerSession> (local_controller_address));
-
         this->local_to_stages.emplace (local_controller_address, std::vector<std::string> {});
+        job_table.register_local (local_controller_address);
+
+        if (local_interface_poller_ != nullptr) {
+            // asynchronous sessions are driven by the shared LocalInterfacePoller
+            this->local_sessions_.emplace (local_controller_address,
+                std::make_unique<LocalControllerSession> (local_controller_address,
+                    local_interface_poller_.get ()));
+
+            local_sessions_.at (local_controller_address)->StartSession (local_controller_address);
+        } else {
+            this->local_sessions_.emplace (local_controller_address,
+                std::make_unique<LocalControllerSession> (local_controller_address));
 
-        std::thread session_thread_t = std::thread (&LocalControllerSession::StartSession,
-            local_sessions_.at (local_controller_address).get (),
-            local_controller_address);
-        session_thread_t.detach ();
+            std::thread session_thread_t = std::thread (&LocalControllerSession::StartSession,
+                local_sessions_.at (local_controller_address).get (),
+                local_controller_address);
+            session_thread_t.detach ();
+        }
 
         PStatus status = this->local_handshake (local_controller_address);
 
+        if (m_statistics_stream_period > 0) {
+            local_sessions_.at (local_controller_address)
+                ->StartStatisticsStream (m_statistics_stream_period);
+        }
+
         m_active_local_controller_sessions.fetch_add (1);
     }
 }
@@ -683,17 +1103,14 @@ PStatus CoreControlApplication::local_handshake (const std::string& local_contro
 PStatus CoreControlApplication::call_local_handshake (const std::string& local_controller_address)
 {
     PStatus status = PStatus::Error ();
-    // create LOCAL_HANDSHAKE request
-    std::string rule = std::to_string (LOCAL_HANDSHAKE) + "|";
-    // put request on LocalPlaneSession::submission_queue
-
-    for (const auto& specific_rule : *housekeeping_rules_ptr_) {
-        rule += ":" + specific_rule;
-    }
+    // create LOCAL_HANDSHAKE request (the housekeeping rules are sent as they are)
+    ControlCommand command { LOCAL_HANDSHAKE, -1, housekeeping_rules_ptr_ };
 
-    Logging::log_info ("LocalHandshake <" + local_controller_address + " " + rule + ">");
+    Logging::log_info ("LocalHandshake <" + local_controller_address + " "
+        + std::to_string (housekeeping_rules_ptr_->size ()) + " housekeeping rules>");
 
-    local_sessions_[local_controller_address]->SubmitRule (rule);
+    // put request on LocalPlaneSession::submission_queue
+    local_sessions_[local_controller_address]->SubmitRule (std::move (command));
 
     // wait for request to be on LocalPlaneSession::completion_queue
     std::unique_ptr<StageResponse> resp_t = local_sessions_[local_controller_address]->GetResult ();
@@ -725,33 +1142,10 @@ void CoreControlApplication::handle_data_plane_sessions ()
 
         change_in_system = true;
 
-        auto existing_locations = job_location_tracker.find (stage_info->m_stage_name);
-
-        if (existing_locations == job_location_tracker.end ()) {
-            /* Does not exist */
-            std::unordered_map<std::string, std::vector<int>> locations;
-
-            std::vector<int> envs;
-            envs.push_back (std::stoi (stage_info->m_stage_env));
-
-            locations.emplace (stage_info->m_local_address, envs);
-            job_location_tracker[stage_info->m_stage_name] = locations;
-
-            job_demands.emplace (stage_info->m_stage_name, -1);
-            job_previous_rates.emplace (stage_info->m_stage_name, 0);
-            job_rates.emplace (stage_info->m_stage_name, -1);
-        } else {
-            /* Already exists */
-            auto existing_envs = existing_locations->second.find (stage_info->m_local_address);
-
-            if (existing_envs == existing_locations->second.end ()) {
-                std::vector<int> envs;
-                envs.push_back (std::stoi (stage_info->m_stage_env));
-                existing_locations->second[stage_info->m_local_address] = envs;
-            } else {
-                existing_envs->second.push_back (std::stoi (stage_info->m_stage_env));
-            }
-        }
+        // identifiers are interned once, so the feedback loop does not hash names
+        job_table.register_stage (stage_info->m_stage_name,
+            stage_info->m_stage_env,
+            stage_info->m_local_address);
 
         std::string stage_name_env = stage_info->m_stage_name + "+" + stage_info->m_stage_env;
 
@@ -779,7 +1173,8 @@ void CoreControlApplication::handle_data_plane_sessions ()
         } else {
             Logging::log_error ("DataPlaneSessionHandshake with Data Plane not established.");
 
-            std::this_thread::sleep_for (milliseconds (100));
+            // back off before the next handshake, unless the feedback loop is stopped meanwhile
+            wait_for_feedback_loop_event (steady_clock::now () + milliseconds (100));
         }
     }
 }
@@ -796,9 +1191,9 @@ PStatus CoreControlApplication::mark_data_plane_stage_ready (
         "CoreControlApplication: mark stage ready (" + local_controller_address + ")");
     PStatus status = PStatus::Error ();
 
-    std::string rule = std::to_string (STAGE_READY) + "|" + stage_name + "+" + stage_env + "|";
+    ControlCommand command { STAGE_READY, -1, stage_name + "+" + stage_env };
     // put request on DataPlaneSession::submission_queue
-    local_sessions_.at (local_controller_address)->SubmitRule (rule);
+    local_sessions_.at (local_controller_address)->SubmitRule (std::move (command));
 
     // get rules from CompletionQueue and cast them to a StageResponseACK object
     std::unique_ptr<StageResponse> resp_t
@@ -831,103 +1226,128 @@ std::string CoreControlApplication::update_job_demands ()
                 "ControlApplication: Received rule for dynamic control with demands.");
 
             operation = tokens[3];
-            auto it = job_demands.find (job_name);
-            if (it != job_demands.end ()) {
-                job_demands[job_name] = std::stol (tokens[4]);
+
+            // operations without a channel are still enforced, sharing the system limit
+            int op = job_table.register_operation (operation, maximum_limit);
+            job_table.demands (op)[job_table.register_job (job_name)] = std::stol (tokens[4]);
+        } else if (tokens[1] == "mds") {
+            Logging::log_debug ("ControlApplication: Received rule for metadata server capacity.");
+
+            operation = tokens[2];
+            int op = job_table.operations ().find (operation);
+            if (op != INVALID_ID) {
+                job_table.capacity (op) = std::stol (tokens[4]);
             } else {
-                job_demands.emplace (job_name, std::stol (tokens[4]));
+                Logging::log_error ("ControlApplication: Unknown metadata server " + operation);
             }
         }
-	
-	active_op = operation;
     }
 
     return operation;
 }
 
-// send_enforcement_rule call. Sends new enforcement rules to local controllers.
-void CoreControlApplication::send_enforcement_rule (std::string app_name,
-    std::unordered_map<std::string, std::vector<int>> local_to_envs,
-    std::string operation,
-    std::unordered_map<std::string, bool>& job_address_updated)
+// send_enforcement_rule call. Adds the job's new enforcement rules to the batch of each of its
+// local controllers.
+void CoreControlApplication::send_enforcement_rule (int job, int operation)
 {
-    job_previous_rates[app_name] = job_rates[app_name];
+    long rate = job_table.rates (operation)[job];
+    job_table.previous_rates (operation)[job] = rate;
 
-    int total_stages = 0;
-    for (auto const& [local_address, envs] : local_to_envs) {
-        total_stages += envs.size ();
-    }
+    job_table.batch_enforcement_rule (job, operation, rate);
+    enforced_rules_metric_.increment ();
+}
 
-    long limit_per_stage = std::floor (job_rates[app_name] / total_stages);
+// submit_enforcement_rules call. Submits the batched enforcement rules of the cycle, one per
+// local controller.
+void CoreControlApplication::submit_enforcement_rules ()
+{
+    end_phase (compute_phase_metric_);
 
-    for (auto const& [local_address, envs] : local_to_envs) {
+    for (int local : job_table.batched_locals ()) {
+        const std::string& local_address = job_table.locals ().name (local);
+        const auto& enforcement_rules = job_table.local_rules (local);
 
-        std::string enforcement_rule = std::to_string (CREATE_ENF_RULE);
-        enforcement_rule += "|.0|" + app_name + "|" + operation + "|";
+        Logging::log_debug ("Enforcing rules of " + std::to_string (enforcement_rules->size ())
+            + " jobs to " + local_address);
 
-        for (int env : envs) {
-            std::string stage_env = app_name + "+" + std::to_string (env);
+        // the batch is shared with the command; clear_batches reuses it for the next cycle
+        this->local_sessions_.at (local_address)
+            ->SubmitRule (ControlCommand { CREATE_ENF_RULE,
+                -1,
+                std::shared_ptr<const std::vector<JobEnforcementRule>> { enforcement_rules } });
+    }
+}
 
-            enforcement_rule += "*" + std::to_string (env) + ":" + std::to_string (limit_per_stage);
-        }
+// collect_enforcement_rule_results call . Collects enforcement rules results.
+void CoreControlApplication::collect_enforcement_rule_results ()
+{
+    auto deadline = std::chrono::steady_clock::now () + microseconds (m_collect_deadline);
 
-        enforcement_rule += "*.";
+    for (int local : job_table.batched_locals ()) {
+        const std::string& local_address = job_table.locals ().name (local);
 
-        job_address_updated[app_name + "+" + local_address] = true;
+        // get responses based on submitted rules
+        std::unique_ptr<StageResponse> ack_ptr
+            = this->local_sessions_.at (local_address)->GetResult (deadline);
 
-        Logging::log_debug ("Enforcing rule " + enforcement_rule + " to " + local_address);
-        this->local_sessions_[local_address]->SubmitRule (enforcement_rule);
-    }
-}
+        if (ack_ptr == nullptr) {
+            Logging::log_error ("Enforcement rules not acknowledged in time by " + local_address);
+        }
 
-// collect_enforcement_rule_results call . Collects enforcement rules results.
-void CoreControlApplication::collect_enforcement_rule_results (
-    std::unordered_map<std::string, bool>& job_address_updated)
-{
-    for (auto const& app : job_location_tracker) {
-        for (auto const& [local_address, envs] : app.second) {
-            if (job_address_updated[app.first + "+" + local_address]) {
-                // get responses based on submitted rules
-                std::unique_ptr<StageResponse> ack_ptr
-                    = this->local_sessions_[local_address]->GetResult ();
-
-                // debug message
-                if (Logging::is_debug_enabled ()) {
-                    // verify if pointer is valid
-                    if (ack_ptr != nullptr) {
-                        // convert StageResponse unique-ptr to StageResponseStats
-                        auto* response_ptr = dynamic_cast<StageResponseACK*> (ack_ptr.get ());
-
-                        Logging::log_debug (
-                            "ACK response :: " + std::to_string (response_ptr->ResponseType ())
-                            + " -- " + response_ptr->toString ());
-                    }
-                }
+        // debug message
+        if (Logging::is_debug_enabled ()) {
+            // verify if pointer is valid
+            if (ack_ptr != nullptr) {
+                // convert StageResponse unique-ptr to StageResponseStats
+                auto* response_ptr = dynamic_cast<StageResponseACK*> (ack_ptr.get ());
+
+                Logging::log_debug ("ACK response :: "
+                    + std::to_string (response_ptr->ResponseType ()) + " -- "
+                    + response_ptr->toString ());
             }
         }
     }
+
+    // batches are reused in the next cycle
+    job_table.clear_batches ();
+    end_phase (enforce_phase_metric_);
 }
 
 // collect_statistics_result call. Collects a local controller statistics.
-void CoreControlApplication::collect_statistics_result (
-    const std::unique_ptr<LocalControllerSession>& session,
-    std::string local_address,
+void CoreControlApplication::collect_statistics_result (std::unique_ptr<StageResponse> stats_ptr,
+    const std::string& local_address,
     std::list<std::string>& sessions_to_delete,
     std::unordered_map<std::string, std::unique_ptr<StageResponse>>& collected_stats)
 {
-    std::unique_ptr<StageResponse> stats_ptr = session->GetResult ();
-
     auto* response_ptr = dynamic_cast<StageResponseStats*> (stats_ptr.get ());
 
     // verify if pointer is valid
-    if (stats_ptr != nullptr && !response_ptr->m_stats_ptr.get ()->empty ()) {
+    if (response_ptr != nullptr && !response_ptr->m_stats_ptr.get ()->empty ()) {
+        LocalStatsSample& sample = local_stats_samples[local_address];
+
+        if (sample.m_quarantined) {
+            Logging::log_info ("ControlApplication: local controller " + local_address
+                + " is reporting statistics again; leaving quarantine.");
+            sample.m_quarantined = false;
+            job_table.set_local_enabled (job_table.locals ().find (local_address), true);
+            change_in_system = true;
+        }
+
+        sample.m_stage_rates.clear ();
+        sample.m_stage_channels.clear ();
+        sample.m_age = 0;
+        sample.m_consecutive_misses = 0;
 
         for (auto const& stats_value : (*response_ptr->m_stats_ptr.get ())) {
             auto* global_stat_ptr = dynamic_cast<StageResponseStat*> (stats_value.second.get ());
 
             double current_rate = global_stat_ptr->get_total_rate ();
 
-            if (current_rate == -1) {
+            if (current_rate != -1) {
+                sample.m_stage_rates.emplace (stats_value.first, current_rate);
+                sample.m_stage_channels.emplace (stats_value.first,
+                    global_stat_ptr->get_channel_stats ());
+            } else {
                 remove_stage (stats_value.first);
 
                 auto& stages = local_to_stages.at (local_address);
@@ -955,28 +1375,86 @@ void CoreControlApplication::collect_statistics_result (
     }
 }
 
-// remove_stage call: Removes a data plane stage that is no longer operational.
-void CoreControlApplication::remove_stage (const std::string& stage_name_env)
+// is_local_available call. Verifies if a local controller is able to serve new requests.
+bool CoreControlApplication::is_local_available (const std::string& local_address)
+{
+    bool lagging = local_sessions_.at (local_address)->HasExpiredResponses ();
+    LocalStatsSample& sample = local_stats_samples[local_address];
+
+    if (sample.m_quarantined && !lagging) {
+        Logging::log_info ("ControlApplication: local controller " + local_address
+            + " caught up; leaving quarantine.");
+        sample.m_quarantined = false;
+        sample.m_consecutive_misses = 0;
+        job_table.set_local_enabled (job_table.locals ().find (local_address), true);
+        // rates were not enforced while quarantined
+        change_in_system = true;
+    }
+
+    return !lagging;
+}
+
+// use_last_statistics_sample call. Registers a missed collection deadline and serves the local
+// controller's last known statistics sample.
+bool CoreControlApplication::use_last_statistics_sample (const std::string& local_address,
+    std::unordered_map<std::string, std::unique_ptr<StageResponse>>& collected_stats,
+    bool missed)
 {
-    auto stage_info = stage_info_detailed.at (stage_name_env).get ();
+    LocalStatsSample& sample = local_stats_samples[local_address];
+    sample.m_age++;
 
-    std::unordered_map<std::string, std::vector<int>>& local_address_to_envs
-        = job_location_tracker.at (stage_info->m_stage_name);
-    std::vector<int>& envs = local_address_to_envs.at (stage_info->m_local_address);
+    if (sample.m_quarantined) {
+        return false;
+    }
+
+    if (missed) {
+        sample.m_consecutive_misses++;
+    }
+
+    if (sample.m_consecutive_misses >= m_collect_max_misses) {
+        Logging::log_error ("ControlApplication: local controller " + local_address + " missed "
+            + std::to_string (sample.m_consecutive_misses) + " deadlines; quarantining it.");
+        sample.m_quarantined = true;
+        job_table.set_local_enabled (job_table.locals ().find (local_address), false);
+        return false;
+    }
+
+    if (sample.m_stage_rates.empty ()) {
+        return false;
+    }
+
+    Logging::log_debug ("ControlApplication: using statistics of " + local_address + " with age "
+        + std::to_string (sample.m_age));
 
-    envs.erase (std::remove (envs.begin (), envs.end (), std::stoi (stage_info->m_stage_env)),
-        envs.end ());
+    std::unique_ptr<std::unordered_map<std::string, std::unique_ptr<StageResponse>>> stats_objects
+        = std::make_unique<std::unordered_map<std::string, std::unique_ptr<StageResponse>>> ();
 
-    if (envs.empty ()) {
-        Logging::log_debug ("ControlApplication: Envs is empty");
-        local_address_to_envs.erase (stage_info->m_local_address);
+    for (auto const& [stage_name_env, rate] : sample.m_stage_rates) {
+        stats_objects->emplace (stage_name_env,
+            std::make_unique<StageResponseStat> (COLLECT_GLOBAL_STATS,
+                rate,
+                0,
+                1,
+                sample.m_stage_channels[stage_name_env]));
+    }
+
+    collected_stats.emplace (local_address,
+        std::make_unique<StageResponseStats> (COLLECT_GLOBAL_STATS, stats_objects));
+
+    return true;
+}
+
+// remove_stage call: Removes a data plane stage that is no longer operational.
+void CoreControlApplication::remove_stage (const std::string& stage_name_env)
+{
+    int stage = job_table.stages ().find (stage_name_env);
 
-        if (local_address_to_envs.empty ()) {
-            job_location_tracker.erase (stage_info->m_stage_name);
-            job_rates.erase (stage_info->m_stage_name);
-            job_previous_rates.erase (stage_info->m_stage_name);
-            job_demands.erase (stage_info->m_stage_name);
+    if (stage != INVALID_ID) {
+        // the history of removed stages and jobs is reused by new ones
+        stage_history_.release (stage);
 
+        if (job_table.remove_stage (stage)) {
+            job_history_.release (job_table.stage_job (stage));
             Logging::log_debug ("ControlApplication: No local sessions with app");
         }
     }
@@ -0,0 +1,47 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <cheferd/controller/id_registry.hpp>
+
+namespace cheferd {
+
+// IdRegistry default constructor.
+IdRegistry::IdRegistry () : ids_ {}, names_ {}
+{ }
+
+// IdRegistry default destructor.
+IdRegistry::~IdRegistry () = default;
+
+// intern call. Gets the identifier of a name, registering it if needed.
+int IdRegistry::intern (const std::string& name)
+{
+    auto [it, inserted] = ids_.try_emplace (name, static_cast<int> (names_.size ()));
+
+    if (inserted) {
+        names_.push_back (name);
+    }
+
+    return it->second;
+}
+
+// find call. Gets the identifier of a name.
+int IdRegistry::find (const std::string& name) const
+{
+    auto it = ids_.find (name);
+    return it != ids_.end () ? it->second : INVALID_ID;
+}
+
+// name call. Gets the name of an identifier.
+const std::string& IdRegistry::name (int id) const
+{
+    return names_[id];
+}
+
+// size call. Gets the number of registered names.
+int IdRegistry::size () const
+{
+    return static_cast<int> (names_.size ());
+}
+
+} // namespace cheferd
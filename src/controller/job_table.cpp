@@ -0,0 +1,359 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <atomic>
+#include <cheferd/controller/job_table.hpp>
+#include <cheferd/networking/interface_definitions.hpp>
+
+namespace cheferd {
+
+// JobTable default constructor.
+JobTable::JobTable () :
+    jobs_ {},
+    stages_ {},
+    locals_ {},
+    operations_ {},
+    job_locations_ {},
+    job_location_envs_ {},
+    job_total_stages_ {},
+    active_jobs_ {},
+    stage_job_ {},
+    stage_local_ {},
+    stage_active_ {},
+    stage_env_ {},
+    stage_usage_ {},
+    local_stages_ {},
+    local_enabled_ {},
+    local_rules_ {},
+    batched_locals_ {},
+    operation_capacities_ {},
+    demands_ {},
+    rates_ {},
+    previous_rates_ {}
+{ }
+
+// JobTable default destructor.
+JobTable::~JobTable () = default;
+
+// register_local call. Registers a local controller.
+int JobTable::register_local (const std::string& local_address)
+{
+    int local = locals_.intern (local_address);
+
+    if (local == static_cast<int> (local_stages_.size ())) {
+        local_stages_.emplace_back ();
+        local_enabled_.push_back (true);
+        local_rules_.push_back (std::make_shared<std::vector<JobEnforcementRule>> ());
+    }
+
+    return local;
+}
+
+// register_operation call. Registers an operation.
+int JobTable::register_operation (const std::string& operation, long capacity)
+{
+    int op = operations_.intern (operation);
+
+    if (op == static_cast<int> (operation_capacities_.size ())) {
+        operation_capacities_.push_back (capacity);
+        demands_.emplace_back (job_total_stages_.size (), UNBOUNDED_DEMAND);
+        rates_.emplace_back (job_total_stages_.size (), -1);
+        previous_rates_.emplace_back (job_total_stages_.size (), 0);
+        stage_usage_.emplace_back (stage_job_.size (), 0);
+    }
+
+    return op;
+}
+
+// register_job call. Registers a job.
+int JobTable::register_job (const std::string& job_name)
+{
+    int job = jobs_.intern (job_name);
+
+    if (job == static_cast<int> (job_total_stages_.size ())) {
+        job_locations_.emplace_back ();
+        job_location_envs_.emplace_back ();
+        job_total_stages_.push_back (0);
+
+        for (int op = 0; op < operations_.size (); op++) {
+            demands_[op].push_back (UNBOUNDED_DEMAND);
+            rates_[op].push_back (-1);
+            previous_rates_[op].push_back (0);
+        }
+    }
+
+    return job;
+}
+
+// register_stage call. Registers an active data plane stage, and its job and local controller.
+int JobTable::register_stage (const std::string& job_name,
+    const std::string& stage_env,
+    const std::string& local_address)
+{
+    int job = register_job (job_name);
+    int local = register_local (local_address);
+    int stage = stages_.intern (job_name + "+" + stage_env);
+
+    if (stage == static_cast<int> (stage_job_.size ())) {
+        stage_job_.push_back (job);
+        stage_local_.push_back (local);
+        stage_active_.push_back (false);
+        stage_env_.push_back (std::stol (stage_env));
+        for (auto& usage : stage_usage_) {
+            usage.push_back (0);
+        }
+    } else if (stage_active_[stage]) {
+        return stage;
+    }
+
+    // a stage that reconnects may do so through another local controller
+    stage_local_[stage] = local;
+    stage_active_[stage] = true;
+    local_stages_[local].push_back (stage);
+
+    auto& locations = job_locations_[job];
+    auto location = std::find_if (locations.begin (), locations.end (), [local] (const auto& l) {
+        return l.first == local;
+    });
+
+    if (location == locations.end ()) {
+        locations.push_back ({ local, { stage } });
+        job_location_envs_[job].emplace_back ();
+        location = locations.end () - 1;
+    } else {
+        location->second.push_back (stage);
+    }
+    update_location_envs (job, location - locations.begin ());
+
+    if (job_total_stages_[job]++ == 0) {
+        active_jobs_.push_back (job);
+    }
+
+    return stage;
+}
+
+// remove_stage call. Removes an active data plane stage.
+bool JobTable::remove_stage (int stage)
+{
+    if (!stage_active_[stage]) {
+        return false;
+    }
+
+    int job = stage_job_[stage];
+    int local = stage_local_[stage];
+    stage_active_[stage] = false;
+
+    auto& stages = local_stages_[local];
+    stages.erase (std::remove (stages.begin (), stages.end (), stage), stages.end ());
+
+    auto& locations = job_locations_[job];
+    for (auto location = locations.begin (); location != locations.end (); location++) {
+        if (location->first == local) {
+            auto& envs = location->second;
+            envs.erase (std::remove (envs.begin (), envs.end (), stage), envs.end ());
+
+            if (envs.empty ()) {
+                auto& location_envs = job_location_envs_[job];
+                location_envs.erase (location_envs.begin () + (location - locations.begin ()));
+                locations.erase (location);
+            } else {
+                update_location_envs (job, location - locations.begin ());
+            }
+            break;
+        }
+    }
+
+    if (--job_total_stages_[job] > 0) {
+        return false;
+    }
+
+    active_jobs_.erase (std::remove (active_jobs_.begin (), active_jobs_.end (), job),
+        active_jobs_.end ());
+    reset_job (job);
+
+    return true;
+}
+
+// update_location_envs call. Rebuilds the env list of an entry of a job's locations.
+void JobTable::update_location_envs (int job, std::size_t location)
+{
+    auto envs = std::make_shared<std::vector<long>> ();
+    envs->reserve (job_locations_[job][location].second.size ());
+
+    for (int stage : job_locations_[job][location].second) {
+        envs->push_back (stage_env_[stage]);
+    }
+
+    job_location_envs_[job][location] = std::move (envs);
+}
+
+// reset_job call. Resets the demand and rates of a job for every operation.
+void JobTable::reset_job (int job)
+{
+    for (int op = 0; op < operations_.size (); op++) {
+        demands_[op][job] = UNBOUNDED_DEMAND;
+        rates_[op][job] = -1;
+        previous_rates_[op][job] = 0;
+    }
+}
+
+// jobs call. Gets the job identifiers.
+const IdRegistry& JobTable::jobs () const
+{
+    return jobs_;
+}
+
+// stages call. Gets the data plane stage identifiers.
+const IdRegistry& JobTable::stages () const
+{
+    return stages_;
+}
+
+// locals call. Gets the local controller identifiers.
+const IdRegistry& JobTable::locals () const
+{
+    return locals_;
+}
+
+// operations call. Gets the operation identifiers.
+const IdRegistry& JobTable::operations () const
+{
+    return operations_;
+}
+
+// active_jobs call. Gets the jobs with at least one active stage.
+const std::vector<int>& JobTable::active_jobs () const
+{
+    return active_jobs_;
+}
+
+// job_locations call. Gets the active stages of a job, grouped by local controller.
+const std::vector<std::pair<int, std::vector<int>>>& JobTable::job_locations (int job) const
+{
+    return job_locations_[job];
+}
+
+// local_stages call. Gets the active stages of a local controller.
+const std::vector<int>& JobTable::local_stages (int local) const
+{
+    return local_stages_[local];
+}
+
+// is_stage_active call. Verifies if a stage is active.
+bool JobTable::is_stage_active (int stage) const
+{
+    return stage_active_[stage];
+}
+
+// stage_job call. Gets the job of a stage.
+int JobTable::stage_job (int stage) const
+{
+    return stage_job_[stage];
+}
+
+// total_operations call. Gets the number of registered operations.
+int JobTable::total_operations () const
+{
+    return operations_.size ();
+}
+
+// capacity call. Gets the capacity of an operation.
+long& JobTable::capacity (int operation)
+{
+    return operation_capacities_[operation];
+}
+
+// demands call. Gets the demands of every job for an operation.
+std::vector<long>& JobTable::demands (int operation)
+{
+    return demands_[operation];
+}
+
+// rates call. Gets the imposed rates of every job for an operation.
+std::vector<long>& JobTable::rates (int operation)
+{
+    return rates_[operation];
+}
+
+// previous_rates call. Gets the previous imposed rates of every job for an operation.
+std::vector<long>& JobTable::previous_rates (int operation)
+{
+    return previous_rates_[operation];
+}
+
+// stage_usage call. Gets the last usage of an operation observed at each stage.
+std::vector<double>& JobTable::stage_usage (int operation)
+{
+    return stage_usage_[operation];
+}
+
+// set_local_enabled call. Defines if a local controller is sent enforcement rules.
+void JobTable::set_local_enabled (int local, bool enabled)
+{
+    local_enabled_[local] = enabled;
+}
+
+// batch_enforcement_rule call. Splits a job's rate among its data plane stages and adds the
+// resulting enforcement rules to the batch of each of its local controllers.
+void JobTable::batch_enforcement_rule (int job, int operation, long rate)
+{
+    long limit_per_stage = rate / job_total_stages_[job];
+    const auto& locations = job_locations_[job];
+
+    for (std::size_t location = 0; location < locations.size (); location++) {
+        int local = locations[location].first;
+
+        // disabled local controllers are updated once they are enabled again
+        if (!local_enabled_[local]) {
+            continue;
+        }
+
+        std::vector<JobEnforcementRule>& enforcement_rules = *local_rules_[local];
+        if (enforcement_rules.empty ()) {
+            batched_locals_.push_back (local);
+        }
+
+        // names and envs are referenced, and resolved when the rule is serialized
+        JobEnforcementRule& enforcement_rule = enforcement_rules.emplace_back ();
+        enforcement_rule.m_job_name = &jobs_.name (job);
+        enforcement_rule.m_operation = &operations_.name (operation);
+        enforcement_rule.m_envs = job_location_envs_[job][location];
+        enforcement_rule.m_rate = limit_per_stage;
+    }
+}
+
+// batched_locals call. Gets the local controllers with a non-empty batch.
+const std::vector<int>& JobTable::batched_locals () const
+{
+    return batched_locals_;
+}
+
+// local_rules call. Gets the batch of enforcement rules of a local controller.
+const std::shared_ptr<std::vector<JobEnforcementRule>>& JobTable::local_rules (int local)
+{
+    return local_rules_[local];
+}
+
+// clear_batches call. Clears the batches of enforcement rules.
+void JobTable::clear_batches ()
+{
+    for (int local : batched_locals_) {
+        auto& batch = local_rules_[local];
+
+        if (batch.use_count () == 1) {
+            // the session released the batch, so its reads happen before it is reused
+            std::atomic_thread_fence (std::memory_order_acquire);
+            batch->clear ();
+        } else {
+            auto capacity = batch->capacity ();
+            batch = std::make_shared<std::vector<JobEnforcementRule>> ();
+            batch->reserve (capacity);
+        }
+    }
+
+    batched_locals_.clear ();
+}
+
+} // namespace cheferd
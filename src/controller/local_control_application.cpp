@@ -2,8 +2,11 @@
  *   Copyright (c) 2022 INESC TEC.
  **/
 
+#include <algorithm>
 #include <cheferd/controller/local_control_application.hpp>
+#include <cheferd/utils/metrics.hpp>
 #include <cheferd/utils/rules_file_parser.hpp>
+#include <cstring>
 
 extern "C" {
 #include <fcntl.h>
@@ -17,10 +20,14 @@ namespace cheferd {
 LocalControlApplication::LocalControlApplication (const std::string& core_address,
     const std::string& local_address) :
     ControlApplication {},
+    stage_reactor_ { option_default_stage_reactor_threads },
+    handshake_pool_ { static_cast<std::size_t> (std::max (option_default_handshake_threads, 1)) },
     data_sessions_ {},
     preparing_data_sessions_ {},
     pending_data_sessions_ {},
+    stage_sampler_ { option_default_local_sampling_capacity },
     operation_to_channel_object {},
+    housekeeping_commands_ {},
     core_stub_ (LocalToGlobal::NewStub (
         grpc::CreateChannel (core_address, grpc::InsecureChannelCredentials ()))),
     m_active_data_plane_sessions { 0 },
@@ -43,10 +50,14 @@ LocalControlApplication::LocalControlApplication (std::vector<std::string>* rule
     const std::string& local_address,
     const uint64_t& cycle_sleep_time) :
     ControlApplication { rules_ptr, cycle_sleep_time },
+    stage_reactor_ { option_default_stage_reactor_threads },
+    handshake_pool_ { static_cast<std::size_t> (std::max (option_default_handshake_threads, 1)) },
     data_sessions_ {},
     preparing_data_sessions_ {},
     pending_data_sessions_ {},
+    stage_sampler_ { option_default_local_sampling_capacity },
     operation_to_channel_object {},
+    housekeeping_commands_ {},
     core_stub_ (LocalToGlobal::NewStub (
         grpc::CreateChannel (core_address, grpc::InsecureChannelCredentials ()))),
     m_active_data_plane_sessions { 0 },
@@ -80,7 +91,7 @@ void LocalControlApplication::register_stage_session (int socket_t)
     Logging::log_debug ("RegisterDataPlaneSession -- DataPlaneStage-" + std::to_string (socket_t));
 
     pending_data_plane_sessions_lock_.lock ();
-    pending_data_sessions_.emplace (std::make_unique<HandshakeSession> (socket_t));
+    pending_data_sessions_.emplace (std::make_shared<HandshakeSession> (socket_t));
 
     pending_data_plane_sessions_lock_.unlock ();
 
@@ -101,6 +112,7 @@ void LocalControlApplication::stop_feedback_loop ()
 {
     server->Shutdown ();
     working_application_ = false;
+    std::unique_lock<std::mutex> lock_t { pending_data_plane_sessions_lock_ };
     while (!pending_data_sessions_.empty ()) {
         pending_data_sessions_.front ()->RemoveSession ();
         pending_data_sessions_.pop ();
@@ -117,6 +129,11 @@ void LocalControlApplication::execute_feedback_loop ()
     PStatus status = PStatus::Error ();
     working_application_ = true;
 
+    // sample the data plane stages in the background, to serve aggregated statistics
+    std::thread sampler_thread_t
+        = std::thread (&LocalControlApplication::sample_stage_statistics, this);
+    sampler_thread_t.detach ();
+
     // wait for a data plane stage to connect
     while (working_application_.load () && this->m_pending_data_plane_sessions.load () == 0) {
         std::this_thread::sleep_for (milliseconds (100));
@@ -126,11 +143,9 @@ void LocalControlApplication::execute_feedback_loop ()
     while (working_application_.load ()
         && (this->m_pending_data_plane_sessions.load () > 0
             || this->m_active_data_plane_sessions.load () > 0)) {
-        // if exists pending sessions, perform the Session Handshake
-        while (this->m_pending_data_plane_sessions.load () > 0) {
-            // execute session handshake
+        // if exists pending sessions, hand them to the handshake pool (without waiting for them)
+        if (this->m_pending_data_plane_sessions.load () > 0) {
             handle_data_plane_sessions ();
-            std::this_thread::sleep_for (milliseconds (100));
         }
 
         this->sleep ();
@@ -257,6 +272,16 @@ Status LocalControlApplication::LocalHandshake (ServerContext* context,
         std::vector<std::string> rule_tokens {};
         parse_rule (rule, &rule_tokens, '|');
 
+        // parse the rule once, so that it is submitted as-is to every data plane stage
+        ControlCommand command {};
+        if (fill_housekeeping_command (rule_tokens, command).isOk ()) {
+            housekeeping_commands_.push_back (std::move (command));
+        } else {
+            Logging::log_error (
+                "LocalControlApplication: invalid housekeeping rule (" + rule + ")");
+            continue;
+        }
+
         if (rule_tokens[2].compare ("create_channel") == 0) {
             auto channel_object = std::make_pair (std::stoi (rule_tokens[3]), 1);
 
@@ -282,6 +307,73 @@ Status LocalControlApplication::LocalHandshake (ServerContext* context,
     return Status::OK;
 }
 
+// fill_housekeeping_command call. Converts a tokenized housekeeping rule into a ControlCommand.
+PStatus LocalControlApplication::fill_housekeeping_command (
+    const std::vector<std::string>& rule_tokens,
+    ControlCommand& command)
+{
+    if (rule_tokens.size () < 3) {
+        return PStatus::Error ();
+    }
+
+    try {
+        switch (RulesFileParser::convert_housekeeping_operation (rule_tokens[2])) {
+            case HousekeepingOperation::create_channel: {
+                if (rule_tokens.size () < 8) {
+                    return PStatus::Error ();
+                }
+
+                HousekeepingCreateChannelRaw create_channel {};
+                create_channel.m_rule_id = std::stol (rule_tokens[1]);
+                create_channel.m_channel_id = std::stol (rule_tokens[3]);
+                create_channel.m_context_definition
+                    = RulesFileParser::convert_context_type_definition (rule_tokens[4]);
+                create_channel.m_workflow_id = std::stol (rule_tokens[5]);
+                create_channel.m_operation_type
+                    = RulesFileParser::convert_differentiation_definitions (rule_tokens[4],
+                        rule_tokens[6]);
+                create_channel.m_operation_context
+                    = RulesFileParser::convert_differentiation_definitions (rule_tokens[4],
+                        rule_tokens[7]);
+
+                command = ControlCommand { CREATE_HSK_RULE, HSK_CREATE_CHANNEL, create_channel };
+                return PStatus::OK ();
+            }
+
+            case HousekeepingOperation::create_object: {
+                if (rule_tokens.size () < 11) {
+                    return PStatus::Error ();
+                }
+
+                HousekeepingCreateObjectRaw create_object {};
+                create_object.m_rule_id = std::stol (rule_tokens[1]);
+                create_object.m_channel_id = std::stol (rule_tokens[3]);
+                create_object.m_enforcement_object_id = std::stol (rule_tokens[4]);
+                create_object.m_context_definition
+                    = RulesFileParser::convert_context_type_definition (rule_tokens[5]);
+                create_object.m_operation_type
+                    = RulesFileParser::convert_differentiation_definitions (rule_tokens[5],
+                        rule_tokens[6]);
+                create_object.m_operation_context
+                    = RulesFileParser::convert_differentiation_definitions (rule_tokens[5],
+                        rule_tokens[7]);
+                create_object.m_enforcement_object_type
+                    = static_cast<long> (RulesFileParser::convert_object_type (rule_tokens[8]));
+                create_object.m_property_first = std::stol (rule_tokens[9]);
+                create_object.m_property_second = std::stol (rule_tokens[10]);
+
+                command = ControlCommand { CREATE_HSK_RULE, HSK_CREATE_OBJECT, create_object };
+                return PStatus::OK ();
+            }
+
+            default:
+                return PStatus::Error ();
+        }
+    } catch (const std::logic_error& error) {
+        return PStatus::Error ();
+    }
+}
+
 // StageHandshake call. Stage handshake from core controller.
 Status LocalControlApplication::StageHandshake (ServerContext* context,
     const controllers_grpc_interface::ControlOperation* request,
@@ -298,6 +390,7 @@ Status LocalControlApplication::MarkStageReady (ServerContext* context,
     Logging::log_info ("LocalControlApplication: Mark stage ready " + request->stage_name_env ()
         + " from core controller");
 
+    std::unique_lock<std::mutex> lock_t { data_sessions_lock_ };
     auto stage = preparing_data_sessions_.extract (request->stage_name_env ());
     data_sessions_.insert (std::move (stage));
 
@@ -312,57 +405,111 @@ Status LocalControlApplication::CreateEnforcementRule (ServerContext* context,
     const controllers_grpc_interface::EnforcementRules* request,
     controllers_grpc_interface::ACK* reply)
 {
-    Logging::log_info (
-        "LocalControlApplication: Received create enforcement rule from core controller");
+    Logging::log_info ("LocalControlApplication: Received create enforcement rule from core "
+                       "controller ("
+        + std::to_string (request->operation_rules_size () + request->job_rules_size ())
+        + " jobs)");
 
+    std::unique_lock<std::mutex> lock_t { stage_requests_lock_ };
     Status status = Status::OK;
+    reply->set_m_message (1);
 
-    for (auto& operation_rates : request->operation_rules ()) {
+    std::vector<std::pair<std::string, std::vector<ControlCommand>>> confirmations {};
 
-        for (auto& env_rate : operation_rates.second.env_rates ()) {
+    {
+        std::unique_lock<std::mutex> sessions_lock_t { data_sessions_lock_ };
 
-            auto existing_channels = operation_to_channel_object.find (operation_rates.first);
+        for (auto& operation_rates : request->operation_rules ()) {
+            if (!enforce_job_rule (operation_rates.first, operation_rates.second, confirmations)
+                     .ok ()) {
+                reply->set_m_message (0);
+                status = Status::CANCELLED;
+            }
+        }
 
-            if (existing_channels == operation_to_channel_object.end ()) {
+        // rules of all jobs of this local controller, batched by the core controller
+        for (auto& job_rates : request->job_rules ()) {
+            if (!enforce_job_rule (job_rates.m_operation (), job_rates, confirmations).ok ()) {
                 reply->set_m_message (0);
                 status = Status::CANCELLED;
-            } else {
+            }
+        }
+    }
 
-                int total_channels = existing_channels->second.size ();
-                long limit_per_channel = 0;
-                if (total_channels > 0) {
-                    limit_per_channel = std::floor (env_rate.second / total_channels);
-                }
+    // stages reading the enforcement table already apply the new rates meanwhile
+    for (auto& confirmation : confirmations) {
+        // the rules of every channel of the stage are in flight at once
+        Status confirmation_status
+            = LocalPassthru (confirmation.first, std::move (confirmation.second));
+
+        // a stage that fails to apply the rule (e.g., it is disconnecting) must not prevent
+        // the remaining stages and jobs of the batch from being updated
+        if (!confirmation_status.ok ()) {
+            Logging::log_debug (
+                "LocalControlApplication: enforcement rule not applied at " + confirmation.first);
+        }
+    }
 
-                for (auto& channel_objects : existing_channels->second) {
-
-                    int channel_id = channel_objects.first;
-                    int enforcement_object_id = channel_objects.second;
-
-                    std::string enforcement_rule = std::to_string (CREATE_ENF_RULE) + "|"
-                        + std::to_string (operation_rates.second.m_rule_id ()) + "|" // rule-id
-                        + std::to_string (channel_id) + "|"
-                        + std::to_string (enforcement_object_id) + "|" + "drl" + "|" + "rate"
-                        + "|" + std::to_string (limit_per_channel);
-
-                    status = LocalPassthru (operation_rates.second.m_stage_name () + "+"
-                            + std::to_string (env_rate.first),
-                        enforcement_rule);
-
-                    if (status.ok ()) {
-                        reply->set_m_message (1);
-                    } else {
-                        // reply->set_m_message(0);
-                        // return status;
-                        reply->set_m_message (1);
-                        return Status::OK;
-                    }
-                }
+    return status;
+}
+
+// enforce_job_rule call. Submits the enforcement rule of a job to its data plane stages.
+Status LocalControlApplication::enforce_job_rule (const std::string& operation,
+    const controllers_grpc_interface::EnforcementOpRules& job_rates,
+    std::vector<std::pair<std::string, std::vector<ControlCommand>>>& confirmations)
+{
+    auto existing_channels = operation_to_channel_object.find (operation);
+
+    if (existing_channels == operation_to_channel_object.end ()) {
+        return Status::CANCELLED;
+    }
+
+    // every enforcement rule of the local controller sets the rate of a DRL object
+    static const int rate_operation
+        = RulesFileParser::convert_enforcement_operation (EnforcementObjectType::DRL, "rate");
+
+    for (auto& env_rate : job_rates.env_rates ()) {
+        std::string stage_name_env
+            = job_rates.m_stage_name () + "+" + std::to_string (env_rate.first);
+        auto data_session = data_sessions_.find (stage_name_env);
+        bool table_written = data_session != data_sessions_.end ();
+
+        int total_channels = existing_channels->second.size ();
+        long limit_per_channel = 0;
+        if (total_channels > 0) {
+            limit_per_channel = std::floor (env_rate.second / total_channels);
+        }
+
+        std::vector<ControlCommand> commands {};
+        commands.reserve (existing_channels->second.size ());
+
+        for (auto& channel_objects : existing_channels->second) {
+
+            int channel_id = channel_objects.first;
+            int enforcement_object_id = channel_objects.second;
+
+            EnforcementRuleRaw enforcement_rule {};
+            enforcement_rule.m_rule_id = job_rates.m_rule_id ();
+            enforcement_rule.m_channel_id = channel_id;
+            enforcement_rule.m_enforcement_object_id = enforcement_object_id;
+            enforcement_rule.m_enforcement_operation = rate_operation;
+            enforcement_rule.m_property_first = limit_per_channel;
+
+            // stages that use the enforcement table pick the rule up at their next refill
+            if (table_written) {
+                table_written
+                    = data_session->second->WriteEnforcementRule (enforcement_rule).isOk ();
             }
+
+            commands.push_back (ControlCommand { CREATE_ENF_RULE, -1, enforcement_rule });
+        }
+
+        if (!table_written || option_default_enforcement_table_confirm) {
+            confirmations.emplace_back (std::move (stage_name_env), std::move (commands));
         }
     }
 
-    return status;
+    return Status::OK;
 }
 
 // CollectGlobalStatistics call. Collect Statistics request from core controller.
@@ -373,36 +520,105 @@ Status LocalControlApplication::CollectGlobalStatistics (ServerContext* context,
     Logging::log_info ("LocalControlApplication: Received collect statistics "
                        "request from core controller");
 
-    std::string rule = std::to_string (COLLECT_DETAILED_STATS) + "|"
-        + std::to_string (COLLECT_GLOBAL_STATS) + "|";
+    std::unique_lock<std::mutex> lock_t { stage_requests_lock_ };
+    collect_stage_statistics (reply);
+    report_disconnected_stages (reply);
 
-    // submit requests to each DataPlaneSession's submission_queue
-    for (auto const& data_session : data_sessions_) {
-        // put request on DataPlaneSession::submission_queue
-        data_session.second->SubmitRule (rule);
+    return Status::OK;
+}
+
+// StreamGlobalStatistics call. Pushes statistics to the core controller at the requested period.
+Status LocalControlApplication::StreamGlobalStatistics (ServerContext* context,
+    const controllers_grpc_interface::StatsStreamRequest* request,
+    grpc::ServerWriter<controllers_grpc_interface::StatsGlobalMap>* writer)
+{
+    Logging::log_info ("LocalControlApplication: Opened statistics stream with core controller ("
+        + std::to_string (request->m_period ()) + " µs)");
+
+    uint64_t sequence = 1;
+    auto period = microseconds (std::max<uint64_t> (request->m_period (), 1));
+    auto next_push = std::chrono::steady_clock::now ();
+
+    while (working_application_.load () && !context->IsCancelled ()) {
+        controllers_grpc_interface::StatsGlobalMap stats;
+
+        {
+            std::unique_lock<std::mutex> lock_t { stage_requests_lock_ };
+            collect_stage_statistics (&stats);
+        }
+
+        report_disconnected_stages (&stats);
+        stats.set_m_sequence (sequence++);
+        if (!writer->Write (stats)) {
+            break;
+        }
+
+        next_push += period;
+        std::this_thread::sleep_until (next_push);
     }
 
+    Logging::log_info ("LocalControlApplication: Closed statistics stream with core controller");
+
+    return Status::OK;
+}
+
+// collect_stage_statistics call. Collects the statistics of the active data plane stages.
+void LocalControlApplication::collect_stage_statistics (
+    controllers_grpc_interface::StatsGlobalMap* reply)
+{
     auto& stats_map = *reply->mutable_gl_stats ();
+    std::vector<StatsChannelRaw> channel_stats {};
+    std::vector<std::pair<std::string, std::shared_ptr<DataPlaneSession>>> sessions;
+    std::vector<std::pair<std::string, std::shared_ptr<DataPlaneSession>>> socket_sessions;
+
+    // the sessions are kept alive by the snapshot, so stages are waited for without
+    // data_sessions_lock_
+    {
+        std::unique_lock<std::mutex> lock_t { data_sessions_lock_ };
+        sessions.assign (data_sessions_.begin (), data_sessions_.end ());
+    }
 
-    std::list<std::string> sessions_to_delete;
+    for (auto const& data_session : sessions) {
+        // stages that publish in the statistics segment are read with plain memory loads
+        if (data_session.second->ReadStatistics (channel_stats).isOk ()) {
+            double total_rate = 0;
+            for (const auto& channel : channel_stats) {
+                total_rate += channel.m_ops_rate;
+            }
 
-    // collect requests from each DataPlaneSession's completion_queue
-    for (auto const& data_session : data_sessions_) {
+            controllers_grpc_interface::StatsGlobal stats_global;
+            stats_global.set_m_metadata_total_rate (total_rate);
+            fill_channel_statistics (channel_stats, &stats_global);
+            stats_map[data_session.first] = stats_global;
+        } else {
+            // put request on DataPlaneSession::submission_queue (with the subtype negotiated at
+            // handshake time)
+            data_session.second->SubmitRule (ControlCommand { COLLECT_DETAILED_STATS,
+                data_session.second->StatisticsSubtype () });
+            socket_sessions.push_back (data_session);
+        }
+    }
 
-        // wait for request to be on DataPlaneSession::completion_queue
-        std::unique_ptr<StageResponse> stats_ptr = data_session.second->GetResult ();
+    std::list<std::pair<std::string, std::shared_ptr<DataPlaneSession>>> sessions_to_delete;
+    auto deadline = std::chrono::steady_clock::now ()
+        + milliseconds (option_default_data_plane_response_timeout);
+
+    // collect requests from each DataPlaneSession's completion_queue
+    for (auto const& data_session : socket_sessions) {
+        // wait (until the deadline) for request to be on DataPlaneSession::completion_queue
+        std::unique_ptr<StageResponse> stats_ptr = data_session.second->GetResult (deadline);
 
         // verify if pointer is valid
         if (stats_ptr != nullptr) {
             // convert StageResponse unique-ptr to StageResponseStatsKVS
             auto* response_ptr = dynamic_cast<StageResponseStat*> (stats_ptr.get ());
 
-            if (response_ptr->get_total_rate () == -1) {
+            if (response_ptr == nullptr || response_ptr->get_total_rate () == -1) {
                 Logging::log_info ("LocalControlApplication: CollectGlobalStatistics ->"
                                    "Connection error; disconnecting from instance-"
                     + data_session.first);
-                this->m_active_data_plane_sessions.fetch_sub (1);
-                sessions_to_delete.push_back (data_session.first);
+                sessions_to_delete.push_back (data_session);
+                continue;
             }
 
             std::string name = data_session.first;
@@ -410,29 +626,40 @@ Status LocalControlApplication::CollectGlobalStatistics (ServerContext* context,
             controllers_grpc_interface::StatsGlobal stats_global;
 
             stats_global.set_m_metadata_total_rate (response_ptr->get_total_rate ());
+            fill_channel_statistics (response_ptr->get_channel_stats (), &stats_global);
 
             stats_map[name] = stats_global;
 
         } else {
+            // the stage did not answer before the deadline (its session was removed)
             Logging::log_info ("LocalControlApplication: CollectGlobalStatistics ->"
-                               "Connection error; disconnecting from instance-"
+                               "Unresponsive stage; disconnecting from instance-"
                 + data_session.first);
-            this->m_active_data_plane_sessions.fetch_sub (1);
+            sessions_to_delete.push_back (data_session);
         }
     }
 
-    for (auto const& data_session : sessions_to_delete) {
+    std::unique_lock<std::mutex> lock_t { data_sessions_lock_ };
+
+    for (auto const& [session_name, session] : sessions_to_delete) {
+        auto data_session = data_sessions_.find (session_name);
+        if (data_session == data_sessions_.end () || data_session->second != session) {
+            continue;
+        }
+
         Logging::log_info (
-            "LocalControlApplication: Deleting session in data_sessions_:" + data_session);
-        data_sessions_.at (data_session)->RemoveSession ();
+            "LocalControlApplication: Deleting session in data_sessions_:" + session_name);
+        session->RemoveSession ();
         data_sessions_.erase (data_session);
-    }
+        this->m_active_data_plane_sessions.fetch_sub (1);
 
-    return Status::OK;
+        // reported once, by the next reply of any statistics request
+        stage_sampler_.remove (session_name);
+    }
 }
 
 // CollectGlobalStatisticsAggregated call. Collect Statistics request from core controller.
-// It aggregates the statistics from several rounds.
+// It summarizes the samples collected in the background over the requested window.
 Status LocalControlApplication::CollectGlobalStatisticsAggregated (ServerContext* context,
     const controllers_grpc_interface::ControlOperation* request,
     controllers_grpc_interface::StatsGlobalMap* reply)
@@ -440,243 +667,388 @@ Status LocalControlApplication::CollectGlobalStatisticsAggregated (ServerContext
     Logging::log_info ("LocalControlApplication: Received collect aggregated statistics "
                        "request from core controller");
 
-    std::string rule = std::to_string (COLLECT_DETAILED_STATS) + "|"
-        + std::to_string (COLLECT_GLOBAL_STATS) + "|";
+    uint64_t window = request->m_window ();
+    if (window == 0) {
+        window = COLLECT_ROUNDS * this->m_feedback_loop_sleep_time;
+    }
+
+    std::unordered_map<std::string, RateSummary> summaries {};
+    stage_sampler_.summarize (window,
+        std::max (request->m_max_samples (), 0),
+        std::chrono::steady_clock::now (),
+        summaries);
 
     auto& stats_map = *reply->mutable_gl_stats ();
 
-    for (int i = 0; i < COLLECT_ROUNDS; i++) {
+    for (auto const& [stage_name_env, summary] : summaries) {
+        controllers_grpc_interface::StatsGlobal stats_global;
+        stats_global.set_m_metadata_total_rate (summary.m_mean);
+        stats_global.set_m_ewma_rate (summary.m_ewma);
+        stats_global.set_m_min_rate (summary.m_min);
+        stats_global.set_m_max_rate (summary.m_max);
+        stats_global.set_m_last_rate (summary.m_last);
+        stats_global.set_m_samples (summary.m_samples);
+        stats_global.set_m_rate_variance (summary.m_variance);
+        fill_channel_statistics (summary.m_channels, &stats_global);
+        stats_map[stage_name_env] = stats_global;
+    }
 
-        auto start = std::chrono::steady_clock::now ();
+    report_disconnected_stages (reply);
 
-        // submit requests to each DataPlaneSession's submission_queue
-        for (auto const& data_session : data_sessions_) {
-            // put request on DataPlaneSession::submission_queue
-            data_session.second->SubmitRule (rule);
-        }
+    return Status::OK;
+}
 
-        std::list<std::string> sessions_to_delete;
-
-        // collect requests from each DataPlaneSession's completion_queue
-        for (auto const& data_session : data_sessions_) {
-
-            // wait for request to be on DataPlaneSession::completion_queue
-            std::unique_ptr<StageResponse> stats_ptr = data_session.second->GetResult ();
-
-            // verify if pointer is valid
-            if (stats_ptr != nullptr) {
-                // convert StageResponse unique-ptr to StageResponseStatsKVS
-                auto* response_ptr = dynamic_cast<StageResponseStat*> (stats_ptr.get ());
-
-                if (response_ptr->get_total_rate () == -1) {
-                    Logging::log_info (
-                        "LocalControlApplication: CollectGlobalStatisticsAggregated ->"
-                        "Connection error; disconnecting from instance-"
-                        + data_session.first);
-                    this->m_active_data_plane_sessions.fetch_sub (1);
-                    sessions_to_delete.push_back (data_session.first);
-                } else {
-                    std::string name = data_session.first;
-
-                    if (!stats_map.contains (name)) {
-                        controllers_grpc_interface::StatsGlobal stats_global;
-                        stats_global.set_m_metadata_total_rate (response_ptr->get_total_rate ());
-                        stats_map[name] = stats_global;
-                    } else {
-                        auto stats_global = stats_map.at (name);
-                        double previous_value = stats_global.m_metadata_total_rate ();
-                        stats_global.set_m_metadata_total_rate (
-                            (double)(response_ptr->get_total_rate () + previous_value * i)
-                            / (i + 1));
-                        stats_map[name] = stats_global;
-                    }
-                }
+// report_disconnected_stages call. Adds the stages that disconnected since the last report to a
+// reply.
+void LocalControlApplication::report_disconnected_stages (
+    controllers_grpc_interface::StatsGlobalMap* reply)
+{
+    std::vector<std::string> disconnected_stages {};
+    stage_sampler_.take_disconnected (disconnected_stages);
 
-            } else {
-                Logging::log_info ("LocalControlApplication: CollectGlobalStatisticsAggregated ->"
-                                   "Connection error; disconnecting from instance-"
-                    + data_session.first);
-                this->m_active_data_plane_sessions.fetch_sub (1);
-            }
-        }
+    auto& stats_map = *reply->mutable_gl_stats ();
 
-        for (auto const& data_session : sessions_to_delete) {
-            controllers_grpc_interface::StatsGlobal stats_global;
-            stats_global.set_m_metadata_total_rate (-1);
-            stats_map[data_session] = stats_global;
-            Logging::log_info (
-                "LocalControlApplication: Deleting session in data_sessions_:" + data_session);
-            data_sessions_.erase (data_session);
+    for (auto const& stage_name_env : disconnected_stages) {
+        controllers_grpc_interface::StatsGlobal stats_global;
+        stats_global.set_m_metadata_total_rate (-1);
+        stats_map[stage_name_env] = stats_global;
+    }
+}
+
+// sample_stage_statistics call. Samples the statistics of the active data plane stages in the
+// background.
+void LocalControlApplication::sample_stage_statistics ()
+{
+    auto period = microseconds (option_default_local_sampling_period);
+    auto next_sample = std::chrono::steady_clock::now ();
+    Histogram& round_metric = Metrics::histogram ("cheferd_sampler_round_seconds",
+        "Duration of the rounds that sample the data plane stages.");
+    Gauge& stages_metric = Metrics::gauge ("cheferd_sampled_stages",
+        "Number of data plane stages sampled in the last round.");
+
+    while (working_application_.load ()) {
+        auto round_start = std::chrono::steady_clock::now ();
+        controllers_grpc_interface::StatsGlobalMap stats;
+
+        {
+            std::unique_lock<std::mutex> lock_t { stage_requests_lock_ };
+            collect_stage_statistics (&stats);
         }
 
-        auto end = std::chrono::steady_clock::now ();
+        RateSample sample {};
+        sample.m_time = std::chrono::steady_clock::now ();
+        std::vector<StatsChannelRaw> channels {};
+
+        for (auto const& [stage_name_env, stats_global] : stats.gl_stats ()) {
+            sample.m_rate = stats_global.m_metadata_total_rate ();
+
+            channels.clear ();
+            for (auto const& [channel_id, channel_stats] : stats_global.m_channel_stats ()) {
+                StatsChannelRaw channel {};
+                channel.m_channel_id = channel_id;
+                channel.m_ops_rate = channel_stats.m_ops_rate ();
+                channel.m_bytes_rate = channel_stats.m_bytes_rate ();
+                channel.m_total_ops = channel_stats.m_total_ops ();
+                channel.m_delayed_ops = channel_stats.m_delayed_ops ();
+                channel.m_avg_wait = channel_stats.m_avg_wait ();
+                channel.m_total_bytes = channel_stats.m_total_bytes ();
+                channel.m_timestamp = channel_stats.m_timestamp ();
+                channels.push_back (channel);
+            }
 
-        if (i < 4) {
-            std::this_thread::sleep_for (microseconds (this->m_feedback_loop_sleep_time
-                - std::chrono::duration_cast<std::chrono::microseconds> (end - start).count ()));
+            stage_sampler_.record (stage_name_env, sample, channels);
         }
-    }
 
-    return Status::OK;
+        round_metric.observe_since (round_start);
+        stages_metric.set (stats.gl_stats_size ());
+
+        // a slow round is not compensated by sampling in bursts
+        next_sample = std::max (next_sample + period, std::chrono::steady_clock::now ());
+        std::this_thread::sleep_until (next_sample);
+    }
 }
 
 ////////////////////////////////////////////
 //////////// Auxiliary Functions ///////////
 ////////////////////////////////////////////
 
+// fill_channel_statistics call. Adds the statistics of each channel of a data plane stage to its
+// statistics message.
+void LocalControlApplication::fill_channel_statistics (
+    const std::vector<StatsChannelRaw>& channel_stats,
+    controllers_grpc_interface::StatsGlobal* stats_global)
+{
+    if (channel_stats.empty ()) {
+        return;
+    }
+
+    stats_global->set_m_stats_version (stats_channel_version);
+    auto& channels_map = *stats_global->mutable_m_channel_stats ();
+
+    for (const auto& channel : channel_stats) {
+        controllers_grpc_interface::ChannelStats& stats = channels_map[channel.m_channel_id];
+        stats.set_m_ops_rate (channel.m_ops_rate);
+        stats.set_m_bytes_rate (channel.m_bytes_rate);
+        stats.set_m_total_ops (channel.m_total_ops);
+        stats.set_m_delayed_ops (channel.m_delayed_ops);
+        stats.set_m_avg_wait (channel.m_avg_wait);
+        stats.set_m_total_bytes (channel.m_total_bytes);
+        stats.set_m_timestamp (channel.m_timestamp);
+    }
+}
+
 //  initialize call. Initialize control application.
 void LocalControlApplication::initialize ()
-{ }
+{
+    // stages publish their statistics in the segment only if it exists
+    if (option_default_stats_segment) {
+        std::string name = "/cheferd_stats_" + std::to_string (getpid ());
+        if (!stats_segment_.create (name, option_default_stats_segment_slots).isOk ()) {
+            Logging::log_error ("LocalControlApplication: statistics segment not created; "
+                                "statistics are collected through the sockets.");
+        }
+    }
+
+    // stages apply their rules from the table only if it exists
+    if (option_default_enforcement_table) {
+        std::string name = "/cheferd_enforcement_" + std::to_string (getpid ());
+        if (!enforcement_table_.create (name, option_default_enforcement_table_slots).isOk ()) {
+            Logging::log_error ("LocalControlApplication: enforcement table not created; "
+                                "rules are submitted through the sockets.");
+        }
+    }
+}
 
 // handle_data_plane_sessions call. Processes pending data plane sessions.
 void LocalControlApplication::handle_data_plane_sessions ()
 {
-    if (!pending_data_sessions_.empty ()) {
-        Logging::log_debug ("LocalControlApplication: Data Plane Session Handshake");
+    std::unique_lock<std::mutex> lock_t { pending_data_plane_sessions_lock_ };
 
-        PStatus status = PStatus::Error ();
+    // each handshake runs in the handshake_pool_, which owns its session, so that data plane
+    // stages are handshaked concurrently (and never by the feedback loop)
+    while (!pending_data_sessions_.empty ()) {
+        Logging::log_debug ("LocalControlApplication: Data Plane Session Handshake");
 
-        pending_data_plane_sessions_lock_.lock ();
-        auto handshake_session = std::move (pending_data_sessions_.front ());
+        std::shared_ptr<HandshakeSession> handshake_session = pending_data_sessions_.front ();
         pending_data_sessions_.pop ();
-        pending_data_plane_sessions_lock_.unlock ();
 
-        m_pending_data_plane_sessions.fetch_sub (1);
+        asio::post (handshake_pool_, [this, handshake_session] () {
+            this->handshake_stage (handshake_session.get ());
 
-        /*Start Session*/
-        std::thread session_thread_t
-            = std::thread (&HandshakeSession::StartSession, handshake_session.get ());
-        session_thread_t.detach ();
+            // the data plane stage is no longer pending once it is active (or failed)
+            this->m_pending_data_plane_sessions.fetch_sub (1);
+        });
+    }
+}
 
-        // invoke CallStageHandshake routine to acknowledge the stage's identifier
-        //<stage_name, stage_env, stage_user>
-        std::unique_ptr<StageInfo> stage_identifier
-            = this->call_stage_handshake (handshake_session.get ());
+// handshake_stage call. Handshakes a data plane stage, and connects it to the core controller.
+void LocalControlApplication::handshake_stage (HandshakeSession* handshake_session)
+{
+    std::shared_ptr<DataPlaneSession> data_session {};
 
-        handshake_session->RemoveSession ();
+    // invoke CallStageHandshake routine to acknowledge the stage's identifier
+    //<stage_name, stage_env, stage_user>
+    std::unique_ptr<StageInfo> stage_identifier
+        = handshake_session->StartSession ().isOk ()
+        ? this->call_stage_handshake (handshake_session, data_session)
+        : std::make_unique<StageInfo> ();
 
-        if (!stage_identifier->m_stage_name.empty ()) {
-            // submit housekeeping rules to the data plane stage
-            std::string stage_env
-                = stage_identifier->m_stage_name + "+" + stage_identifier->m_stage_env;
+    handshake_session->RemoveSession ();
 
-            int installed_rules = this->submit_housekeeping_rules (stage_env);
+    if (stage_identifier->m_stage_name.empty () || data_session == nullptr) {
+        Logging::log_error ("DataPlaneSessionHandshake with DataPlaneStage (socket "
+            + std::to_string (handshake_session->SessionIdentifier ()) + ") not established.");
+        return;
+    }
 
-            Logging::log_debug ("LocalControlApplication: installed rules ... ("
-                + std::to_string (installed_rules) + ") in (" + stage_env + ")");
+    // submit housekeeping rules to the data plane stage
+    std::string stage_env = stage_identifier->m_stage_name + "+" + stage_identifier->m_stage_env;
 
-            if (installed_rules == housekeeping_rules_ptr_->size ()
-                && mark_stage_ready (stage_env).isOk ()) {
+    int installed_rules = this->submit_housekeeping_rules (data_session.get ());
 
-                Logging::log_debug ("LocalControlApplication: Connecting Stage to Global ("
-                    + stage_identifier->m_stage_name + ")");
+    Logging::log_debug ("LocalControlApplication: installed rules ... ("
+        + std::to_string (installed_rules) + ") in (" + stage_env + ")");
 
-                Status status = ConnectStageToGlobal (stage_identifier->m_stage_name,
-                    stage_identifier->m_stage_env,
-                    stage_identifier->m_stage_user);
+    int slot = -1;
 
-                if (status.ok ()) {
-                    m_active_data_plane_sessions.fetch_add (1);
+    // stages that do not report per-channel records are asked for their total rate
+    data_session->SetStatisticsSubtype (
+        this->negotiate_stats_version (stage_env, data_session.get ()).isOk ()
+            ? COLLECT_CHANNEL_STATS
+            : COLLECT_GLOBAL_STATS);
 
-                    Logging::log_debug ("DataPlaneSessionHandshake with DataPlaneStage-"
-                        + stage_identifier->m_stage_name + " successfully established.");
-                } else {
-                    Logging::log_error ("DataPlaneSessionHandshake with DataPlaneStage-"
-                        + stage_identifier->m_stage_name + " not established.");
+    // stages that do not publish their statistics are collected through their sockets
+    if (stats_segment_.is_mapped ()
+        && this->negotiate_shared_segment (stage_env,
+                   data_session.get (),
+                   STAGE_STATS_SEGMENT,
+                   stats_segment_,
+                   stats_segment_version,
+                   slot)
+               .isOk ()) {
+        data_session->AttachStatsSegment (&stats_segment_, slot);
+    }
 
-                    std::this_thread::sleep_for (milliseconds (100));
-                }
+    // stages that do not read the enforcement table receive their rules through their sockets
+    if (enforcement_table_.is_mapped ()
+        && this->negotiate_shared_segment (stage_env,
+                   data_session.get (),
+                   STAGE_ENF_TABLE,
+                   enforcement_table_,
+                   enforcement_table_version,
+                   slot)
+               .isOk ()) {
+        data_session->AttachEnforcementTable (&enforcement_table_, slot);
+    }
 
-            } else {
-                Logging::log_error ("DataPlaneSessionHandshake with DataPlaneStage-"
-                    + stage_identifier->m_stage_name + " not established.");
+    if (installed_rules == housekeeping_rules_ptr_->size ()
+        && mark_stage_ready (data_session.get ()).isOk ()) {
 
-                preparing_data_sessions_.at (stage_env)->RemoveSession ();
-                preparing_data_sessions_.erase (stage_env);
-            }
+        // the core controller marks the stage ready (MarkStageReady) once it is connected
+        {
+            std::unique_lock<std::mutex> lock_t { data_sessions_lock_ };
+            preparing_data_sessions_[stage_env] = data_session;
+        }
+
+        Logging::log_debug ("LocalControlApplication: Connecting Stage to Global ("
+            + stage_identifier->m_stage_name + ")");
+
+        Status status = ConnectStageToGlobal (stage_identifier->m_stage_name,
+            stage_identifier->m_stage_env,
+            stage_identifier->m_stage_user);
+
+        if (status.ok ()) {
+            m_active_data_plane_sessions.fetch_add (1);
+
+            Logging::log_debug ("DataPlaneSessionHandshake with DataPlaneStage-"
+                + stage_identifier->m_stage_name + " successfully established.");
+        } else {
+            Logging::log_error ("DataPlaneSessionHandshake with DataPlaneStage-"
+                + stage_identifier->m_stage_name + " not established.");
+
+            std::this_thread::sleep_for (milliseconds (100));
         }
+
+    } else {
+        Logging::log_error ("DataPlaneSessionHandshake with DataPlaneStage-"
+            + stage_identifier->m_stage_name + " not established.");
+
+        data_session->RemoveSession ();
     }
 }
 
 // call_stage_handshake call.  Submits STAGE_HANDSHAKE rule and housekeeping rules to data plane
 // stage.
 std::unique_ptr<StageInfo> LocalControlApplication::call_stage_handshake (
-    HandshakeSession* handshake_session)
+    HandshakeSession* handshake_session,
+    std::shared_ptr<DataPlaneSession>& data_session)
 {
     // create STAGE_HANDSHAKE request
-    std::string rule = std::to_string (STAGE_HANDSHAKE) + "|";
-    // put request on DataPlaneSession::submission_queue
+    ControlCommand command { STAGE_HANDSHAKE };
+    // send request to the data plane stage
 
-    handshake_session->SubmitRule (rule);
+    handshake_session->SubmitRule (command);
 
-    // wait for request to be on DataPlaneSession::completion_queue
-    std::unique_ptr<StageResponse> response_obj = handshake_session->GetResult ();
+    // wait (until the deadline) for the response of the data plane stage
+    auto deadline = std::chrono::steady_clock::now ()
+        + milliseconds (option_default_data_plane_response_timeout);
+    std::unique_ptr<StageResponse> response_obj = handshake_session->GetResult (deadline);
     // convert StageResponse to Handshake object
 
     auto* handshake_ptr = dynamic_cast<StageResponseHandshake*> (response_obj.get ());
+    // register instance index to stage_name_env
+    std::unique_ptr<StageInfo> all_stage_info = std::make_unique<StageInfo> ();
+
+    // stages that did not answer (before the deadline) are not identified
+    if (handshake_ptr == nullptr || handshake_ptr->get_stage_name ().empty ()) {
+        return all_stage_info;
+    }
 
     std::string stage_name_env
         = handshake_ptr->get_stage_name () + "+" + handshake_ptr->get_stage_env ();
 
     Logging::log_info ("LocalControlApplication: Stage Handshake with " + stage_name_env);
-    // register instance index to stage_name_env
-    std::unique_ptr<StageInfo> all_stage_info = std::make_unique<StageInfo> ();
-
-    if (handshake_ptr != nullptr) {
 
-        Logging::log_info ("LocalControlApplication: establishing UNIX connection with "
-                           "data plane stage.");
+    Logging::log_info ("LocalControlApplication: establishing UNIX connection with "
+                       "data plane stage.");
 
-        std::string socket_info;
-        PStatus status = fill_socket_info (handshake_ptr, socket_info);
+    std::string socket_info;
+    PStatus status = fill_socket_info (handshake_ptr, socket_info);
 
-        Logging::log_info ("LocalControlApplication: StageHandshake <" + socket_info + ">");
+    Logging::log_info ("LocalControlApplication: StageHandshake <" + socket_info + ">");
 
-        int port = -1;
+    int port = -1;
 
-        this->preparing_data_sessions_[stage_name_env]
-            = std::make_unique<DataPlaneSession> (socket_info.c_str ());
+    // the session listens right away, so the data plane stage may connect at any time
+    data_session = std::make_shared<DataPlaneSession> (&stage_reactor_, socket_info.c_str ());
 
-        std::thread session_thread_t = std::thread (&DataPlaneSession::StartSession,
-            (this->preparing_data_sessions_[stage_name_env]).get ());
-        session_thread_t.detach ();
+    /*Send info about the address and port to connect to*/
+    StageHandshakeRaw handshake_info {};
+    std::strncpy (handshake_info.m_address,
+        socket_info.c_str (),
+        stage_max_handshake_address_size - 1);
+    handshake_info.m_port = port;
+    handshake_session->SubmitRule (ControlCommand { STAGE_HANDSHAKE_INFO, -1, handshake_info });
 
-        /*Send info about the address and port to connect to*/
-        rule = std::to_string (STAGE_HANDSHAKE_INFO) + "|" + socket_info + "|"
-            + std::to_string (port) + "|";
-        handshake_session->SubmitRule (rule);
+    deadline = std::chrono::steady_clock::now ()
+        + milliseconds (option_default_data_plane_response_timeout);
+    handshake_session->GetResult (deadline);
 
-        std::unique_ptr<StageResponse> response_obj = handshake_session->GetResult ();
-        // convert StageResponse to Handshake object
-        // auto* handshake_ptr = dynamic_cast<StageResponseACK*> (response_obj.get ());
+    // accept the data plane stage and register its socket at the reactor (on failure, the
+    // commands submitted to the session are answered with an error response)
+    data_session->StartSession ();
 
-        all_stage_info->m_stage_name = handshake_ptr->get_stage_name ();
-        all_stage_info->m_stage_env = handshake_ptr->get_stage_env ();
-        all_stage_info->m_stage_user = handshake_ptr->get_stage_user ();
+    all_stage_info->m_stage_name = handshake_ptr->get_stage_name ();
+    all_stage_info->m_stage_env = handshake_ptr->get_stage_env ();
+    all_stage_info->m_stage_user = handshake_ptr->get_stage_user ();
 
-        // Logging message
-        Logging::log_info ("LocalControlApplication: StageHandshake <"
-            + handshake_ptr->get_stage_name () + ", "
-            + std::to_string (handshake_ptr->get_stage_pid ()) + ", "
-            + std::to_string (handshake_ptr->get_stage_ppid ()) + ">");
-    }
+    // Logging message
+    Logging::log_info ("LocalControlApplication: StageHandshake <"
+        + handshake_ptr->get_stage_name () + ", " + std::to_string (handshake_ptr->get_stage_pid ())
+        + ", " + std::to_string (handshake_ptr->get_stage_ppid ()) + ">");
 
     // return const value of the stage identifier's name
     return all_stage_info;
 }
 
+// negotiate_stats_version call. Exchanges the version of the per-channel statistics records with
+// a data plane stage.
+PStatus LocalControlApplication::negotiate_stats_version (const std::string& stage_name_env,
+    DataPlaneSession* data_session)
+{
+    PStatus status = data_session->SubmitRule (
+        ControlCommand { STAGE_STATS_VERSION, -1, StatsVersionRaw {} });
+
+    if (status.isOk ()) {
+        auto deadline = std::chrono::steady_clock::now ()
+            + milliseconds (option_default_data_plane_response_timeout);
+        std::unique_ptr<StageResponse> response = data_session->GetResult (deadline);
+        auto* ack_ptr = dynamic_cast<StageResponseACK*> (response.get ());
+
+        // stages of the previous version do not know the operation, and answer with an error
+        status = (ack_ptr != nullptr && ack_ptr->ACKValue () == static_cast<int> (AckCode::ok))
+            ? PStatus::OK ()
+            : PStatus::Error ();
+    }
+
+    Logging::log_debug ("LocalControlApplication: (" + stage_name_env + ") reports "
+        + (status.isOk () ? "per-channel" : "global") + " statistics");
+
+    return status;
+}
+
 // submit_housekeeping_rules call. Submits housekeeping rules to data plane stage.
-int LocalControlApplication::submit_housekeeping_rules (const std::string& stage_name_env) const
+int LocalControlApplication::submit_housekeeping_rules (DataPlaneSession* data_session) const
 {
     PStatus status = PStatus::Error ();
     int rule_counter = 0;
     int valid_housekeeping_rules = 0;
 
-    // read rules from housekeeping_rules_ptr and submit to the SubmissionQueue
-    for (const auto& value : *housekeeping_rules_ptr_) {
+    // read the (parsed) housekeeping rules and submit them to the SubmissionQueue
+    for (const auto& command : housekeeping_commands_) {
 
         // submit rule to the SubmissionQueue
-        status = preparing_data_sessions_.at (stage_name_env)->SubmitRule (value);
+        status = data_session->SubmitRule (command);
 
         // update the counter of submitted rules
         if (status.isOk ()) {
@@ -684,11 +1056,13 @@ int LocalControlApplication::submit_housekeeping_rules (const std::string& stage
         }
     }
 
-    // read responses from the CompletionQueue
+    // read responses from the CompletionQueue (an unresponsive stage has its session removed, so
+    // the remaining responses are errors)
+    auto deadline = std::chrono::steady_clock::now ()
+        + milliseconds (option_default_data_plane_response_timeout);
     for (int i = 0; i < rule_counter; i++) {
         // get rules from CompletionQueue and cast them to a StageResponseACK object
-        std::unique_ptr<StageResponse> response
-            = preparing_data_sessions_.at (stage_name_env)->GetResult ();
+        std::unique_ptr<StageResponse> response = data_session->GetResult (deadline);
         auto* ack_ptr = dynamic_cast<StageResponseACK*> (response.get ());
 
         // validate data plane stage response
@@ -705,18 +1079,17 @@ int LocalControlApplication::submit_housekeeping_rules (const std::string& stage
 }
 
 // mark_stage_ready call. Submits STAGE_READY to data plane stage.
-PStatus LocalControlApplication::mark_stage_ready (const std::string& stage_name_env) const
+PStatus LocalControlApplication::mark_stage_ready (DataPlaneSession* data_session) const
 {
     PStatus status = PStatus::Error ();
 
-    std::string rule = std::to_string (STAGE_READY) + "|";
-
-    status = preparing_data_sessions_.at (stage_name_env)->SubmitRule (rule);
+    status = data_session->SubmitRule (ControlCommand { STAGE_READY });
 
-    std::unique_ptr<StageResponse> response = nullptr;
     if (status.isOk ()) {
-        std::unique_ptr<StageResponse> response
-            = preparing_data_sessions_.at (stage_name_env)->GetResult ();
+        status = PStatus::Error ();
+        auto deadline = std::chrono::steady_clock::now ()
+            + milliseconds (option_default_data_plane_response_timeout);
+        std::unique_ptr<StageResponse> response = data_session->GetResult (deadline);
         auto* ack_ptr = dynamic_cast<StageResponseACK*> (response.get ());
 
         // validate data plane stage response
@@ -729,28 +1102,88 @@ PStatus LocalControlApplication::mark_stage_ready (const std::string& stage_name
     return status;
 }
 
+// negotiate_shared_segment call. Offers a slot of a shared-memory segment to a data plane stage.
+PStatus LocalControlApplication::negotiate_shared_segment (const std::string& stage_name_env,
+    DataPlaneSession* data_session,
+    int operation_type,
+    SharedSegment& segment,
+    uint32_t version,
+    int& slot)
+{
+    slot = segment.acquire_slot ();
+    if (slot == -1) {
+        Logging::log_debug ("LocalControlApplication: no free slot in " + segment.name ()
+            + " for (" + stage_name_env + ")");
+        return PStatus::Error ();
+    }
+
+    SharedSegmentRaw segment_info {};
+    std::strncpy (segment_info.m_name, segment.name ().c_str (), shared_segment_name_max_size - 1);
+    segment_info.m_version = version;
+    segment_info.m_slot = slot;
+
+    PStatus status
+        = data_session->SubmitRule (ControlCommand { operation_type, -1, segment_info });
+
+    if (status.isOk ()) {
+        auto deadline = std::chrono::steady_clock::now ()
+            + milliseconds (option_default_data_plane_response_timeout);
+        std::unique_ptr<StageResponse> response = data_session->GetResult (deadline);
+        auto* ack_ptr = dynamic_cast<StageResponseACK*> (response.get ());
+
+        // validate data plane stage response
+        status = (ack_ptr != nullptr && ack_ptr->ACKValue () == static_cast<int> (AckCode::ok))
+            ? PStatus::OK ()
+            : PStatus::Error ();
+    }
+
+    if (!status.isOk ()) {
+        segment.release_slot (slot);
+        slot = -1;
+    }
+
+    Logging::log_debug ("LocalControlApplication: (" + stage_name_env + ") "
+        + (status.isOk () ? "uses " : "does not use ") + segment.name ());
+
+    return status;
+}
+
 // LocalPassthru call. General function to submit rules to data plane stages.
 Status LocalControlApplication::LocalPassthru (const std::string stage_name_env,
-    const std::string rule)
+    std::vector<ControlCommand> commands)
 {
+    std::shared_ptr<DataPlaneSession> data_session {};
+    {
+        std::unique_lock<std::mutex> lock_t { data_sessions_lock_ };
+        auto session = this->data_sessions_.find (stage_name_env);
+        if (session == this->data_sessions_.end ()) {
+            return Status::CANCELLED;
+        }
+        data_session = session->second;
+    }
 
-    this->data_sessions_[stage_name_env]->SubmitRule (rule);
+    // submit every command before reading the responses, so that they are in flight at once
+    for (auto& command : commands) {
+        data_session->SubmitRule (std::move (command));
+    }
+
+    // an unresponsive stage has its session removed, and is deleted at the next collection
+    Status status = Status::OK;
+    auto deadline = std::chrono::steady_clock::now ()
+        + milliseconds (option_default_data_plane_response_timeout);
 
-    std::unique_ptr<StageResponse> ack_ptr = this->data_sessions_[stage_name_env]->GetResult ();
+    for (std::size_t i = 0; i < commands.size (); i++) {
+        std::unique_ptr<StageResponse> ack_ptr = data_session->GetResult (deadline);
 
-    // verify if pointer is valid
-    if (ack_ptr != nullptr) {
-        // convert StageResponse unique-ptr to StageResponseStatsKVS
+        // convert StageResponse unique-ptr to StageResponseACK
         auto* response_ptr = dynamic_cast<StageResponseACK*> (ack_ptr.get ());
 
-        if (response_ptr->ACKValue () == 1) {
-            return Status::OK;
-        } else {
-            return Status::CANCELLED;
+        if (response_ptr == nullptr || response_ptr->ACKValue () != 1) {
+            status = Status::CANCELLED;
         }
     }
 
-    return Status::CANCELLED;
+    return status;
 }
 
 // fill_socket_info call: Defines a new individual socket for data plane stage.
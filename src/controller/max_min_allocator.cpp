@@ -0,0 +1,74 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <cheferd/controller/max_min_allocator.hpp>
+#include <limits>
+
+namespace cheferd {
+
+// MaxMinAllocator default constructor.
+MaxMinAllocator::MaxMinAllocator () : order_ {}
+{ }
+
+// MaxMinAllocator default destructor.
+MaxMinAllocator::~MaxMinAllocator () = default;
+
+// allocate call. Computes the max-min fair allocation of capacity among jobs.
+long MaxMinAllocator::allocate (const std::vector<long>& demands,
+    long capacity,
+    std::vector<long>& rates)
+{
+    std::size_t total_jobs = demands.size ();
+    rates.assign (total_jobs, 0);
+
+    if (total_jobs == 0) {
+        return capacity;
+    }
+
+    // unbounded demands are served last, as if their demand were infinite
+    order_.resize (total_jobs);
+    for (std::size_t job = 0; job < total_jobs; job++) {
+        order_[job] = { demands[job] == UNBOUNDED_DEMAND ? std::numeric_limits<long>::max ()
+                                                         : demands[job],
+            job };
+    }
+
+    // pairs are ordered by demand, and then by position
+    std::sort (order_.begin (), order_.end ());
+
+    long left_capacity = std::max (capacity, 0L);
+    std::size_t position = 0;
+
+    // First phase: satisfy every job whose demand is below the current water level.
+    for (; position < total_jobs; position++) {
+        const auto& [demand, job] = order_[position];
+        long fair_share = left_capacity / static_cast<long> (total_jobs - position);
+
+        if (demand > fair_share) {
+            break;
+        }
+
+        rates[job] = demand;
+        left_capacity -= demand;
+    }
+
+    if (position == total_jobs) {
+        return left_capacity;
+    }
+
+    // Second phase: the remaining jobs all demand more than the water level, which they share.
+    long unsatisfied_jobs = static_cast<long> (total_jobs - position);
+    long fair_share = left_capacity / unsatisfied_jobs;
+    long remainder = left_capacity % unsatisfied_jobs;
+
+    for (std::size_t i = position; i < total_jobs; i++) {
+        bool takes_remainder = static_cast<long> (total_jobs - i) <= remainder;
+        rates[order_[i].second] = fair_share + (takes_remainder ? 1 : 0);
+    }
+
+    return 0;
+}
+
+} // namespace cheferd
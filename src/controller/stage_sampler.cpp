@@ -0,0 +1,156 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <cheferd/controller/stage_sampler.hpp>
+#include <iterator>
+
+namespace cheferd {
+
+// StageSampler parameterized constructor.
+StageSampler::StageSampler (std::size_t capacity) :
+    samples_ {},
+    disconnected_stages_ {},
+    capacity_ { capacity }
+{ }
+
+// StageSampler default destructor.
+StageSampler::~StageSampler () = default;
+
+// record call. Adds a sample of a data plane stage.
+void StageSampler::record (const std::string& stage_name_env,
+    const RateSample& sample,
+    const std::vector<StatsChannelRaw>& channels)
+{
+    std::unique_lock<std::mutex> lock_t { samples_lock_ };
+    StageSamples& samples = samples_.try_emplace (stage_name_env, capacity_).first->second;
+    samples.m_rates.push (sample);
+
+    for (const auto& channel : channels) {
+        auto channel_samples = samples.m_channels.try_emplace (channel.m_channel_id, capacity_);
+        channel_samples.first->second.push (channel);
+    }
+
+    // channels missing from the newest sample were removed from the stage
+    for (auto it = samples.m_channels.begin (); it != samples.m_channels.end ();) {
+        long channel_id = it->first;
+        bool sampled = std::any_of (channels.begin (),
+            channels.end (),
+            [channel_id] (const StatsChannelRaw& channel) {
+                return channel.m_channel_id == channel_id;
+            });
+        it = sampled ? std::next (it) : samples.m_channels.erase (it);
+    }
+}
+
+// remove call. Discards the samples of a data plane stage that disconnected.
+void StageSampler::remove (const std::string& stage_name_env)
+{
+    std::unique_lock<std::mutex> lock_t { samples_lock_ };
+    samples_.erase (stage_name_env);
+    disconnected_stages_.push_back (stage_name_env);
+}
+
+// summarize call. Summarizes the samples of each data plane stage collected within a window.
+void StageSampler::summarize (uint64_t window,
+    std::size_t max_samples,
+    std::chrono::steady_clock::time_point now,
+    std::unordered_map<std::string, RateSummary>& summaries)
+{
+    auto window_start = now - std::chrono::microseconds (window);
+    std::size_t limit = max_samples > 0 ? max_samples : capacity_;
+    std::unique_lock<std::mutex> lock_t { samples_lock_ };
+
+    for (auto const& [stage_name_env, stage_samples] : samples_) {
+        const RingBuffer<RateSample>& samples = stage_samples.m_rates;
+
+        if (samples.empty ()) {
+            continue;
+        }
+
+        // samples within the window, from the newest (a stale stage keeps its newest sample)
+        std::size_t in_window = 1;
+        while (in_window < std::min (samples.size (), limit)
+            && samples.from_newest (in_window).m_time >= window_start) {
+            in_window++;
+        }
+
+        RateSummary& summary = summaries[stage_name_env];
+        const RateSample& oldest = samples.from_newest (in_window - 1);
+        summary.m_min = oldest.m_rate;
+        summary.m_max = oldest.m_rate;
+        summary.m_ewma = oldest.m_rate;
+        double total = 0;
+        double total_squares = 0;
+
+        // visit from the oldest to the newest, so the newest samples weigh more in the EWMA
+        for (std::size_t age = in_window; age-- > 0;) {
+            double rate = samples.from_newest (age).m_rate;
+            total += rate;
+            total_squares += rate * rate;
+            summary.m_min = std::min (summary.m_min, rate);
+            summary.m_max = std::max (summary.m_max, rate);
+            summary.m_ewma = SAMPLE_EWMA_WEIGHT * rate + (1 - SAMPLE_EWMA_WEIGHT) * summary.m_ewma;
+        }
+
+        summary.m_mean = total / in_window;
+        summary.m_variance
+            = std::max (0.0, total_squares / in_window - summary.m_mean * summary.m_mean);
+        summary.m_last = samples.from_newest (0).m_rate;
+        summary.m_samples = static_cast<int> (in_window);
+
+        // channels take the same (newest) samples as the total rate
+        summary.m_channels.clear ();
+        bool exact = !stage_samples.m_channels.empty ();
+        double exact_total = 0;
+        for (auto const& [channel_id, channel_samples] : stage_samples.m_channels) {
+            std::size_t channel_window = std::min (in_window, channel_samples.size ());
+            StatsChannelRaw channel = channel_samples.from_newest (0);
+
+            // counters give the exact rate since the sample that precedes the window (or since
+            // the oldest sample in it); otherwise, the rates sampled are averaged
+            std::size_t baseline = std::min (channel_window, channel_samples.size () - 1);
+            if (baseline > 0
+                && ChannelCounters::rates_between (channel_samples.from_newest (baseline),
+                    channel,
+                    channel.m_ops_rate,
+                    channel.m_bytes_rate)) {
+                exact_total += channel.m_ops_rate;
+                summary.m_channels.push_back (channel);
+                continue;
+            }
+
+            exact = false;
+
+            double ops_total = 0;
+            double bytes_total = 0;
+
+            for (std::size_t age = 0; age < channel_window; age++) {
+                ops_total += channel_samples.from_newest (age).m_ops_rate;
+                bytes_total += channel_samples.from_newest (age).m_bytes_rate;
+            }
+
+            channel.m_ops_rate = ops_total / channel_window;
+            channel.m_bytes_rate = bytes_total / channel_window;
+            summary.m_channels.push_back (channel);
+        }
+
+        // with counters, the mean rate of the stage is exact over the window
+        if (exact) {
+            summary.m_mean = exact_total;
+        }
+    }
+}
+
+// take_disconnected call. Gets the stages that disconnected since the last call.
+void StageSampler::take_disconnected (std::vector<std::string>& disconnected_stages)
+{
+    std::unique_lock<std::mutex> lock_t { samples_lock_ };
+    disconnected_stages.insert (disconnected_stages.end (),
+        disconnected_stages_.begin (),
+        disconnected_stages_.end ());
+    disconnected_stages_.clear ();
+}
+
+} // namespace cheferd
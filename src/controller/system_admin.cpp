@@ -38,6 +38,14 @@ void SystemAdmin::operator() (CoreControlApplication* m_control_application)
             input_stream.open (option_dynamic_rules_with_time_file_path_);
             break;
         }
+        case ControlType::DYNAMIC_WATER_FILLING: {
+            input_stream.open (option_dynamic_rules_with_time_file_path_);
+            break;
+        }
+        case ControlType::MDS: {
+            input_stream.open (option_mds_rules_with_time_file_path_);
+            break;
+        }
         default:
             break;
     }
@@ -80,10 +88,8 @@ void SystemAdmin::operator() (CoreControlApplication* m_control_application)
 
         waitUntil = start_time + std::chrono::milliseconds (std::stoll (staged_rule[1]) * 1000);
 
-        // Check time
-        while (waitUntil > std::chrono::system_clock::now ()) {
-            std::this_thread::sleep_for (std::chrono::milliseconds (10));
-        }
+        // Wait until the rule's submission time
+        std::this_thread::sleep_until (waitUntil);
 
         // Submit to queue in Control
         Logging::log_debug ("SystemAdmin: Rule submitted " + enf_rule);
@@ -0,0 +1,243 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <cheferd/controller/time_series_store.hpp>
+#include <cmath>
+#include <limits>
+
+namespace cheferd {
+
+// Value of a series without a sample.
+static const float missing_value = std::numeric_limits<float>::quiet_NaN ();
+
+// TimeSeriesStore parameterized constructor.
+TimeSeriesStore::TimeSeriesStore (std::size_t capacity, std::size_t max_series) :
+    capacity_ { capacity > 0 ? capacity : 1 },
+    max_series_ { max_series },
+    head_ { 0 },
+    size_ { 0 },
+    total_series_ { 0 },
+    times_ (capacity_),
+    values_ (max_series_ * capacity_, missing_value),
+    id_series_ {},
+    free_series_ {}
+{
+    free_series_.reserve (max_series_);
+}
+
+// TimeSeriesStore default destructor.
+TimeSeriesStore::~TimeSeriesStore () = default;
+
+// slot call. Gets the slot of a sample by its age.
+std::size_t TimeSeriesStore::slot (std::size_t age) const
+{
+    return (head_ + capacity_ - age) % capacity_;
+}
+
+// series_of call. Gets the series assigned to an identifier.
+std::size_t TimeSeriesStore::series_of (std::size_t id) const
+{
+    return id < id_series_.size () ? id_series_[id] : no_series;
+}
+
+// release call. Releases the series of an identifier, to be reused by the next one recorded.
+void TimeSeriesStore::release (std::size_t id)
+{
+    std::size_t series = series_of (id);
+
+    if (series != no_series) {
+        id_series_[id] = no_series;
+        free_series_.push_back (series);
+    }
+}
+
+// advance call. Starts a new sample, where every series holds a missing value.
+void TimeSeriesStore::advance (std::chrono::steady_clock::time_point time)
+{
+    head_ = size_ == 0 ? 0 : (head_ + 1) % capacity_;
+    size_ = std::min (size_ + 1, capacity_);
+    times_[head_] = time;
+
+    for (std::size_t series = 0; series < total_series_; series++) {
+        values_[series * capacity_ + head_] = missing_value;
+    }
+}
+
+// record call. Sets the value of a series at the newest sample, assigning it if needed.
+bool TimeSeriesStore::record (std::size_t id, float value)
+{
+    std::size_t series = series_of (id);
+
+    if (series == no_series) {
+        if (!free_series_.empty ()) {
+            // a reused series drops the values of its previous identifier
+            series = free_series_.back ();
+            free_series_.pop_back ();
+            std::fill_n (values_.begin () + series * capacity_, capacity_, missing_value);
+        } else if (total_series_ < max_series_) {
+            series = total_series_++;
+        } else {
+            return false;
+        }
+
+        if (id >= id_series_.size ()) {
+            id_series_.resize (id + 1, no_series);
+        }
+        id_series_[id] = series;
+    }
+
+    if (size_ > 0) {
+        values_[series * capacity_ + head_] = value;
+    }
+
+    return true;
+}
+
+// window_length call. Gets the number of (newest) samples taken within a window.
+std::size_t TimeSeriesStore::window_length (std::chrono::microseconds window) const
+{
+    if (size_ == 0) {
+        return 0;
+    }
+
+    auto window_start = times_[head_] - window;
+    std::size_t length = 1;
+
+    while (length < size_ && times_[slot (length)] >= window_start) {
+        length++;
+    }
+
+    return length;
+}
+
+// count call. Gets the number of values of a series within the newest samples.
+std::size_t TimeSeriesStore::count (std::size_t id, std::size_t length) const
+{
+    std::size_t total = 0;
+
+    for_each_value (id, length, [&total] (std::size_t, float value) {
+        total += std::isnan (value) ? 0 : 1;
+        return true;
+    });
+
+    return total;
+}
+
+// mean call. Computes the mean of a series within the newest samples.
+double TimeSeriesStore::mean (std::size_t id, std::size_t length) const
+{
+    double total = 0;
+    std::size_t values = 0;
+
+    for_each_value (id, length, [&total, &values] (std::size_t, float value) {
+        if (!std::isnan (value)) {
+            total += value;
+            values++;
+        }
+        return true;
+    });
+
+    return values > 0 ? total / values : 0;
+}
+
+// trend call. Computes the trend (least-squares slope, per second) of a series.
+double TimeSeriesStore::trend (std::size_t id, std::size_t length) const
+{
+    double sum_t = 0;
+    double sum_v = 0;
+    double sum_tt = 0;
+    double sum_tv = 0;
+    std::size_t values = 0;
+
+    for_each_value (id, length, [&] (std::size_t position, float value) {
+        if (!std::isnan (value)) {
+            // seconds before the newest sample (negative), which keeps the sums small
+            double t = std::chrono::duration<double> (times_[position] - times_[head_]).count ();
+            sum_t += t;
+            sum_v += value;
+            sum_tt += t * t;
+            sum_tv += t * value;
+            values++;
+        }
+        return true;
+    });
+
+    double denominator = values * sum_tt - sum_t * sum_t;
+
+    return values < 2 || denominator == 0 ? 0 : (values * sum_tv - sum_t * sum_v) / denominator;
+}
+
+// percentile call. Computes a percentile of a series within the newest samples.
+double TimeSeriesStore::percentile (std::size_t id,
+    std::size_t length,
+    double percentile,
+    std::vector<float>& scratch) const
+{
+    scratch.clear ();
+
+    for_each_value (id, length, [&scratch] (std::size_t, float value) {
+        if (!std::isnan (value)) {
+            scratch.push_back (value);
+        }
+        return true;
+    });
+
+    if (scratch.empty ()) {
+        return 0;
+    }
+
+    // nearest-rank percentile
+    double rank = std::clamp (percentile, 0.0, 100.0) / 100 * (scratch.size () - 1);
+    auto nth = scratch.begin () + static_cast<std::ptrdiff_t> (std::lround (rank));
+    std::nth_element (scratch.begin (), nth, scratch.end ());
+
+    return *nth;
+}
+
+// is_idle call. Verifies if a series did not exceed a threshold within the newest samples.
+bool TimeSeriesStore::is_idle (std::size_t id, std::size_t length, double threshold) const
+{
+    bool idle = true;
+
+    for_each_value (id, length, [&idle, threshold] (std::size_t, float value) {
+        // comparisons with missing values are false
+        idle = !(value > threshold);
+        return idle;
+    });
+
+    return idle;
+}
+
+// size call. Gets the number of samples held.
+std::size_t TimeSeriesStore::size () const
+{
+    return size_;
+}
+
+// capacity call. Gets the number of samples held per series.
+std::size_t TimeSeriesStore::capacity () const
+{
+    return capacity_;
+}
+
+// max_series call. Gets the maximum number of series.
+std::size_t TimeSeriesStore::max_series () const
+{
+    return max_series_;
+}
+
+// total_series call. Gets the number of series assigned to identifiers.
+std::size_t TimeSeriesStore::total_series () const
+{
+    return total_series_ - free_series_.size ();
+}
+
+// memory_usage call. Gets the memory allocated for samples.
+std::size_t TimeSeriesStore::memory_usage () const
+{
+    return values_.capacity () * sizeof (float) + times_.capacity () * sizeof (times_[0]);
+}
+
+} // namespace cheferd
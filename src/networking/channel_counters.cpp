@@ -0,0 +1,65 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <cheferd/networking/channel_counters.hpp>
+
+namespace cheferd {
+
+// ChannelCounters default constructor.
+ChannelCounters::ChannelCounters () : last_counters_ {}
+{ }
+
+// ChannelCounters default destructor.
+ChannelCounters::~ChannelCounters () = default;
+
+// derive_rates call. Replaces the rates of each channel with the rates derived from its counters.
+void ChannelCounters::derive_rates (std::vector<StatsChannelRaw>& channel_stats)
+{
+    for (auto& channel : channel_stats) {
+        if (channel.m_timestamp == 0) {
+            continue;
+        }
+
+        auto [last, inserted] = last_counters_.try_emplace (channel.m_channel_id, channel);
+
+        if (!inserted) {
+            double ops_rate;
+            double bytes_rate;
+
+            if (rates_between (last->second, channel, ops_rate, bytes_rate)) {
+                channel.m_ops_rate = ops_rate;
+                channel.m_bytes_rate = bytes_rate;
+            }
+            last->second = channel;
+        }
+    }
+}
+
+// clear call. Discards the last report of every channel.
+void ChannelCounters::clear ()
+{
+    last_counters_.clear ();
+}
+
+// rates_between call. Computes the rates of a channel between two of its reports.
+bool ChannelCounters::rates_between (const StatsChannelRaw& previous,
+    const StatsChannelRaw& current,
+    double& ops_rate,
+    double& bytes_rate)
+{
+    if (previous.m_timestamp == 0 || current.m_timestamp <= previous.m_timestamp
+        || current.m_total_ops < previous.m_total_ops
+        || current.m_total_bytes < previous.m_total_bytes) {
+        return false;
+    }
+
+    // timestamps are in nanoseconds
+    double interval = static_cast<double> (current.m_timestamp - previous.m_timestamp) / 1e9;
+    ops_rate = static_cast<double> (current.m_total_ops - previous.m_total_ops) / interval;
+    bytes_rate = static_cast<double> (current.m_total_bytes - previous.m_total_bytes) / interval;
+
+    return true;
+}
+
+} // namespace cheferd
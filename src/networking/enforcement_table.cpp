@@ -0,0 +1,98 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <cheferd/networking/enforcement_table.hpp>
+#include <new>
+
+namespace cheferd {
+
+// EnforcementTable default constructor.
+EnforcementTable::EnforcementTable () : SharedSegment {}
+{ }
+
+// EnforcementTable default destructor.
+EnforcementTable::~EnforcementTable () = default;
+
+// initialize_slot call. Initializes a slot (no rules written).
+void EnforcementTable::initialize_slot (void* slot)
+{
+    new (slot) EnforcementTableSlotRaw {};
+}
+
+// create call. Creates the table (local controller side).
+PStatus EnforcementTable::create (const std::string& name, int slots)
+{
+    return SharedSegment::create (name,
+        slots,
+        enforcement_table_version,
+        sizeof (EnforcementTableSlotRaw));
+}
+
+// attach call. Attaches to a table created by the local controller (data plane stage side).
+PStatus EnforcementTable::attach (const std::string& name)
+{
+    return SharedSegment::attach (name,
+        enforcement_table_version,
+        sizeof (EnforcementTableSlotRaw));
+}
+
+// write call. Writes the enforcement rule of an enforcement object of a data plane stage.
+uint64_t EnforcementTable::write (int slot, int entry, const EnforcementRuleRaw& rule)
+{
+    auto* target_slot = static_cast<EnforcementTableSlotRaw*> (slot_address (slot));
+    if (target_slot == nullptr || entry < 0 || entry >= enforcement_table_max_rules) {
+        return 0;
+    }
+
+    EnforcementEntryRaw& target = target_slot->m_entries[entry];
+    uint64_t generation = target.m_generation.load (std::memory_order_relaxed);
+
+    // odd while the rule is written
+    target.m_generation.store (generation + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    target.m_rule = rule;
+
+    target.m_generation.store (generation + 2, std::memory_order_release);
+
+    return generation + 2;
+}
+
+// read call. Reads the enforcement rule of an enforcement object, if it changed since its last
+// read.
+PStatus EnforcementTable::read (int slot,
+    int entry,
+    uint64_t& generation,
+    EnforcementRuleRaw& rule) const
+{
+    const auto* source_slot = static_cast<const EnforcementTableSlotRaw*> (slot_address (slot));
+    if (source_slot == nullptr || entry < 0 || entry >= enforcement_table_max_rules) {
+        return PStatus::Error ();
+    }
+
+    const EnforcementEntryRaw& source = source_slot->m_entries[entry];
+
+    for (int i = 0; i < ENFORCEMENT_TABLE_READ_RETRIES; i++) {
+        uint64_t current = source.m_generation.load (std::memory_order_acquire);
+        if (current == generation) {
+            return PStatus::Error ();
+        } else if (current & 1) {
+            continue;
+        }
+
+        EnforcementRuleRaw copy = source.m_rule;
+
+        // the copy is only valid if no write started meanwhile
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (source.m_generation.load (std::memory_order_relaxed) == current) {
+            rule = copy;
+            generation = current;
+            return PStatus::OK ();
+        }
+    }
+
+    return PStatus::Error ();
+}
+
+} // namespace cheferd
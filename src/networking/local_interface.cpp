@@ -10,7 +10,27 @@ namespace cheferd {
 // LocalInterface parameterized constructor.
 LocalInterface::LocalInterface (const std::string& user_address) :
     stub_ (GlobalToLocal::NewStub (
-        grpc::CreateChannel (user_address, grpc::InsecureChannelCredentials ())))
+        grpc::CreateChannel (user_address, grpc::InsecureChannelCredentials ()))),
+    poller_ { nullptr },
+    in_flight_call_ { nullptr },
+    stream_context_ { nullptr },
+    stream_cancelled_ { false },
+    rpc_latency_metric_ { Metrics::histogram ("cheferd_local_rpc_seconds",
+        "Latency of the unary calls to local controllers.",
+        "local=\"" + user_address + "\"") }
+{ }
+
+// LocalInterface parameterized constructor.
+LocalInterface::LocalInterface (const std::string& user_address, LocalInterfacePoller* poller) :
+    stub_ (GlobalToLocal::NewStub (
+        grpc::CreateChannel (user_address, grpc::InsecureChannelCredentials ()))),
+    poller_ { poller },
+    in_flight_call_ { nullptr },
+    stream_context_ { nullptr },
+    stream_cancelled_ { false },
+    rpc_latency_metric_ { Metrics::histogram ("cheferd_local_rpc_seconds",
+        "Latency of the unary calls to local controllers.",
+        "local=\"" + user_address + "\"") }
 { }
 
 // LocalInterface default destructor.
@@ -20,7 +40,7 @@ LocalInterface::~LocalInterface () = default;
 // of the housekeeping rules that should be imposed at the data plane stages.
 PStatus LocalInterface::local_handshake (const std::string& user_address,
     ControlOperation* operation,
-    const std::string& rule,
+    const std::vector<std::string>& rules,
     ACK& response)
 {
     controllers_grpc_interface::ACK reply;
@@ -31,16 +51,17 @@ PStatus LocalInterface::local_handshake (const std::string& user_address,
     operation1.set_m_operation_type (LOCAL_HANDSHAKE);
     operation1.set_m_size (sizeof (struct StageSimplifiedHandshakeRaw));
 
-    // parsing phase
     controllers_grpc_interface::LocalSimplifiedHandshakeRaw housekeeping_rules;
-    fill_housekeeping_rules_grpc (&housekeeping_rules, rule);
+    fill_housekeeping_rules_grpc (&housekeeping_rules, rules);
 
     // Context for the client. It could be used to convey extra information to
     // the server and/or tweak certain RPC behaviors.
     ClientContext context;
 
     // The actual RPC.
+    auto start = std::chrono::steady_clock::now ();
     Status status = stub_->LocalHandshake (&context, housekeeping_rules, &reply);
+    rpc_latency_metric_.observe_since (start);
 
     if (!status.ok ()) {
         Logging::log_error (
@@ -77,7 +98,9 @@ PStatus LocalInterface::stage_handshake (const std::string& user_address,
     ClientContext context;
 
     // The actual RPC.
+    auto start = std::chrono::steady_clock::now ();
     Status status = stub_->StageHandshake (&context, operation1, &reply);
+    rpc_latency_metric_.observe_since (start);
 
     if (!status.ok ()) {
         Logging::log_error (
@@ -109,7 +132,7 @@ PStatus LocalInterface::stage_handshake (const std::string& user_address,
 // mark_stage_ready call. Mark data plane stage as ready.
 PStatus LocalInterface::mark_stage_ready (const std::string& user_address,
     ControlOperation* operation,
-    const std::string& rule,
+    const std::string& stage_name_env,
     ACK& response)
 {
     controllers_grpc_interface::ACK reply;
@@ -118,95 +141,31 @@ PStatus LocalInterface::mark_stage_ready (const std::string& user_address,
     // the server and/or tweak certain RPC behaviors.
     ClientContext context;
 
-    // parsing phase
-    std::vector<std::string> rule_tokens {};
-    this->parse_rule (rule, &rule_tokens, '|');
-
     controllers_grpc_interface::StageReadyRaw stage_ready_raw;
-    stage_ready_raw.set_m_mark_stage (true);
-    stage_ready_raw.set_stage_name_env (rule_tokens[1]);
+    fill_stage_ready_grpc (&stage_ready_raw, stage_name_env);
 
+    auto start = std::chrono::steady_clock::now ();
     Status status = stub_->MarkStageReady (&context, stage_ready_raw, &reply);
+    rpc_latency_metric_.observe_since (start);
 
-    response.m_message = reply.m_message ();
-
-    if (!status.ok ()) {
-        Logging::log_error (
-            "LocalInterface: mark_stage_ready (channel): Error while writing stage ready ("
-            + status.error_message () + ").");
-        return PStatus::Error ();
-    } else if (reply.m_message () == static_cast<int> (AckCode::ok)) {
-        Logging::log_debug ("LocalInterface: mark_stage_ready: ACK message received ("
-            + std::to_string (response.m_message) + ").");
-        return PStatus::OK ();
-    } else {
-        return PStatus::Error ();
-    }
+    return handle_ack_reply ("mark_stage_ready", status, reply, response);
 }
 
 // create_enforcement_rule call. Submit enforcement rules to the local controller pass to its
 // data plane stages.
 PStatus LocalInterface::create_enforcement_rule (const std::string& user_address,
     ControlOperation* operation,
-    const std::string& rule,
+    const std::vector<JobEnforcementRule>& rules,
     ACK& response)
 {
     // validate if logging is enabled and log debug message
     if (Logging::is_debug_enabled ()) {
-        Logging::log_debug ("LocalInterface: create_enforcement_rule: " + rule);
+        Logging::log_debug ("LocalInterface: create_enforcement_rule: "
+            + std::to_string (rules.size ()) + " jobs");
     }
 
-    size_t start0;
-    size_t end0 = 0;
-    bool first = true;
-
     controllers_grpc_interface::EnforcementRules create_enforcement_rule;
-    auto& op_map = *create_enforcement_rule.mutable_operation_rules ();
-
-    while ((start0 = rule.find_first_not_of ('.', end0)) != std::string::npos) {
-        end0 = rule.find ('.', start0);
-
-        // Exclude LOCAL_HANDSHAKE |
-        if (first) {
-            first = false;
-            continue;
-        }
-
-        std::string cur_rule = rule.substr (start0, end0 - start0);
-
-        std::vector<std::string> rule_tokens {};
-        this->parse_rule (cur_rule, &rule_tokens, '|');
-
-        controllers_grpc_interface::EnforcementOpRules create_enforcement_op_rule;
-
-        create_enforcement_op_rule.set_m_rule_id (std::stoll (rule_tokens[0]));
-        create_enforcement_op_rule.set_m_stage_name (rule_tokens[1]);
-
-        auto& rules_map = *create_enforcement_op_rule.mutable_env_rates ();
-
-        size_t start1;
-        size_t end1 = 0;
-
-        while ((start1 = rule_tokens[3].find_first_not_of ('*', end1)) != std::string::npos) {
-            end1 = rule_tokens[3].find ('*', start1);
-
-            std::string token_rule = rule_tokens[3].substr (start1, end1 - start1);
-
-            size_t start2;
-            size_t end2 = 0;
-
-            std::vector<std::string> tokens = {};
-            while ((start2 = token_rule.find_first_not_of (':', end2)) != std::string::npos) {
-                end2 = token_rule.find (':', start2);
-                tokens.push_back (token_rule.substr (start2, end2 - start2));
-            }
-
-            auto env = std::stoll (tokens[0]);
-            rules_map[env] = std::stoll (tokens[1]);
-        }
-
-        op_map[rule_tokens[2]] = create_enforcement_op_rule;
-    }
+    fill_enforcement_rules_grpc (&create_enforcement_rule, rules);
 
     controllers_grpc_interface::ACK reply;
     // Context for the client. It could be used to convey extra information to
@@ -214,22 +173,11 @@ PStatus LocalInterface::create_enforcement_rule (const std::string& user_address
     ClientContext context;
 
     // write EnforcementRule object through user_address
+    auto start = std::chrono::steady_clock::now ();
     Status status = stub_->CreateEnforcementRule (&context, create_enforcement_rule, &reply);
+    rpc_latency_metric_.observe_since (start);
 
-    response.m_message = reply.m_message ();
-    if (!status.ok ()) {
-        Logging::log_error (
-            "LocalInterface: create_enforcement_rule: Error while writing enforcement rule object "
-            "to the local controler ("
-            + status.error_message () + ").");
-        return PStatus::Error ();
-    } else if (reply.m_message () == static_cast<int> (AckCode::ok)) {
-        Logging::log_debug ("LocalInterface: create_enforcement_rule: ACK message received ("
-            + std::to_string (response.m_message) + ").");
-        return PStatus::OK ();
-    } else {
-        return PStatus::Error ();
-    }
+    return handle_ack_reply ("create_enforcement_rule", status, reply, response);
 }
 
 // collect_global_statistics call. Collect statistics from data plane stages.
@@ -246,7 +194,9 @@ PStatus LocalInterface::collect_global_statistics (const std::string& user_addre
     // the server and/or tweak certain RPC behaviors.
     ClientContext context;
 
+    auto start = std::chrono::steady_clock::now ();
     Status status = stub_->CollectGlobalStatistics (&context, operation1, &reply);
+    rpc_latency_metric_.observe_since (start);
 
     if (!status.ok ()) {
         Logging::log_error (
@@ -254,12 +204,7 @@ PStatus LocalInterface::collect_global_statistics (const std::string& user_addre
             + status.error_message () + ").");
         return PStatus::Error ();
     } else {
-        for (auto stats : reply.gl_stats ()) {
-
-            stats_tf_objects->emplace (stats.first,
-                std::make_unique<StageResponseStat> (COLLECT_GLOBAL_STATS,
-                    stats.second.m_metadata_total_rate ()));
-        }
+        fill_global_statistics (reply, COLLECT_GLOBAL_STATS, stats_tf_objects);
 
         return PStatus::OK ();
     }
@@ -268,10 +213,16 @@ PStatus LocalInterface::collect_global_statistics (const std::string& user_addre
 // collect_global_statistics_aggregated call. Collect aggregated statistics from data plane stages.
 PStatus LocalInterface::collect_global_statistics_aggregated (const std::string& user_address,
     ControlOperation* operation,
+    uint64_t window,
+    int max_samples,
     std::unique_ptr<std::unordered_map<std::string, std::unique_ptr<StageResponse>>>&
         stats_tf_objects)
 {
     controllers_grpc_interface::ControlOperation operation1;
+    operation1.set_m_operation_type (COLLECT_DETAILED_STATS);
+    operation1.set_m_operation_subtype (COLLECT_GLOBAL_STATS_AGGREGATED);
+    operation1.set_m_window (window);
+    operation1.set_m_max_samples (max_samples);
 
     controllers_grpc_interface::StatsGlobalMap reply;
 
@@ -279,65 +230,330 @@ PStatus LocalInterface::collect_global_statistics_aggregated (const std::string&
     // the server and/or tweak certain RPC behaviors.
     ClientContext context;
 
-    Status status = stub_->CollectGlobalStatistics (&context, operation1, &reply);
+    auto start = std::chrono::steady_clock::now ();
+    Status status = stub_->CollectGlobalStatisticsAggregated (&context, operation1, &reply);
+    rpc_latency_metric_.observe_since (start);
 
     if (!status.ok ()) {
-        Logging::log_error (
-            "LocalInterface: collect_tensorflow_statistics: Error while writing control operation ("
+        Logging::log_error ("LocalInterface: collect_global_statistics_aggregated: Error while "
+                            "writing control operation ("
             + status.error_message () + ").");
         return PStatus::Error ();
     } else {
-        for (auto stats : reply.gl_stats ()) {
+        fill_global_statistics (reply, COLLECT_GLOBAL_STATS_AGGREGATED, stats_tf_objects);
+
+        return PStatus::OK ();
+    }
+}
 
-            stats_tf_objects->emplace (stats.first,
-                std::make_unique<StageResponseStat> (COLLECT_GLOBAL_STATS,
-                    stats.second.m_metadata_total_rate ()));
+// stream_global_statistics call. Opens a long-lived stream through which the local controller
+// pushes the statistics of its data plane stages at the given period.
+PStatus LocalInterface::stream_global_statistics (uint64_t period,
+    const StatsStreamCallback& on_stats)
+{
+    ClientContext context;
+
+    {
+        std::unique_lock<std::mutex> lock_t { stream_lock_ };
+        if (stream_cancelled_) {
+            return PStatus::Error ();
         }
+        stream_context_ = &context;
+    }
 
-        return PStatus::OK ();
+    controllers_grpc_interface::StatsStreamRequest request;
+    request.set_m_period (period);
+
+    std::unique_ptr<grpc::ClientReader<controllers_grpc_interface::StatsGlobalMap>> reader
+        = stub_->StreamGlobalStatistics (&context, request);
+
+    controllers_grpc_interface::StatsGlobalMap stats;
+    while (reader->Read (&stats)) {
+        on_stats (stats);
+    }
+
+    Status status = reader->Finish ();
+
+    {
+        std::unique_lock<std::mutex> lock_t { stream_lock_ };
+        stream_context_ = nullptr;
+    }
+
+    if (!status.ok ()) {
+        Logging::log_error ("LocalInterface: stream_global_statistics: Stream closed ("
+            + status.error_message () + ").");
+        return PStatus::Error ();
+    }
+
+    return PStatus::OK ();
+}
+
+// cancel_statistics_stream call. Cancels the statistics stream, and prevents new streams from
+// being opened.
+void LocalInterface::cancel_statistics_stream ()
+{
+    std::unique_lock<std::mutex> lock_t { stream_lock_ };
+    stream_cancelled_ = true;
+
+    if (stream_context_ != nullptr) {
+        stream_context_->TryCancel ();
     }
 }
 
 ////////////////////////////////////////////
-//////////// Auxiliary Functions ///////////
+///////////// Asynchronous Calls ///////////
 ////////////////////////////////////////////
 
-// parse_rule call. Parse a rule into tokens using char c as delimiter.
-void LocalInterface::parse_rule (const std::string& rule,
-    std::vector<std::string>* tokens,
-    const char c)
+// is_async call. Verifies if the interface submits asynchronous calls.
+bool LocalInterface::is_async () const
 {
-    size_t start;
-    size_t end = 0;
+    return poller_ != nullptr;
+}
+
+// start_async_call call. Submits an asynchronous unary call to the shared completion queue.
+template <typename Reply, typename Request, typename Prepare>
+void LocalInterface::start_async_call (Prepare prepare,
+    const Request& request,
+    std::function<void (const Status&, const Reply&)> on_complete)
+{
+    // the call is deleted by the poller once completed
+    auto* call = new LocalAsyncUnaryCall<Reply> ();
+
+    auto start = std::chrono::steady_clock::now ();
+    call->m_on_complete = [this, on_complete, start] (const Status& status, const Reply& reply) {
+        rpc_latency_metric_.observe_since (start);
+        {
+            std::unique_lock<std::mutex> lock_t { in_flight_call_lock_ };
+            in_flight_call_ = nullptr;
+        }
+        on_complete (status, reply);
+    };
 
-    while ((start = rule.find_first_not_of (c, end)) != std::string::npos) {
-        end = rule.find (c, start);
-        tokens->push_back (rule.substr (start, end - start));
+    {
+        std::unique_lock<std::mutex> lock_t { in_flight_call_lock_ };
+        in_flight_call_ = call;
     }
+
+    call->m_reader = prepare (&call->m_context, request, poller_->completion_queue ());
+    call->m_reader->StartCall ();
+    call->m_reader->Finish (&call->m_reply, &call->m_status, call);
 }
 
-// fill_create_channel_rule call. Fill LocalSimplifiedHandshakeRaw with rule data.
+// async_local_handshake call. Asynchronous version of local_handshake.
+void LocalInterface::async_local_handshake (const std::vector<std::string>& rules,
+    ACKCallback on_complete)
+{
+    controllers_grpc_interface::LocalSimplifiedHandshakeRaw housekeeping_rules;
+    fill_housekeeping_rules_grpc (&housekeeping_rules, rules);
+
+    start_async_call<controllers_grpc_interface::ACK> (
+        [this] (ClientContext* context,
+            const controllers_grpc_interface::LocalSimplifiedHandshakeRaw& request,
+            grpc::CompletionQueue* cq) {
+            return stub_->PrepareAsyncLocalHandshake (context, request, cq);
+        },
+        housekeeping_rules,
+        [on_complete] (const Status& status, const controllers_grpc_interface::ACK& reply) {
+            ACK response {};
+            PStatus result = handle_ack_reply ("local_handshake", status, reply, response);
+            on_complete (result, response);
+        });
+}
+
+// async_mark_stage_ready call. Asynchronous version of mark_stage_ready.
+void LocalInterface::async_mark_stage_ready (const std::string& stage_name_env,
+    ACKCallback on_complete)
+{
+    controllers_grpc_interface::StageReadyRaw stage_ready_raw;
+    fill_stage_ready_grpc (&stage_ready_raw, stage_name_env);
+
+    start_async_call<controllers_grpc_interface::ACK> (
+        [this] (ClientContext* context,
+            const controllers_grpc_interface::StageReadyRaw& request,
+            grpc::CompletionQueue* cq) {
+            return stub_->PrepareAsyncMarkStageReady (context, request, cq);
+        },
+        stage_ready_raw,
+        [on_complete] (const Status& status, const controllers_grpc_interface::ACK& reply) {
+            ACK response {};
+            PStatus result = handle_ack_reply ("mark_stage_ready", status, reply, response);
+            on_complete (result, response);
+        });
+}
+
+// async_create_enforcement_rule call. Asynchronous version of create_enforcement_rule.
+void LocalInterface::async_create_enforcement_rule (const std::vector<JobEnforcementRule>& rules,
+    ACKCallback on_complete)
+{
+    controllers_grpc_interface::EnforcementRules create_enforcement_rule;
+    fill_enforcement_rules_grpc (&create_enforcement_rule, rules);
+
+    start_async_call<controllers_grpc_interface::ACK> (
+        [this] (ClientContext* context,
+            const controllers_grpc_interface::EnforcementRules& request,
+            grpc::CompletionQueue* cq) {
+            return stub_->PrepareAsyncCreateEnforcementRule (context, request, cq);
+        },
+        create_enforcement_rule,
+        [on_complete] (const Status& status, const controllers_grpc_interface::ACK& reply) {
+            ACK response {};
+            PStatus result = handle_ack_reply ("create_enforcement_rule", status, reply, response);
+            on_complete (result, response);
+        });
+}
+
+// async_collect_global_statistics call. Asynchronous version of collect_global_statistics and
+// collect_global_statistics_aggregated.
+void LocalInterface::async_collect_global_statistics (ControlOperation* operation,
+    uint64_t window,
+    int max_samples,
+    StatsCallback on_complete)
+{
+    controllers_grpc_interface::ControlOperation operation1;
+    int subtype = operation->m_operation_subtype;
+    bool aggregated = subtype == COLLECT_GLOBAL_STATS_AGGREGATED;
+
+    if (aggregated) {
+        operation1.set_m_operation_type (COLLECT_DETAILED_STATS);
+        operation1.set_m_operation_subtype (COLLECT_GLOBAL_STATS_AGGREGATED);
+        operation1.set_m_window (window);
+        operation1.set_m_max_samples (max_samples);
+    }
+
+    start_async_call<controllers_grpc_interface::StatsGlobalMap> (
+        [this, aggregated] (ClientContext* context,
+            const controllers_grpc_interface::ControlOperation& request,
+            grpc::CompletionQueue* cq) {
+            return aggregated
+                ? stub_->PrepareAsyncCollectGlobalStatisticsAggregated (context, request, cq)
+                : stub_->PrepareAsyncCollectGlobalStatistics (context, request, cq);
+        },
+        operation1,
+        [on_complete, subtype] (const Status& status,
+            const controllers_grpc_interface::StatsGlobalMap& reply) {
+            std::unique_ptr<std::unordered_map<std::string, std::unique_ptr<StageResponse>>>
+                stats_tf_objects = std::make_unique<
+                    std::unordered_map<std::string, std::unique_ptr<StageResponse>>> ();
+
+            if (!status.ok ()) {
+                Logging::log_error ("LocalInterface: collect_global_statistics: Error while "
+                                    "writing control operation ("
+                    + status.error_message () + ").");
+                on_complete (PStatus::Error (), stats_tf_objects);
+            } else {
+                fill_global_statistics (reply, subtype, stats_tf_objects);
+                on_complete (PStatus::OK (), stats_tf_objects);
+            }
+        });
+}
+
+// cancel_async_call call. Cancels the asynchronous call in flight, if any.
+void LocalInterface::cancel_async_call ()
+{
+    std::unique_lock<std::mutex> lock_t { in_flight_call_lock_ };
+    if (in_flight_call_ != nullptr) {
+        in_flight_call_->m_context.TryCancel ();
+    }
+}
+
+////////////////////////////////////////////
+//////////// Auxiliary Functions ///////////
+////////////////////////////////////////////
+
+// fill_housekeeping_rules_grpc call. Fill LocalSimplifiedHandshakeRaw with housekeeping rules.
 void LocalInterface::fill_housekeeping_rules_grpc (
     controllers_grpc_interface::LocalSimplifiedHandshakeRaw* housekeeping_rules,
-    const std::string& rule)
+    const std::vector<std::string>& rules)
 {
+    for (const auto& rule : rules) {
+        housekeeping_rules->add_rules (rule);
+    }
+}
 
-    size_t start;
-    size_t end = 0;
+// fill_enforcement_rules_grpc call. Fill EnforcementRules with the rules of each job, so a single
+// EnforcementRules object carries the rules of all jobs of the local controller.
+void LocalInterface::fill_enforcement_rules_grpc (
+    controllers_grpc_interface::EnforcementRules* enforcement_rules,
+    const std::vector<JobEnforcementRule>& rules)
+{
+    for (const auto& rule : rules) {
+        controllers_grpc_interface::EnforcementOpRules& create_enforcement_op_rule
+            = *enforcement_rules->add_job_rules ();
+
+        // the job's name, operation, and envs are resolved here, as the core controller batches
+        // references to them
+        create_enforcement_op_rule.set_m_rule_id (rule.m_rule_id);
+        create_enforcement_op_rule.set_m_stage_name (*rule.m_job_name);
+        create_enforcement_op_rule.set_m_operation (*rule.m_operation);
 
-    bool first = true;
+        auto& rules_map = *create_enforcement_op_rule.mutable_env_rates ();
+        for (long env : *rule.m_envs) {
+            rules_map[env] = rule.m_rate;
+        }
+    }
+}
 
-    while ((start = rule.find_first_not_of (':', end)) != std::string::npos) {
-        end = rule.find (':', start);
+// fill_stage_ready_grpc call. Fill StageReadyRaw with the stage identifier.
+void LocalInterface::fill_stage_ready_grpc (
+    controllers_grpc_interface::StageReadyRaw* stage_ready_raw,
+    const std::string& stage_name_env)
+{
+    stage_ready_raw->set_m_mark_stage (true);
+    stage_ready_raw->set_stage_name_env (stage_name_env);
+}
 
-        // Exclude LOCAL_HANDSHAKE |
-        if (first) {
-            first = false;
-            continue;
+// fill_global_statistics call. Convert the statistics reply of the local controller.
+void LocalInterface::fill_global_statistics (
+    const controllers_grpc_interface::StatsGlobalMap& reply,
+    int response_type,
+    std::unique_ptr<std::unordered_map<std::string, std::unique_ptr<StageResponse>>>&
+        stats_tf_objects)
+{
+    for (const auto& stats : reply.gl_stats ()) {
+        std::vector<StatsChannelRaw> channel_stats {};
+        channel_stats.reserve (stats.second.m_channel_stats_size ());
+
+        for (const auto& [channel_id, channel] : stats.second.m_channel_stats ()) {
+            StatsChannelRaw channel_raw {};
+            channel_raw.m_channel_id = channel_id;
+            channel_raw.m_ops_rate = channel.m_ops_rate ();
+            channel_raw.m_bytes_rate = channel.m_bytes_rate ();
+            channel_raw.m_total_ops = channel.m_total_ops ();
+            channel_raw.m_delayed_ops = channel.m_delayed_ops ();
+            channel_raw.m_avg_wait = channel.m_avg_wait ();
+            channel_raw.m_total_bytes = channel.m_total_bytes ();
+            channel_raw.m_timestamp = channel.m_timestamp ();
+            channel_stats.push_back (channel_raw);
         }
 
-        std::string token_rule = rule.substr (start, end - start);
-        housekeeping_rules->add_rules (token_rule);
+        // a summary without samples (e.g., a disconnected stage) stands for a single value
+        stats_tf_objects->emplace (stats.first,
+            std::make_unique<StageResponseStat> (response_type,
+                stats.second.m_metadata_total_rate (),
+                stats.second.m_rate_variance (),
+                std::max (stats.second.m_samples (), 1),
+                std::move (channel_stats)));
+    }
+}
+
+// handle_ack_reply call. Validate the ACK reply of the local controller.
+PStatus LocalInterface::handle_ack_reply (const std::string& call_name,
+    const Status& status,
+    const controllers_grpc_interface::ACK& reply,
+    ACK& response)
+{
+    response.m_message = reply.m_message ();
+
+    if (!status.ok ()) {
+        Logging::log_error ("LocalInterface: " + call_name
+            + ": Error while writing to the local controller (" + status.error_message () + ").");
+        return PStatus::Error ();
+    } else if (reply.m_message () == static_cast<int> (AckCode::ok)) {
+        Logging::log_debug ("LocalInterface: " + call_name + ": ACK message received ("
+            + std::to_string (response.m_message) + ").");
+        return PStatus::OK ();
+    } else {
+        return PStatus::Error ();
     }
 }
 
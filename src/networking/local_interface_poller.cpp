@@ -0,0 +1,48 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <cheferd/networking/local_interface_poller.hpp>
+
+namespace cheferd {
+
+// LocalInterfacePoller parameterized constructor.
+LocalInterfacePoller::LocalInterfacePoller (int pollers) : completion_queue_ {}, pollers_ {}
+{
+    Logging::log_info ("LocalInterfacePoller: starting " + std::to_string (pollers) + " pollers.");
+
+    for (int i = 0; i < pollers; i++) {
+        pollers_.emplace_back (&LocalInterfacePoller::poll, this);
+    }
+}
+
+// LocalInterfacePoller default destructor.
+LocalInterfacePoller::~LocalInterfacePoller ()
+{
+    completion_queue_.Shutdown ();
+
+    for (auto& poller : pollers_) {
+        poller.join ();
+    }
+}
+
+// poll call. Polls the completion queue and completes finished calls until shutdown.
+void LocalInterfacePoller::poll ()
+{
+    void* tag;
+    bool ok = false;
+
+    while (completion_queue_.Next (&tag, &ok)) {
+        auto* call = static_cast<LocalAsyncCall*> (tag);
+        call->complete (ok);
+        delete call;
+    }
+}
+
+// completion_queue call. Get the shared completion queue.
+grpc::CompletionQueue* LocalInterfacePoller::completion_queue ()
+{
+    return &completion_queue_;
+}
+
+} // namespace cheferd
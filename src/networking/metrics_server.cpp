@@ -0,0 +1,198 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <cheferd/networking/metrics_server.hpp>
+#include <cheferd/utils/logging.hpp>
+#include <cheferd/utils/metrics.hpp>
+#include <cstring>
+#include <exception>
+
+extern "C" {
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+}
+
+namespace cheferd {
+
+// Time (in milliseconds) that the server waits for connections before verifying if it was stopped.
+#define METRICS_POLL_TIMEOUT 200
+
+// Time (in milliseconds) that a connection has to send its request and to read its response.
+#define METRICS_CONNECTION_TIMEOUT 1000
+
+// Maximum size of the HTTP requests read.
+#define METRICS_REQUEST_SIZE 4096
+
+// MetricsServer parameterized constructor.
+MetricsServer::MetricsServer (const std::string& address, int port) :
+    address_ { address },
+    port_ { port },
+    server_fd_ { -1 },
+    working_server_ { false },
+    server_thread_ {}
+{ }
+
+// MetricsServer default destructor.
+MetricsServer::~MetricsServer ()
+{
+    stop ();
+}
+
+// start call. Starts listening and serving connections in the background.
+bool MetricsServer::start ()
+{
+    if ((server_fd_ = socket (AF_INET, SOCK_STREAM, 0)) < 0) {
+        Logging::log_error ("MetricsServer: Socket creation error.");
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt (server_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof (reuse));
+
+    struct sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons (port_);
+
+    if (inet_pton (AF_INET, address_.c_str (), &address.sin_addr) <= 0) {
+        Logging::log_error ("MetricsServer: Invalid address (" + address_ + ").");
+        close (server_fd_);
+        server_fd_ = -1;
+        return false;
+    }
+
+    if (bind (server_fd_, (struct sockaddr*)&address, sizeof (address)) < 0
+        || listen (server_fd_, 16) < 0) {
+        Logging::log_error ("MetricsServer: Bind/Listen error (port " + std::to_string (port_)
+            + ").");
+        close (server_fd_);
+        server_fd_ = -1;
+        return false;
+    }
+
+    working_server_ = true;
+    server_thread_ = std::thread (&MetricsServer::serve, this);
+    Logging::log_info ("MetricsServer: serving metrics at " + address_ + ":"
+        + std::to_string (port_) + ".");
+
+    return true;
+}
+
+// stop call. Stops serving connections.
+void MetricsServer::stop ()
+{
+    working_server_ = false;
+
+    if (server_thread_.joinable ()) {
+        server_thread_.join ();
+    }
+
+    if (server_fd_ != -1) {
+        close (server_fd_);
+        server_fd_ = -1;
+    }
+}
+
+// serve call. Accepts and serves connections until the server is stopped.
+void MetricsServer::serve ()
+{
+    struct pollfd listener {};
+    listener.fd = server_fd_;
+    listener.events = POLLIN;
+
+    while (working_server_.load ()) {
+        if (poll (&listener, 1, METRICS_POLL_TIMEOUT) <= 0) {
+            continue;
+        }
+
+        int socket = accept (server_fd_, nullptr, nullptr);
+
+        if (socket >= 0) {
+            // reads and writes that time out fail, and the connection is closed
+            struct timeval timeout {};
+            timeout.tv_sec = METRICS_CONNECTION_TIMEOUT / 1000;
+            timeout.tv_usec = (METRICS_CONNECTION_TIMEOUT % 1000) * 1000;
+            setsockopt (socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+            setsockopt (socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof (timeout));
+
+            // a malformed request must not stop the server (nor the controller)
+            try {
+                handle_connection (socket);
+            } catch (const std::exception& exception) {
+                Logging::log_error ("MetricsServer: failed to serve connection ("
+                    + std::string (exception.what ()) + ").");
+            } catch (...) {
+                Logging::log_error ("MetricsServer: failed to serve connection.");
+            }
+            close (socket);
+        }
+    }
+}
+
+// handle_connection call. Reads an HTTP request and writes its response.
+void MetricsServer::handle_connection (int socket)
+{
+    // reads until the end of the request line, the size limit, or the end of the connection
+    char request[METRICS_REQUEST_SIZE];
+    std::size_t size = 0;
+    const char* line_end = nullptr;
+
+    while (line_end == nullptr && size < sizeof (request)) {
+        ssize_t bytes = ::read (socket, request + size, sizeof (request) - size);
+        if (bytes <= 0) {
+            break;
+        }
+
+        line_end = static_cast<const char*> (std::memchr (request + size, '\n', bytes));
+        size += bytes;
+    }
+
+    if (size == 0) {
+        return;
+    }
+
+    std::string status;
+    std::string body;
+
+    // requests without a complete request line (e.g., truncated, or not HTTP) are rejected
+    std::string request_line {};
+    if (line_end != nullptr) {
+        request_line.assign (request, static_cast<std::size_t> (line_end - request));
+        if (!request_line.empty () && request_line.back () == '\r') {
+            request_line.pop_back ();
+        }
+    }
+
+    if (line_end == nullptr) {
+        status = "400 Bad Request";
+        body = "Bad Request\n";
+    } else if (request_line.rfind ("GET /metrics ", 0) == 0
+        || request_line.rfind ("GET / ", 0) == 0) {
+        status = "200 OK";
+        body = Metrics::render ();
+    } else {
+        status = "404 Not Found";
+        body = "Not Found\n";
+    }
+
+    std::string response = "HTTP/1.1 " + status
+        + "\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\nContent-Length: "
+        + std::to_string (body.size ()) + "\r\n\r\n" + body;
+
+    // a scraper that goes away does not stop the server
+    std::size_t written = 0;
+    while (written < response.size ()) {
+        ssize_t value = send (socket, response.data () + written, response.size () - written,
+            MSG_NOSIGNAL);
+        if (value <= 0) {
+            return;
+        }
+        written += value;
+    }
+}
+
+} // namespace cheferd
@@ -2,17 +2,140 @@
  *   Copyright (c) 2022 INESC TEC.
  **/
 
+#include <cerrno>
 #include <cheferd/networking/paio_interface.hpp>
-#include <cheferd/utils/rules_file_parser.hpp>
+#include <cstring>
 
 namespace cheferd {
 
 // PAIOInterface default constructor.
-PAIOInterface::PAIOInterface () = default;
+PAIOInterface::PAIOInterface () : seqpacket_ { false }
+{ }
+
+// PAIOInterface parameterized constructor.
+PAIOInterface::PAIOInterface (bool seqpacket) : seqpacket_ { seqpacket }
+{ }
 
 // PAIOInterface default destructor.
 PAIOInterface::~PAIOInterface () = default;
 
+// write_vectored call. Writes every buffer, retrying on short writes and EINTR.
+ssize_t PAIOInterface::write_vectored (int socket, struct iovec* iov, int iovcnt)
+{
+    ssize_t total = 0;
+
+    while (iovcnt > 0) {
+        ssize_t return_value = ::writev (socket, iov, iovcnt);
+
+        if (return_value < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        } else if (return_value == 0) {
+            break;
+        }
+
+        total += return_value;
+
+        // skip the buffers fully written, and advance the one written partially
+        while (iovcnt > 0 && static_cast<std::size_t> (return_value) >= iov->iov_len) {
+            return_value -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+
+        if (iovcnt > 0) {
+            iov->iov_base = static_cast<char*> (iov->iov_base) + return_value;
+            iov->iov_len -= return_value;
+        }
+    }
+
+    return total;
+}
+
+// write_message call. Writes a control message (ControlOperation followed by its payload) with a
+// single writev.
+ssize_t PAIOInterface::write_message (int socket,
+    const ControlOperation* operation,
+    const void* payload,
+    std::size_t payload_size) const
+{
+    struct iovec iov[2];
+    int iovcnt = 0;
+
+    if (operation != nullptr) {
+        iov[iovcnt].iov_base = const_cast<ControlOperation*> (operation);
+        iov[iovcnt++].iov_len = sizeof (struct ControlOperation);
+    }
+
+    if (payload_size > 0) {
+        iov[iovcnt].iov_base = const_cast<void*> (payload);
+        iov[iovcnt++].iov_len = payload_size;
+    }
+
+    return write_vectored (socket, iov, iovcnt);
+}
+
+// read_vectored call. Fills every buffer, retrying on short reads and EINTR (SOCK_STREAM), or
+// reads a single record, which must fill them exactly (SOCK_SEQPACKET).
+ssize_t PAIOInterface::read_vectored (int socket, struct iovec* iov, int iovcnt) const
+{
+    ssize_t return_value;
+
+    if (seqpacket_) {
+        struct msghdr message {};
+        message.msg_iov = iov;
+        message.msg_iovlen = iovcnt;
+
+        do {
+            return_value = ::recvmsg (socket, &message, 0);
+        } while (return_value < 0 && errno == EINTR);
+
+        // a record larger than the buffers is truncated, and its remainder discarded
+        return (message.msg_flags & MSG_TRUNC) ? -1 : return_value;
+    }
+
+    ssize_t total = 0;
+
+    while (iovcnt > 0) {
+        return_value = ::readv (socket, iov, iovcnt);
+
+        if (return_value < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        } else if (return_value == 0) {
+            // connection closed by the data plane stage
+            break;
+        }
+
+        total += return_value;
+
+        // skip the buffers fully read, and advance the one read partially
+        while (iovcnt > 0 && static_cast<std::size_t> (return_value) >= iov->iov_len) {
+            return_value -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+
+        if (iovcnt > 0) {
+            iov->iov_base = static_cast<char*> (iov->iov_base) + return_value;
+            iov->iov_len -= return_value;
+        }
+    }
+
+    return total;
+}
+
+// read_exact call. Reads exactly size bytes (or a single record of size bytes).
+ssize_t PAIOInterface::read_exact (int socket, void* buffer, std::size_t size) const
+{
+    struct iovec iov { buffer, size };
+    return read_vectored (socket, &iov, 1);
+}
+
 // stage_handshake call. Handshake a data plane stage.
 // Submit a handshake request to collect data about the data plane stage.
 PStatus PAIOInterface::stage_handshake (int socket,
@@ -21,65 +144,24 @@ PStatus PAIOInterface::stage_handshake (int socket,
 {
     // pre-send phase
     // prepare ControlSend object
-    operation->m_operation_id = -1;
     operation->m_operation_type = STAGE_HANDSHAKE;
     operation->m_size = sizeof (struct StageSimplifiedHandshakeRaw);
 
     // write ControlSend structure through socket
-    ssize_t return_value = ::write (socket, operation, sizeof (struct ControlOperation));
-
-    // verify total written bytes
-    if (return_value != sizeof (struct ControlOperation)) {
-        Logging::log_error (
-            "PAIOInterface: stage_handshake: Error while writing control operation ("
-            + std::to_string (return_value) + ").");
-        return PStatus::Error ();
-    }
+    PStatus status = send_operation (socket, *operation, nullptr, 0);
 
     // read StageSimplifiedHandshakeRaw structure from socket
-    return_value = ::read (socket, &stage_info_obj, sizeof (struct StageSimplifiedHandshakeRaw));
-
-    // verify total bytes read
-    if (return_value != sizeof (struct StageSimplifiedHandshakeRaw)) {
-        Logging::log_error ("PAIOInterface: stage_handshake: failed to receive handshake object ("
-            + std::to_string (return_value) + ").");
-        return PStatus::Error ();
-    } else {
-        // debug message
-        std::stringstream stream;
-        stream << "Serialize::StageSimplifiedHandshakeRaw\n";
-        stream << "   name\t\t: " << stage_info_obj.m_stage_name;
-        stream << " (" << sizeof (stage_info_obj.m_stage_name) << ")\n";
-        stream << "   env\t\t: " << stage_info_obj.m_stage_env;
-        stream << " (" << sizeof (stage_info_obj.m_stage_env) << ")\n";
-        stream << "   pid\t\t: " << stage_info_obj.m_pid << "\n";
-        stream << "   ppid\t\t: " << stage_info_obj.m_ppid << "\n";
-        stream << "   hostname\t\t: " << stage_info_obj.m_stage_hostname;
-        stream << " (" << sizeof (stage_info_obj.m_stage_hostname) << ")\n";
-        stream << "   user\t\t: " << stage_info_obj.m_stage_user;
-        stream << " (" << sizeof (stage_info_obj.m_stage_user) << ")\n";
-        stream << "Size of struct: " << sizeof (StageSimplifiedHandshakeRaw) << "\n";
-        Logging::log_debug (stream.str ());
-
-        return PStatus::OK ();
-    }
+    return status.isOk () ? receive_stage_handshake (socket, stage_info_obj) : status;
 }
 
 // stage_handshake_address call. Informs a data plane stage about the new socket to connect to.
-PStatus PAIOInterface::stage_handshake_address (int socket, const std::string& rule, ACK& response)
+PStatus PAIOInterface::stage_handshake_address (int socket,
+    const StageHandshakeRaw& handshake_object,
+    ACK& response)
 {
-
-    std::vector<std::string> tokens {};
-    this->parse_rule (rule, &tokens);
-
-    StageHandshakeRaw handshake_object;
-
-    strcpy (handshake_object.m_address, tokens[1].c_str ());
-
-    handshake_object.m_port = std::stoi (tokens[2]);
-
     // write ControlSend structure through socket
-    ssize_t return_value = ::write (socket, &handshake_object, sizeof (struct StageHandshakeRaw));
+    ssize_t return_value
+        = write_message (socket, nullptr, &handshake_object, sizeof (struct StageHandshakeRaw));
 
     // verify total written bytes
     if (return_value != sizeof (struct StageHandshakeRaw)) {
@@ -94,121 +176,49 @@ PStatus PAIOInterface::stage_handshake_address (int socket, const std::string& r
     }
 }
 
-// create_housekeeping_rule call. Creates a housekeeping rule at the data plane stage.
+// create_housekeeping_rule call. Creates a housekeeping rule (create_channel) at the data plane
+// stage.
 PStatus PAIOInterface::create_housekeeping_rule (int socket,
     ControlOperation* operation,
-    const std::string& rule,
+    const HousekeepingCreateChannelRaw& rule,
     ACK& response)
 {
-    Logging::log_debug ("PAIOInterface: create_housekeeping_rule: " + rule);
-
-    // parsing phase
-    std::vector<std::string> rule_tokens {};
-    this->parse_rule (rule, &rule_tokens);
-
-    if (rule_tokens.empty ()) {
-        Logging::log_error ("PAIOInterface: create_housekeeping_rule: empty rule.");
-        return PStatus::Error ();
-    }
-
-    for (int i = 0; i < rule_tokens.size (); i++) {
-        std::cout << i << " -- " << rule_tokens[i] << "\n";
-    }
+    Logging::log_debug ("PAIOInterface: create_housekeeping_rule: channel "
+        + std::to_string (rule.m_channel_id));
 
     // prepare ControlSend object
-    ssize_t return_value;
-    operation->m_operation_id = 10; // fixme: update the identifier value
     operation->m_operation_type = CREATE_HSK_RULE;
-    operation->m_operation_subtype
-        = static_cast<int> (RulesFileParser::convert_housekeeping_operation (rule_tokens[2]));
-
-    switch (operation->m_operation_subtype) {
-        case HSK_CREATE_CHANNEL: {
-            operation->m_size = sizeof (struct HousekeepingCreateChannelRaw);
-
-            // prepare HousekeepingCreateChannelRaw object to be sent
-            HousekeepingCreateChannelRaw create_channel_rule {};
-            this->fill_create_channel_rule (&create_channel_rule, rule_tokens);
-
-            // pre-send phase
-            return_value = ::write (socket, operation, sizeof (struct ControlOperation));
-            // verify total written bytes
-            if (return_value != sizeof (struct ControlOperation)) {
-                Logging::log_error ("PAIOInterface: create_housekeeping_rule (channel): Error "
-                                    "while writing control operation ("
-                    + std::to_string (return_value) + ").");
-                return PStatus::Error ();
-            }
+    operation->m_operation_subtype = HSK_CREATE_CHANNEL;
+    operation->m_size = sizeof (struct HousekeepingCreateChannelRaw);
 
-            // send phase
-            return_value = ::write (socket,
-                &create_channel_rule,
-                sizeof (struct HousekeepingCreateChannelRaw));
-
-            // verify total written bytes
-            if (return_value != sizeof (struct HousekeepingCreateChannelRaw)) {
-                Logging::log_error ("PAIOInterface: create_housekeeping_rule (channel): Error "
-                                    "while writing housekeeping rule ("
-                    + std::to_string (return_value) + ").");
-                return PStatus::Error ();
-            }
-
-            break;
-        }
+    // send phase (control operation and housekeeping rule)
+    PStatus status = send_operation (socket, *operation, &rule, operation->m_size);
 
-        case HSK_CREATE_OBJECT: {
-            operation->m_size = sizeof (struct HousekeepingCreateObjectRaw);
-
-            // prepare HousekeepingCreateObjectRaw object to be sent
-            HousekeepingCreateObjectRaw create_object_rule {};
-            this->fill_create_object_rule (&create_object_rule, rule_tokens);
-
-            // pre-send phase
-            return_value = ::write (socket, operation, sizeof (struct ControlOperation));
-
-            // verify total written bytes
-            if (return_value != sizeof (struct ControlOperation)) {
-                Logging::log_error ("PAIOInterface: create_housekeeping_rule (object): Error while "
-                                    "writing control operation ("
-                    + std::to_string (return_value) + ").");
-                return PStatus::Error ();
-            }
+    // receive phase
+    return status.isOk () ? receive_ack (socket, response) : status;
+}
 
-            // send phase
-            return_value = ::write (socket,
-                &create_object_rule,
-                sizeof (struct HousekeepingCreateObjectRaw));
-
-            // verify total written bytes
-            if (return_value != sizeof (struct HousekeepingCreateObjectRaw)) {
-                Logging::log_error ("PAIOInterface: create_housekeeping_rule (object): Error while "
-                                    "writing housekeeping rule ("
-                    + std::to_string (return_value) + ").");
-                return PStatus::Error ();
-            }
+// create_housekeeping_rule call. Creates a housekeeping rule (create_object) at the data plane
+// stage.
+PStatus PAIOInterface::create_housekeeping_rule (int socket,
+    ControlOperation* operation,
+    const HousekeepingCreateObjectRaw& rule,
+    ACK& response)
+{
+    Logging::log_debug ("PAIOInterface: create_housekeeping_rule: object "
+        + std::to_string (rule.m_enforcement_object_id) + " of channel "
+        + std::to_string (rule.m_channel_id));
 
-            break;
-        }
+    // prepare ControlSend object
+    operation->m_operation_type = CREATE_HSK_RULE;
+    operation->m_operation_subtype = HSK_CREATE_OBJECT;
+    operation->m_size = sizeof (struct HousekeepingCreateObjectRaw);
 
-        default:
-            Logging::log_error ("PAIOInterface: After parsing -- other rule");
-            return PStatus::Error ();
-    }
+    // send phase (control operation and housekeeping rule)
+    PStatus status = send_operation (socket, *operation, &rule, operation->m_size);
 
     // receive phase
-    return_value = ::read (socket, &response, sizeof (struct ACK));
-    if (return_value <= 0 || response.m_message == static_cast<int> (AckCode::error)) {
-        Logging::log_error ("PAIOInterface: create_housekeeping_rule: Error while reading ACK "
-                            "message from data plane stage ("
-            + std::to_string (return_value) + ").");
-        return PStatus::Error ();
-    } else if (response.m_message == static_cast<int> (AckCode::ok)) {
-        Logging::log_debug ("PAIOInterface: create_housekeeping_rule: ACK message received ("
-            + std::to_string (response.m_message) + ").");
-        return PStatus::OK ();
-    } else {
-        return PStatus::Error ();
-    }
+    return status.isOk () ? receive_ack (socket, response) : status;
 }
 
 // mark_stage_ready call. Mark data plane stage as ready.
@@ -219,163 +229,80 @@ PStatus PAIOInterface::mark_stage_ready (int socket,
 {
     // pre-send phase
     // prepare ControlSend object
-    operation->m_operation_id = -1;
     operation->m_operation_type = STAGE_READY;
     operation->m_size = sizeof (struct StageReadyRaw);
 
-    // write ControlOperation structure through socket
-    ssize_t return_value = ::write (socket, operation, sizeof (struct ControlOperation));
-
-    // verify total written bytes
-    if (return_value != sizeof (struct ControlOperation)) {
-        Logging::log_error (
-            "PAIOInterface: mark_stage_ready: Error while writing control operation ("
-            + std::to_string (return_value) + ").");
-        return PStatus::Error ();
-    }
-
-    // send phase
+    // send phase (ControlOperation and StageReadyRaw structures)
     stage_ready_obj.m_mark_stage = true;
-    return_value = ::write (socket, &stage_ready_obj, sizeof (struct StageReadyRaw));
-    // verify total written bytes
-    if (return_value != sizeof (struct StageReadyRaw)) {
-        Logging::log_error (
-            "PAIOInterface: mark_stage_ready (channel): Error while writing stage ready ("
-            + std::to_string (return_value) + ").");
-        return PStatus::Error ();
-    }
+    PStatus status
+        = send_operation (socket, *operation, &stage_ready_obj, sizeof (struct StageReadyRaw));
 
     // receive phase
-    return_value = ::read (socket, &response, sizeof (struct ACK));
-    if (return_value <= 0 || response.m_message == static_cast<int> (AckCode::error)) {
-        Logging::log_error ("PAIOInterface: mark_stage_ready: Error while reading ACK message from "
-                            "data plane stage ("
-            + std::to_string (return_value) + ").");
-        return PStatus::Error ();
-    } else if (response.m_message == static_cast<int> (AckCode::ok)) {
-        Logging::log_debug ("PAIOInterface: mark_stage_ready: ACK message received ("
-            + std::to_string (response.m_message) + ").");
-        return PStatus::OK ();
-    } else {
-        return PStatus::Error ();
-    }
+    return status.isOk () ? receive_ack (socket, response) : status;
 }
 
 // create_enforcement_rule call. Creates an enforcement rule at the data plane stage.
 PStatus PAIOInterface::create_enforcement_rule (int socket,
     ControlOperation* operation,
-    const std::string& rule,
+    const EnforcementRuleRaw& create_enforcement_rule,
     ACK& response)
 {
     // validate if logging is enabled and log debug message
     if (Logging::is_debug_enabled ()) {
-        Logging::log_debug ("PAIOInterface: create_enforcement_rule: " + rule);
-    }
-
-    // parsing phase
-    std::vector<std::string> rule_tokens {};
-    this->parse_rule (rule, &rule_tokens);
-
-    if (rule_tokens.empty ()) {
-        Logging::log_error ("PAIOInterface: create_enforcement_rule: empty rule.");
-        return PStatus::Error ();
+        Logging::log_debug ("PAIOInterface: create_enforcement_rule: channel "
+            + std::to_string (create_enforcement_rule.m_channel_id) + ", object "
+            + std::to_string (create_enforcement_rule.m_enforcement_object_id) + ", property "
+            + std::to_string (create_enforcement_rule.m_property_first));
     }
 
     // prepare ControlOperation object
-    operation->m_operation_id = 10; // fixme: update the identifier value
     operation->m_operation_type = CREATE_ENF_RULE;
     operation->m_size = sizeof (struct EnforcementRuleRaw);
 
-    // prepare EnforcementRuleRaw object to be sent
-    EnforcementRuleRaw create_enforcement_rule {};
-    this->fill_enforcement_rule (&create_enforcement_rule, rule_tokens);
-
-    // pre-send phase
-    ssize_t return_value = ::write (socket, operation, sizeof (struct ControlOperation));
-
-    // verify total written bytes
-    if (return_value != sizeof (struct ControlOperation)) {
-        Logging::log_error (
-            "PAIOInterface: create_enforcement_rule: Error while writing control operation ("
-            + std::to_string (return_value) + ").");
-        return PStatus::Error ();
-    }
-
-    // send phase
-    return_value = ::write (socket, &create_enforcement_rule, sizeof (struct EnforcementRuleRaw));
-
-    // verify total written bytes
-    if (return_value != sizeof (struct EnforcementRuleRaw)) {
-        Logging::log_error (
-            "PAIOInterface: create_enforcement_rule: Error while writing enforcement rule object "
-            "to the data plane stage ("
-            + std::to_string (return_value) + ").");
-        return PStatus::Error ();
-    }
+    // send phase (ControlOperation and EnforcementRuleRaw structures)
+    PStatus status = send_operation (socket,
+        *operation,
+        &create_enforcement_rule,
+        sizeof (struct EnforcementRuleRaw));
 
     // receive phase
-    return_value = ::read (socket, &response, sizeof (struct ACK));
-    if (return_value <= 0 || response.m_message == static_cast<int> (AckCode::error)) {
-        Logging::log_error ("PAIOInterface: create_enforcement_rule: Error while reading ACK "
-                            "message from data plane stage ("
-            + std::to_string (return_value) + ").");
-        return PStatus::Error ();
-    } else if (response.m_message == static_cast<int> (AckCode::ok)) {
-        Logging::log_debug ("PAIOInterface: create_enforcement_rule: ACK message received ("
-            + std::to_string (response.m_message) + ").");
-        return PStatus::OK ();
-    } else {
-        return PStatus::Error ();
-    }
+    return status.isOk () ? receive_ack (socket, response) : status;
 }
 
 // RemoveRule call. Remove a HousekeepingRule from a specific data plane stage.
 PStatus
 PAIOInterface::RemoveRule (int socket, ControlOperation* operation, int rule_id, ACK& response)
 {
-    PStatus status = PStatus::Error ();
     // Pre-send Phase
     // Prepare ControlOperation object
-    operation->m_operation_id = -1;
     operation->m_size = sizeof (struct ControlOperation);
 
-    ssize_t return_value = ::write (socket, operation, sizeof (struct ControlOperation));
-
-    // verify total written bytes
-    if (return_value != sizeof (struct ControlOperation)) {
-        Logging::log_error ("PAIOInterface: remove_rule: Error while writing control operation ("
-            + std::to_string (return_value) + ").");
-        return PStatus::Error ();
-    }
-
     // Send Phase
-    // Prepare RemoveRule Object to be sent
-    operation->m_operation_id = 300;
-    return_value = ::write (socket, operation, sizeof (struct ControlOperation));
-    if (return_value <= 0) {
-        return PStatus::Error ();
+    // Prepare RemoveRule Object to be sent (right after the ControlOperation)
+    PStatus status = send_operation (socket, *operation, operation, sizeof (ControlOperation));
+    if (!status.isOk ()) {
+        return status;
     }
 
     // Receive Phase
     // Create the ControlResponse object to receive (as the response will be an ACK, we may only
     // receive this one)
-    return_value = ::read (socket, &response, sizeof (struct ACK));
-    if (return_value <= 0) {
+    ssize_t return_value = read_exact (socket, &response, sizeof (struct ACK));
+    if (return_value != sizeof (struct ACK)) {
         return PStatus::Error ();
     }
 
     // Process Phase
     // This will be an ACK of the RemoveRule submission ... (possibly remove)
-    return_value = ::read (socket, &response, sizeof (struct ACK));
-    if (return_value <= 0) {
+    return_value = read_exact (socket, &response, sizeof (struct ACK));
+    if (return_value != sizeof (struct ACK)) {
         return PStatus::Error ();
-    } else {
-        status = PStatus::OK ();
-        // Logging::DEBUG("Process Phase::REMOVE_RULE::" + std::to_string(response.response));
-        fprintf (stdout, "PAIOInterface: Process Phase::REMOVE_RULE::%d\n", response.m_message);
     }
 
-    return status;
+    Logging::log_debug ("PAIOInterface: Process Phase::REMOVE_RULE::"
+        + std::to_string (response.m_message));
+
+    return PStatus::OK ();
 }
 
 // collect_statistics csll. Get the statistics of a current data plane stage.
@@ -392,28 +319,117 @@ PStatus PAIOInterface::collect_global_statistics (int socket,
 {
     // pre-send phase
     // prepare ControlSend object
-    operation->m_operation_id = -1;
     operation->m_operation_type = COLLECT_DETAILED_STATS;
     operation->m_operation_subtype = COLLECT_GLOBAL_STATS;
-    // operation->m_operation_subtype = TENSORFLOW_STATISTIC_COLLECTION; // this is highly hardcoded
     operation->m_size = sizeof (struct StatsGlobalRaw);
 
-    signal (SIGPIPE, SIG_IGN);
+    // write ControlSend structure through socket
+    PStatus status = send_operation (socket, *operation, nullptr, 0);
+
+    // Read phase
+    return status.isOk () ? receive_global_statistics (socket, stats_tf_object) : status;
+}
+
+// collect_channel_statistics call. Get the statistics of each channel of a current data plane
+// stage.
+PStatus PAIOInterface::collect_channel_statistics (int socket,
+    ControlOperation* operation,
+    std::vector<StatsChannelRaw>& channel_stats)
+{
+    // pre-send phase
+    // prepare ControlSend object (m_size holds the record size understood by the control plane)
+    operation->m_operation_type = COLLECT_DETAILED_STATS;
+    operation->m_operation_subtype = COLLECT_CHANNEL_STATS;
+    operation->m_size = sizeof (struct StatsChannelRaw);
 
     // write ControlSend structure through socket
-    ssize_t return_value = ::write (socket, operation, sizeof (struct ControlOperation));
+    PStatus status = send_operation (socket, *operation, nullptr, 0);
+
+    // Read phase
+    return status.isOk () ? receive_channel_statistics (socket, channel_stats) : status;
+}
+
+// send_operation call. Sends a control operation (and its payload) to the data plane stage.
+PStatus PAIOInterface::send_operation (int socket,
+    const ControlOperation& operation,
+    const void* payload,
+    std::size_t payload_size)
+{
+    signal (SIGPIPE, SIG_IGN);
+
+    ssize_t return_value = write_message (socket, &operation, payload, payload_size);
 
     // verify total written bytes
-    if (return_value != sizeof (struct ControlOperation)) {
-        Logging::log_error (
-            "PAIOInterface: collect_global_statistics: Error while writing control operation ("
+    if (return_value != static_cast<ssize_t> (sizeof (struct ControlOperation) + payload_size)) {
+        Logging::log_error ("PAIOInterface: send_operation: Error while writing control operation "
+            + std::to_string (operation.m_operation_id) + " (type "
+            + std::to_string (operation.m_operation_type) + ", "
             + std::to_string (return_value) + ").");
         return PStatus::Error ();
     }
 
-    // Read phase
+    return PStatus::OK ();
+}
+
+// receive_stage_handshake call. Reads the StageSimplifiedHandshakeRaw of a data plane stage.
+PStatus PAIOInterface::receive_stage_handshake (int socket,
+    StageSimplifiedHandshakeRaw& stage_info_obj)
+{
+    // read StageSimplifiedHandshakeRaw structure from socket
+    ssize_t return_value
+        = read_exact (socket, &stage_info_obj, sizeof (struct StageSimplifiedHandshakeRaw));
+
+    // verify total bytes read
+    if (return_value != sizeof (struct StageSimplifiedHandshakeRaw)) {
+        Logging::log_error ("PAIOInterface: stage_handshake: failed to receive handshake object ("
+            + std::to_string (return_value) + ").");
+        return PStatus::Error ();
+    } else {
+        // debug message
+        std::stringstream stream;
+        stream << "Serialize::StageSimplifiedHandshakeRaw\n";
+        stream << "   name\t\t: " << stage_info_obj.m_stage_name;
+        stream << " (" << sizeof (stage_info_obj.m_stage_name) << ")\n";
+        stream << "   env\t\t: " << stage_info_obj.m_stage_env;
+        stream << " (" << sizeof (stage_info_obj.m_stage_env) << ")\n";
+        stream << "   pid\t\t: " << stage_info_obj.m_pid << "\n";
+        stream << "   ppid\t\t: " << stage_info_obj.m_ppid << "\n";
+        stream << "   hostname\t\t: " << stage_info_obj.m_stage_hostname;
+        stream << " (" << sizeof (stage_info_obj.m_stage_hostname) << ")\n";
+        stream << "   user\t\t: " << stage_info_obj.m_stage_user;
+        stream << " (" << sizeof (stage_info_obj.m_stage_user) << ")\n";
+        stream << "Size of struct: " << sizeof (StageSimplifiedHandshakeRaw) << "\n";
+        Logging::log_debug (stream.str ());
+
+        return PStatus::OK ();
+    }
+}
+
+// receive_ack call. Reads the ACK of a control operation.
+PStatus PAIOInterface::receive_ack (int socket, ACK& response)
+{
+    ssize_t return_value = read_exact (socket, &response, sizeof (struct ACK));
+
+    if (return_value != sizeof (struct ACK)
+        || response.m_message == static_cast<int> (AckCode::error)) {
+        Logging::log_error ("PAIOInterface: receive_ack: Error while reading ACK message from "
+                            "data plane stage ("
+            + std::to_string (return_value) + ").");
+        return PStatus::Error ();
+    } else if (response.m_message == static_cast<int> (AckCode::ok)) {
+        Logging::log_debug ("PAIOInterface: receive_ack: ACK message received ("
+            + std::to_string (response.m_message) + ").");
+        return PStatus::OK ();
+    } else {
+        return PStatus::Error ();
+    }
+}
+
+// receive_global_statistics call. Reads the StatsGlobalRaw of a data plane stage.
+PStatus PAIOInterface::receive_global_statistics (int socket, StatsGlobalRaw& stats_tf_object)
+{
     // read StatsTFRaw structure from socket
-    return_value = ::read (socket, &stats_tf_object, sizeof (struct StatsGlobalRaw));
+    ssize_t return_value = read_exact (socket, &stats_tf_object, sizeof (struct StatsGlobalRaw));
 
     // verify total bytes read
     if (return_value != sizeof (struct StatsGlobalRaw)) {
@@ -434,74 +450,94 @@ PStatus PAIOInterface::collect_global_statistics (int socket,
     }
 }
 
-////////////////////////////////////////////
-//////////// Auxiliary Functions ///////////
-////////////////////////////////////////////
-
-// parse_rule call: Parses a rule into tokens.
-void PAIOInterface::parse_rule (const std::string& rule, std::vector<std::string>* tokens)
+// receive_channel_statistics call. Reads the StatsChannelHeaderRaw and the StatsChannelRaw
+// records of a data plane stage.
+PStatus PAIOInterface::receive_channel_statistics (int socket,
+    std::vector<StatsChannelRaw>& channel_stats)
 {
-    size_t start;
-    size_t end = 0;
+    // read StatsChannelHeaderRaw structure from socket (with SOCK_SEQPACKET, the header and the
+    // records are a single record, so the header is peeked to size the read of the whole record)
+    ssize_t return_value;
+    StatsChannelHeaderRaw header {};
+    if (seqpacket_) {
+        do {
+            return_value
+                = ::recv (socket, &header, sizeof (struct StatsChannelHeaderRaw), MSG_PEEK);
+        } while (return_value < 0 && errno == EINTR);
+    } else {
+        return_value = read_exact (socket, &header, sizeof (struct StatsChannelHeaderRaw));
+    }
+    if (return_value != sizeof (struct StatsChannelHeaderRaw) || !valid_channel_header (header)) {
+        Logging::log_error ("PAIOInterface: collect_channel_statistics: Error while reading "
+                            "StatsChannelHeaderRaw object from data plane stage ("
+            + std::to_string (return_value) + ").");
+        return PStatus::Error ();
+    }
+
+    // read the records, as sized by the data plane stage
+    std::size_t payload_size = header.m_record_size * static_cast<std::size_t> (header.m_channels);
+    std::vector<char> payload (payload_size);
 
-    while ((start = rule.find_first_not_of ('|', end)) != std::string::npos) {
-        end = rule.find ('|', start);
-        tokens->push_back (rule.substr (start, end - start));
+    if (seqpacket_) {
+        struct iovec iov[2] { { &header, sizeof (struct StatsChannelHeaderRaw) },
+            { payload.data (), payload_size } };
+        return_value = read_vectored (socket, iov, 2);
+
+        if (return_value
+            != static_cast<ssize_t> (sizeof (struct StatsChannelHeaderRaw) + payload_size)) {
+            Logging::log_error ("PAIOInterface: collect_channel_statistics: Error while reading "
+                                "StatsChannelRaw objects from data plane stage ("
+                + std::to_string (return_value) + ").");
+            return PStatus::Error ();
+        }
+    } else if (payload_size > 0) {
+        return_value = read_exact (socket, payload.data (), payload_size);
+
+        if (return_value != static_cast<ssize_t> (payload_size)) {
+            Logging::log_error ("PAIOInterface: collect_channel_statistics: Error while reading "
+                                "StatsChannelRaw objects from data plane stage ("
+                + std::to_string (return_value) + ").");
+            return PStatus::Error ();
+        }
     }
-}
 
-// fill_create_channel_rule call. Fill HousekeepingCreateChannelRaw with tokens data.
-void PAIOInterface::fill_create_channel_rule (HousekeepingCreateChannelRaw* create_channel,
-    const std::vector<std::string>& tokens)
-{
-    create_channel->m_rule_id = std::stol (tokens[1]);
-    create_channel->m_rule_type = static_cast<int> (HousekeepingOperation::create_channel);
-    create_channel->m_channel_id = std::stol (tokens[3]);
-    create_channel->m_context_definition
-        = RulesFileParser::convert_context_type_definition (tokens[4]);
-    create_channel->m_workflow_id = std::stol (tokens[5]);
-    create_channel->m_operation_type
-        = RulesFileParser::convert_differentiation_definitions (tokens[4], tokens[6]);
-    create_channel->m_operation_context
-        = RulesFileParser::convert_differentiation_definitions (tokens[4], tokens[7]);
+    parse_channel_statistics (header, payload.data (), channel_stats);
+
+    return PStatus::OK ();
 }
 
-// fill_create_object_rule call. Fill HousekeepingCreateObjectRaw with tokens data.
-void PAIOInterface::fill_create_object_rule (HousekeepingCreateObjectRaw* create_object,
-    const std::vector<std::string>& tokens)
+// valid_channel_header call. Validates the StatsChannelHeaderRaw sent by a data plane stage.
+bool PAIOInterface::valid_channel_header (const StatsChannelHeaderRaw& header)
 {
-    create_object->m_rule_id = std::stol (tokens[1]);
-    create_object->m_rule_type = static_cast<int> (HousekeepingOperation::create_object);
-    create_object->m_channel_id = std::stol (tokens[3]);
-    create_object->m_enforcement_object_id = std::stol (tokens[4]);
-    create_object->m_context_definition
-        = RulesFileParser::convert_context_type_definition (tokens[5]);
-    create_object->m_operation_type
-        = RulesFileParser::convert_differentiation_definitions (tokens[5], tokens[6]);
-    create_object->m_operation_context
-        = RulesFileParser::convert_differentiation_definitions (tokens[5], tokens[7]);
-    create_object->m_enforcement_object_type
-        = static_cast<long> (RulesFileParser::convert_object_type (tokens[8]));
-    create_object->m_property_first = std::stol (tokens[9]);
-    create_object->m_property_second = std::stol (tokens[10]);
+    // a bounded record size bounds the records buffered (and allocated) for a response
+    return header.m_version != 0 && header.m_record_size != 0
+        && header.m_record_size <= stats_max_record_size && header.m_channels >= 0
+        && header.m_channels <= stats_max_channels;
 }
 
-// fill_enforcement_rule call. Fill EnforcementRuleRaw with tokens data.
-void PAIOInterface::fill_enforcement_rule (EnforcementRuleRaw* enf_object,
-    const std::vector<std::string>& tokens)
+// parse_channel_statistics call. Converts the records sent by a data plane stage (sized by the
+// stage) into StatsChannelRaw structures.
+void PAIOInterface::parse_channel_statistics (const StatsChannelHeaderRaw& header,
+    const char* records,
+    std::vector<StatsChannelRaw>& channel_stats)
 {
-    // convert string to enforcement operation type
-    int operation_type = RulesFileParser::convert_enforcement_operation (
-        RulesFileParser::convert_object_type (tokens[4]),
-        tokens[5]);
-
-    enf_object->m_rule_id = std::stoll (tokens[1]);
-    enf_object->m_channel_id = std::stol (tokens[2]);
-    enf_object->m_enforcement_object_id = std::stol (tokens[3]);
-    enf_object->m_enforcement_operation = operation_type;
-    enf_object->m_property_first = std::stol (tokens[6]);
-    if (operation_type == 1) {
-        enf_object->m_property_second = std::stol (tokens[7]);
+    // fields unknown to either side are dropped (newer stage) or zero-filled (older stage)
+    std::size_t copy_size = std::min<std::size_t> (header.m_record_size, sizeof (StatsChannelRaw));
+    channel_stats.resize (header.m_channels);
+
+    for (int i = 0; i < header.m_channels; i++) {
+        channel_stats[i] = StatsChannelRaw {};
+        std::memcpy (&channel_stats[i], records + i * header.m_record_size, copy_size);
+    }
+
+    if (Logging::is_debug_enabled ()) {
+        std::stringstream stream;
+        stream << "StatsChannel (v" << header.m_version << ") :: ";
+        for (const auto& channel : channel_stats) {
+            stream << channel.m_channel_id << ": " << channel.m_ops_rate << " ops/s, "
+                   << channel.m_bytes_rate << " B/s, " << channel.m_delayed_ops << " delayed; ";
+        }
+        Logging::log_debug (stream.str ());
     }
 }
 
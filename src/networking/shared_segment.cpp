@@ -0,0 +1,213 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <cerrno>
+#include <cheferd/networking/shared_segment.hpp>
+#include <new>
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+namespace cheferd {
+
+// SharedSegment default constructor.
+SharedSegment::SharedSegment () :
+    name_ {},
+    owner_ { false },
+    size_ { 0 },
+    header_ { nullptr },
+    slots_ { nullptr },
+    used_slots_ {}
+{ }
+
+// SharedSegment default destructor.
+SharedSegment::~SharedSegment ()
+{
+    unmap ();
+
+    if (owner_) {
+        shm_unlink (name_.c_str ());
+    }
+}
+
+// map call. Maps the segment into memory.
+PStatus SharedSegment::map (int fd, std::size_t size)
+{
+    void* region = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close (fd);
+
+    if (region == MAP_FAILED) {
+        Logging::log_error (
+            "SharedSegment: failed to map " + name_ + " (" + std::to_string (errno) + ").");
+        return PStatus::Error ();
+    }
+
+    size_ = size;
+    header_ = static_cast<SharedSegmentHeaderRaw*> (region);
+    slots_ = static_cast<char*> (region) + sizeof (SharedSegmentHeaderRaw);
+
+    return PStatus::OK ();
+}
+
+// unmap call. Unmaps the segment.
+void SharedSegment::unmap ()
+{
+    if (header_ != nullptr) {
+        munmap (header_, size_);
+        header_ = nullptr;
+        slots_ = nullptr;
+    }
+}
+
+// create call. Creates the segment (local controller side).
+PStatus SharedSegment::create (const std::string& name,
+    int slots,
+    uint32_t version,
+    std::size_t slot_size)
+{
+    if (header_ != nullptr || slots <= 0
+        || name.size () >= static_cast<std::size_t> (shared_segment_name_max_size)) {
+        return PStatus::Error ();
+    }
+
+    name_ = name;
+    std::size_t size
+        = sizeof (SharedSegmentHeaderRaw) + static_cast<std::size_t> (slots) * slot_size;
+
+    // only stages of the same user attach to the segment; the remaining use their sockets
+    int fd = shm_open (name_.c_str (), O_CREAT | O_RDWR | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        Logging::log_error (
+            "SharedSegment: failed to create " + name_ + " (" + std::to_string (errno) + ").");
+        return PStatus::Error ();
+    }
+    owner_ = true;
+
+    if (ftruncate (fd, static_cast<off_t> (size)) < 0) {
+        Logging::log_error ("SharedSegment: failed to size " + name_ + ".");
+        close (fd);
+        return PStatus::Error ();
+    }
+
+    PStatus status = map (fd, size);
+    if (!status.isOk ()) {
+        return status;
+    }
+
+    // the slots are initialized before their size is published in the header
+    for (int i = 0; i < slots; i++) {
+        initialize_slot (slots_ + static_cast<std::size_t> (i) * slot_size);
+    }
+    new (header_) SharedSegmentHeaderRaw {};
+    header_->m_version = version;
+    header_->m_slot_size = static_cast<uint32_t> (slot_size);
+    header_->m_slots = slots;
+
+    used_slots_.assign (slots, false);
+
+    Logging::log_info ("SharedSegment: created " + name_ + " (" + std::to_string (slots)
+        + " slots).");
+
+    return PStatus::OK ();
+}
+
+// attach call. Attaches to a segment created by the local controller (data plane stage side).
+PStatus SharedSegment::attach (const std::string& name, uint32_t version, std::size_t slot_size)
+{
+    if (header_ != nullptr) {
+        return PStatus::Error ();
+    }
+
+    name_ = name;
+    int fd = shm_open (name_.c_str (), O_RDWR, 0);
+    if (fd < 0) {
+        return PStatus::Error ();
+    }
+
+    struct stat segment_stat {};
+    if (fstat (fd, &segment_stat) < 0
+        || static_cast<std::size_t> (segment_stat.st_size) < sizeof (SharedSegmentHeaderRaw)) {
+        close (fd);
+        return PStatus::Error ();
+    }
+
+    PStatus status = map (fd, static_cast<std::size_t> (segment_stat.st_size));
+    if (!status.isOk ()) {
+        return status;
+    }
+
+    // the layout must be the one understood by this side
+    std::size_t slots_size = static_cast<std::size_t> (std::max (header_->m_slots, 0)) * slot_size;
+    if (header_->m_version != version || header_->m_slot_size != slot_size
+        || size_ < sizeof (SharedSegmentHeaderRaw) + slots_size) {
+        Logging::log_error ("SharedSegment: unsupported layout of " + name_ + ".");
+        unmap ();
+        return PStatus::Error ();
+    }
+
+    return PStatus::OK ();
+}
+
+// slot_address call. Gets the address of a slot.
+void* SharedSegment::slot_address (int slot) const
+{
+    if (slot < 0 || slot >= slots ()) {
+        return nullptr;
+    }
+
+    return slots_ + static_cast<std::size_t> (slot) * header_->m_slot_size;
+}
+
+// is_mapped call. Checks if the segment is mapped.
+bool SharedSegment::is_mapped () const
+{
+    return header_ != nullptr;
+}
+
+// name call. Gets the name of the segment.
+const std::string& SharedSegment::name () const
+{
+    return name_;
+}
+
+// slots call. Gets the number of slots of the segment.
+int SharedSegment::slots () const
+{
+    return header_ != nullptr ? header_->m_slots : 0;
+}
+
+// acquire_slot call. Assigns a free slot to a data plane stage.
+int SharedSegment::acquire_slot ()
+{
+    std::unique_lock<std::mutex> lock_t { slots_lock_ };
+
+    auto slot = std::find (used_slots_.begin (), used_slots_.end (), false);
+    if (slot == used_slots_.end ()) {
+        return -1;
+    }
+
+    *slot = true;
+    return static_cast<int> (slot - used_slots_.begin ());
+}
+
+// release_slot call. Frees (and initializes) the slot of a data plane stage.
+void SharedSegment::release_slot (int slot)
+{
+    std::unique_lock<std::mutex> lock_t { slots_lock_ };
+
+    if (slot < 0 || slot >= static_cast<int> (used_slots_.size ())) {
+        return;
+    }
+
+    // the next stage of the slot does not see the state of the previous one
+    initialize_slot (slot_address (slot));
+    used_slots_[slot] = false;
+}
+
+} // namespace cheferd
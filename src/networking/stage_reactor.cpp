@@ -0,0 +1,185 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <cerrno>
+#include <cheferd/networking/stage_reactor.hpp>
+#include <cstdint>
+
+extern "C" {
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+}
+
+namespace cheferd {
+
+// StageReactor parameterized constructor.
+StageReactor::StageReactor (int threads) : shards_ {}, working_reactor_ { true }
+{
+    Logging::log_info ("StageReactor: starting " + std::to_string (std::max (threads, 1))
+        + " shards.");
+
+    for (int i = 0; i < std::max (threads, 1); i++) {
+        auto shard = std::make_unique<Shard> ();
+        shard->m_epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+        shard->m_wakeup_fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+        struct epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.fd = shard->m_wakeup_fd;
+
+        if (shard->m_epoll_fd < 0 || shard->m_wakeup_fd < 0
+            || epoll_ctl (shard->m_epoll_fd, EPOLL_CTL_ADD, shard->m_wakeup_fd, &event) < 0) {
+            Logging::log_error ("StageReactor: failed to create shard " + std::to_string (i) + ".");
+            exit (EXIT_FAILURE);
+        }
+
+        shard->m_thread = std::thread (&StageReactor::run, this, shard.get ());
+        shards_.push_back (std::move (shard));
+    }
+}
+
+// StageReactor default destructor.
+StageReactor::~StageReactor ()
+{
+    working_reactor_ = false;
+
+    for (auto& shard : shards_) {
+        uint64_t value = 1;
+        if (::write (shard->m_wakeup_fd, &value, sizeof (value)) < 0) {
+            Logging::log_error ("StageReactor: failed to wake up shard.");
+        }
+    }
+
+    for (auto& shard : shards_) {
+        shard->m_thread.join ();
+        close (shard->m_epoll_fd);
+        close (shard->m_wakeup_fd);
+    }
+}
+
+// shard call. Gets the shard of a socket.
+StageReactor::Shard& StageReactor::shard (int fd)
+{
+    return *shards_[static_cast<std::size_t> (fd) % shards_.size ()];
+}
+
+// add call. Registers a socket, whose handler is executed whenever it is readable.
+PStatus StageReactor::add (int fd, StageReactorHandler* handler)
+{
+    Shard& fd_shard = shard (fd);
+    std::unique_lock<std::mutex> lock_t { fd_shard.m_lock };
+
+    struct epoll_event event {};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.fd = fd;
+
+    if (epoll_ctl (fd_shard.m_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        Logging::log_error ("StageReactor: failed to register socket " + std::to_string (fd) + " ("
+            + std::to_string (errno) + ").");
+        return PStatus::Error ();
+    }
+
+    fd_shard.m_handlers[fd] = handler;
+    return PStatus::OK ();
+}
+
+// set_writable call. Defines if the handler of a socket is also executed whenever it is writable.
+PStatus StageReactor::set_writable (int fd, bool writable)
+{
+    Shard& fd_shard = shard (fd);
+    std::unique_lock<std::mutex> lock_t { fd_shard.m_lock };
+
+    if (fd_shard.m_handlers.find (fd) == fd_shard.m_handlers.end ()) {
+        return PStatus::Error ();
+    }
+
+    struct epoll_event event {};
+    event.events = EPOLLIN | EPOLLRDHUP | (writable ? static_cast<uint32_t> (EPOLLOUT) : 0);
+    event.data.fd = fd;
+
+    if (epoll_ctl (fd_shard.m_epoll_fd, EPOLL_CTL_MOD, fd, &event) < 0) {
+        Logging::log_error ("StageReactor: failed to update socket " + std::to_string (fd) + " ("
+            + std::to_string (errno) + ").");
+        return PStatus::Error ();
+    }
+
+    return PStatus::OK ();
+}
+
+// remove call. Deregisters a socket, waiting for its handler to finish.
+void StageReactor::remove (int fd)
+{
+    Shard& fd_shard = shard (fd);
+    std::unique_lock<std::mutex> lock_t { fd_shard.m_lock };
+
+    if (fd_shard.m_handlers.erase (fd) > 0) {
+        epoll_ctl (fd_shard.m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+
+    // the handler may be executing (without the lock of the shard)
+    fd_shard.m_handler_done.wait (lock_t, [&fd_shard, fd] { return fd_shard.m_running != fd; });
+}
+
+// run call. Waits for, and handles, the events of a shard until the reactor is stopped.
+void StageReactor::run (Shard* shard)
+{
+    struct epoll_event events[STAGE_REACTOR_MAX_EVENTS];
+
+    while (working_reactor_.load ()) {
+        int ready = epoll_wait (shard->m_epoll_fd, events, STAGE_REACTOR_MAX_EVENTS, -1);
+
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Logging::log_error (
+                "StageReactor: epoll_wait failed (" + std::to_string (errno) + ").");
+            break;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == shard->m_wakeup_fd) {
+                continue;
+            }
+
+            // sockets removed after this batch was collected are skipped
+            std::unique_lock<std::mutex> lock_t { shard->m_lock };
+            auto registered = shard->m_handlers.find (fd);
+            if (registered == shard->m_handlers.end ()) {
+                continue;
+            }
+
+            // the handler is executed without the lock, and remove waits for it to finish
+            StageReactorHandler* handler = registered->second;
+            shard->m_running = fd;
+            lock_t.unlock ();
+
+            bool active = true;
+            if (events[i].events & EPOLLOUT) {
+                active = handler->handle_writable ();
+            }
+            if (active && (events[i].events & ~EPOLLOUT)) {
+                active = handler->handle_readable ();
+            }
+
+            lock_t.lock ();
+            shard->m_running = -1;
+
+            // unless the socket was removed (or replaced) meanwhile
+            registered = shard->m_handlers.find (fd);
+            if (!active && registered != shard->m_handlers.end ()
+                && registered->second == handler) {
+                shard->m_handlers.erase (registered);
+                epoll_ctl (shard->m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+            }
+
+            shard->m_handler_done.notify_all ();
+        }
+    }
+}
+
+} // namespace cheferd
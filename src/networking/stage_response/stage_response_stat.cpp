@@ -7,13 +7,45 @@
 namespace cheferd {
 
 // StageResponseStat default constructor.
-StageResponseStat::StageResponseStat () : m_total_rate { 0 }
+StageResponseStat::StageResponseStat () :
+    m_total_rate { 0 },
+    m_rate_variance { 0 },
+    m_samples { 1 },
+    m_channel_stats {}
 { }
 
 // StageResponseStat parameterized constructor.
 StageResponseStat::StageResponseStat (const int& response_type, const double& total_rate) :
     StageResponse { response_type },
-    m_total_rate { total_rate }
+    m_total_rate { total_rate },
+    m_rate_variance { 0 },
+    m_samples { 1 },
+    m_channel_stats {}
+{ }
+
+// StageResponseStat parameterized constructor, for statistics aggregated over a window.
+StageResponseStat::StageResponseStat (const int& response_type,
+    const double& total_rate,
+    const double& rate_variance,
+    const int& samples) :
+    StageResponse { response_type },
+    m_total_rate { total_rate },
+    m_rate_variance { rate_variance },
+    m_samples { samples },
+    m_channel_stats {}
+{ }
+
+// StageResponseStat parameterized constructor, with the statistics of each channel.
+StageResponseStat::StageResponseStat (const int& response_type,
+    const double& total_rate,
+    const double& rate_variance,
+    const int& samples,
+    std::vector<StatsChannelRaw> channel_stats) :
+    StageResponse { response_type },
+    m_total_rate { total_rate },
+    m_rate_variance { rate_variance },
+    m_samples { samples },
+    m_channel_stats { std::move (channel_stats) }
 { }
 
 // StageResponseStat default destructor.
@@ -31,6 +63,24 @@ double StageResponseStat::get_total_rate () const
     return this->m_total_rate;
 }
 
+// get_rate_variance call. Get the variance of the data plane stage rate.
+double StageResponseStat::get_rate_variance () const
+{
+    return this->m_rate_variance;
+}
+
+// get_samples call. Get the number of samples that the rate summarizes.
+int StageResponseStat::get_samples () const
+{
+    return this->m_samples;
+}
+
+// get_channel_stats call. Get the statistics of each channel of the data plane stage.
+const std::vector<StatsChannelRaw>& StageResponseStat::get_channel_stats () const
+{
+    return this->m_channel_stats;
+}
+
 // toString call. Converts response to string.
 std::string StageResponseStat::toString () const
 {
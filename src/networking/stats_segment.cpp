@@ -0,0 +1,89 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <cheferd/networking/stats_segment.hpp>
+#include <new>
+
+namespace cheferd {
+
+// StatsSegment default constructor.
+StatsSegment::StatsSegment () : SharedSegment {}
+{ }
+
+// StatsSegment default destructor.
+StatsSegment::~StatsSegment () = default;
+
+// initialize_slot call. Initializes a slot (no statistics published).
+void StatsSegment::initialize_slot (void* slot)
+{
+    new (slot) StatsSegmentSlotRaw {};
+}
+
+// create call. Creates the segment (local controller side).
+PStatus StatsSegment::create (const std::string& name, int slots)
+{
+    return SharedSegment::create (name, slots, stats_segment_version, sizeof (StatsSegmentSlotRaw));
+}
+
+// attach call. Attaches to a segment created by the local controller (data plane stage side).
+PStatus StatsSegment::attach (const std::string& name)
+{
+    return SharedSegment::attach (name, stats_segment_version, sizeof (StatsSegmentSlotRaw));
+}
+
+// publish call. Publishes the statistics of the channels of a data plane stage.
+void StatsSegment::publish (int slot, const std::vector<StatsChannelRaw>& channel_stats)
+{
+    auto* target_slot = static_cast<StatsSegmentSlotRaw*> (slot_address (slot));
+    if (target_slot == nullptr) {
+        return;
+    }
+
+    StatsSegmentSlotRaw& target = *target_slot;
+    uint64_t sequence = target.m_sequence.load (std::memory_order_relaxed);
+
+    // odd while the records are written
+    target.m_sequence.store (sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    int channels = std::min (static_cast<int> (channel_stats.size ()), stats_max_channels);
+    target.m_channels = channels;
+    std::copy (channel_stats.begin (), channel_stats.begin () + channels, target.m_channel_stats);
+
+    target.m_sequence.store (sequence + 2, std::memory_order_release);
+}
+
+// read call. Reads the statistics published by a data plane stage.
+PStatus StatsSegment::read (int slot, std::vector<StatsChannelRaw>& channel_stats) const
+{
+    const auto* source_slot = static_cast<const StatsSegmentSlotRaw*> (slot_address (slot));
+    if (source_slot == nullptr) {
+        return PStatus::Error ();
+    }
+
+    const StatsSegmentSlotRaw& source = *source_slot;
+
+    for (int i = 0; i < STATS_SEGMENT_READ_RETRIES; i++) {
+        uint64_t sequence = source.m_sequence.load (std::memory_order_acquire);
+        if (sequence == 0) {
+            return PStatus::Error ();
+        } else if (sequence & 1) {
+            continue;
+        }
+
+        int channels = std::clamp (source.m_channels, 0, stats_max_channels);
+        channel_stats.assign (source.m_channel_stats, source.m_channel_stats + channels);
+
+        // the copy is only valid if no write started meanwhile
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (source.m_sequence.load (std::memory_order_relaxed) == sequence) {
+            return PStatus::OK ();
+        }
+    }
+
+    return PStatus::Error ();
+}
+
+} // namespace cheferd
@@ -2,26 +2,103 @@
  *   Copyright (c) 2022 INESC TEC.
  **/
 
+#include <algorithm>
+#include <cerrno>
 #include <cheferd/session/data_plane_session.hpp>
+#include <cheferd/utils/metrics.hpp>
+#include <cstring>
+
+extern "C" {
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+}
 
 namespace cheferd {
 
-// DataPlaneSession parameterized constructor.
-DataPlaneSession::DataPlaneSession (const char* socket_name) : session_id_ { 0 }, interface_ {}
+namespace {
+
+// submission_depth_metric call. Gets the number of rules queued at the submission queues of
+// every DataPlaneSession.
+Gauge& submission_depth_metric ()
 {
-    PrepareUnixConnection (socket_name);
+    static Gauge& metric = Metrics::gauge ("cheferd_session_queue_depth",
+        "Number of entries queued at the queues of the sessions.",
+        "session=\"DataPlaneSession\",queue=\"submission\"");
+    return metric;
 }
 
+// completion_depth_metric call. Gets the number of responses queued at the completion queues of
+// every DataPlaneSession.
+Gauge& completion_depth_metric ()
+{
+    static Gauge& metric = Metrics::gauge ("cheferd_session_queue_depth",
+        "Number of entries queued at the queues of the sessions.",
+        "session=\"DataPlaneSession\",queue=\"completion\"");
+    return metric;
+}
+
+} // namespace
+
 // DataPlaneSession parameterized constructor.
-DataPlaneSession::DataPlaneSession (long id, const char* socket_name) :
+DataPlaneSession::DataPlaneSession (StageReactor* reactor, const char* socket_name) :
+    DataPlaneSession (0, reactor, socket_name)
+{ }
+
+// DataPlaneSession parameterized constructor.
+DataPlaneSession::DataPlaneSession (long id, StageReactor* reactor, const char* socket_name) :
     session_id_ { id },
-    interface_ {}
+    reactor_ { reactor },
+    submission_queue_ { option_default_session_ring_capacity },
+    completion_queue_ { option_default_session_ring_capacity },
+    working_session_ { false },
+    closed_session_ { false },
+    interface_ { option_default_data_plane_seqpacket },
+    next_operation_id_ { 0 },
+    max_in_flight_ { std::max<std::size_t> (option_default_data_plane_max_in_flight, 1) },
+    rx_buffer_ {},
+    tx_buffer_ {},
+    tx_offset_ { 0 },
+    tx_records_ {},
+    stats_segment_ { nullptr },
+    stats_slot_ { -1 },
+    stats_subtype_ { COLLECT_GLOBAL_STATS },
+    enforcement_table_ { nullptr },
+    enforcement_slot_ { -1 },
+    enforcement_entries_ {},
+    server_fd_ { -1 },
+    socket_ { -1 }
 {
     PrepareUnixConnection (socket_name);
 }
 
 // DataPlaneSession default destructor.
-DataPlaneSession::~DataPlaneSession () = default;
+DataPlaneSession::~DataPlaneSession ()
+{
+    // the reactor must no longer execute the handler of the session
+    if (socket_ != -1) {
+        reactor_->remove (socket_);
+        close (socket_);
+    }
+
+    if (server_fd_ != -1) {
+        close (server_fd_);
+    }
+
+    if (stats_segment_ != nullptr) {
+        stats_segment_->release_slot (stats_slot_);
+    }
+
+    if (enforcement_table_ != nullptr) {
+        enforcement_table_->release_slot (enforcement_slot_);
+    }
+
+    // entries left at the queues no longer count
+    submission_depth_metric ().add (-static_cast<double> (submission_queue_.size ()));
+    completion_depth_metric ().add (-static_cast<double> (completion_queue_.size ()));
+}
 
 // PrepareUnixConnection call. Prepare UNIX Domain socket connections
 // between the control plane and the data plane stage (single).
@@ -29,7 +106,9 @@ void DataPlaneSession::PrepareUnixConnection (const char* socket_name)
 {
     unlink (socket_name);
 
-    if ((server_fd_ = socket (AF_UNIX, SOCK_STREAM, 0)) == 0) {
+    int socket_type = option_default_data_plane_seqpacket ? SOCK_SEQPACKET : SOCK_STREAM;
+
+    if ((server_fd_ = socket (AF_UNIX, socket_type, 0)) == 0) {
         Logging::log_error ("DataPlaneSession: Socket creation error.");
         exit (EXIT_FAILURE);
     }
@@ -51,11 +130,23 @@ void DataPlaneSession::PrepareUnixConnection (const char* socket_name)
 }
 
 // StartSession call. Start session execution.
-void DataPlaneSession::StartSession ()
+PStatus DataPlaneSession::StartSession ()
 {
     Logging::log_debug ("DataPlaneSession::StartSession");
 
-    int socket_t = accept (server_fd_, (struct sockaddr*)&unix_socket_, (socklen_t*)&addrlen_);
+    // the data plane stage connects after receiving the name of the session's socket
+    struct pollfd listener {};
+    listener.fd = server_fd_;
+    listener.events = POLLIN;
+
+    int socket_t = -1;
+    if (poll (&listener, 1, option_default_data_plane_accept_timeout) > 0) {
+        socket_t = accept (server_fd_, (struct sockaddr*)&unix_socket_, (socklen_t*)&addrlen_);
+    }
+
+    // the data plane stage connects once, so the listening socket is no longer needed
+    close (server_fd_);
+    server_fd_ = -1;
 
     // verify socket value
     socket_t == -1 ? Logging::log_error ("DataPlaneSession: failed to connect with "
@@ -63,183 +154,651 @@ void DataPlaneSession::StartSession ()
                    : Logging::log_debug ("DataPlaneSession: New data plane stage connection "
                                          "established {UNIX}.");
 
+    // operations are written without blocking (see TransmitOperation)
+    if (socket_t != -1 && fcntl (socket_t, F_SETFL, fcntl (socket_t, F_GETFL) | O_NONBLOCK) < 0) {
+        Logging::log_error ("DataPlaneSession: failed to make the data plane stage socket "
+                            "non-blocking.");
+        close (socket_t);
+        socket_t = -1;
+    }
+
     if (socket_t != -1) {
-        working_session_ = true;
+        socket_ = socket_t;
+        if (!reactor_->add (socket_, this).isOk ()) {
+            close (socket_);
+            socket_ = -1;
+        }
     }
 
-    // after knowing the Stage identifier,
-    while (working_session_.load ()) {
+    std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
+
+    if (socket_ == -1) {
+        Logging::log_debug ("DataPlaneSession: Exiting data plane stage session.");
+        FailSession ();
+        return PStatus::Error ();
+    }
 
-        PStatus status;
-        ControlOperation operation {};
-        std::string rule {};
+    // send the commands submitted while the data plane stage was connecting
+    working_session_ = true;
+    DispatchRules ();
 
-        status = DequeueRuleFromSubmissionQueue (rule);
+    return PStatus::OK ();
+}
 
-        if (status.isOk ()) {
-            status = SendRule (socket_t, rule, &operation);
+// SendRule call. Sends the command to the data plane stage, without waiting for its response.
+PStatus DataPlaneSession::SendRule (const ControlCommand& command, ControlOperation* operation)
+{
+    operation->m_operation_id = next_operation_id_++;
+    operation->m_operation_type = command.m_operation_type;
+    operation->m_operation_subtype = command.m_operation_subtype;
+
+    // payload sent right after the ControlOperation
+    StageReadyRaw stage_ready {};
+    ControlOperation remove_rule {};
+    const void* payload = nullptr;
+    std::size_t payload_size = 0;
+    bool valid = true;
+    PStatus invalid_status = PStatus::Error ();
+
+    switch (operation->m_operation_type) {
+        case STAGE_HANDSHAKE:
+            operation->m_size = sizeof (struct StageSimplifiedHandshakeRaw);
+            break;
+
+        case STAGE_READY:
+            operation->m_size = sizeof (struct StageReadyRaw);
+            stage_ready.m_mark_stage = true;
+            payload = &stage_ready;
+            payload_size = sizeof (struct StageReadyRaw);
+            break;
+
+        case CREATE_HSK_RULE:
+            // housekeeping rule (channel or object)
+            if (const auto* channel_rule
+                = std::get_if<HousekeepingCreateChannelRaw> (&command.m_payload)) {
+                operation->m_operation_subtype = HSK_CREATE_CHANNEL;
+                operation->m_size = sizeof (struct HousekeepingCreateChannelRaw);
+                payload = channel_rule;
+            } else if (const auto* object_rule
+                = std::get_if<HousekeepingCreateObjectRaw> (&command.m_payload)) {
+                operation->m_operation_subtype = HSK_CREATE_OBJECT;
+                operation->m_size = sizeof (struct HousekeepingCreateObjectRaw);
+                payload = object_rule;
+            } else {
+                Logging::log_error ("DataPlaneSession: SendRule -- other housekeeping rule.");
+                valid = false;
+            }
+            payload_size = valid ? operation->m_size : 0;
+            break;
+
+        case CREATE_ENF_RULE:
+            operation->m_size = sizeof (struct EnforcementRuleRaw);
+            payload = &std::get<EnforcementRuleRaw> (command.m_payload);
+            payload_size = sizeof (struct EnforcementRuleRaw);
+            break;
+
+        case REMOVE_RULE:
+            operation->m_size = sizeof (struct ControlOperation);
+            remove_rule = *operation;
+            payload = &remove_rule;
+            payload_size = sizeof (struct ControlOperation);
+            break;
+
+        case STAGE_STATS_SEGMENT:
+        case STAGE_ENF_TABLE:
+            operation->m_size = sizeof (struct SharedSegmentRaw);
+            payload = &std::get<SharedSegmentRaw> (command.m_payload);
+            payload_size = sizeof (struct SharedSegmentRaw);
+            break;
+
+        case STAGE_STATS_VERSION:
+            operation->m_size = sizeof (struct StatsVersionRaw);
+            payload = &std::get<StatsVersionRaw> (command.m_payload);
+            payload_size = sizeof (struct StatsVersionRaw);
+            break;
+
+        case COLLECT_STATS:
+            // not implemented by the interface (see COLLECT_DETAILED_STATS)
+            invalid_status = interface_.collect_statistics (socket_, operation);
+            valid = false;
+            break;
+
+        case COLLECT_DETAILED_STATS:
+            switch (operation->m_operation_subtype) {
+                case COLLECT_GLOBAL_STATS:
+                    operation->m_size = sizeof (struct StatsGlobalRaw);
+                    break;
+                case COLLECT_CHANNEL_STATS:
+                    // m_size holds the record size understood by the control plane
+                    operation->m_size = sizeof (struct StatsChannelRaw);
+                    break;
+                default:
+                    Logging::log_error ("DataPlaneSession: SendRule -- other statistics.");
+                    valid = false;
+            }
+            break;
+
+        default:
+            Logging::log_error ("DataPlaneSession: SendRule -- rule not supported.");
+            invalid_status = PStatus::NotSupported ();
+            valid = false;
+    }
+
+    // operations that were not sent (e.g., not supported) are answered with an error, in
+    // submission order, so GetResult does not wait for them
+    if (!valid) {
+        if (in_flight_.empty ()) {
+            EnqueueErrorResponse (*operation);
+        } else {
+            in_flight_.push_back (InFlightOperation { *operation, false });
         }
+        return invalid_status;
+    }
+
+    PStatus status = TransmitOperation (*operation, payload, payload_size);
+    if (!status.isOk ()) {
+        // the stream can no longer be trusted, so the session fails
+        Logging::log_error ("DataPlaneSession: failed to send operation "
+            + std::to_string (operation->m_operation_id) + ".");
+        in_flight_.push_back (InFlightOperation { *operation, false });
+        FailSession ();
+        return status;
     }
 
-    Logging::log_debug ("DataPlaneSession: Exiting data plane stage session.");
+    in_flight_.push_back (InFlightOperation { *operation, true });
+
+    return status;
 }
 
-// SendRule call. Handle the rule to be submitted to the data plane stage.
-PStatus
-DataPlaneSession::SendRule (int socket, const std::string& rule, ControlOperation* operation)
+// TransmitOperation call. Writes an operation and its payload to the data plane stage without
+// blocking, and queues the bytes that the socket does not take.
+PStatus DataPlaneSession::TransmitOperation (const ControlOperation& operation,
+    const void* payload,
+    std::size_t payload_size)
 {
-    // parse rule
-    if (!rule.empty ()) {
-        std::string token = rule.substr (0, rule.find ('|'));
-        operation->m_operation_type = std::stoi (token);
+    std::size_t header_size = sizeof (struct ControlOperation);
+    std::size_t size = header_size + payload_size;
+    std::size_t written = 0;
+
+    // queued bytes are written first, so the operation is only written directly if there are none
+    if (tx_buffer_.empty ()) {
+        struct iovec iov[2];
+        iov[0].iov_base = const_cast<ControlOperation*> (&operation);
+        iov[0].iov_len = header_size;
+        iov[1].iov_base = const_cast<void*> (payload);
+        iov[1].iov_len = payload_size;
+
+        struct msghdr message {};
+        message.msg_iov = iov;
+        message.msg_iovlen = payload_size > 0 ? 2 : 1;
+
+        ssize_t bytes;
+        do {
+            bytes = sendmsg (socket_, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+        } while (bytes < 0 && errno == EINTR);
+
+        if (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            return PStatus::Error ();
+        }
+
+        written = static_cast<std::size_t> (std::max<ssize_t> (bytes, 0));
+        if (written == size) {
+            return PStatus::OK ();
+        }
     }
 
-    PStatus status = PStatus::Error ();
-    switch (operation->m_operation_type) {
-        case STAGE_HANDSHAKE: {
-            operation->m_size = sizeof (struct StageSimplifiedHandshakeRaw);
-            // create temporary StageHandshakeRAW structure
-            StageSimplifiedHandshakeRaw handshake_obj {};
-            // invoke SouthboundInterface's StageHandshake call
-            status = interface_.stage_handshake (socket, operation, handshake_obj);
-            // enqueue response of data plane stage from StageHandshake request
-            EnqueueResponseInCompletionQueue (
-                std::make_unique<StageResponseHandshake> (STAGE_HANDSHAKE, handshake_obj));
-            break;
+    // the remainder is written by the reactor (a SOCK_SEQPACKET record is written whole or not at
+    // all, so records are never split)
+    bool flushing = !tx_buffer_.empty ();
+    const char* header = reinterpret_cast<const char*> (&operation);
+    const char* body = static_cast<const char*> (payload);
+
+    if (written < header_size) {
+        tx_buffer_.insert (tx_buffer_.end (), header + written, header + header_size);
+        written = header_size;
+    }
+    tx_buffer_.insert (tx_buffer_.end (), body + (written - header_size), body + payload_size);
+
+    if (option_default_data_plane_seqpacket) {
+        tx_records_.push_back (size);
+    }
+
+    return flushing ? PStatus::OK () : reactor_->set_writable (socket_, true);
+}
+
+// FlushTransmitBuffer call. Writes the bytes queued in tx_buffer_ without blocking.
+PStatus DataPlaneSession::FlushTransmitBuffer ()
+{
+    while (tx_offset_ < tx_buffer_.size ()) {
+        std::size_t length = option_default_data_plane_seqpacket ? tx_records_.front ()
+                                                                 : tx_buffer_.size () - tx_offset_;
+        ssize_t bytes
+            = send (socket_, tx_buffer_.data () + tx_offset_, length, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return PStatus::Error ();
         }
 
-        case STAGE_READY: {
-            operation->m_size = sizeof (struct StageReadyRaw);
-            // create temporary StageReadyRaw struct
-            StageReadyRaw stage_ready {};
-            // create temporary ACK structure
-            ACK ack {};
-            // invoke ...
-            status = interface_.mark_stage_ready (socket, operation, stage_ready, ack);
-            // enqueue response of data plane stage from mar_stage_ready request
-            EnqueueResponseInCompletionQueue (
-                std::make_unique<StageResponseACK> (STAGE_READY, ack.m_message));
+        tx_offset_ += bytes;
+        if (option_default_data_plane_seqpacket) {
+            tx_records_.pop_front ();
+        }
+    }
+
+    // the buffer keeps its capacity for the next operations
+    if (tx_offset_ == tx_buffer_.size ()) {
+        tx_buffer_.clear ();
+        tx_offset_ = 0;
+    }
+
+    return PStatus::OK ();
+}
+
+// DispatchRules call. Sends the queued commands while there are free slots in flight.
+void DataPlaneSession::DispatchRules ()
+{
+    while (!closed_session_ && working_session_.load () && in_flight_.size () < max_in_flight_) {
+        ControlCommand command {};
+        if (!DequeueRuleFromSubmissionQueue (command).isOk ()) {
             break;
         }
 
-        case CREATE_HSK_RULE: {
-            // create temporary ACK structure
-            ACK ack {};
-            // invoke SouthboundInterface's CreateHousekeepingRule
-            status = interface_.create_housekeeping_rule (socket, operation, rule, ack);
-            // enqueue response of data plane stage from CreateHousekeepingRule request
-            EnqueueResponseInCompletionQueue (
-                std::make_unique<StageResponseACK> (CREATE_HSK_RULE, ack.m_message));
+        ControlOperation operation {};
+        SendRule (command, &operation);
+    }
+}
+
+// handle_readable call. Reads the responses of the data plane stage without blocking, and
+// completes the operations in flight they belong to.
+bool DataPlaneSession::handle_readable ()
+{
+    bool closed = false;
+
+    // read every byte available (the responses are parsed from rx_buffer_, so partial responses
+    // are completed by later reads)
+    while (true) {
+        int pending = 0;
+        if (ioctl (socket_, FIONREAD, &pending) < 0 || pending <= 0) {
+            pending = DATA_PLANE_SESSION_READ_SIZE;
+        }
+
+        std::size_t offset = rx_buffer_.size ();
+        rx_buffer_.resize (offset + pending);
+        ssize_t bytes = recv (socket_, rx_buffer_.data () + offset, pending, MSG_DONTWAIT);
+        rx_buffer_.resize (offset + std::max<ssize_t> (bytes, 0));
+
+        if (bytes > 0) {
+            continue;
+        } else if (bytes == 0) {
+            closed = true;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            closed = true;
+        }
+        break;
+    }
+
+    std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
+
+    // the stage serves the operations in order, so responses complete the oldest operations
+    PStatus status = PStatus::OK ();
+    while (!in_flight_.empty ()) {
+        bool complete = false;
+        status = CompleteOperation (in_flight_.front (), complete);
+
+        if (!status.isOk () || !complete) {
             break;
         }
+        in_flight_.pop_front ();
+    }
 
-        case CREATE_ENF_RULE: {
-            // create temporary ACK structure
-            ACK ack {};
-            // invoke SouthboundInterface's CreateEnforcementRule
-            status = interface_.create_enforcement_rule (socket, operation, rule, ack);
+    if (closed || !status.isOk ()) {
+        Logging::log_debug ("DataPlaneSession: Exiting data plane stage session.");
+        FailSession ();
+        return false;
+    }
 
-            // enqueue response of data plane stage from CreateEnforcementRule
-            // request
-            EnqueueResponseInCompletionQueue (
-                std::make_unique<StageResponseACK> (CREATE_ENF_RULE, ack.m_message));
+    // the completed operations freed slots in flight
+    DispatchRules ();
+
+    return !closed_session_;
+}
+
+// handle_writable call. Writes the bytes queued in tx_buffer_ without blocking.
+bool DataPlaneSession::handle_writable ()
+{
+    std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
 
+    if (closed_session_) {
+        return false;
+    }
+
+    if (!FlushTransmitBuffer ().isOk ()) {
+        Logging::log_error ("DataPlaneSession: failed to write to the data plane stage; failing "
+                            "session.");
+        FailSession ();
+        return false;
+    }
+
+    if (tx_buffer_.empty ()) {
+        reactor_->set_writable (socket_, false);
+    }
+
+    return true;
+}
+
+// CompleteOperation call. Completes an operation in flight with the response at the front of
+// rx_buffer_, and enqueues it in the completion_queue_.
+PStatus DataPlaneSession::CompleteOperation (const InFlightOperation& in_flight, bool& complete)
+{
+    const ControlOperation& operation = in_flight.m_operation;
+    const char* response = rx_buffer_.data ();
+    std::size_t available = rx_buffer_.size ();
+    std::size_t response_size = 0;
+    complete = false;
+
+    if (!in_flight.m_sent) {
+        EnqueueErrorResponse (operation);
+        complete = true;
+        return PStatus::OK ();
+    }
+
+    switch (operation.m_operation_type) {
+        case STAGE_HANDSHAKE: {
+            response_size = sizeof (struct StageSimplifiedHandshakeRaw);
+            if (available < response_size) {
+                return PStatus::OK ();
+            }
+
+            // create temporary StageHandshakeRAW structure
+            StageSimplifiedHandshakeRaw handshake_obj {};
+            std::memcpy (&handshake_obj, response, response_size);
+            // enqueue response of data plane stage from StageHandshake request
+            EnqueueResponseInCompletionQueue (
+                std::make_unique<StageResponseHandshake> (STAGE_HANDSHAKE, handshake_obj));
             break;
         }
 
+        case STAGE_READY:
+        case CREATE_HSK_RULE:
+        case CREATE_ENF_RULE:
+        case STAGE_STATS_SEGMENT:
+        case STAGE_ENF_TABLE:
+        case STAGE_STATS_VERSION:
         case REMOVE_RULE: {
-            // create temporary ACK structure
+            // the submission and the removal of a RemoveRule request are both acknowledged
+            std::size_t acks = operation.m_operation_type == REMOVE_RULE ? 2 : 1;
+            response_size = acks * sizeof (struct ACK);
+            if (available < response_size) {
+                return PStatus::OK ();
+            }
+
+            // create temporary ACK structure (the last one is enqueued)
             ACK ack {};
-            // invoke SouthboundInterface's RemoveRule
-            status = interface_.RemoveRule (socket, operation, operation->m_operation_id, ack);
-            // enqueue response of data plane stage from RemoveRule request
+            std::memcpy (&ack, response + (acks - 1) * sizeof (struct ACK), sizeof (struct ACK));
+            // enqueue response of data plane stage from the request
             EnqueueResponseInCompletionQueue (
-                std::make_unique<StageResponseACK> (REMOVE_RULE, ack.m_message));
+                std::make_unique<StageResponseACK> (operation.m_operation_type, ack.m_message));
             break;
         }
 
-        case COLLECT_STATS:
-            status = interface_.collect_statistics (socket, operation);
-            break;
-
         case COLLECT_DETAILED_STATS: {
-            std::vector<std::string> tokens {};
-
-            size_t start;
-            size_t end = 0;
-
-            while ((start = rule.find_first_not_of ('|', end)) != std::string::npos) {
-                end = rule.find ('|', start);
-                tokens.push_back (rule.substr (start, end - start));
-            }
-            operation->m_operation_subtype = std::stoi (tokens[1]);
-
-            switch (operation->m_operation_subtype) {
+            switch (operation.m_operation_subtype) {
                 case COLLECT_GLOBAL_STATS: {
+                    response_size = sizeof (struct StatsGlobalRaw);
+                    if (available < response_size) {
+                        return PStatus::OK ();
+                    }
+
                     // create temporary StatsGlobalRaw structure
                     StatsGlobalRaw stats_global {};
-                    // invoke SouthboundInterface's CollectStatisticsKVS
-                    status = interface_.collect_global_statistics (socket, operation, stats_global);
-
-                    if (status.isOk ()) {
-                        // enqueue response of data plane stage from collect_tensorflow_statistics
-                        EnqueueResponseInCompletionQueue (
-                            std::make_unique<StageResponseStat> (COLLECT_GLOBAL_STATS,
-                                stats_global.m_total_rate));
-                    } else {
-                        // enqueue response of data plane stage from collect_tensorflow_statistics
-                        EnqueueResponseInCompletionQueue (
-                            std::make_unique<StageResponseStat> (COLLECT_GLOBAL_STATS, -1));
+                    std::memcpy (&stats_global, response, response_size);
+                    // enqueue response of data plane stage from collect_tensorflow_statistics
+                    EnqueueResponseInCompletionQueue (
+                        std::make_unique<StageResponseStat> (COLLECT_GLOBAL_STATS,
+                            stats_global.m_total_rate));
+                    break;
+                }
+
+                case COLLECT_CHANNEL_STATS: {
+                    // header first, and then the records (sized by the stage)
+                    StatsChannelHeaderRaw header {};
+                    if (available < sizeof (struct StatsChannelHeaderRaw)) {
+                        return PStatus::OK ();
+                    }
+                    std::memcpy (&header, response, sizeof (struct StatsChannelHeaderRaw));
+
+                    if (!PAIOInterface::valid_channel_header (header)) {
+                        Logging::log_error ("DataPlaneSession: invalid channel statistics header "
+                                            "(version "
+                            + std::to_string (header.m_version) + ", record size "
+                            + std::to_string (header.m_record_size) + ", channels "
+                            + std::to_string (header.m_channels) + "); failing session.");
+                        return PStatus::Error ();
+                    }
+
+                    response_size = sizeof (struct StatsChannelHeaderRaw)
+                        + static_cast<std::size_t> (header.m_channels) * header.m_record_size;
+                    if (available < response_size) {
+                        return PStatus::OK ();
+                    }
+
+                    // create temporary container of StatsChannelRaw structures
+                    std::vector<StatsChannelRaw> channel_stats {};
+                    PAIOInterface::parse_channel_statistics (header,
+                        response + sizeof (struct StatsChannelHeaderRaw),
+                        channel_stats);
+
+                    // rates are exact over the interval since the previous report
+                    channel_counters_.derive_rates (channel_stats);
+
+                    // the total rate of the stage is the rate of its channels
+                    double total_rate = 0;
+                    for (const auto& channel : channel_stats) {
+                        total_rate += channel.m_ops_rate;
                     }
+
+                    EnqueueResponseInCompletionQueue (
+                        std::make_unique<StageResponseStat> (COLLECT_CHANNEL_STATS,
+                            total_rate,
+                            0,
+                            1,
+                            std::move (channel_stats)));
                     break;
                 }
 
                 default:
-                    Logging::log_error ("DataPlaneSession: After parsing -- other rule");
                     return PStatus::Error ();
             }
             break;
         }
 
         default:
-            status = PStatus::NotSupported ();
-            Logging::log_error ("DataPlaneSession:.SendRule -- rule not supported.");
+            return PStatus::Error ();
+    }
+
+    rx_buffer_.erase (rx_buffer_.begin (), rx_buffer_.begin () + response_size);
+    complete = true;
+
+    return PStatus::OK ();
+}
+
+// EnqueueErrorResponse call. Enqueue the error response of an operation in the
+// completion_queue_.
+void DataPlaneSession::EnqueueErrorResponse (const ControlOperation& operation)
+{
+    switch (operation.m_operation_type) {
+        case STAGE_HANDSHAKE:
+            EnqueueResponseInCompletionQueue (std::make_unique<StageResponseHandshake> (
+                STAGE_HANDSHAKE, StageSimplifiedHandshakeRaw {}));
+            break;
+
+        case STAGE_READY:
+        case CREATE_HSK_RULE:
+        case CREATE_ENF_RULE:
+        case STAGE_STATS_SEGMENT:
+        case STAGE_ENF_TABLE:
+        case STAGE_STATS_VERSION:
+        case REMOVE_RULE:
+            EnqueueResponseInCompletionQueue (
+                std::make_unique<StageResponseACK> (operation.m_operation_type, ACK {}.m_message));
+            break;
+
+        case COLLECT_DETAILED_STATS:
+            if (operation.m_operation_subtype == COLLECT_GLOBAL_STATS
+                || operation.m_operation_subtype == COLLECT_CHANNEL_STATS) {
+                EnqueueResponseInCompletionQueue (
+                    std::make_unique<StageResponseStat> (operation.m_operation_subtype, -1));
+            }
+            break;
+
+        default:
             break;
     }
+}
 
-    return status;
+// FailSession call. Closes the session, answering the operations in flight and the queued
+// commands with an error response.
+void DataPlaneSession::FailSession ()
+{
+    closed_session_ = true;
+    working_session_ = false;
+
+    // bytes not written yet are dropped with the operations they belong to
+    tx_buffer_.clear ();
+    tx_offset_ = 0;
+    tx_records_.clear ();
+
+    while (!in_flight_.empty ()) {
+        EnqueueErrorResponse (in_flight_.front ().m_operation);
+        in_flight_.pop_front ();
+    }
+
+    ControlCommand command {};
+    while (DequeueRuleFromSubmissionQueue (command).isOk ()) {
+        ControlOperation operation {};
+        operation.m_operation_type = command.m_operation_type;
+        operation.m_operation_subtype = command.m_operation_subtype;
+        EnqueueErrorResponse (operation);
+    }
 }
 
 // RemoveSession call. Stop session execution.
 void DataPlaneSession::RemoveSession ()
 {
-    working_session_ = false;
-    EnqueueRuleInSubmissionQueue ("");
+    // the reactor must no longer execute the handler of the session
+    if (socket_ != -1) {
+        reactor_->remove (socket_);
+    }
+
+    std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
+    FailSession ();
+
+    if (socket_ != -1) {
+        close (socket_);
+        socket_ = -1;
+    }
 }
 
-// EnqueueRuleInSubmissionQueue call. Enqueue rule in the submission_queue_ in
-// string-based format.
-void DataPlaneSession::EnqueueRuleInSubmissionQueue (const std::string& rule)
+// AttachStatsSegment call. Reads the statistics of the data plane stage from a slot of the
+// statistics segment.
+void DataPlaneSession::AttachStatsSegment (StatsSegment* segment, int slot)
 {
     std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
-    submission_queue_.emplace (rule);
-    submission_queue_condition_.notify_one ();
+    stats_segment_ = segment;
+    stats_slot_ = slot;
+}
+
+// SetStatisticsSubtype call. Sets the subtype of the statistics requests sent to the data plane
+// stage.
+void DataPlaneSession::SetStatisticsSubtype (int subtype)
+{
+    stats_subtype_.store (subtype);
+}
+
+// StatisticsSubtype call. Get the subtype of the statistics requests sent to the data plane stage.
+int DataPlaneSession::StatisticsSubtype () const
+{
+    return stats_subtype_.load ();
 }
 
-// DequeueRuleFromSubmissionQueue call. Dequeue rule from the submission_queue_
-// in string-based format.
-PStatus DataPlaneSession::DequeueRuleFromSubmissionQueue (std::string& rule)
+// ReadStatistics call. Reads the statistics published by the data plane stage in the statistics
+// segment, and derives the rates of its channels.
+PStatus DataPlaneSession::ReadStatistics (std::vector<StatsChannelRaw>& channel_stats)
+{
+    std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
+
+    // closed sessions are detected through the socket path
+    if (stats_segment_ == nullptr || closed_session_) {
+        return PStatus::Error ();
+    }
+
+    PStatus status = stats_segment_->read (stats_slot_, channel_stats);
+    if (status.isOk ()) {
+        channel_counters_.derive_rates (channel_stats);
+    }
+
+    return status;
+}
+
+// AttachEnforcementTable call. Writes the enforcement rules of the data plane stage in a slot of
+// the enforcement table.
+void DataPlaneSession::AttachEnforcementTable (EnforcementTable* table, int slot)
+{
+    std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
+    enforcement_table_ = table;
+    enforcement_slot_ = slot;
+    enforcement_entries_.clear ();
+}
+
+// WriteEnforcementRule call. Writes an enforcement rule in the slot of the data plane stage in the
+// enforcement table.
+PStatus DataPlaneSession::WriteEnforcementRule (const EnforcementRuleRaw& rule)
 {
     std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
-    PStatus status_t = PStatus::Error ();
 
-    while (working_session_.load () && submission_queue_.empty ()) {
-        submission_queue_condition_.wait (lock_t);
+    if (enforcement_table_ == nullptr || closed_session_) {
+        return PStatus::Error ();
     }
 
-    if (working_session_.load ()) {
-        rule = submission_queue_.front ();
-        submission_queue_.pop ();
+    // each enforcement object keeps the entry it was first written to
+    auto key = std::make_pair (rule.m_channel_id, rule.m_enforcement_object_id);
+    auto entry = enforcement_entries_.find (key);
+    if (entry == enforcement_entries_.end ()) {
+        if (static_cast<int> (enforcement_entries_.size ()) >= enforcement_table_max_rules) {
+            return PStatus::Error ();
+        }
+        int next_entry = static_cast<int> (enforcement_entries_.size ());
+        entry = enforcement_entries_.emplace (key, next_entry).first;
+    }
+
+    if (enforcement_table_->write (enforcement_slot_, entry->second, rule) == 0) {
+        return PStatus::Error ();
+    }
+
+    return PStatus::OK ();
+}
+
+// EnqueueRuleInSubmissionQueue call. Enqueue command in the submission_queue_.
+void DataPlaneSession::EnqueueRuleInSubmissionQueue (ControlCommand command)
+{
+    submission_queue_.push (std::move (command));
+    submission_depth_metric ().add (1);
+}
+
+// DequeueRuleFromSubmissionQueue call. Dequeue command from the submission_queue_.
+PStatus DataPlaneSession::DequeueRuleFromSubmissionQueue (ControlCommand& command)
+{
+    PStatus status_t = PStatus::Error ();
+
+    if (submission_queue_.try_pop (command)) {
+        submission_depth_metric ().add (-1);
         status_t = PStatus::OK ();
     }
 
@@ -251,23 +810,16 @@ PStatus DataPlaneSession::DequeueRuleFromSubmissionQueue (std::string& rule)
 void DataPlaneSession::EnqueueResponseInCompletionQueue (
     std::unique_ptr<StageResponse> response_object)
 {
-    std::unique_lock<std::mutex> lock_t { completion_queue_lock_ };
-    completion_queue_.emplace (std::move (response_object));
-    completion_queue_condition_.notify_one ();
+    completion_queue_.push (std::move (response_object));
+    completion_depth_metric ().add (1);
 }
 
 // DequeueResponseFromCompletionQueue call. Dequeue response from the
 // completion_queue_ in StageResponse format.
 std::unique_ptr<StageResponse> DataPlaneSession::DequeueResponseFromCompletionQueue ()
 {
-    std::unique_lock<std::mutex> lock_t { completion_queue_lock_ };
-
-    while (completion_queue_.empty ()) {
-        completion_queue_condition_.wait (lock_t);
-    }
-
-    std::unique_ptr<StageResponse> response_t = std::move (completion_queue_.front ());
-    completion_queue_.pop ();
+    std::unique_ptr<StageResponse> response_t = completion_queue_.pop ();
+    completion_depth_metric ().add (-1);
 
     return response_t;
 }
@@ -278,14 +830,28 @@ int DataPlaneSession::getSubmissionQueueSize ()
     return submission_queue_.size ();
 }
 
-// SubmitRule call. Submit rules to the Session.
-PStatus DataPlaneSession::SubmitRule (const std::string& submission_rule)
+// SubmitRule call. Submit commands to the Session.
+PStatus DataPlaneSession::SubmitRule (ControlCommand command)
 {
     PStatus status_t = PStatus::Error ();
 
-    EnqueueRuleInSubmissionQueue (submission_rule);
+    // the command is enqueued without holding submission_queue_lock_, so that a full
+    // submission_queue_ waits for the reactor to send the commands queued before it
+    EnqueueRuleInSubmissionQueue (std::move (command));
+
+    std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
+
+    if (closed_session_) {
+        // the queued commands are answered right away, so that callers never wait for them
+        FailSession ();
+        return status_t;
+    }
+
     status_t = PStatus::OK ();
 
+    // the command is sent right away if there is a free slot in flight
+    DispatchRules ();
+
     return status_t;
 }
 
@@ -295,6 +861,31 @@ std::unique_ptr<StageResponse> DataPlaneSession::GetResult ()
     return DequeueResponseFromCompletionQueue ();
 }
 
+// GetResult call. Pop result objects (StageResponse) from the Session, waiting at most until
+// deadline.
+std::unique_ptr<StageResponse> DataPlaneSession::GetResult (
+    const std::chrono::steady_clock::time_point& deadline)
+{
+    std::unique_ptr<StageResponse> response_t {};
+
+    if (completion_queue_.pop_until (response_t, deadline)) {
+        completion_depth_metric ().add (-1);
+        return response_t;
+    }
+
+    Logging::log_error ("DataPlaneSession: no response from data plane stage of session "
+        + std::to_string (session_id_) + " before the deadline; removing session.");
+    RemoveSession ();
+
+    // the expired request is now answered (by the stage meanwhile, or with an error response by
+    // RemoveSession), and is the oldest response of the completion_queue_
+    if (completion_queue_.try_pop (response_t)) {
+        completion_depth_metric ().add (-1);
+    }
+
+    return nullptr;
+}
+
 // SessionIdentifier call. Get session identifier.
 long DataPlaneSession::SessionIdentifier () const
 {
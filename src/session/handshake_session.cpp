@@ -4,55 +4,56 @@
 
 #include <cheferd/session/handshake_session.hpp>
 
+extern "C" {
+#include <sys/socket.h>
+#include <sys/time.h>
+}
+
 namespace cheferd {
 
 // HandshakeSession default constructor.
-HandshakeSession::HandshakeSession () : socket_id_ { 0 }, interface_ {}
+HandshakeSession::HandshakeSession () : HandshakeSession (0)
 { }
 
 // HandshakeSession parameterized constructor.
-HandshakeSession::HandshakeSession (long id) : socket_id_ { id }, interface_ {}
+HandshakeSession::HandshakeSession (long id) :
+    socket_id_ { id },
+    completion_queue_ { option_default_session_ring_capacity },
+    working_session_ { true },
+    interface_ {}
 { }
 
 // HandshakeSession default destructor.
 HandshakeSession::~HandshakeSession () = default;
 
 // StartSession call. Start session execution.
-void HandshakeSession::StartSession ()
+PStatus HandshakeSession::StartSession ()
 {
-    Logging::log_debug ("HandshakeSession: " + std::to_string (getSubmissionQueueSize ()));
-
-    PStatus status;
-    ControlOperation operation {};
-    std::string rule {};
-
-    working_session_ = true;
-
-    status = DequeueRuleFromSubmissionQueue (rule);
-
-    if (status.isOk ()) {
-        status = SendRule (socket_id_, rule, &operation);
+    Logging::log_debug ("HandshakeSession: " + std::to_string (socket_id_));
+
+    // reads and writes that time out fail, so a data plane stage that does not answer fails the
+    // handshake rather than holding the thread
+    struct timeval timeout {};
+    timeout.tv_sec = option_default_data_plane_response_timeout / 1000;
+    timeout.tv_usec = (option_default_data_plane_response_timeout % 1000) * 1000;
+
+    int socket_t = static_cast<int> (socket_id_);
+    if (setsockopt (socket_t, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout)) < 0
+        || setsockopt (socket_t, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof (timeout)) < 0) {
+        Logging::log_error ("HandshakeSession: failed to bound the reads and writes of socket "
+            + std::to_string (socket_t) + ".");
+        return PStatus::Error ();
     }
 
-    if (working_session_.load () && status.isOk ()) {
-        /* Send info about address and port to connect to */
-        status = DequeueRuleFromSubmissionQueue (rule);
-        if (status.isOk ()) {
-            status = SendRule (socket_id_, rule, &operation);
-        }
-    }
+    return PStatus::OK ();
 }
 
-// SendRule call. Handle the rule to be submitted to the data plane stage.
+// SendRule call. Handle the command to be submitted to the data plane stage.
 PStatus
-HandshakeSession::SendRule (int socket, const std::string& rule, ControlOperation* operation)
+HandshakeSession::SendRule (int socket, const ControlCommand& command, ControlOperation* operation)
 {
-    // parse rule
-    if (!rule.empty ()) {
-        std::string token = rule.substr (0, rule.find ('|'));
-        // std::cout << "Token: " << token << "\n";
-        operation->m_operation_type = std::stoi (token);
-    }
+    operation->m_operation_type = command.m_operation_type;
+    operation->m_operation_subtype = command.m_operation_subtype;
 
     PStatus status = PStatus::Error ();
     switch (operation->m_operation_type) {
@@ -73,7 +74,9 @@ HandshakeSession::SendRule (int socket, const std::string& rule, ControlOperatio
             ACK ack {};
 
             // send to the data plane stage the address and port that it should connect to.
-            status = interface_.stage_handshake_address (socket, rule, ack);
+            status = interface_.stage_handshake_address (socket,
+                std::get<StageHandshakeRaw> (command.m_payload),
+                ack);
 
             // enqueue response of data plane stage from StageHandshakeInfo
             EnqueueResponseInCompletionQueue (
@@ -93,38 +96,8 @@ HandshakeSession::SendRule (int socket, const std::string& rule, ControlOperatio
 // RemoveSession call. Stop session execution.
 void HandshakeSession::RemoveSession ()
 {
+    // commands submitted afterwards are answered with an error response
     working_session_ = false;
-    EnqueueRuleInSubmissionQueue ("");
-}
-
-// EnqueueRuleInSubmissionQueue call. Enqueue rule in the submission_queue_ in
-// string-based format.
-void HandshakeSession::EnqueueRuleInSubmissionQueue (const std::string& rule)
-{
-    std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
-    submission_queue_.emplace (rule);
-    submission_queue_condition_.notify_one ();
-}
-
-// DequeueRuleFromSubmissionQueue call. Dequeue rule from the submission_queue_
-// in string-based format.
-PStatus HandshakeSession::DequeueRuleFromSubmissionQueue (std::string& rule)
-{
-    std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
-    PStatus status_t = PStatus::Error ();
-
-    while (working_session_.load () && submission_queue_.empty ()) {
-        submission_queue_condition_.wait (lock_t);
-    }
-
-    if (working_session_.load ()) {
-        // Logging::log_debug("DataPlaneSession :: 5Dequeueue to dequeue");
-        rule = submission_queue_.front ();
-        submission_queue_.pop ();
-        status_t = PStatus::OK ();
-    }
-
-    return status_t;
 }
 
 // EnqueueResponseInCompletionQueue call. Enqueue response in the completion_queue_
@@ -132,43 +105,34 @@ PStatus HandshakeSession::DequeueRuleFromSubmissionQueue (std::string& rule)
 void HandshakeSession::EnqueueResponseInCompletionQueue (
     std::unique_ptr<StageResponse> response_object)
 {
-    std::unique_lock<std::mutex> lock_t { completion_queue_lock_ };
-    completion_queue_.emplace (std::move (response_object));
-    completion_queue_condition_.notify_one ();
+    completion_queue_.push (std::move (response_object));
 }
 
 // DequeueResponseFromCompletionQueue call. Dequeue response from the
 // completion_queue_ in StageResponse format.
 std::unique_ptr<StageResponse> HandshakeSession::DequeueResponseFromCompletionQueue ()
 {
-
-    std::unique_lock<std::mutex> lock_t { completion_queue_lock_ };
-
-    while (completion_queue_.empty ()) {
-        completion_queue_condition_.wait (lock_t);
-    }
-
-    std::unique_ptr<StageResponse> response_t = std::move (completion_queue_.front ());
-    completion_queue_.pop ();
-
-    return response_t;
-}
-
-// getSubmissionQueueSize call. Get the total size of the submission_queue.
-int HandshakeSession::getSubmissionQueueSize ()
-{
-    return submission_queue_.size ();
+    return completion_queue_.pop ();
 }
 
-// SubmitRule call. Submit rules to the Session.
-PStatus HandshakeSession::SubmitRule (const std::string& submission_rule)
+// SubmitRule call. Sends a command to the data plane stage, and enqueues its response.
+PStatus HandshakeSession::SubmitRule (ControlCommand command)
 {
-    PStatus status_t = PStatus::Error ();
+    ControlOperation operation {};
 
-    EnqueueRuleInSubmissionQueue (submission_rule);
-    status_t = PStatus::OK ();
+    // a removed session sends nothing (the command is answered with an error response)
+    if (!working_session_.load ()) {
+        if (command.m_operation_type == STAGE_HANDSHAKE) {
+            EnqueueResponseInCompletionQueue (std::make_unique<StageResponseHandshake> (
+                STAGE_HANDSHAKE, StageSimplifiedHandshakeRaw {}));
+        } else {
+            EnqueueResponseInCompletionQueue (
+                std::make_unique<StageResponseACK> (command.m_operation_type, ACK {}.m_message));
+        }
+        return PStatus::Error ();
+    }
 
-    return status_t;
+    return SendRule (static_cast<int> (socket_id_), command, &operation);
 }
 
 // GetResult call. Pop result objects (StageResponse) from the Session.
@@ -177,6 +141,17 @@ std::unique_ptr<StageResponse> HandshakeSession::GetResult ()
     return DequeueResponseFromCompletionQueue ();
 }
 
+// GetResult call. Pop result objects (StageResponse) from the Session, waiting at most until
+// deadline.
+std::unique_ptr<StageResponse> HandshakeSession::GetResult (
+    const std::chrono::steady_clock::time_point& deadline)
+{
+    std::unique_ptr<StageResponse> response_t {};
+    completion_queue_.pop_until (response_t, deadline);
+
+    return response_t;
+}
+
 // SessionIdentifier call. Get session identifier.
 long HandshakeSession::SessionIdentifier () const
 {
@@ -5,23 +5,96 @@
 #include "cheferd/networking/stage_response/stage_response_stat.hpp"
 
 #include <cheferd/session/local_controller_session.hpp>
+#include <cheferd/utils/metrics.hpp>
 
 namespace cheferd {
 
+namespace {
+
+// submission_depth_metric call. Gets the number of rules queued at the submission queues of
+// every LocalControllerSession.
+Gauge& submission_depth_metric ()
+{
+    static Gauge& metric = Metrics::gauge ("cheferd_session_queue_depth",
+        "Number of entries queued at the queues of the sessions.",
+        "session=\"LocalControllerSession\",queue=\"submission\"");
+    return metric;
+}
+
+// completion_depth_metric call. Gets the number of responses queued at the completion queues of
+// every LocalControllerSession.
+Gauge& completion_depth_metric ()
+{
+    static Gauge& metric = Metrics::gauge ("cheferd_session_queue_depth",
+        "Number of entries queued at the queues of the sessions.",
+        "session=\"LocalControllerSession\",queue=\"completion\"");
+    return metric;
+}
+
+} // namespace
+
 // LocalControllerSession parameterized constructor.
 LocalControllerSession::LocalControllerSession (const std::string& user_address) :
     session_id_ { 0 },
-    interface_ { user_address }
+    submission_queue_ { option_default_session_ring_capacity },
+    completion_queue_ { option_default_session_ring_capacity },
+    expired_responses_ { 0 },
+    working_session_ { false },
+    rule_in_flight_ { false },
+    interface_ { user_address },
+    latest_statistics_ {},
+    streaming_statistics_ { false }
 { }
 
 // LocalControllerSession parameterized constructor.
 LocalControllerSession::LocalControllerSession (long id, const std::string& user_address) :
     session_id_ { id },
-    interface_ { user_address }
+    submission_queue_ { option_default_session_ring_capacity },
+    completion_queue_ { option_default_session_ring_capacity },
+    expired_responses_ { 0 },
+    working_session_ { false },
+    rule_in_flight_ { false },
+    interface_ { user_address },
+    latest_statistics_ {},
+    streaming_statistics_ { false }
+{ }
+
+// LocalControllerSession parameterized constructor (asynchronous mode).
+LocalControllerSession::LocalControllerSession (const std::string& user_address,
+    LocalInterfacePoller* poller) :
+    session_id_ { 0 },
+    submission_queue_ { option_default_session_ring_capacity },
+    completion_queue_ { option_default_session_ring_capacity },
+    expired_responses_ { 0 },
+    working_session_ { false },
+    rule_in_flight_ { false },
+    interface_ { user_address, poller },
+    latest_statistics_ {},
+    streaming_statistics_ { false }
 { }
 
 // LocalControllerSession default destructor.
-LocalControllerSession::~LocalControllerSession () = default;
+LocalControllerSession::~LocalControllerSession ()
+{
+    if (statistics_stream_thread_.joinable ()) {
+        streaming_statistics_ = false;
+        interface_.cancel_statistics_stream ();
+        statistics_stream_thread_.join ();
+    }
+
+    if (interface_.is_async ()) {
+        // wait for the poller to complete the rule in flight, as it refers to this session
+        std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
+        working_session_ = false;
+        interface_.cancel_async_call ();
+
+        submission_queue_condition_.wait (lock_t, [this] { return !rule_in_flight_; });
+    }
+
+    // entries left at the queues no longer count
+    submission_depth_metric ().add (-static_cast<double> (submission_queue_.size ()));
+    completion_depth_metric ().add (-static_cast<double> (completion_queue_.size ()));
+}
 
 // StartSession call. Start session execution.
 void LocalControllerSession::StartSession (const std::string& user_address)
@@ -30,29 +103,32 @@ void LocalControllerSession::StartSession (const std::string& user_address)
 
     working_session_ = true;
 
+    // in asynchronous mode, rules are submitted by SubmitRule and the poller threads
+    if (interface_.is_async ()) {
+        DispatchNextRule ();
+        return;
+    }
+
     // after knowing the Stage identifier,
     while (working_session_.load ()) {
         PStatus status;
         ControlOperation operation {};
-        std::string rule {};
+        ControlCommand command {};
 
-        status = DequeueRuleFromSubmissionQueue (rule);
+        status = DequeueRuleFromSubmissionQueue (command);
         if (status.isOk ()) {
-            status = SendRule (user_address, rule, &operation);
+            status = SendRule (user_address, command, &operation);
         }
     }
 }
 
-// SendRule call. Handle the rule to be submitted to the local controller.
+// SendRule call. Handle the command to be submitted to the local controller.
 PStatus LocalControllerSession::SendRule (const std::string& user_address,
-    const std::string& rule,
+    const ControlCommand& command,
     ControlOperation* operation)
 {
-    // parse rule
-    if (!rule.empty ()) {
-        std::string token = rule.substr (0, rule.find ('|'));
-        operation->m_operation_type = std::stoi (token);
-    }
+    operation->m_operation_type = command.m_operation_type;
+    operation->m_operation_subtype = command.m_operation_subtype;
 
     PStatus status = PStatus::Error ();
     switch (operation->m_operation_type) {
@@ -61,7 +137,10 @@ PStatus LocalControllerSession::SendRule (const std::string& user_address,
             // create temporary ACK structure
             ACK ack {};
             // invoke SouthboundInterface's StageHandshake call
-            status = interface_.local_handshake (user_address, operation, rule, ack);
+            status = interface_.local_handshake (user_address,
+                operation,
+                *std::get<const std::vector<std::string>*> (command.m_payload),
+                ack);
             // enqueue response of data plane stage from StageHandshake request
             EnqueueResponseInCompletionQueue (
                 std::make_unique<StageResponseACK> (LOCAL_HANDSHAKE, ack.m_message));
@@ -87,7 +166,10 @@ PStatus LocalControllerSession::SendRule (const std::string& user_address,
             // create temporary ACK structure
             ACK ack {};
             // invoke ...
-            status = interface_.mark_stage_ready (user_address, operation, rule, ack);
+            status = interface_.mark_stage_ready (user_address,
+                operation,
+                std::get<std::string> (command.m_payload),
+                ack);
             // enqueue response of data plane stage from mar_stage_ready request
             EnqueueResponseInCompletionQueue (
                 std::make_unique<StageResponseACK> (STAGE_READY, ack.m_message));
@@ -99,7 +181,11 @@ PStatus LocalControllerSession::SendRule (const std::string& user_address,
             // create temporary ACK structure
             ACK ack {};
             // invoke SouthboundInterface's CreateEnforcementRule
-            status = interface_.create_enforcement_rule (user_address, operation, rule, ack);
+            status = interface_.create_enforcement_rule (user_address,
+                operation,
+                *std::get<std::shared_ptr<const std::vector<JobEnforcementRule>>> (
+                    command.m_payload),
+                ack);
 
             // enqueue response of data plane stage from CreateEnforcementRule
             // request
@@ -110,17 +196,6 @@ PStatus LocalControllerSession::SendRule (const std::string& user_address,
         }
 
         case COLLECT_DETAILED_STATS: {
-            std::vector<std::string> tokens {};
-
-            size_t start;
-            size_t end = 0;
-
-            while ((start = rule.find_first_not_of ('|', end)) != std::string::npos) {
-                end = rule.find ('|', start);
-                tokens.push_back (rule.substr (start, end - start));
-            }
-            operation->m_operation_subtype = std::stoi (tokens[1]);
-
             switch (operation->m_operation_subtype) {
                 case COLLECT_GLOBAL_STATS: {
                     // create temporary StatsKVSRaw structure
@@ -153,9 +228,16 @@ PStatus LocalControllerSession::SendRule (const std::string& user_address,
                         stats_tf_objects = std::make_unique<
                             std::unordered_map<std::string, std::unique_ptr<StageResponse>>> ();
 
+                    // window and maximum number of samples are optional
+                    const auto* requested = std::get_if<StatisticsWindow> (&command.m_payload);
+                    StatisticsWindow window
+                        = requested != nullptr ? *requested : StatisticsWindow {};
+
                     // invoke SouthboundInterface's CollectStatisticsKVS
                     status = interface_.collect_global_statistics_aggregated (user_address,
                         operation,
+                        window.m_window,
+                        window.m_max_samples,
                         stats_tf_objects);
 
                     if (status.isOk ()) {
@@ -174,7 +256,7 @@ PStatus LocalControllerSession::SendRule (const std::string& user_address,
                 }
 
                 default:
-                    Logging::log_error ("LocalControllerSession: After parsing -- other rule");
+                    Logging::log_error ("LocalControllerSession: SendRule -- other statistics.");
                     return PStatus::Error ();
             }
             break;
@@ -188,40 +270,160 @@ PStatus LocalControllerSession::SendRule (const std::string& user_address,
     return status;
 }
 
-// RemoveSession call. Stop session execution.
-void LocalControllerSession::RemoveSession ()
+// SendRuleAsync call. Asynchronously submit the command to the local controller.
+void LocalControllerSession::SendRuleAsync (const ControlCommand& command)
 {
-    working_session_ = false;
-    EnqueueRuleInSubmissionQueue ("");
+    int operation_type = command.m_operation_type;
+
+    switch (operation_type) {
+        case LOCAL_HANDSHAKE:
+        case STAGE_READY:
+        case CREATE_ENF_RULE: {
+            ACKCallback on_complete = [this, operation_type] (PStatus status, const ACK& ack) {
+                CompleteAsyncRule (
+                    std::make_unique<StageResponseACK> (operation_type, ack.m_message));
+            };
+
+            if (operation_type == LOCAL_HANDSHAKE) {
+                interface_.async_local_handshake (
+                    *std::get<const std::vector<std::string>*> (command.m_payload),
+                    on_complete);
+            } else if (operation_type == STAGE_READY) {
+                interface_.async_mark_stage_ready (std::get<std::string> (command.m_payload),
+                    on_complete);
+            } else {
+                interface_.async_create_enforcement_rule (
+                    *std::get<std::shared_ptr<const std::vector<JobEnforcementRule>>> (
+                        command.m_payload),
+                    on_complete);
+            }
+            break;
+        }
+
+        case COLLECT_DETAILED_STATS: {
+            ControlOperation operation {};
+            operation.m_operation_type = COLLECT_DETAILED_STATS;
+            operation.m_operation_subtype = command.m_operation_subtype;
+
+            if (operation.m_operation_subtype != COLLECT_GLOBAL_STATS
+                && operation.m_operation_subtype != COLLECT_GLOBAL_STATS_AGGREGATED) {
+                Logging::log_error ("LocalControllerSession: SendRuleAsync -- other statistics.");
+                CompleteAsyncRule (nullptr);
+                break;
+            }
+
+            // window and maximum number of samples are optional (aggregated statistics only)
+            const auto* requested = std::get_if<StatisticsWindow> (&command.m_payload);
+            StatisticsWindow window = requested != nullptr ? *requested : StatisticsWindow {};
+
+            int subtype = operation.m_operation_subtype;
+            interface_.async_collect_global_statistics (&operation,
+                window.m_window,
+                window.m_max_samples,
+                [this, subtype] (PStatus status,
+                    std::unique_ptr<
+                        std::unordered_map<std::string, std::unique_ptr<StageResponse>>>&
+                        stats_tf_objects) {
+                    CompleteAsyncRule (
+                        std::make_unique<StageResponseStats> (subtype, stats_tf_objects));
+                });
+            break;
+        }
+
+        default:
+            Logging::log_error ("LocalControllerSession: SendRuleAsync -- rule not supported.");
+            CompleteAsyncRule (nullptr);
+            break;
+    }
 }
 
-// EnqueueRuleInSubmissionQueue call. Enqueue rule in the submission_queue_ in
-// string-based format.
-void LocalControllerSession::EnqueueRuleInSubmissionQueue (const std::string& rule)
+// DispatchNextRule call. Submits the next rule of the submission_queue_ in asynchronous mode.
+void LocalControllerSession::DispatchNextRule ()
 {
-    std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
-    submission_queue_.emplace (rule);
-    submission_queue_condition_.notify_one ();
+    ControlCommand command {};
+    bool dispatch;
+
+    {
+        std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
+        dispatch = PopNextRule (command);
+    }
+
+    if (dispatch) {
+        SendRuleAsync (command);
+    }
 }
 
-// DequeueRuleFromSubmissionQueue call. Dequeue rule from the submission_queue_
-// in string-based format.
-PStatus LocalControllerSession::DequeueRuleFromSubmissionQueue (std::string& rule)
+// PopNextRule call. Pops the next command to submit in asynchronous mode and marks it as in
+// flight.
+bool LocalControllerSession::PopNextRule (ControlCommand& command)
 {
-    std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
-    PStatus status_t = PStatus::Error ();
+    if (!working_session_.load () || rule_in_flight_ || !submission_queue_.try_pop (command)) {
+        return false;
+    }
+
+    submission_depth_metric ().add (-1);
+    rule_in_flight_ = true;
+
+    return true;
+}
 
-    while (working_session_.load () && submission_queue_.empty ()) {
-        submission_queue_condition_.wait (lock_t);
+// CompleteAsyncRule call. Handles the response of an asynchronously submitted rule and submits
+// the next one.
+void LocalControllerSession::CompleteAsyncRule (std::unique_ptr<StageResponse> response_object)
+{
+    if (response_object != nullptr) {
+        EnqueueResponseInCompletionQueue (std::move (response_object));
     }
 
-    if (working_session_.load ()) {
-        rule = submission_queue_.front ();
-        submission_queue_.pop ();
-        status_t = PStatus::OK ();
+    ControlCommand command {};
+    bool dispatch;
+
+    {
+        std::unique_lock<std::mutex> lock_t { submission_queue_lock_ };
+        rule_in_flight_ = false;
+        dispatch = PopNextRule (command);
+
+        // the session must not be accessed after notifying a waiting destructor
+        if (!dispatch) {
+            submission_queue_condition_.notify_all ();
+        }
     }
 
-    return status_t;
+    if (dispatch) {
+        SendRuleAsync (command);
+    }
+}
+
+// RemoveSession call. Stop session execution.
+void LocalControllerSession::RemoveSession ()
+{
+    working_session_ = false;
+
+    if (interface_.is_async ()) {
+        interface_.cancel_async_call ();
+    } else {
+        // the session thread is woken up, rather than sent a command, so that the
+        // submission_queue_ keeps a single producer
+        submission_queue_.wake_consumer ();
+    }
+}
+
+// EnqueueRuleInSubmissionQueue call. Enqueue command in the submission_queue_.
+void LocalControllerSession::EnqueueRuleInSubmissionQueue (ControlCommand command)
+{
+    submission_queue_.push (std::move (command));
+    submission_depth_metric ().add (1);
+}
+
+// DequeueRuleFromSubmissionQueue call. Dequeue command from the submission_queue_.
+PStatus LocalControllerSession::DequeueRuleFromSubmissionQueue (ControlCommand& command)
+{
+    if (!submission_queue_.pop (command, working_session_)) {
+        return PStatus::Error ();
+    }
+
+    submission_depth_metric ().add (-1);
+    return PStatus::OK ();
 }
 
 // EnqueueResponseInCompletionQueue call. Enqueue response in the completion_queue_
@@ -229,26 +431,59 @@ PStatus LocalControllerSession::DequeueRuleFromSubmissionQueue (std::string& rul
 void LocalControllerSession::EnqueueResponseInCompletionQueue (
     std::unique_ptr<StageResponse> response_object)
 {
-    std::unique_lock<std::mutex> lock_t { completion_queue_lock_ };
-    completion_queue_.emplace (std::move (response_object));
-    completion_queue_condition_.notify_one ();
+    completion_queue_.push (std::move (response_object));
+    completion_depth_metric ().add (1);
 }
 
 // DequeueResponseFromCompletionQueue call. Dequeue response from the
 // completion_queue_ in StageResponse format.
 std::unique_ptr<StageResponse> LocalControllerSession::DequeueResponseFromCompletionQueue ()
 {
+    // the responses of expired requests arrive before the awaited one, and are discarded
+    while (true) {
+        std::unique_ptr<StageResponse> response_t = completion_queue_.pop ();
+        completion_depth_metric ().add (-1);
 
-    std::unique_lock<std::mutex> lock_t { completion_queue_lock_ };
+        if (expired_responses_ == 0) {
+            return response_t;
+        }
+        expired_responses_--;
+    }
+}
+
+// DequeueResponseFromCompletionQueue call. Dequeue response from the completion_queue_ in
+// StageResponse format, waiting at most until deadline.
+std::unique_ptr<StageResponse> LocalControllerSession::DequeueResponseFromCompletionQueue (
+    const std::chrono::steady_clock::time_point& deadline)
+{
+    std::unique_ptr<StageResponse> response_t {};
+
+    // the responses of expired requests arrive before the awaited one, and are discarded
+    while (true) {
+        if (!completion_queue_.pop_until (response_t, deadline)) {
+            // the response is still in flight; discard it once it arrives
+            expired_responses_++;
+            return nullptr;
+        }
+        completion_depth_metric ().add (-1);
 
-    while (completion_queue_.empty ()) {
-        completion_queue_condition_.wait (lock_t);
+        if (expired_responses_ == 0) {
+            return response_t;
+        }
+        expired_responses_--;
     }
+}
 
-    std::unique_ptr<StageResponse> response_t = std::move (completion_queue_.front ());
-    completion_queue_.pop ();
+// DiscardExpiredResponses call. Discard expired responses that already arrived at the
+// completion_queue_.
+void LocalControllerSession::DiscardExpiredResponses ()
+{
+    std::unique_ptr<StageResponse> response_t {};
 
-    return response_t;
+    while (expired_responses_ > 0 && completion_queue_.try_pop (response_t)) {
+        completion_depth_metric ().add (-1);
+        expired_responses_--;
+    }
 }
 
 // getSubmissionQueueSize call. Get the total size of the submission_queue.
@@ -257,14 +492,18 @@ int LocalControllerSession::getSubmissionQueueSize ()
     return submission_queue_.size ();
 }
 
-// SubmitRule call. Submit rules to the Session.
-PStatus LocalControllerSession::SubmitRule (const std::string& submission_rule)
+// SubmitRule call. Submit commands to the Session.
+PStatus LocalControllerSession::SubmitRule (ControlCommand command)
 {
     PStatus status_t = PStatus::Error ();
 
-    EnqueueRuleInSubmissionQueue (submission_rule);
+    EnqueueRuleInSubmissionQueue (std::move (command));
     status_t = PStatus::OK ();
 
+    if (interface_.is_async ()) {
+        DispatchNextRule ();
+    }
+
     return status_t;
 }
 
@@ -274,6 +513,91 @@ std::unique_ptr<StageResponse> LocalControllerSession::GetResult ()
     return DequeueResponseFromCompletionQueue ();
 }
 
+// GetResult call. Pop result objects (StageResponse) from the Session, waiting at most until
+// deadline.
+std::unique_ptr<StageResponse> LocalControllerSession::GetResult (
+    const std::chrono::steady_clock::time_point& deadline)
+{
+    return DequeueResponseFromCompletionQueue (deadline);
+}
+
+// HasExpiredResponses call. Verify if the session still waits for responses whose deadline
+// expired.
+bool LocalControllerSession::HasExpiredResponses ()
+{
+    DiscardExpiredResponses ();
+
+    return expired_responses_ > 0;
+}
+
+// StartStatisticsStream call. Start consuming the statistics pushed by the local controller.
+void LocalControllerSession::StartStatisticsStream (uint64_t period)
+{
+    if (streaming_statistics_.exchange (true)) {
+        return;
+    }
+
+    // statistics missing since the stream start are aged from now on
+    latest_statistics_.back ().m_timestamp = std::chrono::steady_clock::now ();
+    latest_statistics_.publish ();
+    latest_statistics_.update ();
+
+    statistics_stream_thread_
+        = std::thread (&LocalControllerSession::ConsumeStatisticsStream, this, period);
+}
+
+// ConsumeStatisticsStream call. Consumes the statistics stream of the local controller.
+void LocalControllerSession::ConsumeStatisticsStream (uint64_t period)
+{
+    while (streaming_statistics_.load ()) {
+        PStatus status
+            = interface_.stream_global_statistics (period,
+                [this] (const StatsGlobalMap& stats) { PublishStatistics (stats); });
+
+        // wait before reopening the stream
+        if (streaming_statistics_.load ()) {
+            Logging::log_debug ("LocalControllerSession: reopening statistics stream.");
+            std::this_thread::sleep_for (std::chrono::microseconds (period));
+        }
+    }
+}
+
+// PublishStatistics call. Publishes the statistics pushed by the local controller.
+void LocalControllerSession::PublishStatistics (const StatsGlobalMap& stats)
+{
+    StatisticsSnapshot& snapshot = latest_statistics_.back ();
+
+    snapshot.m_timestamp = std::chrono::steady_clock::now ();
+    snapshot.m_stats = stats;
+
+    latest_statistics_.publish ();
+}
+
+// GetLatestStatistics call. Get the statistics pushed by the local controller since the last
+// call, without blocking.
+std::unique_ptr<StageResponse> LocalControllerSession::GetLatestStatistics ()
+{
+    if (!latest_statistics_.update () || latest_statistics_.front ().m_stats.m_sequence () == 0) {
+        return nullptr;
+    }
+
+    std::unique_ptr<std::unordered_map<std::string, std::unique_ptr<StageResponse>>> stats_objects
+        = std::make_unique<std::unordered_map<std::string, std::unique_ptr<StageResponse>>> ();
+
+    // the responses are the same as those of the unary statistics requests
+    LocalInterface::fill_global_statistics (latest_statistics_.front ().m_stats,
+        COLLECT_GLOBAL_STATS,
+        stats_objects);
+
+    return std::make_unique<StageResponseStats> (COLLECT_GLOBAL_STATS, stats_objects);
+}
+
+// LatestStatisticsTime call. Get the time at which the latest statistics were received.
+std::chrono::steady_clock::time_point LocalControllerSession::LatestStatisticsTime () const
+{
+    return latest_statistics_.front ().m_timestamp;
+}
+
 // SessionIdentifier call. Get session identifier.
 long LocalControllerSession::SessionIdentifier () const
 {
@@ -36,6 +36,14 @@ void ConfigFileParser::select_default_housekeeping_rule (ControlType control_typ
             housekeeping_rules_file = cheferd::option_housekeeping_rules_file_path_posix_dynamic;
             break;
         }
+        case ControlType::DYNAMIC_WATER_FILLING: {
+            housekeeping_rules_file = cheferd::option_housekeeping_rules_file_path_posix_dynamic;
+            break;
+        }
+        case ControlType::MDS: {
+            housekeeping_rules_file = cheferd::option_housekeeping_rules_file_path_posix_mds;
+            break;
+        }
         default:
             break;
     }
@@ -47,7 +55,7 @@ void ConfigFileParser::select_control_type (YAML::Node root_node, int control)
 
     if (control == 1) {
         control_type = ControlType::STATIC;
-    } else if (control == 2 || control == 3) {
+    } else if (control == 2 || control == 3 || control == 4 || control == 5) {
 
         if (root_node["system_limit"]) {
             system_limit = root_node["system_limit"].as<long> ();
@@ -57,11 +65,13 @@ void ConfigFileParser::select_control_type (YAML::Node root_node, int control)
 
         if (control == 2) {
             control_type = ControlType::DYNAMIC_VANILLA;
-        } else {
+        } else if (control == 3) {
             control_type = ControlType::DYNAMIC_LEFTOVER;
+        } else if (control == 4) {
+            control_type = ControlType::MDS;
+        } else {
+            control_type = ControlType::DYNAMIC_WATER_FILLING;
         }
-    } else if (control == 4) {
-        control_type = ControlType::MDS;
     }
 }
 
@@ -96,6 +106,55 @@ void ConfigFileParser::process_core_controller_config (YAML::Node root_node)
     } else {
         Logging::log_error ("Policies rules file path needs to be provided!");
     }
+
+    if (root_node["operation_limits"]) {
+        operation_limits = root_node["operation_limits"].as<std::map<std::string, long>> ();
+    }
+
+    if (root_node["local_interface_pollers"]) {
+        local_interface_pollers = root_node["local_interface_pollers"].as<int> ();
+    }
+
+    if (root_node["statistics_stream_period"]) {
+        statistics_stream_period = root_node["statistics_stream_period"].as<uint64_t> ();
+    }
+
+    if (root_node["history_max_stages"]) {
+        history_max_stages = root_node["history_max_stages"].as<std::size_t> ();
+    }
+
+    if (root_node["max_cycle_period"]) {
+        auto period = root_node["max_cycle_period"].as<int64_t> ();
+        if (period > 0) {
+            max_cycle_period = static_cast<uint64_t> (period);
+        } else {
+            Logging::log_error ("max_cycle_period must be greater than 0!");
+        }
+    }
+
+    // the period is fixed unless a minimum is given
+    min_cycle_period = max_cycle_period;
+    if (root_node["min_cycle_period"]) {
+        auto period = root_node["min_cycle_period"].as<int64_t> ();
+        if (period > 0) {
+            min_cycle_period = static_cast<uint64_t> (period);
+        } else {
+            Logging::log_error ("min_cycle_period must be greater than 0!");
+        }
+    }
+
+    if (min_cycle_period > max_cycle_period) {
+        Logging::log_error ("min_cycle_period cannot be greater than max_cycle_period!");
+        min_cycle_period = max_cycle_period;
+    }
+
+    if (root_node["metrics_port"]) {
+        metrics_port = root_node["metrics_port"].as<int> ();
+    }
+
+    if (root_node["metrics_address"]) {
+        metrics_address = root_node["metrics_address"].as<std::string> ();
+    }
 }
 
 // process_local_controller_config call. Process local controller configuration.
@@ -114,6 +173,14 @@ void ConfigFileParser::process_local_controller_config (YAML::Node root_node)
     } else {
         Logging::log_error ("Local controller address needs to be provided!");
     }
+
+    if (root_node["metrics_port"]) {
+        metrics_port = root_node["metrics_port"].as<int> ();
+    }
+
+    if (root_node["metrics_address"]) {
+        metrics_address = root_node["metrics_address"].as<std::string> ();
+    }
 }
 
 // process_config_file call. Process configuration file.
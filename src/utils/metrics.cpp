@@ -0,0 +1,254 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <cheferd/utils/metrics.hpp>
+#include <sstream>
+
+namespace cheferd {
+
+namespace {
+
+/**
+ * MetricFamily struct.
+ * Metrics with the same name, by labels.
+ * - m_help: description of the metrics.
+ * - m_type: type of the metrics (counter, gauge, or histogram).
+ * - m_metrics: container used for mapping the labels to the metric.
+ */
+struct MetricFamily {
+    std::string m_help {};
+    std::string m_type {};
+    std::map<std::string, std::unique_ptr<Metric>> m_metrics {};
+};
+
+/**
+ * Registry struct.
+ * Metrics of the controller, by name.
+ * - m_lock: mutex for concurrency control over m_families (not over the metrics' values).
+ * - m_families: container used for mapping the name to the metrics.
+ */
+struct Registry {
+    std::mutex m_lock {};
+    std::map<std::string, MetricFamily> m_families {};
+};
+
+// registry call. Gets the registry (constructed on first use).
+Registry& registry ()
+{
+    static Registry registry {};
+    return registry;
+}
+
+// get_or_register call. Gets a metric, registering it with the given factory if needed.
+template <typename Type, typename Factory>
+Type& get_or_register (const std::string& name,
+    const std::string& help,
+    const std::string& type,
+    const std::string& labels,
+    Factory factory)
+{
+    Registry& metrics = registry ();
+    std::unique_lock<std::mutex> lock_t { metrics.m_lock };
+
+    MetricFamily& family = metrics.m_families[name];
+    if (family.m_type.empty ()) {
+        family.m_help = help;
+        family.m_type = type;
+    }
+
+    std::unique_ptr<Metric>& metric = family.m_metrics[labels];
+    if (metric == nullptr) {
+        metric = factory ();
+    }
+
+    return static_cast<Type&> (*metric);
+}
+
+// format_value call. Formats a sample value.
+std::string format_value (double value)
+{
+    std::ostringstream stream;
+    stream << value;
+    return stream.str ();
+}
+
+// sample_name call. Formats the name and labels of a sample.
+std::string sample_name (const std::string& name, const std::string& labels)
+{
+    return labels.empty () ? name : name + "{" + labels + "}";
+}
+
+// add_atomic call. Adds to an atomic double (fetch_add is not available before C++20).
+void add_atomic (std::atomic<double>& target, double amount)
+{
+    double current = target.load (std::memory_order_relaxed);
+    while (!target.compare_exchange_weak (current, current + amount, std::memory_order_relaxed)) { }
+}
+
+} // namespace
+
+// Metric default destructor.
+Metric::~Metric () = default;
+
+// increment call. Adds to the counter.
+void Counter::increment (uint64_t amount)
+{
+    value_.fetch_add (amount, std::memory_order_relaxed);
+}
+
+// value call. Gets the value of the counter.
+uint64_t Counter::value () const
+{
+    return value_.load (std::memory_order_relaxed);
+}
+
+// render call. Appends the sample of the counter.
+void Counter::render (const std::string& name,
+    const std::string& labels,
+    std::string& output) const
+{
+    output += sample_name (name, labels) + " " + std::to_string (value ()) + "\n";
+}
+
+// set call. Sets the value of the gauge.
+void Gauge::set (double value)
+{
+    value_.store (value, std::memory_order_relaxed);
+}
+
+// add call. Adds to the value of the gauge.
+void Gauge::add (double amount)
+{
+    add_atomic (value_, amount);
+}
+
+// value call. Gets the value of the gauge.
+double Gauge::value () const
+{
+    return value_.load (std::memory_order_relaxed);
+}
+
+// render call. Appends the sample of the gauge.
+void Gauge::render (const std::string& name, const std::string& labels, std::string& output) const
+{
+    output += sample_name (name, labels) + " " + format_value (value ()) + "\n";
+}
+
+// Histogram parameterized constructor.
+Histogram::Histogram (std::vector<double> bounds) :
+    bounds_ { std::move (bounds) },
+    buckets_ { new std::atomic<uint64_t>[bounds_.size () + 1] {} }
+{ }
+
+// observe call. Adds an observation.
+void Histogram::observe (double value)
+{
+    auto bucket = std::lower_bound (bounds_.begin (), bounds_.end (), value) - bounds_.begin ();
+    buckets_[bucket].fetch_add (1, std::memory_order_relaxed);
+    count_.fetch_add (1, std::memory_order_relaxed);
+    add_atomic (sum_, value);
+}
+
+// observe_since call. Adds the time elapsed since a point in time, in seconds.
+void Histogram::observe_since (std::chrono::steady_clock::time_point start)
+{
+    observe (std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ());
+}
+
+// count call. Gets the number of observations.
+uint64_t Histogram::count () const
+{
+    return count_.load (std::memory_order_relaxed);
+}
+
+// render call. Appends the (cumulative) buckets, sum, and count of the histogram.
+void Histogram::render (const std::string& name,
+    const std::string& labels,
+    std::string& output) const
+{
+    std::string prefix = labels.empty () ? "" : labels + ",";
+    uint64_t cumulative = 0;
+
+    for (std::size_t i = 0; i <= bounds_.size (); i++) {
+        cumulative += buckets_[i].load (std::memory_order_relaxed);
+        std::string bound = i < bounds_.size () ? format_value (bounds_[i]) : "+Inf";
+        output += name + "_bucket{" + prefix + "le=\"" + bound + "\"} "
+            + std::to_string (cumulative) + "\n";
+    }
+
+    output += sample_name (name + "_sum", labels) + " "
+        + format_value (sum_.load (std::memory_order_relaxed)) + "\n";
+    output += sample_name (name + "_count", labels) + " " + std::to_string (count ()) + "\n";
+}
+
+// latency_buckets call. Default buckets (in seconds) of latency histograms.
+const std::vector<double>& Metrics::latency_buckets ()
+{
+    static const std::vector<double> buckets { 0.0001,
+        0.00025,
+        0.0005,
+        0.001,
+        0.0025,
+        0.005,
+        0.01,
+        0.025,
+        0.05,
+        0.1,
+        0.25,
+        0.5,
+        1,
+        2.5 };
+    return buckets;
+}
+
+// counter call. Gets (registering it, if needed) a counter.
+Counter& Metrics::counter (const std::string& name,
+    const std::string& help,
+    const std::string& labels)
+{
+    return get_or_register<Counter> (name, help, "counter", labels, [] {
+        return std::make_unique<Counter> ();
+    });
+}
+
+// gauge call. Gets (registering it, if needed) a gauge.
+Gauge& Metrics::gauge (const std::string& name, const std::string& help, const std::string& labels)
+{
+    return get_or_register<Gauge> (name, help, "gauge", labels, [] {
+        return std::make_unique<Gauge> ();
+    });
+}
+
+// histogram call. Gets (registering it, if needed) a histogram.
+Histogram& Metrics::histogram (const std::string& name,
+    const std::string& help,
+    const std::string& labels,
+    const std::vector<double>& bounds)
+{
+    return get_or_register<Histogram> (name, help, "histogram", labels, [&bounds] {
+        return std::make_unique<Histogram> (bounds);
+    });
+}
+
+// render call. Renders every metric in Prometheus text format.
+std::string Metrics::render ()
+{
+    Registry& metrics = registry ();
+    std::unique_lock<std::mutex> lock_t { metrics.m_lock };
+    std::string output {};
+
+    for (auto const& [name, family] : metrics.m_families) {
+        output += "# HELP " + name + " " + family.m_help + "\n";
+        output += "# TYPE " + name + " " + family.m_type + "\n";
+
+        for (auto const& [labels, metric] : family.m_metrics) {
+            metric->render (name, labels, output);
+        }
+    }
+
+    return output;
+}
+
+} // namespace cheferd
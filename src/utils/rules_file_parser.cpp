@@ -4,6 +4,7 @@
 
 #include <cheferd/utils/rules_file_parser.hpp>
 #include <limits>
+#include <stdexcept>
 
 namespace cheferd {
 
@@ -564,7 +565,7 @@ long RulesFileParser::convert_posix_definitions (const std::string& posix_defini
         case "total"_:
             return static_cast<long> (POSIX::total);
         default:
-            return static_cast<long> (POSIX::no_op);
+            return convert_posix_mds_definition (posix_definitions);
     }
 }
 
@@ -611,11 +612,43 @@ std::string RulesFileParser::convert_posix_definitions (const POSIX& posix_defin
             return "metadata";
         case POSIX::total:
             return "total";
-        default:
+        default: {
+            // metadata servers are identified by their index (mds1, mds2, ..., mdsN)
+            int mds_index = static_cast<int> (posix_definitions) - posix_mds_base;
+            if (mds_index >= 0 && mds_index < posix_max_metadata_servers) {
+                return "mds" + std::to_string (mds_index + 1);
+            }
             return "no_op";
+        }
     }
 }
 
+// convert_posix_mds_definition call. Convert a metadata server definition (mdsN) from string to
+// long.
+long RulesFileParser::convert_posix_mds_definition (const std::string& posix_definitions)
+{
+    if (posix_definitions.size () <= 3 || posix_definitions.compare (0, 3, "mds") != 0
+        || posix_definitions.find_first_not_of ("0123456789", 3) != std::string::npos) {
+        return static_cast<long> (POSIX::no_op);
+    }
+
+    long mds_number = 0;
+    try {
+        mds_number = std::stol (posix_definitions.substr (3));
+    } catch (const std::out_of_range&) {
+        mds_number = std::numeric_limits<long>::max ();
+    }
+
+    if (mds_number < 1 || mds_number > posix_max_metadata_servers) {
+        Logging::log_error ("RulesFileParser: metadata server " + posix_definitions
+            + " is out of range (mds1 to mds" + std::to_string (posix_max_metadata_servers)
+            + ").");
+        return -1;
+    }
+
+    return posix_mds_base + mds_number - 1;
+}
+
 // convert_posix_meta_definitions call. Convert POSIX_META differentiation definitions from string
 // to long and vice-versa.
 long RulesFileParser::convert_posix_meta_definitions (const std::string& posix_meta_definitions)
@@ -0,0 +1,141 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <algorithm>
+#include <cheferd/networking/local_interface.hpp>
+#include <cheferd/session/local_controller_session.hpp>
+#include <cheferd/utils/logging.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cheferd;
+
+// Address of the local controller of the session under test (never contacted).
+#define TEST_LOCAL_ADDRESS "127.0.0.1:50191"
+
+/**
+ * fill_statistics: Fills the statistics of a local controller with a stage that reports
+ * per-channel statistics, a stage that only reports its total rate, and a disconnected stage.
+ * @param stats Statistics to be filled.
+ */
+void fill_statistics (StatsGlobalMap& stats)
+{
+    stats.set_m_sequence (1);
+    auto& stats_map = *stats.mutable_gl_stats ();
+
+    controllers_grpc_interface::StatsGlobal& channels_stage = stats_map["job+channels"];
+    channels_stage.set_m_metadata_total_rate (3000);
+    channels_stage.set_m_rate_variance (25);
+    channels_stage.set_m_samples (4);
+    channels_stage.set_m_stats_version (stats_channel_version);
+    for (long channel_id = 0; channel_id < 3; channel_id++) {
+        controllers_grpc_interface::ChannelStats& channel
+            = (*channels_stage.mutable_m_channel_stats ())[channel_id];
+        channel.set_m_ops_rate (1000);
+        channel.set_m_bytes_rate (4096000);
+        channel.set_m_total_ops (100 * (channel_id + 1));
+        channel.set_m_delayed_ops (channel_id);
+        channel.set_m_avg_wait (12.5);
+        channel.set_m_total_bytes (409600 * (channel_id + 1));
+        channel.set_m_timestamp (1000000 + channel_id);
+    }
+
+    stats_map["job+global"].set_m_metadata_total_rate (1500);
+    stats_map["job+disconnected"].set_m_metadata_total_rate (-1);
+}
+
+/**
+ * same_channel_stats: Verifies that two containers hold the same channel statistics (in any order).
+ * @param first Statistics of each channel.
+ * @param second Statistics of each channel.
+ * @return Returns true if the statistics are the same, false otherwise.
+ */
+bool same_channel_stats (std::vector<StatsChannelRaw> first, std::vector<StatsChannelRaw> second)
+{
+    auto by_channel = [] (const StatsChannelRaw& left, const StatsChannelRaw& right) {
+        return left.m_channel_id < right.m_channel_id;
+    };
+    std::sort (first.begin (), first.end (), by_channel);
+    std::sort (second.begin (), second.end (), by_channel);
+
+    return std::equal (first.begin (),
+        first.end (),
+        second.begin (),
+        second.end (),
+        [] (const StatsChannelRaw& left, const StatsChannelRaw& right) {
+            return left.m_channel_id == right.m_channel_id && left.m_ops_rate == right.m_ops_rate
+                && left.m_bytes_rate == right.m_bytes_rate
+                && left.m_total_ops == right.m_total_ops
+                && left.m_delayed_ops == right.m_delayed_ops
+                && left.m_avg_wait == right.m_avg_wait
+                && left.m_total_bytes == right.m_total_bytes
+                && left.m_timestamp == right.m_timestamp;
+        });
+}
+
+/**
+ * same_response: Verifies that two statistics responses of a data plane stage are the same.
+ * @param first Statistics response.
+ * @param second Statistics response.
+ * @return Returns true if the responses are the same, false otherwise.
+ */
+bool same_response (const StageResponse* first, const StageResponse* second)
+{
+    const auto* first_stat = dynamic_cast<const StageResponseStat*> (first);
+    const auto* second_stat = dynamic_cast<const StageResponseStat*> (second);
+
+    return first_stat != nullptr && second_stat != nullptr
+        && first_stat->ResponseType () == second_stat->ResponseType ()
+        && first_stat->get_total_rate () == second_stat->get_total_rate ()
+        && first_stat->get_rate_variance () == second_stat->get_rate_variance ()
+        && first_stat->get_samples () == second_stat->get_samples ()
+        && same_channel_stats (first_stat->get_channel_stats (), second_stat->get_channel_stats ());
+}
+
+/**
+ * Verifies that the statistics pushed through the statistics stream are converted to the same
+ * StageResponses as the replies of the unary statistics requests.
+ */
+int main (int argc, char** argv)
+{
+    Logging logger { false };
+    StatsGlobalMap stats {};
+    fill_statistics (stats);
+
+    // unary statistics requests
+    std::unique_ptr<std::unordered_map<std::string, std::unique_ptr<StageResponse>>> unary_objects
+        = std::make_unique<std::unordered_map<std::string, std::unique_ptr<StageResponse>>> ();
+    LocalInterface::fill_global_statistics (stats, COLLECT_GLOBAL_STATS, unary_objects);
+
+    // statistics stream
+    LocalControllerSession session { TEST_LOCAL_ADDRESS };
+    session.PublishStatistics (stats);
+    std::unique_ptr<StageResponse> stream_response = session.GetLatestStatistics ();
+    auto* stream_stats = dynamic_cast<StageResponseStats*> (stream_response.get ());
+
+    if (stream_stats == nullptr || stream_stats->ResponseType () != COLLECT_GLOBAL_STATS) {
+        std::cout << "FAIL\tstream response\n";
+        return 1;
+    }
+
+    bool passed = stream_stats->m_stats_ptr->size () == unary_objects->size ();
+    std::cout << (passed ? "PASS" : "FAIL") << "\tnumber of stages\n";
+
+    for (const auto& [stage_name_env, unary_response] : *unary_objects) {
+        auto stream_stage = stream_stats->m_stats_ptr->find (stage_name_env);
+        bool same = stream_stage != stream_stats->m_stats_ptr->end ()
+            && same_response (stream_stage->second.get (), unary_response.get ());
+
+        std::cout << (same ? "PASS" : "FAIL") << "\t" << stage_name_env << "\n";
+        passed &= same;
+    }
+
+    // statistics are only returned once
+    bool consumed = session.GetLatestStatistics () == nullptr;
+    std::cout << (consumed ? "PASS" : "FAIL") << "\tstatistics consumed\n";
+    passed &= consumed;
+
+    return passed ? 0 : 1;
+}
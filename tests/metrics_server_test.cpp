@@ -0,0 +1,100 @@
+/**
+ *   Copyright (c) 2022 INESC TEC.
+ **/
+
+#include <cheferd/networking/metrics_server.hpp>
+#include <cheferd/utils/logging.hpp>
+#include <iostream>
+#include <string>
+
+extern "C" {
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+}
+
+using namespace cheferd;
+
+// Port of the metrics server under test.
+#define TEST_METRICS_PORT 50190
+
+/**
+ * request: Sends a request to the metrics server (closing the writing side of the connection
+ * afterwards), and reads its response.
+ * @param request Bytes of the request.
+ * @return Response of the server (empty if the connection failed).
+ */
+std::string request (const std::string& request)
+{
+    int socket_fd = socket (AF_INET, SOCK_STREAM, 0);
+    if (socket_fd < 0) {
+        return "";
+    }
+
+    struct sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons (TEST_METRICS_PORT);
+    inet_pton (AF_INET, "127.0.0.1", &address.sin_addr);
+
+    std::string response {};
+    if (connect (socket_fd, (struct sockaddr*)&address, sizeof (address)) == 0
+        && write (socket_fd, request.data (), request.size ())
+            == static_cast<ssize_t> (request.size ())) {
+        shutdown (socket_fd, SHUT_WR);
+
+        char buffer[4096];
+        ssize_t bytes;
+        while ((bytes = read (socket_fd, buffer, sizeof (buffer))) > 0) {
+            response.append (buffer, bytes);
+        }
+    }
+
+    close (socket_fd);
+    return response;
+}
+
+/**
+ * expect_status: Verifies that a request is answered with a status.
+ * @param name Name of the case.
+ * @param request_bytes Bytes of the request.
+ * @param status Expected status (e.g., "200 OK").
+ * @return Returns true if the response has the status, false otherwise.
+ */
+bool expect_status (const std::string& name,
+    const std::string& request_bytes,
+    const std::string& status)
+{
+    std::string response = request (request_bytes);
+    bool passed = response.rfind ("HTTP/1.1 " + status + "\r\n", 0) == 0;
+
+    std::cout << (passed ? "PASS" : "FAIL") << "\t" << name << "\n";
+    return passed;
+}
+
+/**
+ * Verifies that the metrics server answers requests without a complete request line (without
+ * CRLF, or truncated) with 400, and keeps serving requests afterwards.
+ */
+int main (int argc, char** argv)
+{
+    Logging logger { false };
+    MetricsServer server { "127.0.0.1", TEST_METRICS_PORT };
+
+    if (!server.start ()) {
+        std::cout << "FAIL\tstart\n";
+        return 1;
+    }
+
+    bool passed = true;
+    passed &= expect_status ("request without CRLF", "GET /metrics HTTP/1.1", "400 Bad Request");
+    passed &= expect_status ("stray bytes", std::string ("\0\1\2", 3), "400 Bad Request");
+    passed &= expect_status ("request with LF", "GET /metrics HTTP/1.1\n\n", "200 OK");
+    passed &= expect_status ("request too large", std::string (4096, 'x'), "400 Bad Request");
+    passed &= expect_status ("unknown path", "GET /other HTTP/1.1\r\n\r\n", "404 Not Found");
+    passed &= expect_status ("request", "GET /metrics HTTP/1.1\r\n\r\n", "200 OK");
+
+    server.stop ();
+
+    return passed ? 0 : 1;
+}